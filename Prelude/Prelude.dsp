@@ -256,6 +256,58 @@ SOURCE=..\Source\path.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\pathgraph.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\chunkstreamer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\chunkresidency.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\offscreensim.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\replay.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\profiler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\heightfield.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\bakegraph.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\mesharchive.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\assetregistry.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\hashindex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\mappedarea.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\workerpool.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\Pickpocket.cpp
 # End Source File
 # Begin Source File
@@ -276,6 +328,10 @@ SOURCE=..\Source\script.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\scriptvm.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\scriptfuncs.cpp
 # End Source File
 # Begin Source File
@@ -300,6 +356,14 @@ SOURCE=..\Source\things.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\thingindex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\fieldschema.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\updateworld.cpp
 # End Source File
 # Begin Source File
@@ -424,6 +488,22 @@ SOURCE=..\Source\path.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\pathgraph.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\chunkstreamer.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\chunkresidency.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\mappedarea.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\portals.h
 # End Source File
 # Begin Source File
@@ -468,6 +548,14 @@ SOURCE=..\Source\things.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\thingindex.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\Source\fieldschema.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\walls.h
 # End Source File
 # Begin Source File
@@ -568,6 +656,10 @@ SOURCE=..\Source\ZSutilities.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\Source\debuglog.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\Source\ZSutilities.h
 # End Source File
 # End Group
@@ -21,8 +21,8 @@
 #include <assert.h>
 #include "regions.h"
 #include "area.h"
-
-float TempBuf[9 * 9];
+#include "pathgraph.h"
+#include "profiler.h"
 
 #define TDIR_N	44
 #define TDIR_NE 48
@@ -43,6 +43,7 @@ TextureGroup Chunk::ChunkTextures(CHUNK_TEXTURE_WIDTH, CHUNK_TEXTURE_HEIGHT);
 Chunk::Chunk()
 {
 	pTerrainTexture = NULL;
+	Scratch = FALSE;
 
 	//create the texture for the chunk
 	pObjectList = NULL;
@@ -632,18 +633,17 @@ void Chunk::InitTerrain()
 
 //end: Debug ***********************************************************
 
-void Chunk::Load(FILE *fp)
+//everything but the objects, touches nothing outside the chunk so the
+//streamer's loader thread can call it
+void Chunk::LoadStatic(FILE *fp)
 {
+	float TempBuf[CHUNK_CORNERS];
+
 	fread(&X,sizeof(X),1,fp);
 	fread(&Y,sizeof(Y),1,fp);
 //	fread(Regions,sizeof(unsigned short) * NUM_CHUNK_REGIONS,1,fp);
 	
 	int xn,yn;
-	int VertOffset = 0;
-	int XOffset;
-	int YOffset;
-	XOffset = X * CHUNK_WIDTH * 2;
-	YOffset = Y * CHUNK_HEIGHT * 2;
 
 	int n, overlayn;
 	for(n = 0; n < CHUNK_WIDTH; n++)
@@ -660,53 +660,142 @@ void Chunk::Load(FILE *fp)
 
 	fread(TileHeights, sizeof(float),CHUNK_TILE_WIDTH * CHUNK_TILE_HEIGHT,fp);
 	
-	fread(TempBuf,sizeof(float),9*9,fp);
+	fread(TempBuf,sizeof(float),CHUNK_CORNERS,fp);
+
+	BuildVerts(TempBuf);
+
+	fread(DrawList,sizeof(unsigned short), CHUNK_DRAW_LENGTH, fp);
+
+	fread(&NumObjects,sizeof(int),1,fp);
+
+	assert(NumObjects < 8*8*4);
+
+	for(yn = 0; yn < CHUNK_HEIGHT; yn++)
+	for(xn = 0; xn < CHUNK_WIDTH; xn++)
+	{
+		ResetTile(xn,yn);
+	}
+}
+
+//the file must be positioned where LoadStatic left off
+void Chunk::LoadObjects(FILE *fp)
+{
+	Object *pOb;
+	int n;
+
+	//note this inverts the order from the save order
+	//should not matter.
+	for(n = 0; n < NumObjects; n++)
+	{
+	//	pOb = new Object;
+	//	pOb->Load(fp);
+
+		pOb = LoadObject(fp);
+		AddObject(pOb);
+	}
+}
+
+void Chunk::Load(FILE *fp)
+{
+	ProfileZone LoadZone(ZONE_CHUNK_LOAD);
+
+	LoadStatic(fp);
+	LoadObjects(fp);
+}
+
+void Chunk::BuildVerts(const float *Corners)
+{
+	int xn,yn;
+	int VertOffset = 0;
+	int XOffset;
+	int YOffset;
+	XOffset = X * CHUNK_WIDTH * 2;
+	YOffset = Y * CHUNK_HEIGHT * 2;
 
 	for(yn = 0; yn < CHUNK_TILE_HEIGHT; yn += 2)
 	for(xn = 0; xn < CHUNK_TILE_WIDTH; xn += 2)
 	{
 		Verts[VertOffset + tx1] = (float)xn + XOffset;
 		Verts[VertOffset + ty1] = (float)yn + YOffset;
-		Verts[VertOffset + tz1] = TempBuf[(xn/2) + (yn/2) * 9];
+		Verts[VertOffset + tz1] = Corners[(xn/2) + (yn/2) * 9];
 		
 		Verts[VertOffset + tx2] = (float)xn + XOffset + 2;
 		Verts[VertOffset + ty2] = (float)yn + YOffset;
-		Verts[VertOffset + tz2] = TempBuf[(xn/2) + 1 + (yn/2) * 9];
+		Verts[VertOffset + tz2] = Corners[(xn/2) + 1 + (yn/2) * 9];
 
 		Verts[VertOffset + tx3] = (float)xn + XOffset;
 		Verts[VertOffset + ty3] = (float)yn + YOffset + 2;
-		Verts[VertOffset + tz3] = TempBuf[(xn/2) + ((yn/2)+1) * 9];
+		Verts[VertOffset + tz3] = Corners[(xn/2) + ((yn/2)+1) * 9];
 
 		Verts[VertOffset + tx4] = (float)xn + XOffset + 2;
 		Verts[VertOffset + ty4] = (float)yn + YOffset + 2;
-		Verts[VertOffset + tz4] = TempBuf[(xn/2) + 1 + ((yn/2)+1) * 9];
+		Verts[VertOffset + tz4] = Corners[(xn/2) + 1 + ((yn/2)+1) * 9];
 
 		VertOffset += 24;
 	}
+}
 
-	fread(DrawList,sizeof(unsigned short), CHUNK_DRAW_LENGTH, fp);
+//the same state LoadStatic leaves, with no file reads.  Safe on the loader
+//thread for the same reasons.
+void Chunk::LoadMapped(const MAPPED_CHUNK_T *pRecord)
+{
+	ProfileZone LoadZone(ZONE_CHUNK_LOAD);
 
-	fread(&NumObjects,sizeof(int),1,fp);
+	int xn,yn;
 
-	assert(NumObjects < 8*8*4);
+	X = pRecord->X;
+	Y = pRecord->Y;
+	NumObjects = pRecord->NumObjects;
 
-	Object *pOb;
+	memcpy(Terrain, pRecord->Terrain, sizeof(Terrain));
+	memcpy(Overlays, pRecord->Overlays, sizeof(Overlays));
+	memcpy(DrawList, pRecord->DrawList, sizeof(DrawList));
+	memcpy(Blocking, pRecord->Blocking, sizeof(Blocking));
+	memcpy(TileHeights, pRecord->TileHeights, sizeof(TileHeights));
 
-	//note this inverts the order from the save order
-	//should not matter.
-	for(n = 0; n < NumObjects; n++)
-	{
-	//	pOb = new Object;
-	//	pOb->Load(fp);
+	BuildVerts(pRecord->Corners);
 
-		pOb = LoadObject(fp);
-		AddObject(pOb);
+	for(yn = 0; yn < CHUNK_HEIGHT; yn++)
+	for(xn = 0; xn < CHUNK_WIDTH; xn++)
+	{
+		ResetTile(xn,yn);
 	}
+}
+
+//ObjectOffset is left for the caller, only it knows where the objects went
+void Chunk::SaveMapped(MAPPED_CHUNK_T *pRecord)
+{
+	int xn,yn;
+	int VertOffset = 0;
 
+	pRecord->X = X;
+	pRecord->Y = Y;
+	pRecord->NumObjects = NumObjects;
+
+	memcpy(pRecord->Terrain, Terrain, sizeof(Terrain));
+	memcpy(pRecord->Overlays, Overlays, sizeof(Overlays));
+	memcpy(pRecord->DrawList, DrawList, sizeof(DrawList));
+	memcpy(pRecord->Blocking, Blocking, sizeof(Blocking));
+	memcpy(pRecord->TileHeights, TileHeights, sizeof(TileHeights));
+
+	//every corner is the first vertex of some tile or an edge of the last ones
 	for(yn = 0; yn < CHUNK_HEIGHT; yn++)
 	for(xn = 0; xn < CHUNK_WIDTH; xn++)
 	{
-		ResetTile(xn,yn);
+		pRecord->Corners[xn + yn * 9] = Verts[VertOffset + tz1];
+		if(xn == CHUNK_WIDTH - 1)
+		{
+			pRecord->Corners[xn + 1 + yn * 9] = Verts[VertOffset + tz2];
+		}
+		if(yn == CHUNK_HEIGHT - 1)
+		{
+			pRecord->Corners[xn + (yn + 1) * 9] = Verts[VertOffset + tz3];
+			if(xn == CHUNK_WIDTH - 1)
+			{
+				pRecord->Corners[xn + 1 + (yn + 1) * 9] = Verts[VertOffset + tz4];
+			}
+		}
+		VertOffset += 24;
 	}
 }
 
@@ -1099,6 +1188,7 @@ void Chunk::ResetBlocking()
 {
 	
 	memset(Blocking,0, CHUNK_HEIGHT * 2);
+	InvalidatePaths();
 
 	return;
 
@@ -1130,14 +1220,33 @@ void Chunk::ResetBlocking()
 
 static unsigned short BaseBlock = 1;
 
+//the portal graph has to be rebuilt around any change to blocking or heights
+void Chunk::InvalidatePaths(int x, int y)
+{
+	if(!Scratch && Valley && Valley->GetPathGraph())
+	{
+		Valley->GetPathGraph()->InvalidateTile(X * CHUNK_TILE_WIDTH + x, Y * CHUNK_TILE_HEIGHT + y);
+	}
+}
+
+void Chunk::InvalidatePaths()
+{
+	if(!Scratch && Valley && Valley->GetPathGraph())
+	{
+		Valley->GetPathGraph()->InvalidateChunk(X, Y);
+	}
+}
+
 void Chunk::SetBlocking(int x, int y)
 {
 	Blocking[y] = Blocking[y] | (BaseBlock << x);
+	InvalidatePaths(x,y);
 }
 
 void Chunk::RemoveBlocking(int x, int y)
 {
 	Blocking[y] = Blocking[y] ^ (BaseBlock << x);
+	InvalidatePaths(x,y);
 }
 
 BOOL Chunk::GetBlocking(int x, int y)
@@ -1232,7 +1341,7 @@ void Chunk::CreateHeightMap()
 		//sw
 		if(fMid > fSW && fMid > fW && fMid > fS)
 		{
-			TileHeights[xn*2 + 1 + (yn*2 + 1)*(2*CHUNK_WIDTH)] = fMid;
+			TileHeights[xn*2 + (yn*2 + 1)*(2*CHUNK_WIDTH)] = fMid;
 		}
 		else
 		if(fSW > fS && fSW > fW)
@@ -1269,6 +1378,7 @@ void Chunk::CreateHeightMap()
 			TileHeights[xn*2 + 1 + (yn*2 + 1)*(2*CHUNK_WIDTH)] = fE;
 		}
 	}
+	InvalidatePaths();
 }
 
 void Chunk::RemoveTile(int x, int y)
@@ -1459,6 +1569,7 @@ void Chunk::Smooth(BYTE *pTerrains, int Pitch)
 void Chunk::SetTileHeight(int x, int y, float NewHeight)
 {
 	TileHeights[x + y * CHUNK_TILE_WIDTH] = NewHeight;
+	InvalidatePaths(x,y);
 }
 
 void Chunk::BlockBySlope(float fTestSlope)
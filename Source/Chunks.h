@@ -78,6 +78,23 @@ typedef enum
 
 #define NUM_CHUNK_VERTS	(CHUNK_WIDTH * CHUNK_HEIGHT * 4)
 #define CHUNK_DRAW_LENGTH (CHUNK_WIDTH * CHUNK_HEIGHT * 6)
+#define CHUNK_CORNERS	((CHUNK_WIDTH + 1) * (CHUNK_HEIGHT + 1))
+
+//a chunk's static arrays as they sit in memory, the record format of the
+//mapped area files.  Every array is copied in or out whole.
+typedef struct
+{
+	int X;
+	int Y;
+	int NumObjects;
+	int ObjectOffset;	//where this chunk's objects start in the .bin
+	unsigned short Terrain[CHUNK_WIDTH][CHUNK_HEIGHT];
+	unsigned short Overlays[CHUNK_WIDTH][CHUNK_HEIGHT][NUM_OVERLAYS];
+	unsigned short DrawList[CHUNK_DRAW_LENGTH];
+	unsigned short Blocking[CHUNK_TILE_HEIGHT];
+	float TileHeights[CHUNK_TILE_WIDTH * CHUNK_TILE_HEIGHT];
+	float Corners[CHUNK_CORNERS];
+} MAPPED_CHUNK_T;
 
 //class Region;
 
@@ -100,6 +117,9 @@ private:
 
 	int	X;
 	int	Y;
+	//a bake's or an edit's working copy rather than one of the area's,
+	//it leaves the area's path graph alone
+	BOOL Scratch;
 	ZSTexture *pTerrainTexture;
 	Object *pObjectList;
 	Object *pObjectList2;
@@ -127,6 +147,9 @@ private:
 		//texture number
 		//run length
 	//Regions
+
+	//positions from the 9x9 grid of corner heights the files hold
+	void BuildVerts(const float *Corners);
 	
 //************************************************************************************** 
 
@@ -158,6 +181,9 @@ public:
 
 // Mutators -----------------------------------------
 	void Load(FILE *fp);
+	void LoadStatic(FILE *fp);
+	void LoadObjects(FILE *fp);
+	void LoadMapped(const MAPPED_CHUNK_T *pRecord);
 	int AddObject(Object *pAddObject);
 	int RemoveObject(Object *pToRemove);
 	
@@ -167,6 +193,8 @@ public:
 		Y = y;
 	}
 
+	void SetScratch(BOOL NewScratch) { Scratch = NewScratch; }
+
 	int CreateTexture(ZSTexture *pBaseTexture = NULL);
 
 	void ResetTile(int x, int y);
@@ -188,6 +216,8 @@ public:
 
 
 	void ResetBlocking();
+	void InvalidatePaths(int x, int y);
+	void InvalidatePaths();
 
 	BOOL IsFlipped(int x, int y) { return Blocking[x + y * CHUNK_WIDTH] & DRAW_FLIPPED; }
 	void RemoveTile(int x, int y);
@@ -205,6 +235,7 @@ public:
 // Output ---------------------------------------------
 	void Save(FILE *fp);
 	void SaveBrief(FILE *fp);
+	void SaveMapped(MAPPED_CHUNK_T *pRecord);
   
 // Constructors ---------------------------------------
 	Chunk();
@@ -1,4 +1,5 @@
 #include "combatmanager.h"
+#include "profiler.h"
 #include "objects.h"
 #include "things.h"
 #include "creatures.h"
@@ -30,6 +31,8 @@ void Combat::FillCombatArea()
 	rCombat.top = PreludeParty.GetLeader()->GetPosition()->y - CREATURE_RANGE;
 	rCombat.bottom = rCombat.top + COMBAT_HEIGHT;
 
+	InvalidateLineOfSight();
+
 	if(rCombat.left < 0)
 	{
 		rCombat.left = 0;
@@ -180,77 +183,210 @@ void Combat::RecordMoveLeft(int xn, int yn, int mp)
 }
 
 
-void inline Combat::CreautureMoveTileSurround(int xn, int yn, int AttackP, int MP)
+//a step in each direction, indexed by DIRECTION_T
+static int FloodStepX[9] = { 0, 0, 1, 1, 1, 0, -1, -1, -1 };
+static int FloodStepY[9] = { 0, -1, -1, 0, 1, 1, 1, 0, -1 };
+
+void Combat::FloodPush(int Offset)
+{
+	int Index;
+	int Parent;
+	unsigned short Moving;
+
+	Index = FloodHeapIndex[Offset];
+	if(Index < 0)
+	{
+		Index = FloodOpen++;
+	}
+
+	Moving = (unsigned short)Offset;
+	while(Index > 0)
+	{
+		Parent = (Index - 1) / 2;
+		if(FloodCost[FloodHeap[Parent]] <= FloodCost[Moving])
+		{
+			break;
+		}
+		FloodHeap[Index] = FloodHeap[Parent];
+		FloodHeapIndex[FloodHeap[Index]] = Index;
+		Index = Parent;
+	}
+	FloodHeap[Index] = Moving;
+	FloodHeapIndex[Moving] = Index;
+}
+
+int Combat::FloodPop()
+{
+	int Top;
+	int Index;
+	int Child;
+	unsigned short Moving;
+
+	Top = FloodHeap[0];
+	FloodHeapIndex[Top] = -1;
+	FloodOpen--;
+	if(!FloodOpen)
+	{
+		return Top;
+	}
+
+	Moving = FloodHeap[FloodOpen];
+	Index = 0;
+	while((Child = Index * 2 + 1) < FloodOpen)
+	{
+		if(Child + 1 < FloodOpen && FloodCost[FloodHeap[Child + 1]] < FloodCost[FloodHeap[Child]])
+		{
+			Child++;
+		}
+		if(FloodCost[Moving] <= FloodCost[FloodHeap[Child]])
+		{
+			break;
+		}
+		FloodHeap[Index] = FloodHeap[Child];
+		FloodHeapIndex[FloodHeap[Index]] = Index;
+		Index = Child;
+	}
+	FloodHeap[Index] = Moving;
+	FloodHeapIndex[Moving] = Index;
+
+	return Top;
+}
+
+//one search from xn,yn to every tile in the combat area, moving as
+//FindCombatPath does at MP a straight step and half as much again a
+//diagonal one
+void Combat::FloodFill(int xn, int yn, int MP)
+{
+	int n;
+	int Offset;
+	int ToOffset;
+	int FromX;
+	int FromY;
+	int ToX;
+	int ToY;
+	int Dir;
+	int NewCost;
+
+	for(n = 0; n < COMBAT_WIDTH * COMBAT_HEIGHT; n++)
+	{
+		FloodCost[n] = FLOOD_UNREACHED;
+	}
+	memset(FloodDir, DIR_NONE, sizeof(char) * COMBAT_WIDTH * COMBAT_HEIGHT);
+	memset(FloodHeapIndex, -1, sizeof(int) * COMBAT_WIDTH * COMBAT_HEIGHT);
+	FloodOpen = 0;
+
+	FloodX = xn;
+	FloodY = yn;
+	FloodValid = TRUE;
+
+	if(xn < rCombat.left || xn >= rCombat.right || yn < rCombat.top || yn >= rCombat.bottom)
+	{
+		return;
+	}
+
+	Offset = COMBATCONVERT(xn,yn);
+	FloodCost[Offset] = 0;
+	FloodPush(Offset);
+
+	while(FloodOpen)
+	{
+		Offset = FloodPop();
+		FromX = Offset % COMBAT_WIDTH + rCombat.left;
+		FromY = Offset / COMBAT_WIDTH + rCombat.top;
+
+		for(Dir = NORTH; Dir <= NORTHWEST; Dir++)
+		{
+			ToX = FromX + FloodStepX[Dir];
+			ToY = FromY + FloodStepY[Dir];
+			if(ToX < rCombat.left || ToX >= rCombat.right || ToY < rCombat.top || ToY >= rCombat.bottom)
+			{
+				continue;
+			}
+
+			ToOffset = COMBATCONVERT(ToX,ToY);
+			if(CreatureArea[ToOffset] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED))
+			{
+				continue;
+			}
+
+			if(ToX != FromX && ToY != FromY)
+			{
+				//the same corner rule as FindCombatPath
+				if(CreatureArea[COMBATCONVERT(FromX,ToY)] & CreatureArea[COMBATCONVERT(ToX,FromY)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED))
+				{
+					continue;
+				}
+				NewCost = FloodCost[Offset] + MP + MP / 2;
+			}
+			else
+			{
+				NewCost = FloodCost[Offset] + MP;
+			}
+
+			if(NewCost < FloodCost[ToOffset])
+			{
+				FloodCost[ToOffset] = NewCost;
+				FloodDir[ToOffset] = (char)Dir;
+				FloodPush(ToOffset);
+			}
+		}
+	}
+}
+
+int Combat::GetFloodLength(int xn, int yn)
 {
-	int tx = xn - 1;
-	int ty = yn - 1;
-	int AP = GetMoveLeft(xn,yn);
-	if(AP < 0) return;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - (MP + MP / 2));
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - MP);
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - (MP + MP / 2));
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx = xn - 1;
-	ty++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - MP);
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx = xn + 1;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - MP);
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx = xn - 1;
-	ty++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - (MP + MP / 2));
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - MP);
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	}
-	tx++;
-	if(!(CreatureArea[COMBATCONVERT(tx,ty)] & (COMBAT_LOCATION_BLOCKED | COMBAT_LOCATION_OCCUPIED)))
-	{
-		CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_WALKABLE;
-		RecordMoveLeft(tx,ty,AP - (MP + MP / 2));
-		if(AP > AttackP)
-			CreatureArea[COMBATCONVERT(tx,ty)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
+	int Offset;
+	int Length;
+
+	if(!FloodValid || xn < rCombat.left || xn >= rCombat.right || yn < rCombat.top || yn >= rCombat.bottom)
+	{
+		return -1;
+	}
+
+	Offset = COMBATCONVERT(xn,yn);
+	if(FloodCost[Offset] == FLOOD_UNREACHED)
+	{
+		return -1;
+	}
+
+	Length = 0;
+	while(FloodDir[Offset] != DIR_NONE)
+	{
+		xn -= FloodStepX[FloodDir[Offset]];
+		yn -= FloodStepY[FloodDir[Offset]];
+		Offset = COMBATCONVERT(xn,yn);
+		Length++;
 	}
+
+	return Length;
+}
+
+int Combat::GetFloodPath(int xn, int yn, int *pX, int *pY, DIRECTION_T *pDir, int MaxLength)
+{
+	int Offset;
+	int Length;
+	int n;
+
+	Length = GetFloodLength(xn,yn);
+	if(Length < 0 || Length >= MaxLength)
+	{
+		return -1;
+	}
+
+	for(n = Length; n > 0; n--)
+	{
+		Offset = COMBATCONVERT(xn,yn);
+		pX[n] = xn;
+		pY[n] = yn;
+		pDir[n] = (DIRECTION_T)FloodDir[Offset];
+		xn -= FloodStepX[FloodDir[Offset]];
+		yn -= FloodStepY[FloodDir[Offset]];
+	}
+	pX[0] = xn;
+	pY[0] = yn;
+	pDir[0] = DIR_NONE;
+
+	return Length;
 }
 
 float GetDistance(int x1, int y1, int x2, int y2)
@@ -274,6 +410,7 @@ void Combat::FillCreatureArea()
 	ZeroMemory(CreatureArea,sizeof(unsigned short) * COMBAT_WIDTH * COMBAT_HEIGHT);
 	memset(CreatureMove, -1, sizeof(char) * COMBAT_WIDTH * COMBAT_HEIGHT);
 	memcpy(CreatureArea,CombatArea,sizeof(unsigned short) * COMBAT_WIDTH * COMBAT_HEIGHT);
+	FloodValid = FALSE;
 	Creature *pActive;
 	pActive = (Creature *)this->GetActiveCombatant();
 	ZeroMemory(EnemyReferenceList, sizeof(BOOL) * MAX_COMBATANTS);
@@ -325,12 +462,13 @@ void Combat::FillCreatureArea()
 	fARange = pActive->GetData(INDEX_RANGE).fValue;
 
 	EnemiesInRange = 0;
-	Path TempPath;
 
 
 	int EnemyNum;
 	float fEnemyRange;
 	int iER;
+	int iAR;
+	int BestCost;
 
 
 	while(pOb)
@@ -376,15 +514,15 @@ void Combat::FillCreatureArea()
 					}
 				}
 			}
-/*
+			//mark the tiles this enemy could hit from where it stands
 			fEnemyRange = pCreature->GetData(INDEX_RANGE).fValue;
 			iER = (int)fEnemyRange;
 			StartX = cx-iER;
 			EndX = cx+iER;
 			StartY = cy-iER;
 			EndY = cy+iER;
-			if(StartX < 0) StartX = 0;
-			if(StartY < 0) StartY = 0;
+			if(StartX < rCombat.left) StartX = rCombat.left;
+			if(StartY < rCombat.top) StartY = rCombat.top;
 			if(EndX >= rCombat.right) EndX = rCombat.right - 1;
 			if(EndY >= rCombat.bottom) EndY = rCombat.bottom - 1;
 			
@@ -393,101 +531,92 @@ void Combat::FillCreatureArea()
 			{
 				fDist = GetDistance(xn,yn,cx,cy);
 
-				if(fDist < fEnemyRange && CheckLineOfSight(ActiveX, ActiveY, xn, yn, pActive, pOb))
+				if(fDist < fEnemyRange && CheckLineOfSight(cx, cy, xn, yn, NULL, NULL))
 				{
-					if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_THREATENED)
+					Offset = COMBATCONVERT(xn,yn);
+					if((CreatureArea[Offset] & COMBAT_LOCATION_VERY_THREATENED) == COMBAT_LOCATION_VERY_THREATENED)
 					{
-						if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_VERY_THREATENED)
-						{
-							CreatureArea[COMBATCONVERT(xn,yn)] |= COMBAT_LOCATION_EXTREME_THREAT;
-						}
-						else
-						{
-							CreatureArea[COMBATCONVERT(xn,yn)] |= COMBAT_LOCATION_VERY_THREATENED;
-						}
+						CreatureArea[Offset] |= COMBAT_LOCATION_EXTREME_THREAT;
 					}
 					else
+					if(CreatureArea[Offset] & COMBAT_LOCATION_THREATENED)
 					{
-						CreatureArea[COMBATCONVERT(xn,yn)] |= COMBAT_LOCATION_THREATENED;
+						CreatureArea[Offset] |= COMBAT_LOCATION_VERY_THREATENED;
+					}
+					else
+					{
+						CreatureArea[Offset] |= COMBAT_LOCATION_THREATENED;
 					}
-
 				}
 			}
-*/
-			if(TempPath.FindCombatPath(ActiveX, ActiveY,cx,cy, fARange))
-			{
-				TempPath.GetEnd(&PathAttackX[EnemyNum],
-								&PathAttackY[EnemyNum]);
-				PathToAttackLength[EnemyNum] = TempPath.GetLength();
-			}
-			else
-			{
-				PathAttackX[EnemyNum] = -1;
-				PathAttackY[EnemyNum] = -1;
-				PathToAttackLength[EnemyNum] = 999;
-			}
-			
 		}
 					
 		pOb = pOb->GetNextUpdate();
 	}
 
-	CreatureArea[COMBATCONVERT(ActiveX,ActiveY)] |= COMBAT_LOCATION_WALKABLE;
-	RecordMoveLeft(ActiveX,ActiveY,AP);
-	if(AP > AttackP)
-		CreatureArea[COMBATCONVERT(ActiveX,ActiveY)] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
-	CreautureMoveTileSurround(ActiveX, ActiveY, AttackP, MP);
+	//every tile is costed from where the active creature stands, now that
+	//all the combatants are marked
+	FloodFill(ActiveX, ActiveY, MP);
 
-	//fill movement area
-	for(Offset = 1; Offset <= MaxRange; Offset++)
+	//the cheapest tile to attack each enemy from
+	pOb = this->GetCombatants();
+	while(pOb)
 	{
-		AP -= MP;
-		yn = ActiveY - Offset;
-		if(yn > rCombat.top)
-		for(xn = ActiveX - Offset; xn < ActiveX + Offset; xn++)
-		{
-			if(xn > rCombat.left && xn < rCombat.right - 1 && yn < rCombat.bottom -1)
-			if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_WALKABLE)
-			{
-				CreautureMoveTileSurround(xn,yn,AttackP, MP);
-				//AddMoveTile(xn,yn, AttackP);
-			}
-		}
-		xn = ActiveX + Offset;
-		if(xn < rCombat.right - 1)
-		for(yn = ActiveY - Offset; yn < ActiveY + Offset; yn++)
-		{
-			if(xn > rCombat.left && yn > rCombat.top && yn < rCombat.bottom -1)
-			if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_WALKABLE)
-			{
-				CreautureMoveTileSurround(xn,yn,AttackP, MP);
-				//AddMoveTile(xn,yn, AttackP);
-			}
-		}
-		yn = ActiveY + Offset;
-		if(yn < rCombat.bottom - 1)
-		for(xn = ActiveX + Offset; xn > ActiveX - Offset; xn--)
+		pCreature = (Creature *) pOb;
+		EnemyNum = pOb->GetData();
+
+		if(pCreature->GetData(INDEX_BATTLESIDE).Value != BattleSide)
 		{
-			if(xn > rCombat.left && yn > rCombat.top && xn < rCombat.right - 1)
-			if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_WALKABLE)
+			int cx;
+			int cy;
+
+			cx = (int)pCreature->GetPosition()->x;
+			cy = (int)pCreature->GetPosition()->y;
+
+			PathAttackX[EnemyNum] = -1;
+			PathAttackY[EnemyNum] = -1;
+			PathToAttackLength[EnemyNum] = 999;
+
+			iAR = (int)fARange;
+			StartX = cx-iAR;
+			EndX = cx+iAR;
+			StartY = cy-iAR;
+			EndY = cy+iAR;
+			if(StartX < rCombat.left) StartX = rCombat.left;
+			if(StartY < rCombat.top) StartY = rCombat.top;
+			if(EndX >= rCombat.right) EndX = rCombat.right - 1;
+			if(EndY >= rCombat.bottom) EndY = rCombat.bottom - 1;
+
+			BestCost = FLOOD_UNREACHED;
+			for(yn = StartY; yn <= EndY; yn++)
+			for(xn = StartX; xn <= EndX; xn++)
 			{
-				CreautureMoveTileSurround(xn,yn,AttackP, MP);
-				//AddMoveTile(xn,yn, AttackP);
+				Offset = COMBATCONVERT(xn,yn);
+				if(FloodCost[Offset] < BestCost
+					&& GetDistance(xn,yn,cx,cy) <= fARange
+					&& CheckLineOfSight(xn,yn,cx,cy,NULL,NULL))
+				{
+					BestCost = FloodCost[Offset];
+					PathAttackX[EnemyNum] = xn;
+					PathAttackY[EnemyNum] = yn;
+				}
 			}
-		}
-		xn = ActiveX - Offset;
-		if(xn > rCombat.left)
-		for(yn = ActiveY + Offset; yn > ActiveY - Offset; yn--)
-		{
-			if(yn > rCombat.top && xn < rCombat.right - 1 && yn < rCombat.bottom -1)
-			if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_WALKABLE)
+
+			if(BestCost != FLOOD_UNREACHED)
 			{
-				CreautureMoveTileSurround(xn,yn,AttackP, MP);
-				//AddMoveTile(xn,yn, AttackP);
+				PathToAttackLength[EnemyNum] = GetFloodLength(PathAttackX[EnemyNum], PathAttackY[EnemyNum]);
+				if(PathToAttackLength[EnemyNum] >= MAX_PATH_LENGTH)
+				{
+					PathAttackX[EnemyNum] = -1;
+					PathAttackY[EnemyNum] = -1;
+					PathToAttackLength[EnemyNum] = 999;
+				}
 			}
 		}
+
+		pOb = pOb->GetNextUpdate();
 	}
-	
+
 	int APRemaining;
 
 	//fill in the draw list
@@ -504,13 +633,17 @@ void Combat::FillCreatureArea()
 	for(yn = StartY; yn <= EndY; yn++)
 	for(xn = StartX; xn <= EndX; xn++)
 	{
-		if(CreatureArea[COMBATCONVERT(xn,yn)] & COMBAT_LOCATION_WALKABLE)
+		Offset = COMBATCONVERT(xn,yn);
+		if(FloodCost[Offset] <= AP)
 		{
-			APRemaining = GetMoveLeft(xn,yn);
-			if(APRemaining >= 0)
+			APRemaining = AP - FloodCost[Offset];
+			CreatureArea[Offset] |= COMBAT_LOCATION_WALKABLE;
+			RecordMoveLeft(xn,yn,APRemaining);
+			if(APRemaining >= AttackP)
 			{
-				AddMoveTile(xn, yn, AttackP);
+				CreatureArea[Offset] |= COMBAT_LOCATION_TIME_FOR_ATTACK;
 			}
+			AddMoveTile(xn, yn, AttackP);
 		}
 	}
 
@@ -800,14 +933,46 @@ BOOL Combat::CheckLineOfSight(int x1, int y1, int x2, int y2, Object *pSource, O
 	}
 
 
-	int xn,yn, cn;
-	int XOffset;
-	int YOffset;
-	int Count;
-	xn = x1;
-	yn = y1;
-	
-	
+	DWORD Key;
+	DWORD Slot;
+	BOOL Clear;
+
+	//cache tile to tile results inside the combat area, the slot's top
+	//bit holds the answer
+	if(Active && LOSCache
+		&& x1 >= rCombat.left && x1 < rCombat.right && y1 >= rCombat.top && y1 < rCombat.bottom
+		&& x2 >= rCombat.left && x2 < rCombat.right && y2 >= rCombat.top && y2 < rCombat.bottom)
+	{
+		if(LOSCacheUsed >= LOS_CACHE_LIMIT)
+		{
+			InvalidateLineOfSight();
+		}
+
+		Key = (((DWORD)(COMBATCONVERT(x1,y1)) << 14) | (DWORD)(COMBATCONVERT(x2,y2))) + 1;
+		Slot = (Key * 2654435761u) >> (32 - LOS_CACHE_BITS);
+		while(LOSCache[Slot])
+		{
+			if((LOSCache[Slot] & ~LOS_CLEAR) == Key)
+			{
+				LOSHits++;
+				return (LOSCache[Slot] & LOS_CLEAR) ? TRUE : FALSE;
+			}
+			Slot = (Slot + 1) & (LOS_CACHE_SIZE - 1);
+		}
+
+		Clear = TraceLineOfSight(x1,y1,x2,y2);
+		LOSCache[Slot] = Clear ? (Key | LOS_CLEAR) : Key;
+		LOSCacheUsed++;
+		return Clear;
+	}
+
+	return TraceLineOfSight(x1,y1,x2,y2);
+}
+
+BOOL Combat::TraceLineOfSight(int x1, int y1, int x2, int y2)
+{
+	LOSTraced++;
+
 	D3DVECTOR vLineStart;
 	D3DVECTOR vLineEnd;
 	vLineStart.x = x1 + 0.5f;
@@ -998,6 +1163,25 @@ BOOL Combat::CheckLineOfSight(int x1, int y1, int x2, int y2, Object *pSource, O
 	return TRUE;
 }
 
+void Combat::InvalidateLineOfSight()
+{
+	if(!LOSCache)
+	{
+		return;
+	}
+
+	if(LOSHits || LOSTraced)
+	{
+		LogPrintf(LOG_INFO, LOG_COMBAT, "line of sight: %i cached, %i traced, %i pairs stored",
+			LOSHits, LOSTraced, LOSCacheUsed);
+	}
+
+	ZeroMemory(LOSCache, sizeof(DWORD) * LOS_CACHE_SIZE);
+	LOSCacheUsed = 0;
+	LOSHits = 0;
+	LOSTraced = 0;
+}
+
 
 Object *Combat::GetActiveCombatant()
 {
@@ -1095,6 +1279,8 @@ int Combat::SetActiveCombatant()
 
 int Combat::Update()
 {
+	ProfileZone CombatZone(ZONE_COMBAT_UPDATE);
+
 	//Object *pOb;
 	//first update non-creature things
 	///int Offset;
@@ -1856,6 +2042,7 @@ Combat::~Combat()
 	delete[] EnemiesInRangeList;
 	delete[] EnemyDistance;
 
+	delete[] LOSCache;
 }
 Combat::Combat()
 {
@@ -1948,7 +2135,15 @@ Combat::Combat()
 	EnemiesInRangeList= new Object *[256];
 	EnemyDistance = new float[256];
 
+	ZeroMemory(&rCombat, sizeof(RECT));
+	LOSCache = new DWORD[LOS_CACHE_SIZE];
+	LOSCacheUsed = 0;
+	LOSHits = 0;
+	LOSTraced = 0;
+	InvalidateLineOfSight();
 
+	FloodValid = FALSE;
+	FloodOpen = 0;
 }
 
 void Combat::Draw()
@@ -25,6 +25,16 @@ class ZSTexture;
 #define COMBAT_LOCATION_VERY_THREATENED (32 | 64)
 #define COMBAT_LOCATION_EXTREME_THREAT	(32 | 64 | 128)
 
+//line of sight between two combat tiles, hashed on the pair of tiles
+#define LOS_CACHE_BITS		16
+#define LOS_CACHE_SIZE		(1 << LOS_CACHE_BITS)
+//emptied when this full so probes stay short
+#define LOS_CACHE_LIMIT		(LOS_CACHE_SIZE * 3 / 4)
+#define LOS_CLEAR			0x80000000
+
+//flood cost of a tile the active combatant can't reach
+#define FLOOD_UNREACHED		0x7fffffff
+
 class Combat
 {
 private:
@@ -45,6 +55,18 @@ private:
 	unsigned short *MoveDrawList;
 	int NumMoveVerts;
 	D3DVERTEX *MoveVerts;
+
+	//action points from the tile the active combatant started its turn on
+	//to every tile, and the direction the cheapest way steps into it
+	int FloodCost[COMBAT_WIDTH * COMBAT_HEIGHT];
+	char FloodDir[COMBAT_WIDTH * COMBAT_HEIGHT];
+	int FloodX;
+	int FloodY;
+	BOOL FloodValid;
+	//tiles still to be spread from, a binary heap on cost
+	unsigned short FloodHeap[COMBAT_WIDTH * COMBAT_HEIGHT];
+	int FloodHeapIndex[COMBAT_WIDTH * COMBAT_HEIGHT];
+	int FloodOpen;
 	
 	int NumEnemies;
 	BOOL *EnemyReferenceList;
@@ -64,9 +86,19 @@ private:
 
 	BOOL Active;
 
+	//tile pair + 1 in the low bits, LOS_CLEAR if the line is clear
+	DWORD *LOSCache;
+	int LOSCacheUsed;
+	int LOSHits;
+	int LOSTraced;
+
 	void ClearMods();
-	
-	void inline CreautureMoveTileSurround(int xn, int yn, int AttackP, int MP);
+
+	BOOL TraceLineOfSight(int x1, int y1, int x2, int y2);
+
+	void FloodFill(int xn, int yn, int MP);
+	void FloodPush(int Offset);
+	int FloodPop();
 
 public:
 
@@ -81,6 +113,14 @@ public:
 	int GetMoveLeft(int xn, int yn);
 	void RecordMoveLeft(int xn, int yn, int ap);
 
+	//steps on the cheapest way from the start of the active combatant's turn,
+	//-1 if there is none
+	int GetFloodLength(int xn, int yn);
+	//fills pX, pY and pDir from the start, 0, to xn,yn and returns the steps.
+	//-1 if there is no way or it is MaxLength steps or more
+	int GetFloodPath(int xn, int yn, int *pX, int *pY, DIRECTION_T *pDir, int MaxLength);
+	BOOL IsFloodFrom(int xn, int yn) { return FloodValid && Active && xn == FloodX && yn == FloodY; }
+
 	void AddMoveTile(int xn, int yn, int AttackP);
 	void AddFriendTile(int xn, int yn, int AttackP);
 	void AddEnemyTile(int xn, int yn, int AttackP);
@@ -131,6 +171,8 @@ public:
 
 	BOOL InCombat() { return Active; }
 	BOOL CheckLineOfSight(int x1, int y1, int x2, int y2, Object *pSource, Object *pTarget);
+	//walls don't move during a fight, call when the area they stand in changes
+	void InvalidateLineOfSight();
 
 	friend class Area;
 	friend class World;
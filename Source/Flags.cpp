@@ -4,165 +4,227 @@
 
 #include "flags.h"
 #include "defs.h"
+#include "zsutilities.h"
 #include <assert.h>
+#include <ctype.h>
 
 
 #define FLAG_FILE "flags.txt"
 
-void Flag::Save(FILE *fp)
+int Flags::GetBucket(const char *FlagName)
 {
-	BOOL NextHere = TRUE;
-	BOOL NextNotHere = FALSE;
-	fwrite(Name,32,1,fp);
-	fwrite(&Value,sizeof(Value),1,fp);
-	if(pNext)
-	{
-		fwrite(&NextHere, sizeof(NextHere),1, fp);
-		pNext->Save(fp);
-	}
-	else
+	int BucketNum;
+
+	BucketNum = tolower(FlagName[0]);
+	BucketNum -= 'a';
+
+	//the old table indexed off the end here, lump them into the first bucket
+	if(BucketNum < 0 || BucketNum >= NUM_FLAG_BUCKETS)
 	{
-		fwrite(&NextNotHere, sizeof(NextNotHere),1,fp);
+		BucketNum = 0;
 	}
+
+	return BucketNum;
 }
 
-void Flag::Load(FILE *fp)
+int Flags::Find(const char *FlagName)
 {
-	BOOL NextHere;
-	fread(Name,32,1,fp);
-	fread(&Value,sizeof(Value),1,fp);
-	fread(&NextHere,sizeof(NextHere),1,fp);
-	if(NextHere)
+	unsigned int Hash;
+	int Slot;
+	int ID;
+	Flag *pFlag;
+	char Truncated[32];
+
+	//names are stored in 32 chars, look up what would be stored
+	if(strlen(FlagName) > 31)
 	{
-		if(!pNext)
-			pNext = new Flag;
-		pNext->Load(fp);
+		strncpy(Truncated, FlagName, 31);
+		Truncated[31] = '\0';
+		FlagName = Truncated;
 	}
-	else
+
+	Hash = HashString(FlagName);
+	for(Slot = HashTable.First(Hash); (ID = HashTable.Get(Slot)) != HASH_EMPTY; Slot = HashTable.Next(Slot))
 	{
-		if(pNext)
+		pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
+		if(pFlag->Hash == Hash && !strcmp(pFlag->Name, FlagName))
 		{
-			delete pNext;
-			pNext = NULL;
+			return ID;
 		}
-	}	
-}
-
-void Flag::Print(FILE *fp)
-{
-	fprintf(fp,"%s: %i\n",Name,Value);
-	if(pNext)
-	{
-		fprintf(fp,"\n   ");
-		pNext->Print(fp);
 	}
+
+	return -1;
 }
 
-Flag *Flags::Get(const char *FlagName)
+int Flags::GetID(const char *FlagName)
 {
-	int BucketNum;
-
-	BucketNum = tolower(FlagName[0]);
-	BucketNum -= 'a';
-
+	unsigned int Hash;
+	int Slot;
+	int ID;
 	Flag *pFlag;
+	char Truncated[32];
 
-	pFlag = &Buckets[BucketNum];
+	//names are stored in 32 chars, look up what would be stored
+	if(strlen(FlagName) > 31)
+	{
+		strncpy(Truncated, FlagName, 31);
+		Truncated[31] = '\0';
+		FlagName = Truncated;
+	}
 
-	while(TRUE)
+	Hash = HashString(FlagName);
+	for(Slot = HashTable.First(Hash); (ID = HashTable.Get(Slot)) != HASH_EMPTY; Slot = HashTable.Next(Slot))
 	{
-		if(pFlag->Name[0] == '\0')
-		{
-			strcpy(pFlag->Name,FlagName);
-			DEBUG_INFO("FLAG added in Get: ");
-			DEBUG_INFO(FlagName);
-			DEBUG_INFO("\n");
-			return pFlag;
-		}
-		else
+		pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
+		if(pFlag->Hash == Hash && !strcmp(pFlag->Name, FlagName))
 		{
-			if(!strcmp(pFlag->Name,FlagName))
-			{
-				return pFlag;
-			}
+			pFlag->Live = TRUE;
+			return ID;
 		}
+	}
 
-		if(!pFlag->pNext)
-		{
-			pFlag->pNext = new Flag;
-		}
+	if(NumFlags >= MAX_FLAGS)
+	{
+		SafeExit("Too many flags");
+	}
 
-		pFlag = pFlag->pNext;
+	ID = NumFlags;
+	if(!Pages[ID / FLAG_PAGE_SIZE])
+	{
+		Pages[ID / FLAG_PAGE_SIZE] = new Flag[FLAG_PAGE_SIZE];
 	}
+	NumFlags++;
+
+	pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
+	strcpy(pFlag->Name, FlagName);
+	pFlag->Hash = Hash;
+	pFlag->Value = NULL;
+	pFlag->Live = TRUE;
+	HashTable.Set(Slot, ID);
 
-	return NULL;
+	DEBUG_INFO("FLAG added in Get: ");
+	DEBUG_INFO(FlagName);
+	DEBUG_INFO("\n");
+
+	return ID;
 }
 
-int Flags::Kill(char *FlagName)
+Flag *Flags::Get(const char *FlagName)
 {
-	int BucketNum;
-
-	BucketNum = tolower(FlagName[0]);
-	BucketNum -= 'a';
+	return GetFlag(GetID(FlagName));
+}
 
+int Flags::Kill(int ID)
+{
 	Flag *pFlag;
 
-	pFlag = &Buckets[BucketNum];
+	pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
 
-	while(TRUE)
+	if(!IsSet(pFlag))
 	{
-		if(pFlag->Name[0] == '\0')
-		{
-			return FALSE;
-		}
-		else
-		{
-			if(!strcmp(pFlag->Name, FlagName))
-			{
-				while(pFlag->pNext)
-				{
-					strcpy(pFlag->Name,pFlag->pNext->Name);
-					pFlag->Value = pFlag->pNext->Value;
-					pFlag = pFlag->pNext;
-				}
-				pFlag->Name[0] = '\0';
-				pFlag->Value = 0;
-				return TRUE;
-			}
-		}
+		return FALSE;
+	}
 
-		if(!pFlag->pNext)
-		{
-			return FALSE;
-		}
+	//the name stays interned so handles held by scripts remain valid
+	pFlag->Live = FALSE;
+	pFlag->Value = 0;
+	return TRUE;
+}
 
-		pFlag = pFlag->pNext;
+int Flags::Kill(char *FlagName)
+{
+	int ID;
+
+	ID = Find(FlagName);
+	if(ID == -1)
+	{
+		return FALSE;
 	}
 
-	return FALSE;
+	return Kill(ID);
 }
 
+//returns the next flag worth saving in the bucket after the given ID, or -1
+int Flags::NextInBucket(int Bucket, int After)
+{
+	Flag *pFlag;
+	for(int n = After + 1; n < NumFlags; n++)
+	{
+		pFlag = &Pages[n / FLAG_PAGE_SIZE][n % FLAG_PAGE_SIZE];
+		if(IsSet(pFlag) && GetBucket(pFlag->Name) == Bucket)
+		{
+			return n;
+		}
+	}
+	return -1;
+}
 
+//written as the old chained buckets, a chain of name, value and a more-follows
+//marker for each letter, so existing savegames load and new ones load in old builds
 void Flags::Save(FILE *fp)
 {
 	assert(fp);
-	for(int n = 0; n < 26; n++)
+	BOOL NextHere;
+	char Name[32];
+	void *Value;
+	int ID;
+	int Next;
+	Flag *pFlag;
+
+	for(int n = 0; n < NUM_FLAG_BUCKETS; n++)
 	{
-		Buckets[n].Save(fp);
+		ID = NextInBucket(n, -1);
+		if(ID == -1)
+		{
+			//an empty bucket still has its head
+			memset(Name, 0, 32);
+			Value = NULL;
+			NextHere = FALSE;
+			fwrite(Name,32,1,fp);
+			fwrite(&Value,sizeof(Value),1,fp);
+			fwrite(&NextHere,sizeof(NextHere),1,fp);
+			continue;
+		}
+
+		while(ID != -1)
+		{
+			pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
+			Next = NextInBucket(n, ID);
+			NextHere = (Next != -1);
+			fwrite(pFlag->Name,32,1,fp);
+			fwrite(&pFlag->Value,sizeof(pFlag->Value),1,fp);
+			fwrite(&NextHere,sizeof(NextHere),1,fp);
+			ID = Next;
+		}
 	}
 }
 
 void Flags::Load(FILE *fp)
 {
 	assert(fp);
+	BOOL NextHere;
+	char Name[32];
+	void *Value;
+
 	Clear();
-	for(int n = 0; n < 26; n++)
+	for(int n = 0; n < NUM_FLAG_BUCKETS; n++)
 	{
-		Buckets[n].Load(fp);
+		do
+		{
+			fread(Name,32,1,fp);
+			fread(&Value,sizeof(Value),1,fp);
+			fread(&NextHere,sizeof(NextHere),1,fp);
+			Name[31] = '\0';
+			//killed flags left blank links in the old chains
+			if(Name[0] != '\0')
+			{
+				GetFlag(GetID(Name))->Value = Value;
+			}
+		} while(NextHere);
 	}
 
 }
-	
+
 void Flags::Import()
 {
 
@@ -179,41 +241,71 @@ void Flags::AddFlag(const char *FlagName)
 
 void Flags::OutPutDebugInfo(FILE *fp)
 {
-	for(int n = 0; n < 26; n++)
+	Flag *pFlag;
+	for(int n = 0; n < NumFlags; n++)
 	{
-		Buckets[n].Print(fp);
+		pFlag = &Pages[n / FLAG_PAGE_SIZE][n % FLAG_PAGE_SIZE];
+		if(IsSet(pFlag))
+		{
+			fprintf(fp,"%s: %i\n",pFlag->Name,pFlag->Value);
+		}
 	}
 }
 
+//values are wiped but names stay interned, IDs held by loaded scripts stay good
 void Flags::Clear()
 {
 	Flag *pFlag;
-	for(int n = 0; n < 26; n++)
+	for(int n = 0; n < NumFlags; n++)
 	{
-		Buckets[n].Name[0] = '\0';
-		Buckets[n].Value = 0;
-		pFlag = Buckets[n].pNext;
-		while(pFlag)
-		{
-			pFlag->Name[0] = '\0';
-			pFlag->Value = 0;
-			pFlag = pFlag->pNext;
-		}
+		pFlag = &Pages[n / FLAG_PAGE_SIZE][n % FLAG_PAGE_SIZE];
+		pFlag->Value = 0;
+		pFlag->Live = FALSE;
+	}
+}
+
+void Flags::GetState(void **Values, BOOL *Live)
+{
+	Flag *pFlag;
+	for(int n = 0; n < NumFlags; n++)
+	{
+		pFlag = &Pages[n / FLAG_PAGE_SIZE][n % FLAG_PAGE_SIZE];
+		Values[n] = pFlag->Value;
+		Live[n] = pFlag->Live;
 	}
 }
 
+void Flags::SetState(void **Values, BOOL *Live)
+{
+	Flag *pFlag;
+	for(int n = 0; n < NumFlags; n++)
+	{
+		pFlag = &Pages[n / FLAG_PAGE_SIZE][n % FLAG_PAGE_SIZE];
+		pFlag->Value = Values[n];
+		pFlag->Live = Live[n];
+	}
+}
+
+Flags::Flags()
+{
+	int n;
+	NumFlags = 0;
+	for(n = 0; n < MAX_FLAG_PAGES; n++)
+	{
+		Pages[n] = NULL;
+	}
+	HashTable.Reset(MAX_FLAGS);
+}
+
 Flags::~Flags()
 {
-	for(int n = 0; n < 26; n++)
+	for(int n = 0; n < MAX_FLAG_PAGES; n++)
 	{
-		Buckets[n].Name[0] = '\0';
-		Buckets[n].Value = 0;
-		if(Buckets[n].pNext)
+		if(Pages[n])
 		{
-			delete Buckets[n].pNext;
-			Buckets[n].pNext = NULL;
+			delete[] Pages[n];
+			Pages[n] = NULL;
 		}
-	
 	}
-
+	NumFlags = 0;
 }
@@ -6,6 +6,8 @@
  */
 
 #include <stdio.h>
+#include "defs.h"
+#include "hashindex.h"
 
 #define NUM_NFLAGS	512
 #define NUM_BFLAGS	2048
@@ -21,29 +23,47 @@
 //definition for script directroy
 #define SCRIPTDIRECTORY		"\\script\\"
 
+//flags live in fixed pages so a Flag * or an ID handed out once stays
+//good for the rest of the session, kills and loads included
+#define FLAG_PAGE_SIZE		256
+#define MAX_FLAG_PAGES		64
+#define MAX_FLAGS				(FLAG_PAGE_SIZE * MAX_FLAG_PAGES)
+
+//the old chained table bucketed by first letter, savegames still do
+#define NUM_FLAG_BUCKETS	26
+
 class Flag 
 {
 public:
 	char Name[32];
 	void *Value;
-	Flag *pNext;
-
-	void Save(FILE *fp);
-	void Load(FILE *fp);
+	unsigned int Hash;
+	BOOL Live;
 
-	void Print(FILE *fp);
-
-	Flag() { Name[0] = '\0'; pNext = NULL; Value = NULL;}
-	~Flag() { if(pNext) delete pNext; pNext = NULL; }
+	Flag() { Name[0] = '\0'; Value = NULL; Hash = 0; Live = FALSE; }
 };
 
 // DATA STRUCTURES
 class Flags {
 public:
-	Flag Buckets[26];
+	//interns the name and returns its ID, scripts resolve their flags once this way
+	int GetID(const char *FlagName);
+	//-1 if the name has never been seen
+	int Find(const char *FlagName);
+
+	//touching a flag brings it back after a kill, just as Get always has
+	inline Flag *GetFlag(int ID) 
+	{ 
+		Flag *pFlag = &Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE];
+		pFlag->Live = TRUE;
+		return pFlag; 
+	}
+	inline const char *GetName(int ID) { return Pages[ID / FLAG_PAGE_SIZE][ID % FLAG_PAGE_SIZE].Name; }
+	int GetNumFlags() { return NumFlags; }
 		
 	Flag *Get(const char *FlagName);
 	int Kill(char *FlagName);
+	int Kill(int ID);
 	
 	void Save(FILE *fp);
 	void Load(FILE *fp);
@@ -54,10 +74,22 @@ public:
 	void OutPutDebugInfo(FILE *fp);
 	void Clear();
 
+	//every flag's value and live bit, GetNumFlags() long, so a script can be run twice
+	void GetState(void **Values, BOOL *Live);
+	void SetState(void **Values, BOOL *Live);
+
+	Flags();
 	~Flags();
 	
 private:
-	
+	Flag *Pages[MAX_FLAG_PAGES];
+	int NumFlags;
+	HashIndex HashTable;
+
+	static int GetBucket(const char *FlagName);
+	int NextInBucket(int Bucket, int After);
+	//code that kept a Flag * across a clear can still write to it
+	static BOOL IsSet(Flag *pFlag) { return pFlag->Live || pFlag->Value; }
 };
 
 
@@ -7,6 +7,9 @@
 #include <assert.h>
 #include "editregion.h"
 #include "cavewall.h"
+#include "heightfield.h"
+#include "bakegraph.h"
+#include "pathgraph.h"
 
 #define HEIGHT_RANGE		256.0f //must limit to 64 in order to have a tile variance of .25f 
 
@@ -17,6 +20,15 @@
 
 #define WORLD_DIM		1600
 
+//the stages of GenerateBase's bake
+#define BASE_STAGE_SMOOTH_ONE	0
+#define BASE_STAGE_SMOOTH_TWO	1
+#define BASE_STAGE_CHUNKS		2
+//FillTerrain lays the same patches every time so part of the map can be
+//rebaked to match the rest
+#define BASE_TERRAIN_SEED		1
+#define BASE_COPY_BLOCK			65536
+
 #define ID_X_WIN		41415
 #define ID_Y_WIN		41414
 typedef struct
@@ -39,7 +51,10 @@ static int Terrain[1600][1600];
 static int ForestDensity[1600][1600];
 static BYTE Road[3200][3200];
 static BYTE BaseRoad[3200][3200];
+//a chunk per entry for MakeWater and Water::AdjustWater
 BYTE Watered[200][200];
+//a tile per entry for GenerateBase
+static BYTE BaseWater[1600][1600];
 static WORD ForestTypes[32][32];	
 static float CornerHeights[200][200];
 static BYTE Locations[1600][1600];
@@ -51,6 +66,7 @@ static int ForestDensity[1][1];
 static BYTE Road[1][1];
 static BYTE BaseRoad[1][1];
 BYTE Watered[1][1];
+static BYTE BaseWater[1][1];
 static WORD ForestTypes[1][1];	
 static float CornerHeights[1][1];
 static BYTE Locations[1][1];
@@ -187,12 +203,15 @@ void FillTerrain()
 	int yn;
 	int n;
 	RECT rArea;
+	DWORD Seed;
+
+	Seed = BASE_TERRAIN_SEED;
 
 	//fill basic grass
 	for(yn = 0; yn < 1600; yn++)
 	for(xn = 0; xn < 1600; xn++)
 	{
-		n = rand() % 5;
+		n = BakeGraph::Rand(&Seed) % 5;
 	
 		switch(n)
 		{
@@ -217,10 +236,10 @@ void FillTerrain()
 	for(yn = 0; yn < 1600; yn += 2)
 	for(xn = 0; xn < 1600; xn += 2)
 	{
-		n = rand() % 100;
+		n = BakeGraph::Rand(&Seed) % 100;
 		if(n < 10)
 		{
-			n = rand() % 9;
+			n = BakeGraph::Rand(&Seed) % 9;
 
 			switch(n)
 			{
@@ -248,26 +267,26 @@ void FillTerrain()
 					break;
 			}
 
-			rArea.left = xn - (rand() % 6);
+			rArea.left = xn - (BakeGraph::Rand(&Seed) % 6);
 			if(rArea.left < 0) 
 				rArea.left = 0;
 
-			rArea.right = xn + (rand() % 6);
+			rArea.right = xn + (BakeGraph::Rand(&Seed) % 6);
 			if(rArea.right > 1600) 
 				rArea.right = 1600;
 			
-			rArea.top = yn - (rand() % 6);
+			rArea.top = yn - (BakeGraph::Rand(&Seed) % 6);
 			if(rArea.top < 0) 
 				rArea.top = 0;
 			
-			rArea.bottom = yn + (rand() % 6);
+			rArea.bottom = yn + (BakeGraph::Rand(&Seed) % 6);
 			if(rArea.bottom > 1600) 
 				rArea.bottom = 1600;
 			
 			for(suby = rArea.top; suby < rArea.bottom; suby++)
 			for(subx = rArea.left; subx < rArea.right; subx++)
 			{
-				n = rand() % 100;
+				n = BakeGraph::Rand(&Seed) % 100;
 				if(n < 66)
 				{
 					Terrain[subx][suby] = TerrainIndex[Index] + (n%4) * 4;			
@@ -357,6 +376,8 @@ void Area::SmoothBaseTerrain()
 
 	SetCurrentDirectory(".\\Areas");
 	
+	CloseStaticViews();
+
 	if(StaticFile)
 		fclose(StaticFile);
 	
@@ -413,8 +434,7 @@ void Area::SmoothBaseTerrain()
 				DEBUG_INFO("Could not seek during smoothing.\n");
 			}
 
-			delete BigMap[xn-1 + (yn-1) * ChunkWidth];
-			BigMap[xn-1 + (yn-1) * ChunkWidth ] = NULL;
+			RemoveChunk(xn-1, yn-1);
 		}
 	}
 
@@ -423,6 +443,7 @@ void Area::SmoothBaseTerrain()
 
 	fclose(StaticFile);
 	StaticFile = SafeFileOpen("valley.bin","rb");
+	OpenStaticViews();
 	
 	SetCurrentDirectory(Engine->GetRootDirectory());
 
@@ -433,13 +454,17 @@ void Area::CleanUpChunks()
 	int xn;
 	int yn;
 
-	for(yn = 0; yn < this->Height; yn++)
-	for(xn = 0; xn < this->Width; xn++)
+	if(!BigMap)
+	{
+		return;
+	}
+
+	for(yn = 0; yn < this->ChunkHeight; yn++)
+	for(xn = 0; xn < this->ChunkWidth; xn++)
 	{
-		if(BigMap[xn + yn * Width])
+		if(BigMap[xn + yn * ChunkWidth])
 		{
-			delete BigMap[xn + yn * Width];
-			BigMap[xn + yn * Width ] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	}
 }
@@ -1396,30 +1421,21 @@ void Area::MakeWater(BOOL Vert)
 void CreateBaseHeights()
 {
 	ZSModelEx *pMesh;
+	HeightField Heights;
 	pMesh = Engine->GetMesh("valley");
 	assert(pMesh);
 
 	DEBUG_INFO("Filling height levels\n");
-/*  float foffset;
-	float x;
-	float y;
-	foffset = 1.0f / 1600.0f;
 
-	x = 0.0f;
-	y = 0.0f;
+	//the valley mesh spans 0 to 1, one sample per tile corner
+	Heights.Bake(pMesh, 0, 0.0f, 0.0f, 1.0f / (float)WORLD_DIM, WORLD_DIM, WORLD_DIM);
 
-	for(int yn = 0; yn < 1600; yn ++)
+	for(int yn = 0; yn < WORLD_DIM; yn ++)
+	for(int xn = 0; xn < WORLD_DIM; xn ++)
 	{
-		x = 0;
-		for(int xn = 0; xn < 1600; xn ++)
-		{
-			x+= foffset;
-			StartHeightLevels[xn][yn] = (pMesh->GetZ(x,y) * HEIGHT_RANGE);
-		}
-		y += foffset;
+		StartHeightLevels[xn][yn] = Heights.GetHeight(xn,yn) * HEIGHT_RANGE;
 	}
-*/
-	pMesh->GetZ(0.0f,0.0f);
+
 	DEBUG_INFO("Done Filling base height levels\n");
 
 }
@@ -1987,8 +2003,7 @@ void Area::GenerateTerrain(RECT *pArea)
 	}	
 		NewOff[ChunkX + ChunkY * this->ChunkWidth] = ftell(fp);
 		pChunk->Save(fp);
-		delete pChunk;
-		BigMap[ChunkX + ChunkY * this->ChunkWidth] = NULL;
+		RemoveChunk(ChunkX, ChunkY);
 	}
 
 	fseek(fp,0,SEEK_SET);
@@ -2000,12 +2015,14 @@ void Area::GenerateTerrain(RECT *pArea)
 
 	fclose(fp);
 
+	CloseStaticViews();
 	fclose(StaticFile);
 
 	remove(FileName);
 	rename("temp.bin",FileName);
 
 	StaticFile = SafeFileOpen(FileName,"rb");
+	OpenStaticViews();
 
 	SetCurrentDirectory(Engine->GetRootDirectory());
 
@@ -2013,10 +2030,430 @@ void Area::GenerateTerrain(RECT *pArea)
 	return;
 }
 
-int Area::GenerateBase(RECT *rArea)
+//GenerateBase is the only pass on a BakeGraph yet.  GenerateTerrain,
+//SmoothBaseTerrain, MakeWater and area.cpp's ReBlock and RegionObjects
+//are still to be split into stages
+
+//a chunk's place in the files GenerateBase bakes into
+typedef struct
+{
+	int Worker;		//whose file it is in, -1 if it wasn't baked
+	long Offset;
+	long Length;
+} BASE_CHUNK_T;
+
+typedef struct
+{
+	//the area's corner, in height cells and in chunks
+	int LeftOffset;
+	int TopOffset;
+	int ChunkLeft;
+	int ChunkTop;
+	int ChunksWide;
+	int MaxDense;
+	//one of each for every worker
+	Chunk *pChunks[BAKE_MAX_THREADS];
+	FILE *fpWorkers[BAKE_MAX_THREADS];
+	BASE_CHUNK_T *pRecords;
+} BASE_BAKE_T;
+
+//one pass of the box filter over a chunk's cells, the first from
+//HeightLevels into StartHeightLevels and the second back again
+static void SmoothBaseTile(int Stage, int TileX, int TileY, int Worker, void *pData)
+{
+	int XStart;
+	int XEnd;
+	int YStart;
+	int YEnd;
+	int xn, yn;
+
+	XStart = TileX * CHUNK_WIDTH;
+	XEnd = XStart + CHUNK_WIDTH;
+	YStart = TileY * CHUNK_HEIGHT;
+	YEnd = YStart + CHUNK_HEIGHT;
+
+	//the edge of the map has nothing to average with
+	if(XStart < 1) XStart = 1;
+	if(YStart < 1) YStart = 1;
+	if(XEnd > WORLD_DIM - 1) XEnd = WORLD_DIM - 1;
+	if(YEnd > WORLD_DIM - 1) YEnd = WORLD_DIM - 1;
+
+	if(Stage == BASE_STAGE_SMOOTH_ONE)
+	{
+		for(yn = YStart; yn < YEnd; yn ++)
+		for(xn = XStart; xn < XEnd; xn ++)
+		{
+			StartHeightLevels[xn][yn] =
+				(HeightLevels[xn][yn] + 
+				 HeightLevels[xn+1][yn] + 
+				 HeightLevels[xn-1][yn] + 
+				 HeightLevels[xn][yn+1] + 
+				 HeightLevels[xn+1][yn-1] + 
+				 HeightLevels[xn-1][yn-1] + 
+				 HeightLevels[xn+1][yn+1] + 
+				 HeightLevels[xn-1][yn+1] + 
+				 HeightLevels[xn][yn-1]) / 9.0f;
+		}
+	}
+	else
+	{
+		for(yn = YStart; yn < YEnd; yn ++)
+		for(xn = XStart; xn < XEnd; xn ++)
+		{
+			HeightLevels[xn][yn] =
+				(StartHeightLevels[xn][yn] + 
+				 StartHeightLevels[xn+1][yn] + 
+				 StartHeightLevels[xn-1][yn] + 
+				 StartHeightLevels[xn][yn+1] + 
+				 StartHeightLevels[xn+1][yn-1] + 
+				 StartHeightLevels[xn-1][yn-1] + 
+				 StartHeightLevels[xn+1][yn+1] + 
+				 StartHeightLevels[xn-1][yn+1] + 
+				 StartHeightLevels[xn][yn-1]) / 9.0f;
+		}
+	}
+}
+
+//builds chunk TileX, TileY of the map and saves it to the end of the
+//worker's file
+void Area::BakeBaseChunk(int Stage, int TileX, int TileY, int Worker, void *pData)
+{
+	BASE_BAKE_T *pBake;
+	BASE_CHUNK_T *pRecord;
+	Chunk *pChunk;
+	FILE *fp;
+	ZSModelEx *Tree;
+	ZSModelEx *Shrub;
+	Water *TempWater;
+	Object *Op;
+	Object *pNext;
+	D3DVECTOR Position;
+	DWORD Seed;
+	float Height;
+	float HHighest;
+	float HLowest;
+	float Percent;
+	float ScaleOffset;
+	float Angle;
+	float ShrubX;
+	float ShrubY;
+	BOOL WaterFound;
+	int VertOffset;
+	int DI;
+	int Level;
+	int Chance;
+	int xoffset;
+	int yoffset;
+	int xn, yn;
+
+	pBake = (BASE_BAKE_T *)pData;
+	pChunk = pBake->pChunks[Worker];
+	fp = pBake->fpWorkers[Worker];
+
+	//the chunk's own numbers, so it comes out the same whichever thread
+	//gets it and whatever was baked before
+	Seed = BakeGraph::Seed(TileX, TileY);
+
+	pChunk->X = TileX - pBake->ChunkLeft;
+	pChunk->Y = TileY - pBake->ChunkTop;
+	pChunk->pObjectList = NULL;
+	pChunk->pObjectList2 = NULL;
+	pChunk->pObjectListEnd = NULL;
+	pChunk->NumObjects = 0;
+	TempWater = NULL;
+	DI = 0;
+	yoffset = TileY * CHUNK_HEIGHT;
+	WaterFound = FALSE;
+	for(yn = 0; yn < CHUNK_HEIGHT; yn ++)
+	{	
+		xoffset = TileX * CHUNK_WIDTH;
+		for(xn = 0; xn < CHUNK_WIDTH; xn ++)
+		{
+			if(BaseWater[xoffset][yoffset])
+			{
+				WaterFound = TRUE;
+			}
+			HHighest = 0.0f;
+			HLowest = 256.0f;
+			//each tile in a chunk must have the height of each corner
+			Height = (HeightLevels[xoffset][yoffset]);
+			if(Height > HHighest) HHighest = Height;
+			if(Height < HLowest) HLowest = Height;
+
+			VertOffset = (xn + yn * CHUNK_WIDTH)*24;
+			
+			pChunk->Verts[VertOffset] = (xoffset - pBake->LeftOffset)*2;
+			pChunk->Verts[VertOffset+1] = (yoffset - pBake->TopOffset)*2;
+			pChunk->Verts[VertOffset+2] = Height;
+			
+			Height = (HeightLevels[xoffset+1][yoffset]);
+			if(Height > HHighest) HHighest = Height;
+			if(Height < HLowest) HLowest = Height;
+
+			pChunk->Verts[VertOffset+6] = (xoffset+1 - pBake->LeftOffset)*2;
+			pChunk->Verts[VertOffset+7] = yoffset - pBake->TopOffset;
+			pChunk->Verts[VertOffset+8] = Height;
+			
+			Height = (HeightLevels[xoffset][yoffset+1]);
+			if(Height > HHighest) HHighest = Height;
+			if(Height < HLowest) HLowest = Height;
+
+			pChunk->Verts[VertOffset+12] = (xoffset - pBake->LeftOffset)*2;
+			pChunk->Verts[VertOffset+13] = (yoffset+1 - pBake->TopOffset)*2;
+			pChunk->Verts[VertOffset+14] = Height;
+		
+			Height = (HeightLevels[xoffset+1][yoffset+1]);
+			if(Height > HHighest) HHighest = Height;
+			if(Height < HLowest) HLowest = Height;
+
+			pChunk->Verts[VertOffset+18] = (xoffset + 1 - pBake->LeftOffset)*2;
+			pChunk->Verts[VertOffset+19] = (yoffset + 1 - pBake->TopOffset)*2;
+			pChunk->Verts[VertOffset+20] = Height;
+		
+			Level = pBake->MaxDense - (ForestDensity[xoffset/2][yoffset/2]);
+			Percent = ((float)Level/(float)pBake->MaxDense);
+			
+			Tree = Forests[GetForestValue(xoffset,yoffset)].GetTree(Percent,xoffset,yoffset,&Seed);
+
+			if(!Tree)
+				Shrub = Forests[GetForestValue(xoffset,yoffset)].GetShrub(Percent,xoffset,yoffset,&Seed);
+
+			pChunk->DrawList[DI] = VertOffset;
+			pChunk->DrawList[DI + 1] = VertOffset + 1;
+			pChunk->DrawList[DI + 2] = VertOffset + 2;
+			pChunk->DrawList[DI + 3] = VertOffset + 1;	
+			pChunk->DrawList[DI + 4] = VertOffset + 3;
+			pChunk->DrawList[DI + 5] = VertOffset + 2;
+			
+			DI += 6;
+
+			//set up the base terrain
+			if(Road[xoffset][yoffset] || BaseWater[xoffset][yoffset])
+			{
+				pChunk->Terrain[xn][yn] = TerrainIndex[TER_SAND] + (BakeGraph::Rand(&Seed)%4)*4;
+			}
+			else
+			{
+				pChunk->Terrain[xn][yn] = Terrain[xoffset][yoffset];				
+				Chance = BakeGraph::Rand(&Seed) % 10;
+				if(Percent > 0.4f)
+				{
+					switch(Chance)
+					{
+						case 7:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_GRASS_FOUR] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						case 1:
+						case 2:
+						case 3:
+						case 4:
+						case 5:
+						case 6:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_DIRT] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						case 8:
+						case 9:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_MOSS] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						default:
+							break;
+					}
+				}
+				
+				if(Tree)
+				{
+					ScaleOffset = (float)BakeGraph::Rand(&Seed) / (float)BAKE_RAND_MAX;
+					ScaleOffset *= 0.5f;
+					Op = new Object;
+					Position.x = ((float)xoffset - pBake->LeftOffset) * 2.0f + 0.5f;
+					Position.y = ((float)yoffset - pBake->TopOffset) * 2.0f + 0.5f;
+					Position.z = ((HHighest + HLowest) / 2.0f) - .05f;
+					Op->SetPosition(&Position);
+					Op->SetMesh(Tree);
+					Op->SetMeshNum(Engine->GetMeshNum(Tree));
+					Op->SetScale(0.75f + ScaleOffset);
+					Angle = ((float)BakeGraph::Rand(&Seed) /(float)BAKE_RAND_MAX) * PI_MUL_2;
+					Op->SetAngle(Angle);
+					Op->SetTexture(Tree->GetTexture());
+					Op->SetTextureNum(Engine->GetTextureNum(Tree->GetTexture()));
+					Op->SetNext(pChunk->pObjectList);
+					pChunk->pObjectList = Op;
+					switch(Chance)
+					{
+						case 7:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_GRASS_FOUR] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						case 1:
+						case 2:
+						case 3:
+						case 4:
+						case 5:
+						case 6:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_DIRT] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						case 8:
+						case 9:
+							pChunk->Terrain[xn][yn] = TerrainIndex[TER_MOSS] + (BakeGraph::Rand(&Seed)%4) * 4;
+							break;
+						default:
+							break;
+					}
+				}
+				else
+				if(Shrub)
+				{
+					ScaleOffset = (float)BakeGraph::Rand(&Seed) / (float)BAKE_RAND_MAX;
+					ScaleOffset *= 0.5;
+					Op = new Object;
+					ShrubX = (float)BakeGraph::Rand(&Seed) / (float)BAKE_RAND_MAX;
+					ShrubY = (float)BakeGraph::Rand(&Seed) / (float)BAKE_RAND_MAX;
+					Position.x = ((float)xoffset + ShrubX - pBake->LeftOffset) * 2.0f;
+					Position.y = ((float)yoffset + ShrubY - pBake->TopOffset) * 2.0f;
+					Position.z = ((HHighest + HLowest) / 2.0f) - .05f;
+					
+					Op->SetPosition(&Position);
+					Op->SetMesh(Shrub);
+					Op->SetMeshNum(Engine->GetMeshNum(Shrub));
+					Op->SetScale(0.75f + ScaleOffset);
+					Angle = ((float)BakeGraph::Rand(&Seed) /(float)BAKE_RAND_MAX) * PI_MUL_2;
+					Op->SetAngle(Angle);
+					Op->SetTexture(Shrub->GetTexture());
+					Op->SetTextureNum(Engine->GetTextureNum(Shrub->GetTexture()));
+					Op->SetNext(pChunk->pObjectList);
+					pChunk->pObjectList = Op;
+				}
+				
+				if((HHighest - HLowest) >= 1.1f)
+				{
+					pChunk->Terrain[xn][yn] = TerrainIndex[TER_STONE_ONE + BakeGraph::Rand(&Seed)%4] + (BakeGraph::Rand(&Seed)%4) * 4; 
+				}
+			}
+			xoffset++;
+		}
+		yoffset++;
+	}
+	if(WaterFound)
+	{
+		TempWater = CreateWater(pChunk->X, pChunk->Y);
+		pChunk->AddObject(TempWater);
+	}
+	pChunk->Build();
+	pChunk->CreateHeightMap();
+	if(WaterFound)
+	{
+		yoffset = pChunk->Y * CHUNK_HEIGHT;
+		for(yn = 0; yn < CHUNK_HEIGHT; yn ++)
+		{	
+			xoffset = pChunk->X * CHUNK_WIDTH;
+			for(xn = 0; xn < CHUNK_WIDTH; xn ++)
+			{
+				if(BaseWater[xoffset][yoffset] == 1 ||
+					BaseWater[xoffset][yoffset] == 2)
+				{
+					pChunk->RemoveTile(xn,yn);
+				}
+				xoffset++;
+			}
+			yoffset++;
+		}
+	}
+
+	pRecord = &pBake->pRecords[pChunk->X + pChunk->Y * pBake->ChunksWide];
+	pRecord->Worker = Worker;
+	pRecord->Offset = ftell(fp);
+	pChunk->Save(fp);
+	pRecord->Length = ftell(fp) - pRecord->Offset;
+
+	//the chunk is used again for the next one, its objects aren't
+	Op = pChunk->pObjectList;
+	while(Op)
+	{
+		pNext = Op->GetNext();
+		delete Op;
+		Op = pNext;
+	}
+	pChunk->pObjectList = NULL;
+	pChunk->pObjectListEnd = NULL;
+}
+
+//where each chunk of the last world.bin is and how long it is, FALSE if
+//there isn't one the same size as the area being baked
+static BOOL ReadBaseChunks(FILE *fp, int ChunksWide, int ChunksHigh, long *pOffsets, long *pLengths)
+{
+	char Name[32];
+	int Width;
+	int Height;
+	int ChunkWidth;
+	int ChunkHeight;
+	int *Offsets;
+	long FileLength;
+	int NumChunks;
+	int n;
+
+	if(fread(Name, sizeof(char), 32, fp) != 32 ||
+		fread(&Width, sizeof(int), 1, fp) != 1 ||
+		fread(&Height, sizeof(int), 1, fp) != 1 ||
+		fread(&ChunkWidth, sizeof(int), 1, fp) != 1 ||
+		fread(&ChunkHeight, sizeof(int), 1, fp) != 1 ||
+		ChunkWidth != ChunksWide || ChunkHeight != ChunksHigh)
+	{
+		return FALSE;
+	}
+
+	NumChunks = ChunkWidth * ChunkHeight;
+	Offsets = new int[NumChunks];
+	if(fread(Offsets, sizeof(int), NumChunks, fp) != (size_t)NumChunks)
+	{
+		delete[] Offsets;
+		return FALSE;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	FileLength = ftell(fp);
+
+	//GenerateBase writes them one after another in order
+	for(n = 0; n < NumChunks; n++)
+	{
+		pOffsets[n] = Offsets[n];
+		pLengths[n] = ((n + 1 < NumChunks) ? (long)Offsets[n + 1] : FileLength) - (long)Offsets[n];
+		if(pLengths[n] <= 0)
+		{
+			delete[] Offsets;
+			return FALSE;
+		}
+	}
+
+	delete[] Offsets;
+	return TRUE;
+}
+
+static void CopyBaseChunk(FILE *fpTo, FILE *fpFrom, long Offset, long Length, BYTE *pBuffer)
+{
+	long Block;
+
+	fseek(fpFrom, Offset, SEEK_SET);
+	while(Length > 0)
+	{
+		Block = (Length > BASE_COPY_BLOCK) ? BASE_COPY_BLOCK : Length;
+		fread(pBuffer, 1, Block, fpFrom);
+		fwrite(pBuffer, 1, Block, fpTo);
+		Length -= Block;
+	}
+}
+
+int Area::GenerateBase(RECT *rArea, RECT *rDirty, int NumThreads)
 {
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER StartTime;
+	LARGE_INTEGER MapsTime;
+	LARGE_INTEGER GraphTime;
+	LARGE_INTEGER EndTime;
+	double ToMS;
 	RECT *pArea;
 	RECT pAll;
+
+	QueryPerformanceCounter(&StartTime);
+
 	pAll.right = WORLD_DIM;
 	pAll.bottom = WORLD_DIM;
 	pAll.top = 0;
@@ -2036,12 +2473,16 @@ int Area::GenerateBase(RECT *rArea)
 	pArea->bottom -= pArea->bottom % CHUNK_HEIGHT;
 
 
+	CloseStaticViews();
+
 	if(StaticFile)
+	{
 		fclose(StaticFile);
+		StaticFile = NULL;
+	}
 
-//	CleanUpChunks();
-
-	Chunk TempChunk;
+	//anything loaded came from the old file
+	CleanUpChunks();
 
 	Forests[0].Load("Maple");
 	Forests[1].Load("Aspen");
@@ -2052,13 +2493,16 @@ int Area::GenerateBase(RECT *rArea)
 	Forests[6].Load("SparseOne");
 	Forests[7].Load("SparseTwo");
 
-	int ChunkSize;
-	ChunkSize = sizeof(Chunk); //sansitemlist
-	Header.ChunkWidth = CHUNK_WIDTH;
-	Header.ChunkHeight = CHUNK_HEIGHT;
-	this->Height = Header.Height = (pArea->right/CHUNK_WIDTH) - (pArea->left/CHUNK_WIDTH);
-	this->Width = Header.Width = (pArea->bottom/CHUNK_HEIGHT) - (pArea->top/CHUNK_HEIGHT);
-	//RegionHeader.NumRegions = 0;
+	//laid out the way LoadHeader reads it
+	Header.ChunkWidth = (pArea->right/CHUNK_WIDTH) - (pArea->left/CHUNK_WIDTH);
+	Header.ChunkHeight = (pArea->bottom/CHUNK_HEIGHT) - (pArea->top/CHUNK_HEIGHT);
+	Header.Width = Header.ChunkWidth * CHUNK_TILE_WIDTH;
+	Header.Height = Header.ChunkHeight * CHUNK_TILE_HEIGHT;
+	if(Header.ChunkOffsets)
+	{
+		delete[] Header.ChunkOffsets;
+	}
+	Header.ChunkOffsets = new int[Header.ChunkWidth * Header.ChunkHeight];
 	strcpy(Header.Name,"TestWorld");
 	
 	LPDIRECTDRAWSURFACE7 ElevationSurface = NULL;
@@ -2183,16 +2627,30 @@ int Area::GenerateBase(RECT *rArea)
 	int MinDense = 255;
 
 
-	for(yn = 0; yn < 800; yn ++)
+	//all of them, or the last bake's roads and water carry over
+	for(xn = 0; xn < 1600; xn++)
 	{
-		memset(&Road[yn][0],0,1600);	
-		memset(&Watered[yn][0],0,1600);	
+		memset(&Road[xn][0], 0, 1600);
+		memset(&BaseRoad[xn][0], 0, 1600);
 	}
+	memset(BaseWater, 0, sizeof(BaseWater));
 
 	int xo, yo;
 	float HLevel;
 	
-//	CreateBaseHeights();
+	//the water's corners come from the valley mesh when there is one,
+	//and from nothing a previous bake left when there is not
+	if(Engine->GetMesh("valley"))
+	{
+		CreateBaseHeights();
+	}
+	else
+	{
+		memset(StartHeightLevels, 0, sizeof(StartHeightLevels));
+	}
+
+	Highest = 0;
+	Lowest = 255;
 
 	//scan to get the height scale range;
 	for(yn = 0; yn < 800; yn ++)
@@ -2248,15 +2706,15 @@ int Area::GenerateBase(RECT *rArea)
 		Level = GetLevel(WaterPtr,xn,yn,800);
 		if(Level < 16)
 		{
-			Watered[xo-1][yo-1] = 1;			
-			Watered[xo][yo-1] = 1;			
-			Watered[xo+1][yo-1] = 1;			
-			Watered[xo-1][yo] = 1;			
-			Watered[xo][yo] = 1;			
-			Watered[xo+1][yo] = 1;			
-			Watered[xo-1][yo+1] = 1;			
-			Watered[xo][yo+1] = 1;			
-			Watered[xo+1][yo+1] = 1;			
+			BaseWater[xo-1][yo-1] = 1;			
+			BaseWater[xo][yo-1] = 1;			
+			BaseWater[xo+1][yo-1] = 1;			
+			BaseWater[xo-1][yo] = 1;			
+			BaseWater[xo][yo] = 1;			
+			BaseWater[xo+1][yo] = 1;			
+			BaseWater[xo-1][yo+1] = 1;			
+			BaseWater[xo][yo+1] = 1;			
+			BaseWater[xo+1][yo+1] = 1;			
 		
 		}
 
@@ -2283,17 +2741,17 @@ int Area::GenerateBase(RECT *rArea)
 		}
 
 		WaterTotal = 0;
-		if(Watered[xn-1][yn] == 1) WaterTotal++;
+		if(BaseWater[xn-1][yn] == 1) WaterTotal++;
 
-		if(Watered[xn][yn+1] == 1) WaterTotal++;
+		if(BaseWater[xn][yn+1] == 1) WaterTotal++;
 		
-		if(Watered[xn][yn-1] == 1) WaterTotal++;
+		if(BaseWater[xn][yn-1] == 1) WaterTotal++;
 		
-		if(Watered[xn+1][yn] == 1) WaterTotal++;
+		if(BaseWater[xn+1][yn] == 1) WaterTotal++;
 		
-		if(WaterTotal >= 2 && !Watered[xn][yn])
+		if(WaterTotal >= 2 && !BaseWater[xn][yn])
 		{
-			Watered[xn][yn] = 2;
+			BaseWater[xn][yn] = 2;
 		}
 	}
 
@@ -2323,54 +2781,24 @@ int Area::GenerateBase(RECT *rArea)
 	for(yn = 1; yn < 1599; yn ++)
 	for(xn = 1; xn < 1599; xn ++)
 	{
-		if(Watered[xn][yn])
+		if(BaseWater[xn][yn])
 		{
 			HeightLevels[xn][yn] -= 24.0f;
 		}
 	}	
 
-	for(yn = 1; yn < 1599; yn ++)
-	for(xn = 1; xn < 1599; xn ++)
-	{
-		StartHeightLevels[xn][yn] =
-			(HeightLevels[xn][yn] + 
-			 HeightLevels[xn+1][yn] + 
-			 HeightLevels[xn-1][yn] + 
-			 HeightLevels[xn][yn+1] + 
-			 HeightLevels[xn+1][yn-1] + 
-			 HeightLevels[xn-1][yn-1] + 
-			 HeightLevels[xn+1][yn+1] + 
-			 HeightLevels[xn-1][yn+1] + 
-			 HeightLevels[xn][yn-1]) / 9.0f;
-	}
-
-	for(yn = 1; yn < 1599; yn ++)
-	for(xn = 1; xn < 1599; xn ++)
-	{
-		HeightLevels[xn][yn] =
-			(StartHeightLevels[xn][yn] + 
-			 StartHeightLevels[xn+1][yn] + 
-			 StartHeightLevels[xn-1][yn] + 
-			 StartHeightLevels[xn][yn+1] + 
-			 StartHeightLevels[xn+1][yn-1] + 
-			 StartHeightLevels[xn-1][yn-1] + 
-			 StartHeightLevels[xn+1][yn+1] + 
-			 StartHeightLevels[xn-1][yn+1] + 
-			 StartHeightLevels[xn][yn-1]) / 9.0f;
-	}
-
 	//expand our watered tiles
 	for(yn = 1599; yn > 0; yn --)
 	for(xn = 1599; xn > 0; xn --)
 	{
-		if(Watered[xn][yn] && !Watered[xn+1][yn])
+		if(BaseWater[xn][yn] && !BaseWater[xn+1][yn])
 		{
-			Watered[xn][yn] = 3;
+			BaseWater[xn][yn] = 3;
 		}
 		/*
-		if(!Watered[xn][yn] && Watered[xn+1][yn])
+		if(!BaseWater[xn][yn] && BaseWater[xn+1][yn])
 		{
-			Watered[xn][yn] = 2;
+			BaseWater[xn][yn] = 2;
 		}
 		*/
 	}
@@ -2379,14 +2807,14 @@ int Area::GenerateBase(RECT *rArea)
 	for(xn = 1599; xn > 0; xn --)
 	{
 		
-		if(Watered[xn][yn] && !Watered[xn+1][yn])
+		if(BaseWater[xn][yn] && !BaseWater[xn+1][yn])
 		{
-			Watered[xn][yn] = 3;
+			BaseWater[xn][yn] = 3;
 		}
 		
-		if(!Watered[xn][yn] && Watered[xn+1][yn])
+		if(!BaseWater[xn][yn] && BaseWater[xn+1][yn])
 		{
-			Watered[xn][yn] = 2;
+			BaseWater[xn][yn] = 2;
 		}
 	}
 */
@@ -2395,21 +2823,21 @@ int Area::GenerateBase(RECT *rArea)
 	for(xn = 1599; xn > 0; xn --)
 	{
 		WaterTotal = 0;
-		if(Watered[xn-1][yn+1] == 1 ||
-			Watered[xn-1][yn+1] == 2) WaterTotal++;
+		if(BaseWater[xn-1][yn+1] == 1 ||
+			BaseWater[xn-1][yn+1] == 2) WaterTotal++;
 		
-		if(Watered[xn][yn+1] == 1 ||
-			Watered[xn][yn+1] == 2) WaterTotal++;
+		if(BaseWater[xn][yn+1] == 1 ||
+			BaseWater[xn][yn+1] == 2) WaterTotal++;
 			
-		if(Watered[xn][yn-1] == 1 ||
-			Watered[xn][yn-1] == 2) WaterTotal++;
+		if(BaseWater[xn][yn-1] == 1 ||
+			BaseWater[xn][yn-1] == 2) WaterTotal++;
 			
-		if(Watered[xn+1][yn] == 1 ||
-			Watered[xn+1][yn] == 2) WaterTotal++;
+		if(BaseWater[xn+1][yn] == 1 ||
+			BaseWater[xn+1][yn] == 2) WaterTotal++;
 		
-		if(WaterTotal && !Watered[xn][yn])
+		if(WaterTotal && !BaseWater[xn][yn])
 		{
-			Watered[xn][yn] = 3;
+			BaseWater[xn][yn] = 3;
 		}
 	}
 
@@ -2428,287 +2856,218 @@ int Area::GenerateBase(RECT *rArea)
 
 	FillTerrain();
 
-	ZSModelEx *Tree;
-	ZSModelEx *Shrub;
+	QueryPerformanceCounter(&MapsTime);
 
-	float Height;
+	BakeGraph Graph(WORLD_DIM / CHUNK_WIDTH, WORLD_DIM / CHUNK_HEIGHT);
+	BASE_BAKE_T Bake;
+	RECT rChunks;
+	Water *TempWater;
+	FILE *fpOld;
+	FILE *fp;
+	char WorkerName[32];
+	long *OldOffsets;
+	long *OldLengths;
+	long Offset;
+	BYTE *pBuffer;
+	int NumChunks;
+	int NumBaked;
+	int n;
 
-	int ChunkX;
-	int ChunkY;
+	Graph.AddStage("smooth one", SmoothBaseTile, 0);
+	//a cell is averaged with the ones around it, which can be in the next chunk
+	Graph.AddStage("smooth two", SmoothBaseTile, 1);
+	//and a chunk's last row and column of corners are the next chunks' first
+	Graph.AddStage("chunks", BakeBaseChunk, 1);
+	Graph.SetThreads(NumThreads);
+
+	NumChunks = Header.ChunkWidth * Header.ChunkHeight;
+
+	Bake.LeftOffset = pArea->left;
+	Bake.TopOffset = pArea->top;
+	Bake.ChunkLeft = pArea->left / CHUNK_WIDTH;
+	Bake.ChunkTop = pArea->top / CHUNK_HEIGHT;
+	Bake.ChunksWide = Header.ChunkWidth;
+	Bake.MaxDense = MaxDense;
+	Bake.pRecords = new BASE_CHUNK_T[NumChunks];
+	for(n = 0; n < NumChunks; n++)
+	{
+		Bake.pRecords[n].Worker = -1;
+		Bake.pRecords[n].Offset = 0;
+		Bake.pRecords[n].Length = 0;
+	}
 
-	D3DVECTOR Position;
-	float Angle;
+	rChunks.left = Bake.ChunkLeft;
+	rChunks.top = Bake.ChunkTop;
+	rChunks.right = Bake.ChunkLeft + Header.ChunkWidth;
+	rChunks.bottom = Bake.ChunkTop + Header.ChunkHeight;
 
-	int VertOffset;
-	Object *Op;
+	//outside the dirty rectangle the last bake's chunks are copied over
+	fpOld = NULL;
+	OldOffsets = NULL;
+	OldLengths = NULL;
+	if(rDirty)
+	{
+		OldOffsets = new long[NumChunks];
+		OldLengths = new long[NumChunks];
+		fpOld = fopen("world.bin","rb");
+		if(fpOld && ReadBaseChunks(fpOld, Header.ChunkWidth, Header.ChunkHeight, OldOffsets, OldLengths))
+		{
+			if(rDirty->left / CHUNK_WIDTH > rChunks.left)
+				rChunks.left = rDirty->left / CHUNK_WIDTH;
+			if(rDirty->top / CHUNK_HEIGHT > rChunks.top)
+				rChunks.top = rDirty->top / CHUNK_HEIGHT;
+			if((rDirty->right + CHUNK_WIDTH - 1) / CHUNK_WIDTH < rChunks.right)
+				rChunks.right = (rDirty->right + CHUNK_WIDTH - 1) / CHUNK_WIDTH;
+			if((rDirty->bottom + CHUNK_HEIGHT - 1) / CHUNK_HEIGHT < rChunks.bottom)
+				rChunks.bottom = (rDirty->bottom + CHUNK_HEIGHT - 1) / CHUNK_HEIGHT;
+		}
+		else
+		{
+			LogPrintf(LOG_WARNING, LOG_WORLD, "no world.bin the size of the area to rebake, baking all of it");
+			if(fpOld)
+			{
+				fclose(fpOld);
+				fpOld = NULL;
+			}
+		}
+	}
 
-	FILE *fp;
+	for(n = 0; n < Graph.GetNumWorkers(); n++)
+	{
+		Bake.pChunks[n] = new Chunk;
+		Bake.pChunks[n]->SetScratch(TRUE);
+		sprintf(WorkerName,"bake%i.tmp",n);
+		Bake.fpWorkers[n] = SafeFileOpen(WorkerName,"w+b");
+	}
 
-	fp = SafeFileOpen("world.bin","wb");
-	long Offset = 0;
-	Offset += sizeof(STATIC_FILE_HEADER_T);
+	//the first water looks up the textures every water shares, which
+	//mustn't happen on two threads at once
+	TempWater = new Water;
+	delete TempWater;
 
-	fwrite(&Header,sizeof(Header),1,fp);
-	int DI;
-	int TerrainLevel;
-	float HHighest;
-	float HLowest;
+	Graph.Run(&rChunks, &Bake);
 
-	TempChunk.pObjectList = NULL;
-	TempChunk.pObjectList2 = NULL;
-	TempChunk.NumObjects = 0;
-	int LeftOffset;
-	int TopOffset;
+	QueryPerformanceCounter(&GraphTime);
 
-	LeftOffset = pArea->left; // * CHUNK_WIDTH;
-	TopOffset = pArea->top; // * CHUNK_HEIGHT;
-	Water *TempWater;
-	TempWater = NULL;
-	BOOL WaterFound;
+	//the workers' chunks left the path graph alone, so if this is the
+	//area being played it is thrown out here and built again as needed
+	if(Valley == this && pPathGraph)
+	{
+		pPathGraph->Clear();
+	}
 
-	for(ChunkY = (pArea->top /CHUNK_HEIGHT); ChunkY < (pArea->bottom/CHUNK_HEIGHT); ChunkY++)
+	//in order whichever worker baked them
+	NumBaked = 0;
+	Offset = 32 * sizeof(char) + 4 * sizeof(int) + NumChunks * sizeof(int);
+	for(n = 0; n < NumChunks; n++)
 	{
-		for(ChunkX = (pArea->left/CHUNK_WIDTH); ChunkX < (pArea->right/CHUNK_WIDTH); ChunkX++)
+		Header.ChunkOffsets[n] = Offset;
+		if(Bake.pRecords[n].Worker >= 0)
 		{
-			TempChunk.X = ChunkX - (pArea->left / CHUNK_WIDTH);
-			TempChunk.Y = ChunkY - (pArea->top / CHUNK_HEIGHT);
-			DI = 0;
-			yoffset = ChunkY * CHUNK_HEIGHT;
-			WaterFound = FALSE;
-			for(yn = 0; yn < CHUNK_HEIGHT; yn ++)
-			{	
-				xoffset = ChunkX * CHUNK_WIDTH;
-				for(xn = 0; xn < CHUNK_WIDTH; xn ++)
-				{
-					if(Watered[xoffset][yoffset])
-					{
-						WaterFound = TRUE;
-					}
-					HHighest = 0.0f;
-					HLowest = 256.0f;
-					//each tile in a chunk must have the height of each corner
-					Percent = HLevel/(float)Highest;
-					Height = (HeightLevels[xoffset][yoffset]);
-					if(Height > HHighest) HHighest = Height;
-					if(Height < HLowest) HLowest = Height;
+			Offset += Bake.pRecords[n].Length;
+			NumBaked++;
+		}
+		else
+		{
+			Offset += OldLengths[n];
+		}
+	}
 
-					TerrainLevel = (int)Height;
+	fp = SafeFileOpen("temp.bin","wb");
+	SaveHeader(fp);
 
-					VertOffset = (xn + yn * CHUNK_WIDTH)*24;
-					
-					TempChunk.Verts[VertOffset] = (xoffset - LeftOffset)*2;
-					TempChunk.Verts[VertOffset+1] = (yoffset - TopOffset)*2;
-					TempChunk.Verts[VertOffset+2] = Height;
-					
-					Height = (HeightLevels[xoffset+1][yoffset]);
-					if(Height > HHighest) HHighest = Height;
-					if(Height < HLowest) HLowest = Height;
+	pBuffer = new BYTE[BASE_COPY_BLOCK];
+	for(n = 0; n < NumChunks; n++)
+	{
+		if(Bake.pRecords[n].Worker >= 0)
+		{
+			CopyBaseChunk(fp, Bake.fpWorkers[Bake.pRecords[n].Worker], Bake.pRecords[n].Offset, Bake.pRecords[n].Length, pBuffer);
+		}
+		else
+		{
+			CopyBaseChunk(fp, fpOld, OldOffsets[n], OldLengths[n], pBuffer);
+		}
+	}
+	delete[] pBuffer;
 
-					TempChunk.Verts[VertOffset+6] = (xoffset+1 - LeftOffset)*2;
-					TempChunk.Verts[VertOffset+7] = yoffset - TopOffset;
-					TempChunk.Verts[VertOffset+8] = Height;
-					
-					Height = (HeightLevels[xoffset][yoffset+1]);
-					if(Height > HHighest) HHighest = Height;
-					if(Height < HLowest) HLowest = Height;
+	fclose(fp);
 
-					TempChunk.Verts[VertOffset+12] = (xoffset - LeftOffset)*2;
-					TempChunk.Verts[VertOffset+13] = (yoffset+1 - TopOffset)*2;
-					TempChunk.Verts[VertOffset+14] = Height;
-				
-					Height = (HeightLevels[xoffset+1][yoffset+1]);
-					if(Height > HHighest) HHighest = Height;
-					if(Height < HLowest) HLowest = Height;
+	for(n = 0; n < Graph.GetNumWorkers(); n++)
+	{
+		delete Bake.pChunks[n];
+		fclose(Bake.fpWorkers[n]);
+		sprintf(WorkerName,"bake%i.tmp",n);
+		remove(WorkerName);
+	}
+	delete[] Bake.pRecords;
 
-					TempChunk.Verts[VertOffset+18] = (xoffset + 1 - LeftOffset)*2;
-					TempChunk.Verts[VertOffset+19] = (yoffset + 1 - TopOffset)*2;
-					TempChunk.Verts[VertOffset+20] = Height;
-				
-					Level = MaxDense - (ForestDensity[xoffset/2][yoffset/2]);
-					Percent = ((float)Level/(float)MaxDense);
-					
-					Tree = Forests[GetForestValue(xoffset,yoffset)].GetTree(Percent,xoffset,yoffset);
+	if(fpOld)
+	{
+		fclose(fpOld);
+	}
+	if(OldOffsets)
+	{
+		delete[] OldOffsets;
+		delete[] OldLengths;
+	}
 
-					if(!Tree)
-						Shrub = Forests[GetForestValue(xoffset,yoffset)].GetShrub(Percent,xoffset,yoffset);
+	remove("world.bin");
+	rename("temp.bin","world.bin");
 
-					TempChunk.DrawList[DI] = VertOffset;
-					TempChunk.DrawList[DI + 1] = VertOffset + 1;
-					TempChunk.DrawList[DI + 2] = VertOffset + 2;
-					TempChunk.DrawList[DI + 3] = VertOffset + 1;	
-					TempChunk.DrawList[DI + 4] = VertOffset + 3;
-					TempChunk.DrawList[DI + 5] = VertOffset + 2;
-					
-					DI += 6;
+	QueryPerformanceCounter(&EndTime);
+	QueryPerformanceFrequency(&Frequency);
+	ToMS = 1000.0 / (double)Frequency.QuadPart;
 
-					float ScaleOffset;
-					
-					//set up the base terrain
-					TerrainLevel = TerrainLevel / TERRAIN_DEPTH;
+	LogPrintf(LOG_INFO, LOG_WORLD, "bake %-12s %10.2f ms", "maps", (double)(MapsTime.QuadPart - StartTime.QuadPart) * ToMS);
+	Graph.LogTimes();
+	LogPrintf(LOG_INFO, LOG_WORLD, "bake %-12s %10.2f ms", "write", (double)(EndTime.QuadPart - GraphTime.QuadPart) * ToMS);
+	LogPrintf(LOG_INFO, LOG_WORLD, "baked %i of %i chunks in %.2f ms", NumBaked, NumChunks, (double)(EndTime.QuadPart - StartTime.QuadPart) * ToMS);
 
-					if(Road[xoffset][yoffset] || Watered[xoffset][yoffset])
-					{
-						TempChunk.Terrain[xn][yn] = TerrainIndex[TER_SAND] + (rand()%4)*4;
-					}
-					else
-					{
-						TempChunk.Terrain[xn][yn] = Terrain[xoffset][yoffset];				
-						int Chance;
-						Chance = rand() % 10;
-						if(Percent > 0.4f)
-						{
-							switch(Chance)
-							{
-								case 7:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_GRASS_FOUR] + (rand()%4) * 4;
-									break;
-								case 1:
-								case 2:
-								case 3:
-								case 4:
-								case 5:
-								case 6:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_DIRT] + (rand()%4) * 4;
-									break;
-								case 8:
-								case 9:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_MOSS] + (rand()%4) * 4;
-									break;
-								default:
-									break;
-							}
-						}
-						
-						if(Tree)
-						{
-							ScaleOffset = (float)rand() / (float)RAND_MAX;
-							ScaleOffset *= 0.5f;
-							Op = new Object;
-							Position.x = ((float)xoffset - LeftOffset) * 2.0f + 0.5f;
-							Position.y = ((float)yoffset - TopOffset) * 2.0f + 0.5f;
-							Position.z = ((HHighest + HLowest) / 2.0f) - .05f;
-							Op->SetPosition(&Position);
-							Op->SetMesh(Tree);
-							Op->SetMeshNum(Engine->GetMeshNum(Tree));
-							Op->SetScale(0.75f + ScaleOffset);
-							Angle = ((float)rand() /(float)RAND_MAX) * PI_MUL_2;
-							Op->SetAngle(Angle);
-							Op->SetTexture(Tree->GetTexture());
-							Op->SetTextureNum(Engine->GetTextureNum(Tree->GetTexture()));
-							Op->SetNext(TempChunk.pObjectList);
-							TempChunk.pObjectList = Op;
-//							TempChunk.SetBlocking(xn,yn,Tree->GetBlocking());
-							switch(Chance)
-							{
-								case 7:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_GRASS_FOUR] + (rand()%4) * 4;
-									break;
-								case 1:
-								case 2:
-								case 3:
-								case 4:
-								case 5:
-								case 6:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_DIRT] + (rand()%4) * 4;
-									break;
-								case 8:
-								case 9:
-									TempChunk.Terrain[xn][yn] = TerrainIndex[TER_MOSS] + (rand()%4) * 4;
-									break;
-								default:
-									break;
-							}
-						}
-						else
-						if(Shrub)
-						{
-							ScaleOffset = (float)rand() / (float)RAND_MAX;
-							ScaleOffset *= 0.5;
-							Op = new Object;
-							float ShrubX;
-							float ShrubY;
-							ShrubX = (float)rand() / (float)RAND_MAX;
-							ShrubY = (float)rand() / (float)RAND_MAX;
-							Position.x = ((float)xoffset + ShrubX - LeftOffset) * 2.0f;
-							Position.y = ((float)yoffset + ShrubY - TopOffset) * 2.0f;
-							Position.z = ((HHighest + HLowest) / 2.0f) - .05f;
-							
-							Op->SetPosition(&Position);
-							Op->SetMesh(Shrub);
-							Op->SetMeshNum(Engine->GetMeshNum(Shrub));
-							Op->SetScale(0.75f + ScaleOffset);
-							Angle = ((float)rand() /(float)RAND_MAX) * PI_MUL_2;
-							Op->SetAngle(Angle);
-							Op->SetTexture(Shrub->GetTexture());
-							Op->SetTextureNum(Engine->GetTextureNum(Shrub->GetTexture()));
-							Op->SetNext(TempChunk.pObjectList);
-
-//							TempChunk.SetBlocking(xn, yn, Shrub->GetBlocking());
-							TempChunk.pObjectList = Op;
-						}
-						
-						if((HHighest - HLowest) >= 1.1f)
-						{
-							TempChunk.Terrain[xn][yn] = TerrainIndex[TER_STONE_ONE + rand()%4] + (rand()%4) * 4; 
-						}
-					}
-					xoffset++;
-				}
-				yoffset++;;
-			}
-			if(WaterFound)
-			{
-				TempWater = CreateWater(TempChunk.X, TempChunk.Y);
-				TempChunk.AddObject(TempWater);
-			}
-			Header.ChunkOffsets[TempChunk.X + TempChunk.Y * Header.Width] = ftell(fp);
-			TempChunk.Build();
-			TempChunk.CreateHeightMap();
-			if(WaterFound)
-			{
-				yoffset = TempChunk.Y * CHUNK_HEIGHT;
-				for(yn = 0; yn < CHUNK_HEIGHT; yn ++)
-				{	
-					xoffset = TempChunk.X * CHUNK_WIDTH;
-					for(xn = 0; xn < CHUNK_WIDTH; xn ++)
-					{
-						if(Watered[xoffset][yoffset] == 1 ||
-							Watered[xoffset][yoffset] == 2)
-						{
-							TempChunk.RemoveTile(xn,yn);
-						}
-						xoffset++;
-					}
-					yoffset++;
-				}
-			}
-			TempChunk.Save(fp);
-			TempChunk.pObjectList = NULL;
-			TempChunk.pObjectList2 = NULL;
-			TempChunk.NumObjects = 0;
-			if(TempWater)
-			{
-				delete TempWater;
-				TempWater = NULL;
-			}
-		}
-	}
+	StaticFile = SafeFileOpen("world.bin","rb");
+	OpenStaticViews();
 
-	
+//	SmoothBaseTerrain();
+	return TRUE;
+}
 
+BOOL Area::CheckBase(RECT *rArea)
+{
+	RECT rSerial;
+	RECT rParallel;
+	BOOL Same;
 
-	fseek(fp,0,SEEK_SET);
+	if(rArea)
+	{
+		rSerial = *rArea;
+		rParallel = *rArea;
+	}
 
-	fwrite(&Header,sizeof(Header),1,fp);
+	GenerateBase(rArea ? &rSerial : NULL, NULL, 1);
 
-	fclose(fp);
+	//kept to one side while the parallel bake takes its place
+	CloseStaticViews();
+	if(StaticFile)
+	{
+		fclose(StaticFile);
+		StaticFile = NULL;
+	}
+	remove("serial.bin");
+	rename("world.bin","serial.bin");
 
-	fp = SafeFileOpen("world.bin","rb");
-	StaticFile = fp;
+	GenerateBase(rArea ? &rParallel : NULL, NULL, 0);
 
-	CleanUpChunks();
-//	SmoothBaseTerrain();
-	return TRUE;
+	Same = BakeCompareFiles("serial.bin","world.bin");
+	remove("serial.bin");
+
+	if(Same)
+	{
+		LogPrintf(LOG_INFO, LOG_WORLD, "the parallel bake matches the serial one");
+	}
+	else
+	{
+		LogPrintf(LOG_WARNING, LOG_WORLD, "the parallel bake differs from the serial one");
+	}
+	return Same;
 }
 
 void World::DefaultRegions(RECT *rArea)
@@ -2936,6 +3295,7 @@ void Area::BuildCavern(char *filename, int TileWidth, int TileHeight)
 	
 	this->UpdateSegments = new Object *[this->UpdateWidth * this->UpdateHeight];
 	ZeroMemory(this->UpdateSegments, sizeof(Object *) * this->UpdateWidth * this->UpdateHeight);
+	this->ClearCells();
 
 	if(this->Regions)
 		delete[] this->Regions;
@@ -3128,6 +3488,7 @@ void Area::BuildCavern(char *filename, int TileWidth, int TileHeight)
 	{
 		TempChunk.X = ChunkX;
 		TempChunk.Y = ChunkY;
+		TempChunk.SetScratch(TRUE);
 		this->Header.ChunkOffsets[ChunkX + ChunkY * this->ChunkWidth] = ftell(fp);
 
 		XStart = ChunkX * CHUNK_TILE_WIDTH;
@@ -3211,6 +3572,7 @@ void Area::BuildCavern(char *filename, int TileWidth, int TileHeight)
 	fclose(fp);
 
 	StaticFile = SafeFileOpen(AreaFileName,"rb");
+	OpenStaticViews();
 
 	SetCurrentDirectory(Engine->GetRootDirectory());
 
@@ -4233,6 +4595,7 @@ void Area::AddCaveWalls(char *Texture, int WallHeight, int Type)
 
 	fclose(fp);
 
+	CloseStaticViews();
 	fclose(StaticFile);
 	
 	remove(AreaFileName);
@@ -4240,6 +4603,7 @@ void Area::AddCaveWalls(char *Texture, int WallHeight, int Type)
 	rename("temp.bin",AreaFileName);
 
 	StaticFile = SafeFileOpen(AreaFileName,"rb");
+	OpenStaticViews();
 
 	delete[] WallAreas;
 	delete[] Visited;
@@ -4251,8 +4615,7 @@ void Area::AddCaveWalls(char *Texture, int WallHeight, int Type)
 		offset = xn + yn * ChunkWidth;
 		if(BigMap[offset])
 		{
-			delete BigMap[offset];
-			BigMap[offset] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	}
 
@@ -4318,8 +4681,7 @@ void Area::FixOutDoorTerrain()
 			NewOffsets[xn + yn * ChunkWidth] = ftell(fp);
 			pChunk->FixTerrainHeights();
 			pChunk->Save(fp);
-			delete pChunk;
-			BigMap[xn + yn * ChunkWidth] = 0;
+			RemoveChunk(xn, yn);
 		}
 		else
 		{
@@ -4336,6 +4698,7 @@ void Area::FixOutDoorTerrain()
 	SaveHeader(fp);
 
 	fclose(fp);
+	CloseStaticViews();
 	fclose(StaticFile);
 
 	char filename[64];
@@ -4346,6 +4709,7 @@ void Area::FixOutDoorTerrain()
 	rename("temp.bin",filename);
 
 	StaticFile = SafeFileOpen(filename,"rb");
+	OpenStaticViews();
 	
 	SetCurrentDirectory(Engine->GetRootDirectory());
 }
@@ -0,0 +1,26 @@
+#!/bin/sh
+#links every #include spelt in a different case from the file it means,
+#the sources were written against a filesystem that ignores case
+#usage: caselinks.sh <output dir> <include dir>...
+Out=$1
+shift
+mkdir -p "$Out"
+awk 1 $(for Dir in "$@"; do ls "$Dir"/*.c "$Dir"/*.cpp "$Dir"/*.h "$Dir"/*.inl 2>/dev/null; done) |
+	sed -n 's/^[ 	]*#[ 	]*include[ 	]*["<]\([^">/]*\)[">].*/\1/p' | sort -u |
+	while read Name; do
+		Found=
+		for Dir in "$@"; do
+			if [ -e "$Dir/$Name" ]; then
+				Found=yes
+				break
+			fi
+		done
+		[ -n "$Found" ] && continue
+		for Dir in "$@"; do
+			Real=$(ls "$Dir" | grep -ix -m1 -F "$Name")
+			if [ -n "$Real" ]; then
+				ln -sf "$(cd "$Dir" && pwd)/$Real" "$Out/$Name"
+				break
+			fi
+		done
+	done
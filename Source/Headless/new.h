@@ -0,0 +1,2 @@
+//stands in for the old Visual C++ header in headless builds
+#include <new>
@@ -0,0 +1,2 @@
+//stands in for the Windows header in headless builds
+#include "../headless.h"
@@ -39,6 +39,8 @@
 #include "inventorywin.h"
 #include "zscaveedit.h"
 #include "combatmanager.h"
+#include "replay.h"
+#include "profiler.h"
 
 #ifndef NDEBUG
 #define VERSION_NUMBER			"v1.5"
@@ -66,6 +68,7 @@ ZSMainWindow::ZSMainWindow()
 	pScriptWin = NULL;
 	pFPS = NULL;
 	pDrawTime = NULL;
+	pProfile = NULL;
 	pMenuBar = NULL;
 	pDescribe = NULL;
 	Frame = 0;
@@ -98,6 +101,8 @@ ZSMainWindow::ZSMainWindow()
 	Bounds.top = 0;
 	Bounds.bottom = Engine->Graphics()->GetHeight();
 	Pathing = FALSE;
+	PathToX = 0;
+	PathToY = 0;
 	ZSWindow::pMainWindow = this;
 	ZSWindow::pInputFocus = this;
 
@@ -144,6 +149,11 @@ ZSMainWindow::ZSMainWindow()
 	pDrawTime->Hide();
 	pDrawTime->SetText("             ");
 
+	pProfile = new ZSText(124500, 0, 320, 320, 160, " ", 0);
+	AddChild(pProfile);
+	pProfile->Hide();
+	pProfile->SetTextColor(TEXT_WHITE);
+
 	pTargetString = new ZSText(124500, 0, 475,"wwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwwww: hp:wwwww rp:wwwww wp: wwwww");
 	AddChild(pTargetString);
 	pTargetString->Hide();
@@ -509,18 +519,18 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 				switch(this->pTarget->GetDefaultAction(pActive))
 				{
 					case ACTION_ATTACK:
-						pActive->InsertAction(ACTION_ATTACK,(void *)this->pTarget,(void *)pActive->GetData(INDEX_LASTATTACK).Value);
+						PreludeReplay.Command(REPLAY_ATTACK, this->pTarget, 0, 0, pActive->GetData(INDEX_LASTATTACK).Value);
 						//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 						break;
 					case ACTION_DEFEND:
-						pActive->InsertAction(ACTION_DEFEND,NULL,NULL);
+						PreludeReplay.Command(REPLAY_DEFEND, NULL, 0, 0, 0);
 						//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 						break;
 					case ACTION_OPEN:
-						pActive->InsertAction(ACTION_OPEN,(void *)this->pTarget,NULL);
+						PreludeReplay.Command(REPLAY_OPEN, this->pTarget, 0, 0, 0);
 						break;
 					case ACTION_CLOSE:
-						pActive->InsertAction(ACTION_CLOSE,(void *)this->pTarget,NULL);
+						PreludeReplay.Command(REPLAY_CLOSE, this->pTarget, 0, 0, 0);
 						break;
 					case ACTION_TALK:
 						if(((Creature *)this->pTarget)->GetRegionIn() == PreludeParty.GetLeader()->GetRegionIn()
@@ -537,7 +547,7 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 					//	pActive->Update();
 						break;
 					case ACTION_PICKUP:
-						pActive->InsertAction(ACTION_PICKUP,(void *)this->pTarget,NULL);
+						PreludeReplay.Command(REPLAY_PICKUP, this->pTarget, 0, 0, 0);
 						break;
 					default:
 						break;
@@ -546,11 +556,9 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 			else
 			if(Pathing && PreludeWorld->GetGameState() == GAME_STATE_COMBAT && MainPath.IsOnPath(EndX,EndY))
 			{
-				Path *pPath;
-				pPath = new Path;
-				memcpy(pPath, &MainPath, sizeof(Path));
-				pPath->SetEnd(EndX,EndY);
-				pActive->InsertAction(ACTION_FOLLOWPATH,(void *)pPath,(void *)NULL);
+				//the path is found again from where it was asked for, so a
+				//recording follows the same one
+				PreludeReplay.Command(REPLAY_PATH, NULL, EndX, EndY, 0, PathToX, PathToY);
 				//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 				Pathing = FALSE;
 				return TRUE;
@@ -566,7 +574,7 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 				{
 					if(MainPath.FindPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, EndX, EndY,  0.0f, pActive))
 					{
-						PreludeParty.MoveParty(EndX,EndY);
+						PreludeReplay.Command(REPLAY_MOVE, NULL, EndX, EndY, 0);
 						//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 					}
 				}
@@ -584,7 +592,8 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 					else
 					{
 						MainPath.SetTravellerSize(1);
-						if(MainPath.FindCombatPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, EndX, EndY,  0.0f, pActive))
+						if(MainPath.FindCombatFloodPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, EndX, EndY, pActive)
+							|| MainPath.FindCombatPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, EndX, EndY,  0.0f, pActive))
 						{
 							Pathing = TRUE;
 						//	Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
@@ -592,6 +601,8 @@ int ZSMainWindow::LeftButtonUp(int x, int y)
 					}
 
 				}
+				PathToX = EndX;
+				PathToY = EndY;
 				this->pTarget = NULL;
 				return TRUE;
 			}
@@ -936,6 +947,38 @@ int ZSMainWindow::HandleKeys(BYTE *CurrentKeys, BYTE *LastKeys)
 		pDrawTime->Hide();
 	}
 
+//zone times overlay
+	if(CurrentKeys[DIK_F11] & 0x80 && !(LastKeys[DIK_F11] & 0x80))
+	{
+		ProfileShowOverlay(!ProfileOverlayOn());
+		pProfile->SetText((char *)ProfileGetOverlay());
+		if(ProfileOverlayOn())
+		{
+			pProfile->Show();
+		}
+		else
+		{
+			pProfile->Hide();
+		}
+	}
+
+//start or stop a profile capture
+	if(CurrentKeys[DIK_F12] & 0x80 && !(LastKeys[DIK_F12] & 0x80))
+	{
+		if(ProfileCapturing())
+		{
+			if(ProfileStopCapture(PROFILE_FILE_NAME))
+			{
+				Describe("Profile saved to " PROFILE_FILE_NAME);
+			}
+		}
+		else
+		{
+			ProfileStartCapture();
+			Describe("Profiling...");
+		}
+	}
+
 	D3DMATRIX mRotation;
 	D3DVECTOR vResult;
 
@@ -1411,7 +1454,7 @@ if(PreludeWorld->IsEdittingEnabled())
 	{
 		if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT && pThing->GetMajorAction()->GetType() == ACTION_USER)
 		{
-			pThing->InsertAction(ACTION_DEFEND, NULL, NULL);
+			PreludeReplay.Command(REPLAY_DEFEND, NULL, 0, 0, 0);
 			//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 		}
 	}
@@ -1421,7 +1464,7 @@ if(PreludeWorld->IsEdittingEnabled())
 	{
 		if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT && pThing->GetMajorAction()->GetType() == ACTION_USER)
 		{
-			pThing->InsertAction(ACTION_WAITACTION, NULL, NULL);
+			PreludeReplay.Command(REPLAY_WAIT, NULL, 0, 0, 0);
 			//Valley->SetCameraOffset(_D3DVECTOR(0.0f,0.0f,0.0f));
 		}
 	}
@@ -1730,6 +1773,11 @@ int ZSMainWindow::GoModal()
 		Draw();
 		Engine->Graphics()->Flip();
 
+		if(ProfileEndFrame())
+		{
+			pProfile->SetText((char *)ProfileGetOverlay());
+		}
+
 		if(ShowFrames && !(FrameNum % 30))
 		{
 			FrameLength =  (timeGetTime() - LastFrame) + 1;
@@ -1766,7 +1814,11 @@ int ZSMainWindow::GoModal()
 			PreludeWorld->ChangeCamera();
 		}
 
-		PreludeWorld->UpdateOffScreenCreatures();
+		//fixed ticks update them in World::Update
+		if(!FixedTicks())
+		{
+			PreludeWorld->UpdateOffScreenCreatures();
+		}
 		PreludeWorld->CleanOffScreenChunks();
 
 		if(SkipFrames)
@@ -1990,7 +2042,10 @@ int ZSMainWindow::GoModal()
 		while(timeGetTime() < NextFrame) 
 		{
 			//update creatures
-			PreludeWorld->UpdateOffScreenCreatures();
+			if(!FixedTicks())
+			{
+				PreludeWorld->UpdateOffScreenCreatures();
+			}
 	
 			//perform memory clean-up;
 			PreludeWorld->CleanOffScreenChunks();
@@ -2099,6 +2154,11 @@ int ZSMainWindow::DrawAndUpdate()
 
 	Draw();
 	Engine->Graphics()->Flip();
+
+	if(ProfileEndFrame())
+	{
+		pProfile->SetText((char *)ProfileGetOverlay());
+	}
 /*
 	if(ShowFrames && !(FrameNum % 30))
 	{
@@ -43,11 +43,16 @@ Object::Object()
 	Frame = 0;
 	Position = D3DVECTOR(0.0f,0.0f,0.0f);
 	Scale = 1.0f;
+	BlockingRadius = 0.0f;
 	MeshNum = 0;
 	pMesh = NULL;
 	pNextUpdate = NULL;
 	pPrevUpdate = NULL;
 	pContents = NULL;
+	pNextCell = NULL;
+	pPrevCell = NULL;
+	pCellArea = NULL;
+	CellIn = -1;
 }
 
 //copy constructor
@@ -132,6 +137,11 @@ BOOL Object::RayIntersectAlwaysCheck(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 
 	InverseScale = 1.0f/Scale;
 
+	if(!pMesh->NearRay(vRayStart, vRayEnd, GetPosition(), Scale))
+	{
+		return FALSE;
+	}
+
 	//convert the ray to object coordinates
 	//first translate then rotate
 	D3DMATRIX matRotate, matScale, matTransform;
@@ -166,7 +176,8 @@ BOOL Object::RayIntersect(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 
 	InverseScale = 1.0f/Scale;
 
-	if(Distance < pMesh->GetWidth() || Distance < pMesh->GetHeight())
+	if((Distance < pMesh->GetWidth() || Distance < pMesh->GetHeight()) &&
+		pMesh->NearRay(vRayStart, vRayEnd, GetPosition(), Scale))
 	{
 		//convert the ray to object coordinates
 		//first translate then rotate
@@ -516,6 +527,11 @@ void Object::Move(D3DVECTOR *vDirection)
 	pPosition->x += vDirection->x;
 	pPosition->y += vDirection->y;	
 	pPosition->z += vDirection->z;
+
+	if(pCellArea)
+	{
+		pCellArea->UpdateCell(this);
+	}
 }
 
 BOOL Object::AddItem(GameItem *pGameItem)
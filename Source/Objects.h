@@ -81,6 +81,11 @@ protected:
 	Object *pNextUpdate;
 	Object *pPrevUpdate;
 	Object *pContents;
+	//the area tile cell this is filed under, alongside the update list
+	Object *pNextCell;
+	Object *pPrevCell;
+	Area *pCellArea;
+	int CellIn;
 	
 //************************************************************************************** 
 
@@ -115,6 +120,10 @@ public:
 	virtual int LookAt(Object *looker) { return 0; };
 	Object *GetNextUpdate() { return pNextUpdate; }
 	Object *GetPrevUpdate() { return pPrevUpdate; }
+	Object *GetNextCell() { return pNextCell; }
+	Object *GetPrevCell() { return pPrevCell; }
+	Area *GetCellArea() { return pCellArea; }
+	int GetCellIn() { return CellIn; }
 	D3DVECTOR GetCenter();
 	float GetCurrentRadius();
 	long GetData() { return Data; }
@@ -141,6 +150,9 @@ public:
 
 	void SetNextUpdate(Object *pNew) { pNextUpdate = pNew; }
 	void SetPrevUpdate(Object *pNew) { pPrevUpdate = pNew; }
+	void SetNextCell(Object *pNew) { pNextCell = pNew; }
+	void SetPrevCell(Object *pNew) { pPrevCell = pNew; }
+	void SetCell(Area *pArea, int NewCell) { pCellArea = pArea; CellIn = NewCell; }
 
 	virtual void Move(D3DVECTOR *vDirection);
 
@@ -31,8 +31,13 @@
 #include "deathwin.h"
 #include "zsmenubar.h"
 #include "area.h"
+#include "chunkstreamer.h"
+#include "chunkresidency.h"
+#include "offscreensim.h"
 #include "minimap.h" //to unset when entering dungeons
 #include "zsdescribe.h"
+#include "replay.h"
+#include "profiler.h"
 
 //for re-seeding random number generator
 #include <time.h>
@@ -88,9 +93,20 @@ World::World()
 	FullBodySelection = FALSE;
 	HighlightInformation = TRUE;
 	
-	pOffScreenCreature = NULL;
-	CleanX = 0;
-	CleanY = 0;
+	//gui.ini may give the time for offscreen creatures, in microseconds a frame
+	int OffScreenBudget;
+	FILE *fpIni;
+	OffScreenBudget = OFFSCREEN_DEFAULT_BUDGET;
+	fpIni = fopen("gui.ini","rt");
+	if(fpIni)
+	{
+		if(SeekTo(fpIni,"OFFSCREENBUDGET"))
+		{
+			OffScreenBudget = GetInt(fpIni);
+		}
+		fclose(fpIni);
+	}
+	pOffScreen = new OffScreenSim(OffScreenBudget);
 	
 	CurAreaNum = 0;
 	
@@ -145,7 +161,7 @@ World::World()
 	pMainObjects = NULL;
 
 	AutosaveRate = 0;
-	LastAutosave = timeGetTime();
+	LastAutosave = GameTime();
 }
 
 World::World(const char *filename)
@@ -309,6 +325,10 @@ World::~World()
 	DEBUG_INFO("Deleting World\n");
 	Object *pOb, *pKillOb;
 
+	//creatures deleted from here on have nothing to tell it
+	delete pOffScreen;
+	pOffScreen = NULL;
+
 	DEBUG_INFO("Deleting Objects\n");
 
 	pOb = pMainObjects;
@@ -1137,10 +1157,8 @@ void World::ConvertToWorld(D3DVECTOR *vScreen)
 //************ Mutators ************************************************
 int World::Load(const char *filename)
 {
-	LastAutosave = timeGetTime();
-	pOffScreenCreature = NULL;
-	CleanX = 0;
-	CleanY = 0;
+	LastAutosave = GameTime();
+	pOffScreen->Reset();
 
 	FILE *fp;
 	fp = SafeFileOpen(filename,"rb");
@@ -1273,12 +1291,19 @@ int World::LookAt(Thing *pThing)
 		if(EndY >= Valley->ChunkHeight)
 			EndY = Valley->ChunkHeight - 1;
 		
+		//queue the ring past the new window for the loader, the window is
+		//read here, claiming whatever the loader already finished
+		if(Valley->pStreamer && !FixedTicks())
+		{
+			Valley->pStreamer->Update(NewScreenX, NewScreenY, DrawRadius);
+		}
+
 		Chunk *pChunk;
 		Engine->Graphics()->GetD3D()->BeginScene();
-		for(yn = StartY; yn <= EndY; yn++)
+		for(yn = EndY; yn >= StartY; yn--)
 		{
 			Offset = yn * Valley->ChunkWidth;
-			for(xn = StartX; xn <= EndX; xn++)
+			for(xn = EndX; xn >= StartX; xn--)
 			{
 				if(!Valley->BigMap[Offset + xn])
 				{
@@ -1326,6 +1351,10 @@ int World::Update()
 	int EndX;
 	int EndY;
 
+	ProfileZone UpdateZone(ZONE_WORLD_UPDATE);
+
+	PreludeReplay.BeginTick();
+
 	StartX = ScreenX - DrawRadius;
 	StartY = ScreenY - DrawRadius;
 	
@@ -1346,33 +1375,40 @@ int World::Update()
 	
 	Chunk *pChunk;
 	BOOL Loaded = FALSE;
-	for(yn = StartY; (yn <= EndY && !Loaded); yn++)
+
+	//the loader thread reads the ring ahead of the window.  in fixed ticks
+	//it is left alone so chunks turn up on the same tick every time
+	if(Valley->pStreamer && Valley->pStreamer->IsRunning() && !FixedTicks())
+	{
+		Valley->pStreamer->Update(ScreenX, ScreenY, DrawRadius);
+	}
+
+	//a chunk in view is never left out, it is claimed from the loader or
+	//read here.  textures are still made one a frame
+	for(yn = StartY; yn <= EndY; yn++)
 	{
 		Offset = yn * Valley->ChunkWidth;
-		for(xn = StartX; (xn <= EndX && !Loaded); xn++)
+		for(xn = StartX; xn <= EndX; xn++)
 		{
 			if(!Valley->BigMap[Offset + xn])
 			{
 				Valley->LoadChunk(xn,yn);
-				Loaded = TRUE;
 			}
-			else
+			
+			pChunk = Valley->GetChunk(xn,yn);
+			if(!Loaded && pChunk && !pChunk->GetTexture()) 
 			{
-				pChunk = Valley->GetChunk(xn,yn);
-				if(pChunk && !pChunk->GetTexture()) 
-				{
-					Engine->Graphics()->GetD3D()->BeginScene();
-					pChunk->CreateTexture(Valley->GetBaseTexture());
-					Engine->Graphics()->GetD3D()->EndScene();
-					Loaded = TRUE;
-				}
+				Engine->Graphics()->GetD3D()->BeginScene();
+				pChunk->CreateTexture(Valley->GetBaseTexture());
+				Engine->Graphics()->GetD3D()->EndScene();
+				Loaded = TRUE;
 			}
 		}
 	}
 	
 	//done loading a chunk if it's not there
 	
-	CurTime = timeGetTime();
+	CurTime = GameTime();
 
 	pOb = pMainObjects;
 
@@ -1400,6 +1436,8 @@ int World::Update()
 		if(GameState != GAME_STATE_COMBAT)
 			return TRUE;		
 			
+		ProfileZone AreaZone(ZONE_AREA_UPDATE);
+
 		//update everything no in combat, adding to combat if necessary
 		for(yn = UpdateRect.top; yn <= UpdateRect.bottom; yn++)
 		{
@@ -1497,6 +1535,15 @@ int World::Update()
 		{
 			IncrementTime();
 		}
+
+		//the main window gives them whatever is left of the frame, a fixed
+		//tick gives them a fixed share here
+		if(FixedTicks())
+		{
+			UpdateOffScreenCreatures();
+		}
+
+		ProfileZone AreaZone(ZONE_AREA_UPDATE);
 		
 		for(yn = UpdateRect.top; yn <= UpdateRect.bottom; yn++)
 		{
@@ -1914,7 +1961,7 @@ void World::ClearRegions()
 
 void World::SaveGame(const char *filename, char *GameID)
 {
-	this->LastAutosave = timeGetTime();
+	this->LastAutosave = GameTime();
 	unsigned long Pos;
 	char blarg[64];
 	FILE *fp;
@@ -2063,9 +2110,10 @@ void World::SaveGame(const char *filename, char *GameID)
 
 void World::LoadGame(const char *filename)
 {
-	pOffScreenCreature = NULL;
-	CleanX = 0;
-	CleanY = 0;
+	//a recording only holds from the save it started at
+	PreludeReplay.StopRecording();
+
+	pOffScreen->Reset();
 
 	PreludeEvents.Clear();
 	PreludeEvents.UnsetCreaturePointers();
@@ -2347,7 +2395,7 @@ void World::IncrementTime()
 	}
 
 	TotalTime++; 
-	NextAdvanceTime = timeGetTime() + TIME_PASS_SPEED;
+	NextAdvanceTime = GameTime() + TIME_PASS_SPEED;
 }
 
 void World::UpdateCameraOffset(D3DVECTOR UpdateRay)
@@ -2646,7 +2694,7 @@ void World::LoadTowns()
 
 int World::PseudoRand(int modifier)
 {
-	int randreturn = rand();
+	int randreturn = GameRand();
 	return randreturn;
 }
 
@@ -2885,8 +2933,6 @@ void World::BringUpToDate()
 void World::GotoArea(int AreaNum, int x, int y)
 {
 	CurAreaNum = AreaNum;
-	CleanX = 0;
-	CleanY = 0;
 
 	if(AreaNum)
 	{
@@ -3111,83 +3157,41 @@ void World::UpdateOffScreenCreatures()
 	if(this->GameState != GAME_STATE_NORMAL)
 		return;
 
-	if(!pOffScreenCreature)
-	{
-		pOffScreenCreature = (Object *)Creature::GetFirst();
-	}
-	Creature *pCreature;
-	pCreature = (Creature *)pOffScreenCreature;
-	
-	//check to see if the creature is actually offscreen;
-	int CX;
-	int CY;
-	CX = pCreature->GetPosition()->x;
-	CX /= UPDATE_SEGMENT_WIDTH;
-
-	CY = pCreature->GetPosition()->y;
-	CY /= UPDATE_SEGMENT_HEIGHT;
+	ProfileZone OffScreenZone(ZONE_OFFSCREEN);
 
-	if(pCreature->GetAreaIn() == this->GetCurAreaNum() 
-		&& CX >= UpdateRect.left 
-		&& CX <= UpdateRect.right 
-		&& CY >= UpdateRect.top 
-		&& CY <= UpdateRect.bottom)
-	{
-		pOffScreenCreature = pOffScreenCreature->GetNext();
-	}
-	else
-	{
-		pCreature->UpdateOffScreen();
-		pOffScreenCreature = pOffScreenCreature->GetNext();
-	}
+	pOffScreen->Update(this->GetCurAreaNum(), &UpdateRect, this->GetHour(), this->GetTotalTime());
+}
 
-	//post update clean texture if necessary
-	if(pCreature->GetAreaIn() != this->GetCurAreaNum() || CX < UpdateRect.left || CX > UpdateRect.right || CY < UpdateRect.top || CY > UpdateRect.bottom)
+void World::ForgetOffScreenCreature(Creature *pCreature)
+{
+	if(pOffScreen)
 	{
-		if(pCreature->GetData(INDEX_TYPE).Value == 0)
-		{
-			if(pCreature->GetTexture())
-			{
-				delete pCreature->GetTexture();
-				pCreature->SetTexture(NULL);
-			}
-		}
+		pOffScreen->Remove(pCreature);
 	}
-
 }
 
 void World::CleanOffScreenChunks()
 {
-	if(!Valley) return;
-	if(this->InCombat() == TRUE || this->GameState == GAME_STATE_COMBAT) return;	
+	if(!Valley || !Valley->pResidency) return;
 
-	int Top = this->ScreenY - (this->DrawRadius);
-	int Left = this->ScreenX - (this->DrawRadius);
-	int Bottom = this->ScreenY + (this->DrawRadius);
-	int Right = this->ScreenX + (this->DrawRadius);
-	
-	Chunk *pChunk;
-	pChunk = Valley->GetChunk(CleanX, CleanY);
-
-	if(pChunk && (CleanX < Left || CleanX > Right || CleanY < Top || CleanY > Bottom))
-	{
-		Valley->RemoveChunk(CleanX, CleanY);
-	}
-	
-	if(CleanX >= Valley->GetWidth())
+	//the chunks under a fight stay loaded however long they go untouched
+	if(this->InCombat() == TRUE || this->GameState == GAME_STATE_COMBAT)
 	{
-		CleanX = 0;
-		CleanY++;
-		if(CleanY >= Valley->GetHeight())
-		{
-			CleanY = 0;
-		}
+		RECT rCombat;
+		RECT rPin;
+		pCombat->GetCombatRect(&rCombat);
+		rPin.left = rCombat.left / CHUNK_TILE_WIDTH;
+		rPin.right = rCombat.right / CHUNK_TILE_WIDTH;
+		rPin.top = rCombat.top / CHUNK_TILE_HEIGHT;
+		rPin.bottom = rCombat.bottom / CHUNK_TILE_HEIGHT;
+		Valley->pResidency->SetPin(&rPin);
 	}
 	else
 	{
-		CleanX++;
+		Valley->pResidency->ClearPin();
 	}
 
+	Valley->pResidency->Update(this->ScreenX, this->ScreenY, this->DrawRadius);
 }
 
 void World::GetNearestRoad(int CurX, int CurY, int *DropX, int *DropY)
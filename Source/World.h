@@ -51,6 +51,7 @@ class Region;
 class Creature;
 class Thing;
 class Combat;
+class OffScreenSim;
 
 //preprocessor defs ***********************************************
 
@@ -196,9 +197,7 @@ private:
 	BYTE CurAreaNum;
 
 //for updates
-	Object *pOffScreenCreature;
-	int CleanX;
-	int CleanY;
+	OffScreenSim *pOffScreen;
 
 //for help tips
 	BOOL CreationHelp;
@@ -379,6 +378,8 @@ public:
 	
 	void GetUpdateRect(RECT *pRect) { *pRect = UpdateRect; }
 	void UpdateOffScreenCreatures();
+	void ForgetOffScreenCreature(Creature *pCreature);
+	OffScreenSim *GetOffScreenSim() { return pOffScreen; }
 	void CleanOffScreenChunks();
 
 	char *GetTown(int x, int y);
@@ -26,6 +26,7 @@
 //#include <commctrl.h>
 #include <assert.h>
 #include "ZSutilities.h"
+#include "mesharchive.h"
 
 #define TEXTURE_FILE "textures.txt"
 #define MESH_FILE	"meshes.txt"
@@ -35,11 +36,12 @@
 ZSEngine *Engine = NULL;
 
 //constructor
-ZSEngine::ZSEngine() 
+ZSEngine::ZSEngine() : MeshRegistry("meshes"), TextureRegistry("textures")
 {
 	NumMesh = 0;
 	
 	memset(MeshList,0,sizeof(ZSModelEx *) * MAX_MESH);
+	pMeshArchive = NULL;
 
 	NumTextures = 0;
 	TextureList = NULL;
@@ -121,6 +123,12 @@ ZSEngine::~ZSEngine()
 		DEBUG_INFO("Meshes deleted\n");
 	}
 
+	if(pMeshArchive)
+	{
+		delete pMeshArchive;
+		pMeshArchive = NULL;
+	}
+
 	if(TextureList)
 	{
 		delete[] TextureList;
@@ -217,12 +225,12 @@ void ZSEngine::ReportError(HRESULT ddrval)
 
 ZSModelEx *ZSEngine::GetMesh(const char *pMeshName)
 {
-	for(int n = 0; n < NumMesh; n++)
+	int n;
+
+	n = MeshRegistry.Find(pMeshName);
+	if(n != ASSET_NONE)
 	{
-		if(MeshList[n] && !strcmp(pMeshName,MeshList[n]->GetName()))
-		{
-			return MeshList[n];
-		}
+		return MeshList[n];
 	}
 //	DEBUG_INFO("Failed to find mesh named: ");
 //	DEBUG_INFO(pMeshName);
@@ -234,12 +242,12 @@ ZSModelEx *ZSEngine::GetMesh(const char *pMeshName)
 
 int ZSEngine::GetMeshNum(const char *pMeshName)
 {
-	for(int n = 0; n < NumMesh; n++)
+	int n;
+
+	n = MeshRegistry.Find(pMeshName);
+	if(n != ASSET_NONE)
 	{
-		if(!strcmp(pMeshName, MeshList[n]->GetName()))
-		{
-			return n;
-		}
+		return n;
 	}
 
 	return 0;
@@ -247,17 +255,35 @@ int ZSEngine::GetMeshNum(const char *pMeshName)
 
 int ZSEngine::GetMeshNum(ZSModelEx *pMesh)
 {
-	for(int n = 0; n < NumMesh; n++)
+	int n;
+
+	n = MeshRegistry.Find(pMesh);
+	if(n != ASSET_NONE)
 	{
-		if(MeshList[n] == pMesh)
-		{
-			return n;
-		}
+		return n;
 	}
 
 	return 0;
 }
 
+void ZSEngine::IndexMeshes()
+{
+	int n;
+
+	MeshRegistry.Reset(NumMesh);
+	for(n = 0; n < NumMesh; n++)
+	{
+		if(MeshList[n])
+		{
+			MeshRegistry.Add(MeshList[n]->GetName(), MeshList[n]);
+		}
+		else
+		{
+			MeshRegistry.Add(NULL, NULL);
+		}
+	}
+}
+
 
 void ZSEngine::LoadMeshes()
 {
@@ -282,6 +308,12 @@ void ZSEngine::LoadMeshes()
 		}
 	}
 
+	if(pMeshArchive)
+	{
+		delete pMeshArchive;
+		pMeshArchive = NULL;
+	}
+
 	char meshdir[256];
 
 
@@ -394,6 +426,8 @@ void ZSEngine::LoadMeshes()
 
 	//return to the main directory
 	SetCurrentDirectory(RootDirectory);
+	IndexMeshes();
+
 	return;
 }
 
@@ -420,6 +454,54 @@ void ZSEngine::LoadMeshes(const char *FileName)
 	fclose(fp);
 
 	DEBUG_INFO("Done Loading Meshes\n\n");
+
+	IndexMeshes();
+}
+
+BOOL ZSEngine::LoadMeshArchive(const char *FileName, const char *BinName)
+{
+	int n;
+
+	for(n = 0; n < MAX_MESH; n++)
+	{
+		if(MeshList[n])
+		{
+			delete MeshList[n];
+			MeshList[n] = NULL;
+		}
+	}
+	NumMesh = 0;
+
+	if(pMeshArchive)
+	{
+		delete pMeshArchive;
+		pMeshArchive = NULL;
+	}
+
+	pMeshArchive = new MeshArchive;
+	if(!pMeshArchive->Open(FileName, BinName) || pMeshArchive->GetNumMesh() > MAX_MESH)
+	{
+		delete pMeshArchive;
+		pMeshArchive = NULL;
+		IndexMeshes();
+		return FALSE;
+	}
+
+	DEBUG_INFO("Loading meshes from: ");
+	DEBUG_INFO(FileName);
+	DEBUG_INFO("\n\n");
+
+	NumMesh = pMeshArchive->GetNumMesh();
+	for(n = 0; n < NumMesh; n++)
+	{
+		MeshList[n] = pMeshArchive->CreateMesh(n);
+	}
+
+	DEBUG_INFO("Done Loading Meshes\n\n");
+
+	IndexMeshes();
+
+	return TRUE;
 }
 
 void ZSEngine::SaveMeshes(const char *FileName)
@@ -452,17 +534,12 @@ void ZSEngine::SaveMeshes(const char *FileName)
 
 ZSTexture *ZSEngine::GetTexture(const char *pTextureName)
 {
-	char blarg[32];
-
-	strcpy(blarg,pTextureName);
-	strcat(blarg,".bmp");
+	int n;
 
-	for(int n = 0; n < NumTextures; n++)
+	n = TextureRegistry.Find(pTextureName);
+	if(n != ASSET_NONE)
 	{
-		if(!strcmp(blarg,TextureList[n].GetName()))
-		{
-			return &TextureList[n];
-		}
+		return &TextureList[n];
 	}
 //	DEBUG_INFO("Failed to find texture named: ");
 //	DEBUG_INFO(pTextureName);
@@ -473,17 +550,12 @@ ZSTexture *ZSEngine::GetTexture(const char *pTextureName)
 
 int ZSEngine::GetTextureNum(const char *pTextureName)
 {
-	char blarg[32];
-
-	strcpy(blarg,pTextureName);
-	strcat(blarg,".bmp");
+	int n;
 
-	for(int n = 0; n < NumTextures; n++)
+	n = TextureRegistry.Find(pTextureName);
+	if(n != ASSET_NONE)
 	{
-		if(!strcmp(blarg,TextureList[n].GetName()))
-		{
-			return n;
-		}
+		return n;
 	}
 
 	return 0;
@@ -491,15 +563,47 @@ int ZSEngine::GetTextureNum(const char *pTextureName)
 
 int ZSEngine::GetTextureNum(ZSTexture *pTexture)
 {
-	for(int n = 0; n < NumTextures; n++)
+	int n;
+
+	n = TextureRegistry.Find(pTexture);
+	if(n != ASSET_NONE)
+	{
+		return n;
+	}
+
+	return 0;
+}
+
+void ZSEngine::IndexTextures()
+{
+	char Stem[TEXTURE_NAME_LENGTH];
+	int Length;
+	int n;
+
+	//looked up without the .bmp every texture file name ends in, the
+	//name of one that doesn't can't be found
+	TextureRegistry.Reset(NumTextures);
+	for(n = 0; n < NumTextures; n++)
 	{
-		if(&TextureList[n] == pTexture)
+		Length = strlen(TextureList[n].GetName()) - 4;
+		if(Length > 0 && Length < TEXTURE_NAME_LENGTH && !strcmp(TextureList[n].GetName() + Length, ".bmp"))
+		{
+			memcpy(Stem, TextureList[n].GetName(), Length);
+			Stem[Length] = '\0';
+			TextureRegistry.Add(Stem, &TextureList[n]);
+		}
+		else
 		{
-			return n;
+			TextureRegistry.Add(NULL, &TextureList[n]);
 		}
 	}
+}
 
-	return 0;
+void ZSEngine::OutputAssetStats(FILE *fp)
+{
+	MeshRegistry.OutputStats(fp);
+	TextureRegistry.OutputStats(fp);
+	ZSSound.OutputStats(fp);
 }
 
 
@@ -563,6 +667,8 @@ void ZSEngine::LoadTextures()
 
 //	DEBUG_INFO("Done Loading Textures\n\n");
 
+	IndexTextures();
+
 	return;
 }
 
@@ -679,6 +785,8 @@ void ZSEngine::ImportMeshes()
 
 	//return to the main directory
 	SetCurrentDirectory(RootDirectory);
+	IndexMeshes();
+
 	return;
 }
 
@@ -718,6 +826,8 @@ void ZSEngine::DeleteMesh(int Num)
 	//return to the main directory
 	SetCurrentDirectory(RootDirectory);
 
+	IndexMeshes();
+
 	return;
 }
 
@@ -809,6 +919,8 @@ void ZSEngine::Import(int Num)
 	//return to the main directory
 	SetCurrentDirectory(RootDirectory);
 
+	IndexMeshes();
+
 	return;
 }
 
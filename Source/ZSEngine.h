@@ -25,9 +25,12 @@
 #include <stdio.h>
 #include "ZSsound.h"		//sound system
 #include "ZSModelEX.h"	//3d meshes
+#include "assetregistry.h"	//name lookups
 
 #define MAX_MESH	768
 
+class MeshArchive;
+
 class ZSEngine
 {
 private:
@@ -42,12 +45,21 @@ private:
 	//3d meshes
 	int NumMesh;
 	ZSModelEx *MeshList[MAX_MESH];
+	//what the meshes' arrays point into when they came from an archive
+	MeshArchive *pMeshArchive;
 
 
 	//Textures
 	int NumTextures;
 	ZSTexture *TextureList;
 
+	//handles are places in MeshList and TextureList, indexed again
+	//whenever either list changes
+	AssetRegistry MeshRegistry;
+	AssetRegistry TextureRegistry;
+	void IndexMeshes();
+	void IndexTextures();
+
 public:
 #ifdef USE_SDL
 	int Init();
@@ -61,13 +73,16 @@ public:
 	ZSModelEx *GetMesh(const char *pMeshName);
 	int GetMeshNum(const char *pMeshName);
 	int GetMeshNum(ZSModelEx *pMesh);
-	void SetMesh(int Num, ZSModelEx *pNewMesh) { MeshList[Num] = pNewMesh; };
+	void SetMesh(int Num, ZSModelEx *pNewMesh) { MeshList[Num] = pNewMesh; IndexMeshes(); };
 	void DeleteMesh(int Num);
 	inline int GetNumMesh() { return NumMesh; }	
 	
 	void LoadMeshes();
 	void LoadMeshes(const char *FileName);
 	void SaveMeshes(const char *FileName);
+	//every mesh straight from a mesh archive, FALSE if it is missing
+	//or older than BinName, leaving no meshes loaded
+	BOOL LoadMeshArchive(const char *FileName, const char *BinName);
 	void ImportMeshes();
 	void Import(int Num);
 
@@ -75,6 +90,9 @@ public:
 	int GetTextureNum(const char *pTextureName);
 	int GetTextureNum(ZSTexture *pTexture);
 	inline int GetNumTextures() { return NumTextures; }
+
+	//lookup counts for meshes, textures and sound effects
+	void OutputAssetStats(FILE *fp);
 	
 
 	ZSTexture *GetTexture(const char *pTextureName);
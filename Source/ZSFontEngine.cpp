@@ -116,7 +116,7 @@ try
 
 	     // Read text metrics:
         ReadFile(f, &TextMetrics, sizeof(TextMetrics), &BytesRead, NULL);
-        ReadFile(f, (LPVOID)((DWORD)ABCWidths+32*sizeof(ABC)),
+        ReadFile(f, (LPVOID)&ABCWidths[32],
             224*sizeof(ABC), &BytesRead, NULL);
         if (!ReadFile(f, &LogFont, sizeof(LogFont), &BytesRead, NULL))
             throw (int)4;
@@ -229,6 +229,7 @@ void ZSFont::SetTextColor(DWORD textcolor)
     DWORD *palentry = (DWORD*)&lpbi->bmiColors[1];
     *palentry = TextColor;
 
+#ifndef HEADLESS
     HDC SurfDC;
     if (!FAILED(lpFontSurf[0]->GetDC(&SurfDC)))
     {    StretchDIBits(SurfDC,
@@ -240,6 +241,7 @@ void ZSFont::SetTextColor(DWORD textcolor)
             SRCCOPY);
         lpFontSurf[0]->ReleaseDC(SurfDC);
     }
+#endif
 }
 //---------------------------------------------------------------------------
 
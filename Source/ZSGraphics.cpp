@@ -7,6 +7,11 @@
 #include <SDL_syswm.h>
 #endif
 
+#ifdef HEADLESS
+//there is no desktop, the screen is the size gui.ini asks for
+#define GetSystemMetrics(Index)	((Index) == SM_CXSCREEN ? ScreenWidth : ScreenHeight)
+#endif
+
 #define WINDOW_CLASS_NAME	"ZeroSumMainWindow"
 #define WINDOW_TITLE			"ZSMain"
 
@@ -98,19 +103,19 @@ void D3DMatrixRotationAxis(D3DMATRIX* mat, D3DVECTOR* axis, float angle)
 
 void D3DMatrixRotationX(D3DMATRIX* mat, float angle)
 {
-	D3DVECTOR vec = { 1.0f, 0.0f, 0.0f };
+	D3DVECTOR vec(1.0f, 0.0f, 0.0f);
 	D3DMatrixRotationAxis(mat, &vec, angle);
 }
 
 void D3DMatrixRotationY(D3DMATRIX* mat, float angle)
 {
-	D3DVECTOR vec = { 0.0f, 1.0f, 0.0f };
+	D3DVECTOR vec(0.0f, 1.0f, 0.0f);
 	D3DMatrixRotationAxis(mat, &vec, angle);
 }
 
 void D3DMatrixRotationZ(D3DMATRIX* mat, float angle)
 {
-	D3DVECTOR vec = { 0.0f, 0.0f, 1.0f };
+	D3DVECTOR vec(0.0f, 0.0f, 1.0f);
 	D3DMatrixRotationAxis(mat, &vec, angle);
 }
 
@@ -436,6 +441,7 @@ LPDIRECTDRAWSURFACE7 ZSGraphicsSystem::CreateSurface(int width, int height, int
 
 BOOL ZSGraphicsSystem::LoadFileIntoSurface(LPDIRECTDRAWSURFACE7 lpddInto, char *filename, int width, int height)
 {
+#ifndef HEADLESS
 	HBITMAP hBM;  
 	BITMAP BM;  
 	HDC hDCImage, hDC;  
@@ -469,6 +475,7 @@ BOOL ZSGraphicsSystem::LoadFileIntoSurface(LPDIRECTDRAWSURFACE7 lpddInto, char *
 	
 	DeleteDC( hDCImage );  
 	DeleteObject( hBM );
+#endif
 
 	// Return the surface
 	return TRUE;
@@ -511,6 +518,7 @@ LPDIRECTDRAWSURFACE7 ZSGraphicsSystem::CreateSurfaceFromFile(char *filename, int
 		return NULL;
 	};
 
+#ifndef HEADLESS
 	HBITMAP hBM;  
 	BITMAP BM;  
 	HDC hDCImage, hDC;  
@@ -544,6 +552,7 @@ LPDIRECTDRAWSURFACE7 ZSGraphicsSystem::CreateSurfaceFromFile(char *filename, int
 	
 	DeleteDC( hDCImage );  
 	DeleteObject( hBM );
+#endif
 
 	WORD Mask;
 	WORD* SurfPtr;  
@@ -694,6 +703,8 @@ void ZSGraphicsSystem::DrawBox(LPDIRECTDRAWSURFACE7 Target, LPRECT rBox, DWORD C
 
 void ZSGraphicsSystem::Flip()
 {
+	//headless builds have nothing to show
+#ifndef HEADLESS
 	// Flip pages
 	if (!Windowed) 
 	{
@@ -717,6 +728,7 @@ void ZSGraphicsSystem::Flip()
 			SafeExit("Blit failed");
 		};
 	};
+#endif
 }
 
 void ZSGraphicsSystem::TextureBlt(LPRECT rArea, ZSTexture *source, float x, float y, float w, float h)
@@ -894,6 +906,8 @@ HWND ZSGraphicsSystem::Init(HINSTANCE hInstance)
 #ifdef USE_SDL
 	SDL_SysWMinfo info;
 	int window_flags = 0;
+#elif defined(HEADLESS)
+	Application = hInstance;
 #else
 	WNDCLASS winclass;	// this will hold the class we create
 	// first fill in the window class stucture
@@ -939,7 +953,9 @@ HWND ZSGraphicsSystem::Init(HINSTANCE hInstance)
 	
 	DEBUG_INFO("Creating Windows interface Window\n");
 
-#ifndef USE_SDL
+#if defined(HEADLESS)
+	MainWindow = NULL;
+#elif !defined(USE_SDL)
 	MainWindow = CreateWindowEx(0,
 			WINDOW_CLASS_NAME,
 			WINDOW_TITLE,
@@ -974,7 +990,9 @@ HWND ZSGraphicsSystem::Init(HINSTANCE hInstance)
 #endif
 	DEBUG_INFO("Windows interface window created\n\n");
 
+#ifndef HEADLESS
 	ShowWindow(MainWindow, SW_SHOW);
+#endif
 	
 	DEBUG_INFO("Initializing D3DX\n");
 	D3DXInitialize();
@@ -1497,7 +1515,7 @@ int ZSGraphicsSystem::ShutDown()
 #ifdef USE_SDL
 	SDL_DestroyWindow(window);
 	SDL_Quit();
-#else
+#elif !defined(HEADLESS)
 	if(MainWindow)
 	DestroyWindow(MainWindow);
 #endif
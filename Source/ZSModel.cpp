@@ -20,10 +20,12 @@
 #include "ZSModel.h"
 #include "zsutilities.h" //for input helpers
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <fstream>
 #include "zsengine.h"
+#include "heightfield.h"
 
 //#define TLISTPRINT
 
@@ -400,6 +402,8 @@ bool ZSModel::Load(FILE *fp)
 	stridedDataInfo.normal.lpvData = stridedNormals;
 	stridedDataInfo.textureCoords[0].lpvData = stridedUV;
 
+	BuildBVH();
+
 	//after this step we should be done.
 	return 1;
 
@@ -562,6 +566,18 @@ void ZSModel::Clear()
 	//However, for debugger visibility and for porting to C we wish to keep them
 	// in for now.
 
+	ClearBVH();
+
+	if (mapped)
+	{
+		//the archive's, not ours
+		trianglelist = NULL;
+		stridedVertexArray = NULL;
+		stridedUV = NULL;
+		stridedNormals = NULL;
+		mapped = false;
+	}
+
 	//delete the equipment rays
 	if (equipmentlist != NULL)
 	{
@@ -610,6 +626,243 @@ void ZSModel::Clear()
 }
 
 
+//************BOUNDING VOLUME TREE****************************************
+
+//makes a node for bvhtriangles[first] to bvhtriangles[first + count - 1], splitting
+// them at the middle of their centers along the widest axis.  Returns the node's index.
+static int BuildBVHNode(BVHNode *nodes, int *numnodes, int *triangles, float *centers, 
+						int first, int count, int depth)
+{
+	int node = (*numnodes)++;
+	float low[3];
+	float high[3];
+	float split;
+	int axis;
+	int mid;
+	int temp;
+	int i, j;
+
+	nodes[node].first = first;
+	nodes[node].count = count;
+	nodes[node].right = 0;
+
+	if (count <= BVH_LEAF_SIZE || depth >= BVH_MAX_DEPTH - 1)
+		return node;
+
+	for (j = 0 ; j < 3 ; j++)
+	{
+		low[j] = centers[triangles[first] * 3 + j];
+		high[j] = low[j];
+	}
+	for (i = first + 1 ; i < first + count ; i++)
+	{
+		for (j = 0 ; j < 3 ; j++)
+		{
+			if (centers[triangles[i] * 3 + j] < low[j])
+				low[j] = centers[triangles[i] * 3 + j];
+			if (centers[triangles[i] * 3 + j] > high[j])
+				high[j] = centers[triangles[i] * 3 + j];
+		}
+	}
+
+	axis = 0;
+	if (high[1] - low[1] > high[axis] - low[axis])
+		axis = 1;
+	if (high[2] - low[2] > high[axis] - low[axis])
+		axis = 2;
+	split = (low[axis] + high[axis]) * 0.5f;
+
+	//triangles centered below the split go first
+	i = first;
+	j = first + count - 1;
+	while (i <= j)
+	{
+		if (centers[triangles[i] * 3 + axis] < split)
+		{
+			i++;
+		}
+		else
+		{
+			temp = triangles[i];
+			triangles[i] = triangles[j];
+			triangles[j] = temp;
+			j--;
+		}
+	}
+	mid = i - first;
+
+	//everything on one side, just halve them
+	if (mid == 0 || mid == count)
+		mid = count / 2;
+
+	nodes[node].count = 0;
+	BuildBVHNode(nodes, numnodes, triangles, centers, first, mid, depth + 1);
+	nodes[node].right = BuildBVHNode(nodes, numnodes, triangles, centers, first + mid, count - mid, depth + 1);
+
+	return node;
+}
+
+//fills in every node's box for one frame.  Children come after their parents,
+// so going backwards finds them done.
+static void RefitBVH(BVHNode *nodes, int numnodes, int *triangles, unsigned short *trianglelist, 
+					 float *vertices, float *bounds)
+{
+	float *box;
+	float *left;
+	float *right;
+	float *vertex;
+	float pad;
+	int n, i, j, k;
+
+	for (n = numnodes - 1 ; n >= 0 ; n--)
+	{
+		box = &bounds[n * 6];
+		if (nodes[n].count)
+		{
+			for (j = 0 ; j < 3 ; j++)
+			{
+				box[j] = FLT_MAX;
+				box[j + 3] = -FLT_MAX;
+			}
+			for (i = nodes[n].first ; i < nodes[n].first + nodes[n].count ; i++)
+			{
+				for (k = 0 ; k < 3 ; k++)
+				{
+					vertex = &vertices[trianglelist[triangles[i] * 3 + k] * 3];
+					for (j = 0 ; j < 3 ; j++)
+					{
+						if (vertex[j] < box[j])
+							box[j] = vertex[j];
+						if (vertex[j] > box[j + 3])
+							box[j + 3] = vertex[j];
+					}
+				}
+			}
+
+			pad = box[3] - box[0];
+			if (box[4] - box[1] > pad)
+				pad = box[4] - box[1];
+			if (box[5] - box[2] > pad)
+				pad = box[5] - box[2];
+			pad = pad * BVH_PAD + BVH_MIN_PAD;
+			for (j = 0 ; j < 3 ; j++)
+			{
+				box[j] -= pad;
+				box[j + 3] += pad;
+			}
+		}
+		else
+		{
+			left = &bounds[(n + 1) * 6];
+			right = &bounds[nodes[n].right * 6];
+			for (j = 0 ; j < 3 ; j++)
+			{
+				box[j] = (left[j] < right[j]) ? left[j] : right[j];
+				box[j + 3] = (left[j + 3] > right[j + 3]) ? left[j + 3] : right[j + 3];
+			}
+		}
+	}
+}
+
+void ZSModel::BuildBVH()
+{
+	float *centers;
+	float *vertices;
+	float *box;
+	float reach;
+	float farthest;
+	int n, fn, j;
+
+	ClearBVH();
+
+	if (!numtriangles || !numframes || !trianglelist || !stridedVertexArray)
+		return;
+
+	//split on where the triangles sit in the first frame, every frame shares the tree
+	centers = new float[numtriangles * 3];
+	vertices = stridedVertexArray[0];
+	for (n = 0 ; n < numtriangles ; n++)
+	{
+		for (j = 0 ; j < 3 ; j++)
+		{
+			centers[n * 3 + j] = (vertices[trianglelist[n * 3] * 3 + j] + 
+								  vertices[trianglelist[n * 3 + 1] * 3 + j] + 
+								  vertices[trianglelist[n * 3 + 2] * 3 + j]) / 3.0f;
+		}
+	}
+
+	bvhtriangles = new int[numtriangles];
+	for (n = 0 ; n < numtriangles ; n++)
+		bvhtriangles[n] = n;
+
+	//a leaf has at least one triangle, so this many is always enough
+	bvhnodes = new BVHNode[numtriangles * 2];
+	numbvhnodes = 0;
+	BuildBVHNode(bvhnodes, &numbvhnodes, bvhtriangles, centers, 0, numtriangles, 0);
+
+	delete[] centers;
+
+	bvhbounds = new float*[numframes];
+	boundingradius = 0.0f;
+	for (fn = 0 ; fn < numframes ; fn++)
+	{
+		bvhbounds[fn] = new float[numbvhnodes * 6];
+		RefitBVH(bvhnodes, numbvhnodes, bvhtriangles, trianglelist, stridedVertexArray[fn], bvhbounds[fn]);
+
+		//farthest corner of the root box
+		box = bvhbounds[fn];
+		reach = 0.0f;
+		for (j = 0 ; j < 3 ; j++)
+		{
+			farthest = (float)fabs(box[j]);
+			if ((float)fabs(box[j + 3]) > farthest)
+				farthest = (float)fabs(box[j + 3]);
+			reach += farthest * farthest;
+		}
+		reach = (float)sqrt(reach);
+		if (reach > boundingradius)
+			boundingradius = reach;
+	}
+}
+
+void ZSModel::ClearBVH()
+{
+	if (bvhmapped)
+	{
+		bvhbounds = NULL;
+		bvhnodes = NULL;
+		bvhtriangles = NULL;
+		bvhmapped = false;
+	}
+
+	if (bvhbounds)
+	{
+		for (int i = 0 ; i < numframes ; i++)
+		{
+			if (bvhbounds[i])
+				delete[] bvhbounds[i];
+		}
+		delete[] bvhbounds;
+	}
+
+	if (bvhnodes)
+		delete[] bvhnodes;
+
+	if (bvhtriangles)
+		delete[] bvhtriangles;
+
+	if (heights)
+		delete heights;
+
+	bvhnodes = NULL;
+	numbvhnodes = 0;
+	bvhtriangles = NULL;
+	bvhbounds = NULL;
+	boundingradius = 0.0f;
+	heights = NULL;
+}
+
+
 
 
 
@@ -630,6 +883,15 @@ ZSModel::ZSModel()
 	stridedUV		= NULL;
 	stridedNormals = NULL;
 
+	bvhnodes = NULL;
+	numbvhnodes = 0;
+	bvhtriangles = NULL;
+	bvhbounds = NULL;
+	boundingradius = 0.0f;
+	heights = NULL;
+	mapped = false;
+	bvhmapped = false;
+
 	ZeroMemory(&stridedDataInfo, sizeof(D3DDRAWPRIMITIVESTRIDEDDATA));
 
 	//set the strides.  
@@ -1271,6 +1533,7 @@ ZSModel::Import(const char *filename)
 	stridedDataInfo.normal.lpvData = stridedNormals;
 	stridedDataInfo.textureCoords[0].lpvData = stridedUV;
 
+	BuildBVH();
 
 	return 1;
 }
@@ -48,6 +48,19 @@ using namespace std;
 #define MAX_EQUIPMENT_POSITIONS	10
 #define MAX_MODEL_FILENAME			32
 
+//triangles at most in a leaf of the bounding volume tree
+#define BVH_LEAF_SIZE				8
+//nodes this deep are leaves whatever they hold, so a traversal stack of
+//this size can't overflow
+#define BVH_MAX_DEPTH				32
+//leaf boxes grow by this much of their largest side.  Triangle3DIntersect
+//takes points a little outside a triangle as hits, a tighter box would
+//miss them
+#define BVH_PAD						0.01f
+#define BVH_MIN_PAD					0.001f
+
+
+class HeightField;
 
 //------------------------Local Data Structures-----------------------------------------
 //**************************************************************************************
@@ -110,6 +123,16 @@ struct ZSModelFileInfoHeader
 //*************************************************************************************
 
 
+//a node of the bounding volume tree.  An interior node's left child is the next
+//node and its right child is at right, so every child comes after its parent
+struct BVHNode
+{
+	int first;		//leaves, first entry in bvhtriangles
+	int count;		//leaves, number of triangles, 0 for an interior node
+	int right;		//interior nodes, index of the right child
+};
+
+
 //enumeration for equipment positions. We use the enumeration to access the multidimensional
 //    array in the ZSModel class directly. See below.
 typedef enum { 
@@ -183,6 +206,15 @@ public:
 	D3DDRAWPRIMITIVESTRIDEDDATA stridedDataInfo;
 									//nasty struct needed to use strided vertices.
 									//embedded here for efficiency. (we don't want to push more on the stack than necessary).
+
+	BVHNode* bvhnodes;				//bounding volume tree over the triangles, built from frame 0's layout
+	int		numbvhnodes;
+	int*	bvhtriangles;			//triangle numbers in leaf order
+	float**	bvhbounds;				//per frame, six floats a node.  min x y z, max x y z
+	float	boundingradius;			//furthest any frame's boxes reach from the model's origin
+	HeightField* heights;			//frame 0 seen from above, baked by the first ZSModelEx::GetZ
+	bool	mapped;					//the arrays belong to a MeshArchive, Clear lets go of them without deleting
+	bool	bvhmapped;				//the same for the tree, until BuildBVH makes one of its own
 	//----------------------------------------
 	//**
 	//******************************************************************************
@@ -220,6 +252,15 @@ public:
 	void Clear();
 	//deletes all internal data and sets members to their initial values.
 
+	void BuildBVH();
+	//builds the bounding volume tree used by ray tests.  Load and Import call it,
+	// anything else that moves vertices must call it again.
+
+	void ClearBVH();
+	//also drops the baked heights, they are stale for the same reasons
+
+	float GetBoundingRadius() { return boundingradius; }
+
 	bool DrawAsEquipment(LPDIRECT3DDEVICE7 D3DDevice, float scale, ZSModel* target, 
 					     float rotation, int frame, int targetFrame, 
 					     EQUIP_POSITION equip_position, float offset,
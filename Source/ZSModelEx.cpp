@@ -3,12 +3,9 @@
 #include "zsengine.h"
 #include "zsgraphics.h"
 #include "zsutilities.h"
+#include "heightfield.h"
+#include <float.h>
 
-#ifndef NDEBUG
-extern float HeightLevels[1600][1600];
-#else
-static float HeightLevels[1][1];
-#endif
 
 void ZSModelEx::LoadEx(const char *filename)
 {
@@ -192,6 +189,7 @@ void ZSModelEx::Scale(float xfactor, float yfactor, float zfactor)
 		stridedVertexArray[fn][n+2] = ((stridedVertexArray[fn][n+2] - cz)	* zfactor) + cz;
 	}
 	GetBounds();
+	BuildBVH();
 }
 
 void ZSModelEx::Move(float xfactor, float yfactor, float zfactor)
@@ -214,6 +212,7 @@ void ZSModelEx::Move(float xfactor, float yfactor, float zfactor)
 	leftbound += xfactor;
 	rightbound += xfactor;
 
+	BuildBVH();
 }
 
 
@@ -663,6 +662,7 @@ void ZSModelEx::Rotate(float yaw, float pitch, float roll)
 		
 		}
 	}
+	BuildBVH();
 }
 
 void ZSModelEx::FixNormals()
@@ -697,68 +697,141 @@ void ZSModelEx::FixNormals()
 	return;
 }
 
-//assumes that the ray has already been transformed into model coordinates
-BOOL ZSModelEx::Intersect(int Frame, D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
+//the infinite line through vStart along vRay against a box, Triangle3DIntersect
+//doesn't stop at the ends of its ray either
+static BOOL LineHitsBox(float *box, float *start, float *ray)
 {
-	D3DVERTEX vA,vB,vC;
+	float Near = -FLT_MAX;
+	float Far = FLT_MAX;
+	float In;
+	float Out;
+	float Temp;
 	int n;
-	int TriangleOffset = 0;
-	for(n = 0; n < numtriangles; n ++)
-	{
-		//convert from the strided format to normal vertices
-		vA.x = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3];
-		vA.y = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3+1];
-		vA.z = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3+2];
-		
-		vB.x = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3];
-		vB.y = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3+1];
-		vB.z = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3+2];
-		
-		vC.x = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3];
-		vC.y = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3+1];
-		vC.z = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3+2];
 
-		//check for intersection
-		if(Triangle3DIntersect(vRayStart,vRayEnd,&vA,&vB,&vC))
+	for(n = 0; n < 3; n++)
+	{
+		if(ray[n] == 0.0f)
 		{
-			return TRUE;
+			if(start[n] < box[n] || start[n] > box[n + 3])
+			{
+				return FALSE;
+			}
+			continue;
+		}
+		In = (box[n] - start[n]) / ray[n];
+		Out = (box[n + 3] - start[n]) / ray[n];
+		if(In > Out)
+		{
+			Temp = In;
+			In = Out;
+			Out = Temp;
+		}
+		if(In > Near) Near = In;
+		if(Out < Far) Far = Out;
+		if(Near > Far)
+		{
+			return FALSE;
 		}
-		TriangleOffset += 3;
 	}
-	return FALSE;
+	return TRUE;
 }
 
-//assumes that the line has already been transformed into model coordinates
-BOOL ZSModelEx::LineIntersect(int Frame, D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
+//assumes that the ray has already been transformed into model coordinates
+BOOL ZSModelEx::Intersect(int Frame, D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 {
 	D3DVERTEX vA,vB,vC;
+	float *Vertices;
+	float *Bounds;
+	unsigned short *Triangle;
+	float Start[3];
+	float Ray[3];
+	int Stack[BVH_MAX_DEPTH];
+	int StackSize;
+	int Node;
 	int n;
-	int TriangleOffset = 0;
-	for(n = 0; n < numtriangles; n ++)
+
+	if(!bvhnodes)
 	{
-		//convert from the strided format to normal vertices
-		vA.x = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3];
-		vA.y = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3+1];
-		vA.z = stridedVertexArray[Frame][trianglelist[TriangleOffset]*3+2];
-		
-		vB.x = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3];
-		vB.y = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3+1];
-		vB.z = stridedVertexArray[Frame][trianglelist[TriangleOffset + 1]*3+2];
-		
-		vC.x = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3];
-		vC.y = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3+1];
-		vC.z = stridedVertexArray[Frame][trianglelist[TriangleOffset + 2]*3+2];
+		return FALSE;
+	}
+
+	Vertices = stridedVertexArray[Frame];
+	Bounds = bvhbounds[Frame];
+
+	Start[0] = vRayStart->x;
+	Start[1] = vRayStart->y;
+	Start[2] = vRayStart->z;
+	Ray[0] = vRayEnd->x - vRayStart->x;
+	Ray[1] = vRayEnd->y - vRayStart->y;
+	Ray[2] = vRayEnd->z - vRayStart->z;
 
-		//check for intersection
-		if(Triangle3DIntersect(vRayStart,vRayEnd,&vA,&vB,&vC))
+	Stack[0] = 0;
+	StackSize = 1;
+	while(StackSize)
+	{
+		Node = Stack[--StackSize];
+		if(!LineHitsBox(&Bounds[Node * 6], Start, Ray))
 		{
-			return TRUE;
+			continue;
+		}
+
+		if(!bvhnodes[Node].count)
+		{
+			Stack[StackSize++] = bvhnodes[Node].right;
+			Stack[StackSize++] = Node + 1;
+			continue;
+		}
+
+		for(n = bvhnodes[Node].first; n < bvhnodes[Node].first + bvhnodes[Node].count; n++)
+		{
+			//convert from the strided format to normal vertices
+			Triangle = &trianglelist[bvhtriangles[n] * 3];
+			vA.x = Vertices[Triangle[0]*3];
+			vA.y = Vertices[Triangle[0]*3+1];
+			vA.z = Vertices[Triangle[0]*3+2];
+
+			vB.x = Vertices[Triangle[1]*3];
+			vB.y = Vertices[Triangle[1]*3+1];
+			vB.z = Vertices[Triangle[1]*3+2];
+
+			vC.x = Vertices[Triangle[2]*3];
+			vC.y = Vertices[Triangle[2]*3+1];
+			vC.z = Vertices[Triangle[2]*3+2];
+
+			//check for intersection
+			if(Triangle3DIntersect(vRayStart,vRayEnd,&vA,&vB,&vC))
+			{
+				return TRUE;
+			}
 		}
-		TriangleOffset += 3;
 	}
 	return FALSE;
 }
 
+//assumes that the line has already been transformed into model coordinates
+BOOL ZSModelEx::LineIntersect(int Frame, D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
+{
+	return Intersect(Frame, vRayStart, vRayEnd);
+}
+
+//world space, for a model drawn at vOrigin and scaled by Scale.  Passes anything
+//that might hit the model's boxes in any frame.
+BOOL ZSModelEx::NearRay(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd, D3DVECTOR *vOrigin, float Scale)
+{
+	D3DVECTOR vRay;
+	D3DVECTOR vToOrigin;
+	D3DVECTOR vCross;
+	float Radius;
+
+	vRay = *vRayEnd - *vRayStart;
+	vToOrigin = *vOrigin - *vRayStart;
+	vCross = CrossProduct(vToOrigin, vRay);
+	Radius = boundingradius * Scale;
+
+	//distance from the line squared, times the ray's length squared
+	return DotProduct(vCross, vCross) <= Radius * Radius * DotProduct(vRay, vRay);
+}
+
 void ZSModelEx::Sharpen()
 {
 	D3DVECTOR vNorm;
@@ -845,152 +918,36 @@ void ZSModelEx::SmoothNormals()
 
 //assumes normals are set up properly.
 
+//heights are in model coordinates, off the mesh they are its nearest edge
 float ZSModelEx::GetZ(float x, float y)
 {
-	float zVal = 0.0f;
-	float xn;
-	float yn;
-	float foffset;
-	float fleft, fright, ftop, fbottom;
-	int xh;
-	int yh;
-	RECT rTriangle;
-	foffset = 1.0f / 1600.0f;
-
-	D3DVECTOR vPoint;
-	vPoint = _D3DVECTOR(x,y,0.0f);
-
-	D3DVERTEX vxA,vxB,vxC;
-	int n;
-	for(xh  = 0; xh < 1600; xh++)
-	for(yh = 0; yh < 1600; yh++)
-	{
-		HeightLevels[xh][yh] = 0.0f;
-	}
-		
-	int TriangleOffset = 0;
-	float a,b,c,d;
-	D3DVECTOR vA, vB, vC, vNorm, vSideOne, vSideTwo;
-	
-	for(n = 0; n < numtriangles; n++)
-	{
-		//convert from the strided format to normal vertices
-		vA.x = vxA.x = stridedVertexArray[0][trianglelist[TriangleOffset]*3];
-		vA.y = vxA.y = stridedVertexArray[0][trianglelist[TriangleOffset]*3+1];
-		vA.z = vxA.z = stridedVertexArray[0][trianglelist[TriangleOffset]*3+2];
-		
-		vB.x = vxB.x = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3];
-		vB.y = vxB.y = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3+1];
-		vB.z = vxB.z = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3+2];
-		
-		vC.x = vxC.x = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3];
-		vC.y = vxC.y = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3+1];
-		vC.z = vxC.z = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3+2];
+	float Left, Right, Top, Bottom, Front, Back;
+	float Step;
 
-		vSideOne = Normalize(vB - vA);
-		vSideTwo = Normalize(vC - vA);
-
-		vNorm = CrossProduct(vSideOne,vSideTwo);
-
-		a = vNorm.x;
-		b = vNorm.y;
-		c = vNorm.z;
-
-		fleft = fright = vxA.x;
-		if(fleft > vxB.x) fleft = vxB.x;
-		if(fleft > vxC.x) fleft = vxC.x;
-		if(fright < vxB.x) fright = vxB.x;
-		if(fright < vxC.x) fright = vxC.x;
-
-		ftop = fbottom = vxA.y;
-		if(ftop > vxB.y) ftop = vxB.y;
-		if(ftop > vxC.y) ftop = vxC.y;
-		if(fbottom < vxB.y) fbottom = vxB.y;
-		if(fbottom < vxC.y) fbottom = vxC.y;
-
-		rTriangle.left   = (int)(fleft / foffset);
-		rTriangle.right  = (int)(fright / foffset);
-		rTriangle.top	 = (int)(ftop / foffset);
-		rTriangle.bottom = (int)(fbottom / foffset);
-
-		for(yh = rTriangle.top; yh <= rTriangle.bottom; yh++)
-		for(xh = rTriangle.left; xh <= rTriangle.right; xh++)
+	if(!heights)
+	{
+		if(!stridedVertexArray)
 		{
-			xn = (float)xh * foffset;
-			yn = (float)yh * foffset;
+			return 0.0f;
+		}
 
-		//	vPoint.x = xn;
-		//	vPoint.y = yn;
-		
-			//if(Triangle2DIntersect(&vPoint,&vxA,&vxB,&vxC))
-			//{
-			d = -1 * (a * vA.x +
-					 b * vA.y +
-					 c * vA.z);
-
-			zVal = -1 * (a * xn + b * yn + d)/c;
-			HeightLevels[xh][yh] = zVal * 256.0f;
-			//}
+		GetBounds(&Left, &Right, &Top, &Bottom, &Front, &Back, 0);
+		Step = Right - Left;
+		if(Back - Front > Step)
+		{
+			Step = Back - Front;
 		}
-		TriangleOffset += 3;
-	}
-	
-/*	
-	
-	for(n = 0; n < numtriangles; n ++)
-	{
-		//convert from the strided format to normal vertices
-		vxA.x = stridedVertexArray[0][trianglelist[TriangleOffset]*3];
-		vxA.y = stridedVertexArray[0][trianglelist[TriangleOffset]*3+1];
-		
-		vxB.x = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3];
-		vxB.y = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3+1];
-		
-		vxC.x = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3];
-		vxC.y = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3+1];
-		
-		//check for intersection
-		if(Triangle2DIntersect(&vPoint,&vxA,&vxB,&vxC))
+		Step = Step / (float)(HEIGHTFIELD_MESH_SAMPLES - 1);
+		if(Step <= 0.0f)
 		{
-			D3DVECTOR vA;
-		//	D3DVECTOR vB;
-		//	D3DVECTOR vC;
-
-			vA.x = vxA.x;
-			vA.y = vxA.y;
-		
-		//	vB.x = vxB.x;
-		//	vB.y = vxB.y;
-
-		//	vC.x = vxC.x;
-		//	vC.y = vxC.y;
-
-			vA.z = stridedVertexArray[0][trianglelist[TriangleOffset]*3+2];
-		//	vB.z = stridedVertexArray[0][trianglelist[TriangleOffset + 1]*3+2];
-		//	vC.z = stridedVertexArray[0][trianglelist[TriangleOffset + 2]*3+2];
-
-			float a,b,c,d,zn;
-
-			a = stridedNormals[trianglelist[TriangleOffset]*3];
-			b = stridedNormals[trianglelist[TriangleOffset]*3+1];
-			c = stridedNormals[trianglelist[TriangleOffset]*3+2];
-		
-		//	a = vNorm.x;
-		//	b = vNorm.y;
-		//	c = vNorm.z;
-			d = -1 * (a * vA.x +
-						 b * vA.y +
-						 c * vA.z);
-
-			zVal = -1 * (a * x + b * y + d)/c;
-		
-			return zVal;
+			return Top;
 		}
-		TriangleOffset += 3;
+
+		heights = new HeightField;
+		heights->Bake(this, 0, Left, Front, Step,
+			(int)((Right - Left) / Step) + 1,
+			(int)((Back - Front) / Step) + 1);
 	}
 
-//	DEBUG_INFO("Failed to get z from mesh\n");
-*/
-	return 0.0f;
+	return heights->Sample(x, y);
 }
-
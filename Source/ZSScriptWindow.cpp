@@ -854,6 +854,49 @@ void ZSScriptWin::ExecuteGameCommand()
 		Valley->GenerateBase(&rArea);
 	}
 
+	if(CommandText[1] == 'r' &&
+		CommandText[2] == 'e' &&
+		CommandText[3] == 'b' &&
+		CommandText[4] == 'a')
+	{
+		RECT rArea;
+		char *pleft;
+		pleft = strchr(CommandText,' ');
+		pleft[0] = '\0';
+		pleft++;
+
+		char *ptop;
+		ptop = strchr(pleft,' ');
+		ptop[0] = '\0';
+		ptop++;
+
+		char *pright;
+		pright = strchr(ptop,' ');
+		pright[0] = '\0';
+		pright++;
+
+		char *pbottom;
+		pbottom = strchr(pright,' ');
+		pbottom[0] = '\0';
+		pbottom++;
+
+		rArea.left = atoi(pleft);
+		rArea.right = atoi(pright);
+		rArea.bottom = atoi(pbottom);
+		rArea.top = atoi(ptop);
+
+		//only the chunks under the rectangle
+		Valley->GenerateBase(NULL, &rArea);
+	}
+
+	if(CommandText[1] == 'b' &&
+		CommandText[2] == 'a' &&
+		CommandText[3] == 'k' &&
+		CommandText[4] == 'e')
+	{
+		Valley->CheckBase(NULL);
+	}
+
 	if(CommandText[1] == 't' &&
 		CommandText[2] == 'e' &&
 		CommandText[3] == 'r' &&
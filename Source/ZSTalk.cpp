@@ -169,6 +169,9 @@ ZSTalkWin::ZSTalkWin(int NewID, int x, int y, int Width, int Height, ScriptBlock
 	ScriptContextBlock = ContextBlock;
 	ScriptContextWindow = this;
 
+	//the words it offers are looked up in ContextBlock from here on
+	ContextBlock->CheckConversation();
+
 	return; 
 
 }
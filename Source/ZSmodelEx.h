@@ -82,6 +82,8 @@ public:
 
 	BOOL Intersect(int Frame, D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd);
 	BOOL LineIntersect(int Frame, D3DVECTOR *vLineStart, D3DVECTOR *vLineEnd);
+	//cheap test before moving a ray into model coordinates for Intersect
+	BOOL NearRay(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd, D3DVECTOR *vOrigin, float Scale);
 
 
 	float GetZ(float x, float y);
@@ -123,16 +123,14 @@ int ZSSoundSystem::PlayEffect(const char *EffectName)
 	
 	if(!NumFX) return FALSE;
 
-	for(n = 0; n < NumFX; n++)
+	n = Effects.Find(EffectName);
+	if(n != ASSET_NONE)
 	{
-		if(!strcmp(FX[n].GetName(),EffectName))
-		{
-			return PlayEffect(n);
-		}
+		return PlayEffect(n);
 	}
 
-	assert(n < NumFX);
-	
+	assert(n != ASSET_NONE);
+
 	return FALSE;
 }
 
@@ -206,6 +204,12 @@ int ZSSoundSystem::Init(HWND hWindow)
 		FX[n].Load(SoundFileName);
 	}
 
+	Effects.Reset(NumFX);
+	for(n = 0; n < NumFX; n++)
+	{
+		Effects.Add(FX[n].GetName(), &FX[n]);
+	}
+
 	SeekTo(fp,"NumSuites:");
 	NumMusic = GetInt(fp);
 	Music = new MusicSuite[NumMusic];
@@ -239,6 +243,7 @@ void ZSSoundSystem::ShutDown()
 		DEBUG_INFO("Deleting FX\n");
 		delete[] FX;
 	}
+	Effects.Clear();
 
 	if(Music)
 	{
@@ -461,6 +466,7 @@ long WINAPI MusicMan(LPVOID param)
 		if(!BASS_StreamPlay(hStream, FALSE,  NULL))
 		{
 			DEBUG_INFO("Failed to start music stream.\n");
+			LogThreadDone();
 			return FALSE;
 		}
 		dwStreamLength = BASS_StreamGetLength(hStream);
@@ -533,6 +539,7 @@ long WINAPI MusicMan(LPVOID param)
 			DEBUG_INFO("Failed to open stream file: ");
 			DEBUG_INFO(FileName);
 			DEBUG_INFO("\n");
+			LogThreadDone();
 			return FALSE;
 		}
 	//	dwStreamLength = BASS_StreamGetLength(hStream);
@@ -653,10 +660,17 @@ void ZSSoundSystem::UnPauseMusic()
 
 void ZSSoundSystem::StopMusic()
 {
+	DWORD ExitCode;
+
 	if(hmusic)
 	{
 		BASS_StreamFree(hLastStream);
-		TerminateThread(hmusic,0);
+		//a thread that stopped on its own has already given its log ring back
+		if(GetExitCodeThread(hmusic,&ExitCode) && ExitCode == STILL_ACTIVE)
+		{
+			TerminateThread(hmusic,0);
+			LogReleaseThread(musicthreadID);
+		}
 		hLastStream = 0;
 		hMusicThread = hmusic = 0;
 	}
@@ -7,6 +7,7 @@
 #include <wave.h>
 #include "BASS.h"
 #include <stdio.h>
+#include "assetregistry.h"
 
 
 #define SOUND_INI_FILENAME	"sound.ini"
@@ -29,7 +30,7 @@ public:
 
 	SoundEffect()
 	{
-		hSample = NULL;
+		hSample = 0;
 		Name[0] = '\0';
 	}
 
@@ -38,7 +39,7 @@ public:
 		if(hSample)
 		{
 			BASS_SampleFree(hSample);
-			hSample = NULL;
+			hSample = 0;
 		}
 	}
 
@@ -74,6 +75,9 @@ private:
 	int NumFX;
 	int NumMusic;
 
+	//effects by name, handles are places in FX
+	AssetRegistry Effects;
+
 	int MusicPlaying;
 	HANDLE hmusic;
 
@@ -82,7 +86,7 @@ private:
 
 public:
 
-	ZSSoundSystem()
+	ZSSoundSystem() : Effects("effects")
 	{ 
 		hmusic = NULL;
 		FX = NULL;
@@ -132,6 +136,8 @@ public:
 
 	int GetMusicPlaying() { return MusicPlaying; }
 
+	void OutputStats(FILE *fp) { Effects.OutputStats(fp); }
+
 	void Update();
 
 };
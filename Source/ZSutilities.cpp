@@ -95,8 +95,15 @@ FILE *SafeFileOpen(const char *filename, const char *attributestring)
 	return fp;
 }
 
-void SafeExit(char *ErrorMessage)
+void SafeExit(const char *ErrorMessage)
 {
+	LogPrintf(LOG_ERROR, LOG_GENERAL, "SafeExit: %s", ErrorMessage);
+	LogFlush();
+#ifdef HEADLESS
+	//there may not be a log yet, and no one to show a message box to
+	fprintf(stderr, "%s\n", ErrorMessage);
+#endif
+
 	ExitErrorMessage = new char[256];
 	sprintf(ExitErrorMessage,"%s",ErrorMessage);
 	exit(1);
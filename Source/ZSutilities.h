@@ -42,7 +42,7 @@ typedef enum
 } RANGE_T;
 
 FILE *SafeFileOpen(const char *filename, const char *attributestring);
-void SafeExit(char *ErrorMessage);
+void SafeExit(const char *ErrorMessage);
 
 int GetInt(FILE *fp);
 
@@ -131,7 +131,7 @@ int ZSWindow::RemoveChild(ZSWindow *ToRemove)
 
 //SetText
 // Replace our current text with the new text
-int ZSWindow::SetText(char *NewText) 
+int ZSWindow::SetText(const char *NewText) 
 { 
 	//delete the old text
 	if(!Text || strlen(NewText) + 1 > sizeof(Text))
@@ -788,15 +788,18 @@ void ZSWindow::ReleaseFocus()
 	if(pInputFocus != this)
 	{
 		FILE *fp;
-		fp = SafeFileOpen("debug.txt","a+t");
-		fprintf(fp,"\n");
-		fprintf(fp,"bad release w/o owning input");
-		fprintf(fp,"\n");
-		this->OutputDebugInfo(fp);
-		fprintf(fp,"\n");
-		pInputFocus->OutputDebugInfo(fp);
-		fprintf(fp,"\n");
-		fclose(fp);
+		fp = LogGetFile();
+		if(fp)
+		{
+			fprintf(fp,"\n");
+			fprintf(fp,"bad release w/o owning input");
+			fprintf(fp,"\n");
+			this->OutputDebugInfo(fp);
+			fprintf(fp,"\n");
+			pInputFocus->OutputDebugInfo(fp);
+			fprintf(fp,"\n");
+			LogReleaseFile();
+		}
 	}
 #endif
 
@@ -224,7 +224,7 @@ class ZSWindow
 		virtual void Hide() { Visible = FALSE; }
 
 		
-		int SetText(char *NewText);
+		int SetText(const char *NewText);
 		int SetText(int n);
 
 		int AddChild(ZSWindow *ToAdd);
@@ -32,6 +32,12 @@
 #include "combatmanager.h"
 #include "gameitem.h"
 #include "cavewall.h"
+#include "pathgraph.h"
+#include "chunkstreamer.h"
+#include "mappedarea.h"
+#include "chunkresidency.h"
+#include "replay.h"
+#include "profiler.h"
 
 #define D3D_OVERLOADS
 #define DIFFUSE_FACTOR				0.5f
@@ -56,6 +62,71 @@ typedef struct
 #define TIME_PASS_SPEED		2000	
 
 #include <d3d.h>
+#include <stdlib.h>
+
+//an object the mouse might be over, nearest first once sorted
+typedef struct
+{
+	Object *pObject;
+	float Depth;				//along the ray, unscaled
+	BOOL AlwaysCheck;			//test with RayIntersectAlwaysCheck
+} PICK_CANDIDATE_T;
+
+static PICK_CANDIDATE_T *PickCandidates = NULL;
+static int MaxPickCandidates = 0;
+static int NumPickCandidates = 0;
+
+static int ComparePickDepth(const void *pA, const void *pB)
+{
+	float A = ((PICK_CANDIDATE_T *)pA)->Depth;
+	float B = ((PICK_CANDIDATE_T *)pB)->Depth;
+
+	if(A < B) return -1;
+	if(A > B) return 1;
+	return 0;
+}
+
+static void AddPickCandidate(Object *pOb, D3DVECTOR *vRayStart, D3DVECTOR *vRay, BOOL AlwaysCheck)
+{
+	PICK_CANDIDATE_T *pNew;
+
+	if(NumPickCandidates == MaxPickCandidates)
+	{
+		MaxPickCandidates = MaxPickCandidates ? MaxPickCandidates * 2 : 256;
+		pNew = new PICK_CANDIDATE_T[MaxPickCandidates];
+		if(PickCandidates)
+		{
+			memcpy(pNew, PickCandidates, sizeof(PICK_CANDIDATE_T) * NumPickCandidates);
+			delete[] PickCandidates;
+		}
+		PickCandidates = pNew;
+	}
+
+	PickCandidates[NumPickCandidates].pObject = pOb;
+	PickCandidates[NumPickCandidates].Depth = DotProduct(*pOb->GetPosition() - *vRayStart, *vRay);
+	PickCandidates[NumPickCandidates].AlwaysCheck = AlwaysCheck;
+	NumPickCandidates++;
+}
+
+//tests the candidates nearest the camera first, so the first hit is the one in front
+static Object *PickNearest(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
+{
+	PICK_CANDIDATE_T *pCandidate;
+	int n;
+
+	qsort(PickCandidates, NumPickCandidates, sizeof(PICK_CANDIDATE_T), ComparePickDepth);
+
+	for(n = 0; n < NumPickCandidates; n++)
+	{
+		pCandidate = &PickCandidates[n];
+		if(pCandidate->AlwaysCheck ? pCandidate->pObject->RayIntersectAlwaysCheck(vRayStart,vRayEnd) :
+			pCandidate->pObject->RayIntersect(vRayStart,vRayEnd))
+		{
+			return pCandidate->pObject;
+		}
+	}
+	return NULL;
+}
 
 //************** static Members *********************************
 
@@ -110,11 +181,32 @@ Area::Area()
 	ChunkWidth = 0;
 	ChunkHeight = 0;
 
+	pPathGraph = NULL;
+
+	pStreamer = NULL;
+	pMapped = NULL;
+	NumMappedLoads = 0;
+	NumBinLoads = 0;
+	pResidency = NULL;
+
+	Cells = NULL;
+	CellWidth = 0;
+	CellHeight = 0;
+
 }
 
 Area::Area(const char *filename)
 {
 	BigMap = NULL;
+	pPathGraph = NULL;
+	pStreamer = NULL;
+	pMapped = NULL;
+	NumMappedLoads = 0;
+	NumBinLoads = 0;
+	pResidency = NULL;
+	Cells = NULL;
+	CellWidth = 0;
+	CellHeight = 0;
 	ZeroMemory(&Header,sizeof(Header));
 
 	HightLightTextureCoordinates[0] = 0.0f;
@@ -168,6 +260,12 @@ void Area::Clear()
 	int n;
 	int maxn;
 	
+	//nothing half loaded may come back after the map is emptied
+	if(pStreamer)
+	{
+		pStreamer->Flush();
+	}
+
 	//clear out the static data that is still loaded
 	maxn = this->Header.ChunkWidth * this->Header.ChunkHeight;
 	for(n = 0; n < maxn; n++)
@@ -178,6 +276,10 @@ void Area::Clear()
 			BigMap[n] = NULL;
 		}
 	}
+	if(pResidency)
+	{
+		pResidency->Reset();
+	}
 	Object *pOb;
 
 	int xn,yn;
@@ -199,12 +301,26 @@ void Area::Clear()
 
 Area::~Area()
 {
+	CloseStaticViews();
+
 	if(StaticFile)
 	{
 		fclose(StaticFile);
 		StaticFile = NULL;
 	}
 
+	if(pPathGraph)
+	{
+		delete pPathGraph;
+		pPathGraph = NULL;
+	}
+
+	if(pResidency)
+	{
+		delete pResidency;
+		pResidency = NULL;
+	}
+
 	if(BigMap)
 	{
 		Clear();
@@ -216,6 +332,9 @@ Area::~Area()
 		delete[] UpdateSegments;
 		UpdateSegments = NULL;
 	}
+
+	//objects that outlive the area must not point back at it
+	ClearCells();
 	
 	if(Header.ChunkOffsets)
 	{
@@ -264,8 +383,7 @@ float Area::GetTileHeight(int TileX, int TileY)
 		{
 			float zval;
 			zval = BigMap[MapOffset]->GetHeight(TileX % CHUNK_TILE_WIDTH, TileY % CHUNK_TILE_HEIGHT);
-			delete BigMap[MapOffset];
-			BigMap[TileX / CHUNK_TILE_WIDTH + TileY/CHUNK_TILE_WIDTH * this->ChunkWidth] = NULL;
+			RemoveChunk(TileX/CHUNK_TILE_WIDTH,TileY/CHUNK_TILE_WIDTH);
 			return zval;
 		}
 		else
@@ -502,24 +620,27 @@ BOOL Area::IsClear(int x, int y, Object *pTester)
 
 	if(x >= 0 && x < this->Width && y >= 0 && y < this->Height)
 	{
-		pOb = UpdateSegments[x / UPDATE_SEGMENT_WIDTH + (y/UPDATE_SEGMENT_HEIGHT)*this->UpdateWidth];
+		RECT rCells;
+		int xn;
+		int yn;
 
-		while(pOb)
+		if(!GetCellRange(x, y, x, y, &rCells))
 		{
-			if(pOb->TileBlock(x,y))
+			return TRUE;
+		}
+
+		for(yn = rCells.top; yn <= rCells.bottom; yn++)
+		for(xn = rCells.left; xn <= rCells.right; xn++)
+		{
+			pOb = Cells[xn + yn * CellWidth];
+
+			while(pOb)
 			{
-				if(pOb == pTester)
-				{
-					pOb = pOb->GetNextUpdate();
-				}
-				else
+				if(pOb != pTester && pOb->TileBlock(x,y))
 				{
 					return FALSE;
 				}
-			}
-			else
-			{
-				pOb = pOb->GetNextUpdate();
+				pOb = pOb->GetNextCell();
 			}
 		}
 
@@ -535,30 +656,32 @@ BOOL Area::IsClear(int x, int y, Object *pTester)
 	
 Object *Area::FindThing(int x, int y)
 {
-	//needs to be optimized to search only the area immediately around the x/y coordinates
-	//also needs code to check for things which have a radius of greater than one
-	int SegX;
-	int SegY;
-
-
-	SegX = x/UPDATE_SEGMENT_WIDTH;
-	SegY = y/UPDATE_SEGMENT_HEIGHT;
+	RECT rCells;
+	int xn;
+	int yn;
 
 	Object *pOb;
-
-	pOb = UpdateSegments[SegX + SegY * this->UpdateWidth];
 	D3DVECTOR *pPosition;
-	
-	while(pOb)
-	{
-		pPosition = pOb->GetPosition();
 
-		if((int)pPosition->x == x 
-			&& (int)pPosition->y == y)
+	if(GetCellRange(x, y, x, y, &rCells))
+	{
+		for(yn = rCells.top; yn <= rCells.bottom; yn++)
+		for(xn = rCells.left; xn <= rCells.right; xn++)
 		{
-			return pOb;
+			pOb = Cells[xn + yn * CellWidth];
+
+			while(pOb)
+			{
+				pPosition = pOb->GetPosition();
+
+				if((int)pPosition->x == x 
+					&& (int)pPosition->y == y)
+				{
+					return pOb;
+				}
+				pOb = pOb->GetNextCell();
+			}
 		}
-		pOb = pOb->GetNextUpdate();
 	}
 
 	if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT)
@@ -1163,6 +1286,8 @@ void Area::DrawTerrain()
 
 void Area::Draw()
 {
+	ProfileZone DrawZone(ZONE_AREA_DRAW);
+
 	int xn;
 	int yn;
 
@@ -1748,9 +1873,38 @@ int Area::Load()
 
 	BigMap = new Chunk *[this->ChunkWidth * this->ChunkHeight];
 	ZeroMemory(BigMap, sizeof(Chunk *) * this->ChunkWidth * this->ChunkHeight);
+
+	//portals are built lazily as long routes reach each chunk
+	if(pPathGraph)
+	{
+		delete pPathGraph;
+	}
+	pPathGraph = new PathGraph(this, this->ChunkWidth, this->ChunkHeight);
 	
 	SetCurrentDirectory(Engine->GetRootDirectory());
 
+	//gui.ini may give the budget for loaded chunks, in kilobytes
+	int Budget;
+	FILE *fp;
+	Budget = RESIDENCY_DEFAULT_BUDGET;
+	fp = fopen("gui.ini","rt");
+	if(fp)
+	{
+		if(SeekTo(fp,"CHUNKBUDGET"))
+		{
+			Budget = GetInt(fp) * 1024;
+		}
+		fclose(fp);
+	}
+
+	if(pResidency)
+	{
+		delete pResidency;
+	}
+	pResidency = new ChunkResidency(this, this->ChunkWidth, this->ChunkHeight, Budget);
+
+	OpenStaticViews();
+
 	if(!strcmp(this->Header.Name,"valley"))
 	{
 		pBaseTexture = Engine->GetTexture("terrain");
@@ -1875,6 +2029,8 @@ void Area::AddToUpdate(Object *pToAdd, int xUpdate, int yUpdate)
 	
 	pToAdd->SetPrevUpdate(NULL);
 
+	AddToCell(pToAdd, xUpdate, yUpdate);
+
 	if(pToAdd->GetObjectType() == OBJECT_CREATURE)
 	{
 		((Creature *)pToAdd)->SetAreaIn(this->AreaID);
@@ -2088,6 +2244,9 @@ void Area::RemoveFromUpdate(Object *pToRemove)
 void Area::RemoveFromUpdate(Object *pToRemove, int xUpdate, int yUpdate)
 {
 	if(!UpdateSegments) return;
+
+	RemoveFromCell(pToRemove);
+
 	if(!pToRemove->GetPrevUpdate())
 	{
 		D3DVECTOR *pPosition;
@@ -2145,6 +2304,317 @@ void Area::RemoveFromUpdate(Object *pToRemove, int xUpdate, int yUpdate)
 
 }
 
+BOOL Area::GetCellRange(int Left, int Top, int Right, int Bottom, RECT *rCells)
+{
+	if(!Cells)
+	{
+		return FALSE;
+	}
+
+	Left -= AREA_CELL_MARGIN;
+	Top -= AREA_CELL_MARGIN;
+	Right += AREA_CELL_MARGIN;
+	Bottom += AREA_CELL_MARGIN;
+
+	if(Left < 0) Left = 0;
+	if(Top < 0) Top = 0;
+	if(Right >= Width) Right = Width - 1;
+	if(Bottom >= Height) Bottom = Height - 1;
+
+	if(Left > Right || Top > Bottom)
+	{
+		return FALSE;
+	}
+
+	rCells->left = Left / AREA_CELL_SIZE;
+	rCells->top = Top / AREA_CELL_SIZE;
+	rCells->right = Right / AREA_CELL_SIZE;
+	rCells->bottom = Bottom / AREA_CELL_SIZE;
+
+	return TRUE;
+}
+
+void Area::AddToCell(Object *pToAdd, int x, int y)
+{
+	int Cell;
+
+	if(!Cells)
+	{
+		CellWidth = (Width + AREA_CELL_SIZE - 1) / AREA_CELL_SIZE;
+		CellHeight = (Height + AREA_CELL_SIZE - 1) / AREA_CELL_SIZE;
+		if(!CellWidth || !CellHeight)
+		{
+			return;
+		}
+		Cells = new Object *[CellWidth * CellHeight];
+		memset(Cells, 0, sizeof(Object *) * CellWidth * CellHeight);
+	}
+
+	if(pToAdd->GetCellArea())
+	{
+		RemoveFromCell(pToAdd);
+	}
+
+	if(x < 0) x = 0;
+	if(y < 0) y = 0;
+	if(x >= Width) x = Width - 1;
+	if(y >= Height) y = Height - 1;
+
+	Cell = x / AREA_CELL_SIZE + (y / AREA_CELL_SIZE) * CellWidth;
+
+	if(Cells[Cell])
+	{
+		Cells[Cell]->SetPrevCell(pToAdd);
+	}
+	pToAdd->SetNextCell(Cells[Cell]);
+	pToAdd->SetPrevCell(NULL);
+	Cells[Cell] = pToAdd;
+	pToAdd->SetCell(this, Cell);
+}
+
+void Area::RemoveFromCell(Object *pToRemove)
+{
+	Area *pArea;
+
+	//it may be filed in another area than the one asked
+	pArea = pToRemove->GetCellArea();
+	if(!pArea)
+	{
+		return;
+	}
+
+	if(pToRemove->GetPrevCell())
+	{
+		pToRemove->GetPrevCell()->SetNextCell(pToRemove->GetNextCell());
+	}
+	else
+	if(pArea->Cells && pArea->Cells[pToRemove->GetCellIn()] == pToRemove)
+	{
+		pArea->Cells[pToRemove->GetCellIn()] = pToRemove->GetNextCell();
+	}
+
+	if(pToRemove->GetNextCell())
+	{
+		pToRemove->GetNextCell()->SetPrevCell(pToRemove->GetPrevCell());
+	}
+
+	pToRemove->SetNextCell(NULL);
+	pToRemove->SetPrevCell(NULL);
+	pToRemove->SetCell(NULL, -1);
+}
+
+void Area::UpdateCell(Object *pToUpdate)
+{
+	int x;
+	int y;
+
+	if(pToUpdate->GetCellArea() != this)
+	{
+		return;
+	}
+
+	x = (int)pToUpdate->GetPosition()->x;
+	y = (int)pToUpdate->GetPosition()->y;
+	if(x < 0) x = 0;
+	if(y < 0) y = 0;
+	if(x >= Width) x = Width - 1;
+	if(y >= Height) y = Height - 1;
+
+	if(x / AREA_CELL_SIZE + (y / AREA_CELL_SIZE) * CellWidth != pToUpdate->GetCellIn())
+	{
+		AddToCell(pToUpdate, x, y);
+	}
+}
+
+void Area::ClearCells()
+{
+	Object *pOb;
+	Object *pNextOb;
+	int n;
+
+	if(!Cells)
+	{
+		return;
+	}
+
+	for(n = 0; n < CellWidth * CellHeight; n++)
+	{
+		pOb = Cells[n];
+		while(pOb)
+		{
+			pNextOb = pOb->GetNextCell();
+			pOb->SetNextCell(NULL);
+			pOb->SetPrevCell(NULL);
+			pOb->SetCell(NULL, -1);
+			pOb = pNextOb;
+		}
+	}
+
+	delete[] Cells;
+	Cells = NULL;
+}
+
+int Area::FindInRadius(float x, float y, float Radius, OBJECT_T oType, Object **pFound, int MaxFound)
+{
+	RECT rCells;
+	D3DVECTOR vCenter;
+	D3DVECTOR vAt;
+	Object *pOb;
+	int NumFound;
+	int xstart;
+	int ystart;
+	int xend;
+	int yend;
+	int xn;
+	int yn;
+
+	//the tiles Damage has always hit, those whose corner is inside the circle
+	xstart = (int)(x - Radius + 0.5f);
+	ystart = (int)(y - Radius + 0.5f);
+	xend = (int)(x + Radius + 0.5f);
+	yend = (int)(y + Radius + 0.5f);
+
+	vCenter.x = x;
+	vCenter.y = y;
+	vCenter.z = 0.0f;
+	vAt.z = 0.0f;
+
+	NumFound = 0;
+
+	if(GetCellRange(xstart, ystart, xend, yend, &rCells))
+	{
+		for(yn = rCells.top; yn <= rCells.bottom; yn++)
+		for(xn = rCells.left; xn <= rCells.right; xn++)
+		{
+			pOb = Cells[xn + yn * CellWidth];
+
+			while(pOb)
+			{
+				vAt.x = (float)(int)pOb->GetPosition()->x;
+				vAt.y = (float)(int)pOb->GetPosition()->y;
+
+				if((oType == OBJECT_NONE || pOb->GetObjectType() == oType)
+					&& vAt.x >= xstart && vAt.x <= xend && vAt.y >= ystart && vAt.y <= yend
+					&& GetDistance(&vAt, &vCenter) <= Radius)
+				{
+					if(NumFound < MaxFound)
+					{
+						pFound[NumFound] = pOb;
+					}
+					NumFound++;
+				}
+				pOb = pOb->GetNextCell();
+			}
+		}
+	}
+
+	if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT)
+	{
+		pOb = PreludeWorld->GetCombat()->GetCombatants();
+
+		while(pOb)
+		{
+			vAt.x = (float)(int)pOb->GetPosition()->x;
+			vAt.y = (float)(int)pOb->GetPosition()->y;
+
+			if(!pOb->GetCellArea()
+				&& (oType == OBJECT_NONE || pOb->GetObjectType() == oType)
+				&& vAt.x >= xstart && vAt.x <= xend && vAt.y >= ystart && vAt.y <= yend
+				&& GetDistance(&vAt, &vCenter) <= Radius)
+			{
+				if(NumFound < MaxFound)
+				{
+					pFound[NumFound] = pOb;
+				}
+				NumFound++;
+			}
+			pOb = pOb->GetNextUpdate();
+		}
+	}
+
+	return NumFound;
+}
+
+int Area::FindOnLine(int xStart, int yStart, int xEnd, int yEnd, Object **pFound, int MaxFound)
+{
+	RECT rCells;
+	Object *pOb;
+	int NumFound;
+	int dx;
+	int dy;
+	int StepX;
+	int StepY;
+	int Error;
+	int Error2;
+	int x;
+	int y;
+	int xn;
+	int yn;
+	int n;
+
+	NumFound = 0;
+
+	dx = xEnd > xStart ? xEnd - xStart : xStart - xEnd;
+	dy = yEnd > yStart ? yEnd - yStart : yStart - yEnd;
+	StepX = xStart < xEnd ? 1 : -1;
+	StepY = yStart < yEnd ? 1 : -1;
+	Error = dx - dy;
+
+	x = xStart;
+	y = yStart;
+
+	while(NumFound < MaxFound)
+	{
+		if(GetCellRange(x, y, x, y, &rCells))
+		{
+			for(yn = rCells.top; yn <= rCells.bottom; yn++)
+			for(xn = rCells.left; xn <= rCells.right; xn++)
+			{
+				pOb = Cells[xn + yn * CellWidth];
+
+				while(pOb && NumFound < MaxFound)
+				{
+					if(pOb->TileIntersect(x,y))
+					{
+						//a large creature or a door can cover two tiles of the line
+						for(n = 0; n < NumFound; n++)
+						{
+							if(pFound[n] == pOb)
+							{
+								break;
+							}
+						}
+						if(n == NumFound)
+						{
+							pFound[NumFound++] = pOb;
+						}
+					}
+					pOb = pOb->GetNextCell();
+				}
+			}
+		}
+
+		if(x == xEnd && y == yEnd)
+		{
+			break;
+		}
+
+		Error2 = Error * 2;
+		if(Error2 > -dy)
+		{
+			Error -= dy;
+			x += StepX;
+		}
+		if(Error2 < dx)
+		{
+			Error += dx;
+			y += StepY;
+		}
+	}
+
+	return NumFound;
+}
+
 int Area::Update()
 {
 //	DWORD CurTime;
@@ -2503,6 +2973,8 @@ int Area::Save()
 	int yn;
 
 	Chunk *pChunk;
+
+	CloseStaticViews();
 	
 	SaveHeader(fp);
 	
@@ -2520,7 +2992,7 @@ int Area::Save()
 			{
 				Header.ChunkOffsets[xn + yn * this->ChunkWidth] = ftell(fp);
 				pChunk->Save(fp);
-				delete pChunk;
+				RemoveChunk(xn, yn);
 				pChunk = NULL;
 			}
 			else
@@ -2542,6 +3014,7 @@ int Area::Save()
 	rename("temp.bin",filename);
 	
 	StaticFile = SafeFileOpen(filename,"rb");
+	OpenStaticViews();
 	char blarg[64];
 	sprintf(blarg,"saved %s",Header.Name);
 	Describe(blarg);
@@ -2585,6 +3058,11 @@ void Area::LoadHeader(FILE *fp)
 
 }
 
+void Area::OutputLoadStats(FILE *fp)
+{
+	fprintf(fp,"%-12s%li chunks mapped, %li read from the .bin%s\n",
+		Header.Name, (long)NumMappedLoads, (long)NumBinLoads, pMapped ? "" : ", no mapped file");
+}
   
 //end: Outputs ********************************************************
 
@@ -2761,36 +3239,53 @@ void Area::CreateChunks()
 
 Object *Area::FindNextThing(Object *pThing, int x, int y)
 {
-	int SegX;
-	int SegY;
-
-	SegX = x/UPDATE_SEGMENT_WIDTH;
-	SegY = y/UPDATE_SEGMENT_HEIGHT;
+	RECT rCells;
+	int xn;
+	int yn;
 
 	Object *pOb;
+	D3DVECTOR *pPosition;
 
-	pOb = UpdateSegments[SegX + SegY * this->UpdateWidth];
-
-	while(pOb && pOb != pThing)
+	//carry on through the cells in the order FindThing walks them
+	if(pThing->GetCellArea() == this && GetCellRange(x, y, x, y, &rCells))
 	{
-		pOb = pOb->GetNextUpdate();
-	}
+		xn = pThing->GetCellIn() % CellWidth;
+		yn = pThing->GetCellIn() / CellWidth;
+		pOb = pThing->GetNextCell();
 
-	if(pOb)
-		pOb = pOb->GetNextUpdate();
+		if(xn < rCells.left || xn > rCells.right || yn < rCells.top || yn > rCells.bottom)
+		{
+			return NULL;
+		}
 
-	D3DVECTOR *pPosition;
+		while(TRUE)
+		{
+			while(pOb)
+			{
+				pPosition = pOb->GetPosition();
 
-	while(pOb)
-	{
-		pPosition = pOb->GetPosition();
+				if((int)pPosition->x == x 
+					&& (int)pPosition->y == y)
+				{
+					return pOb;
+				}
+				pOb = pOb->GetNextCell();
+			}
 
-		if((int)pPosition->x == x 
-			&& (int)pPosition->y == y)
-		{
-			return pOb;
+			xn++;
+			if(xn > rCells.right)
+			{
+				xn = rCells.left;
+				yn++;
+			}
+			if(yn > rCells.bottom)
+			{
+				break;
+			}
+			pOb = Cells[xn + yn * CellWidth];
 		}
-		pOb = pOb->GetNextUpdate();
+
+		return NULL;
 	}
 
 	if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT)
@@ -2824,34 +3319,32 @@ Object *Area::FindNextThing(Object *pThing, int x, int y)
 
 void Area::Damage(float Radius, D3DVECTOR Center, int Min, int Max, DAMAGE_T Type, Thing *pSource)
 {
+	Object *pLocal[AREA_MAX_FOUND];
+	Object **pFound;
+	int NumFound;
+	int n;
 
-	int xn;
-	int yn;
-
-	int xstart;
-	int ystart;
-	int xend;
-	int yend;
+	//collect first, taking damage can move things between cells
+	pFound = pLocal;
+	NumFound = FindInRadius(Center.x, Center.y, Radius, OBJECT_CREATURE, pFound, AREA_MAX_FOUND);
 
-	xstart = (int)(Center.x - Radius + 0.5f);
-	ystart = (int)(Center.y - Radius + 0.5f);
+	//a crowd bigger than the buffer is asked again with room for all of it
+	if(NumFound > AREA_MAX_FOUND)
+	{
+		pFound = new Object *[NumFound];
+		NumFound = FindInRadius(Center.x, Center.y, Radius, OBJECT_CREATURE, pFound, NumFound);
+	}
 
-	xend = (int)(Center.x + Radius + 0.5f);
-	yend = (int)(Center.y + Radius + 0.5f);
-	
-	D3DVECTOR vAt;
-	
-	for(xn = xstart; xn <= xend; xn++)
-	for(yn = ystart; yn <= yend; yn++)
+	for(n = 0; n < NumFound; n++)
 	{
-		vAt.x = (float)xn;
-		vAt.y = (float)yn;
-		vAt.z = 0.0f;
+		int Damage;
+		Damage = GameRand()%(Max+1-Min) + Min;
+		((Creature *)pFound[n])->TakeDamage(pSource, Damage, Type);
+	}
 
-		if(GetDistance(&vAt, &Center) <= Radius)
-		{
-			DamageTile(xn,yn,Min,Max,Type, pSource);
-		}
+	if(pFound != pLocal)
+	{
+		delete[] pFound;
 	}
 }
 
@@ -2866,7 +3359,7 @@ void Area::DamageTile(int x, int y, int Min, int Max, DAMAGE_T Type, Thing *pSou
 		if(pOb->GetObjectType() == OBJECT_CREATURE)
 		{
 			int Damage;
-			Damage = rand()%(Max+1-Min) + Min;
+			Damage = GameRand()%(Max+1-Min) + Min;
 			((Creature *)pOb)->TakeDamage(pSource, Damage, Type);
 		}
 		pOb = FindNextThing(pOb,x,y);
@@ -2889,27 +3382,98 @@ void Area::LoadChunk(int x, int y)
 	if(!Header.ChunkOffsets[x + y * this->ChunkWidth])
 		return;
 
+	//the loader thread may already have it
+	if(pStreamer && pStreamer->Claim(x,y))
+	{
+		return;
+	}
+
 	//allocate space for the new chunk
 	Chunk *pChunk;
+	const MAPPED_CHUNK_T *pRecord;
 
 	pChunk = new Chunk;
 
 	//position the file pointer
 	int Error;
 
-	Error = fseek(StaticFile, Header.ChunkOffsets[x + y * this->ChunkWidth], SEEK_SET);
+	pRecord = pMapped ? pMapped->GetChunk(x,y) : NULL;
+	if(pRecord)
+	{
+		//the static arrays come straight out of the mapped file
+		pChunk->LoadMapped(pRecord);
+		Error = fseek(StaticFile, pRecord->ObjectOffset, SEEK_SET);
+		assert(!Error);
+		pChunk->LoadObjects(StaticFile);
+		InterlockedIncrement(&NumMappedLoads);
+	}
+	else
+	{
+		Error = fseek(StaticFile, Header.ChunkOffsets[x + y * this->ChunkWidth], SEEK_SET);
 
-	assert(!Error);
+		assert(!Error);
 
-	pChunk->Load(StaticFile);
+		pChunk->Load(StaticFile);
+		InterlockedIncrement(&NumBinLoads);
+	}
 
 
 	BigMap[y*this->ChunkWidth + x] = pChunk;
+
+	if(pResidency)
+	{
+		pResidency->Add(x,y);
+	}
 	
 	//pChunk->OutPutDebugInfo("chunk.txt");
 
 }
 
+void Area::OpenStaticViews()
+{
+	char filename[256];
+	char mapname[256];
+
+	CloseStaticViews();
+
+	if(!StaticFile || !BigMap)
+	{
+		return;
+	}
+
+	sprintf(filename,"%s\\Areas\\%s.bin",Engine->GetRootDirectory(),Header.Name);
+	sprintf(mapname,"%s\\Areas\\%s.sta",Engine->GetRootDirectory(),Header.Name);
+
+	//the streamer reads from the mapping, so it goes up first
+	pMapped = new MappedArea;
+	if(!pMapped->Open(mapname, filename, this->ChunkWidth, this->ChunkHeight))
+	{
+		delete pMapped;
+		pMapped = NULL;
+	}
+
+	//fixed ticks load chunks on the main thread, see World::Update
+	if(!FixedTicks())
+	{
+		pStreamer = new ChunkStreamer(this, filename);
+	}
+}
+
+void Area::CloseStaticViews()
+{
+	if(pStreamer)
+	{
+		delete pStreamer;
+		pStreamer = NULL;
+	}
+
+	if(pMapped)
+	{
+		delete pMapped;
+		pMapped = NULL;
+	}
+}
+
 void Area::SetTerrain(int x, int y, int NewVal)
 {
 	Chunk *pChunk;
@@ -3217,7 +3781,9 @@ Object *Area::GetTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 {
 	Object *pOb;
 	int xn, yn, Offset;
+	D3DVECTOR vRay;
 
+	//whoever is fighting comes before anything in front of them
 	if(PreludeWorld->InCombat())
 	{
 		pOb = PreludeWorld->GetCombat()->Combatants;
@@ -3232,6 +3798,9 @@ Object *Area::GetTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 		}
 	 }
 	
+	vRay = *vRayEnd - *vRayStart;
+	NumPickCandidates = 0;
+
 	Offset = PreludeWorld->UpdateRect.left + PreludeWorld->UpdateRect.top * this->UpdateWidth;
 	
 	for(yn = PreludeWorld->UpdateRect.top; yn <= PreludeWorld->UpdateRect.bottom; yn++)
@@ -3242,11 +3811,7 @@ Object *Area::GetTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 
 			while(pOb)
 			{
-				if(pOb->RayIntersect(vRayStart,vRayEnd))
-				{
-					return pOb;
-				}
-
+				AddPickCandidate(pOb, vRayStart, &vRay, FALSE);
 				pOb = pOb->GetNextUpdate();
 			}
 			Offset++;
@@ -3260,15 +3825,12 @@ Object *Area::GetTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 	{
 		if(pOb->GetObjectType() != OBJECT_STATIC)
 		{
-			if(pOb->RayIntersect(vRayStart,vRayEnd))
-			{
-				return pOb;
-			}
+			AddPickCandidate(pOb, vRayStart, &vRay, FALSE);
 		}
 		pOb = pOb->GetNext();
 	}
 
-	return NULL;
+	return PickNearest(vRayStart, vRayEnd);
 }
 
 Object *Area::GetStaticTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
@@ -3277,17 +3839,16 @@ Object *Area::GetStaticTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 	int xn, yn, Offset;
 	int EndY;
 	int EndX;
+	D3DVECTOR vRay;
 	
-	Offset = PreludeWorld->UpdateRect.left + PreludeWorld->UpdateRect.top * this->UpdateWidth;
-	
+	vRay = *vRayEnd - *vRayStart;
+	NumPickCandidates = 0;
+
 	pOb = PreludeWorld->GetMainObjects();
 
 	while(pOb)
 	{
-		if(pOb->RayIntersect(vRayStart,vRayEnd))
-		{
-			return pOb;
-		}
+		AddPickCandidate(pOb, vRayStart, &vRay, FALSE);
 		pOb = pOb->GetNext();
 	}
 
@@ -3322,10 +3883,7 @@ Object *Area::GetStaticTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 				pOb = BigMap[Offset + xn]->GetObjects();
 				while(pOb)
 				{
-					if(pOb->RayIntersectAlwaysCheck(vRayStart,vRayEnd))
-					{
-						return pOb;
-					}
+					AddPickCandidate(pOb, vRayStart, &vRay, TRUE);
 					pOb = pOb->GetNext();
 				}
 
@@ -3343,16 +3901,12 @@ Object *Area::GetStaticTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd)
 		pOb = pRegion ->GetObjects();
 		while(pOb)
 		{
-			if(pOb->RayIntersectAlwaysCheck(vRayStart,vRayEnd))
-			{
-				return pOb;
-			}
+			AddPickCandidate(pOb, vRayStart, &vRay, TRUE);
 			pOb = pOb->GetNext();
 		}
 	}
 	
-
-   return NULL;
+	return PickNearest(vRayStart, vRayEnd);
 }
 
 void Area::LoadNonStatic(FILE *fp)
@@ -3514,17 +4068,25 @@ Object *Area::FindOtherObject(int x, int y, OBJECT_T oType, Object *pExclude)
 {
 	Object *pOb;
 	
-	pOb = UpdateSegments[x / UPDATE_SEGMENT_WIDTH + (y/UPDATE_SEGMENT_HEIGHT)*(Width / UPDATE_SEGMENT_WIDTH)];
+	RECT rCells;
+	int xn;
+	int yn;
 
-	while(pOb)
+	if(GetCellRange(x, y, x, y, &rCells))
 	{
-		if(pOb != pExclude && pOb->GetObjectType() == oType && pOb->TileIntersect(x,y))
+		for(yn = rCells.top; yn <= rCells.bottom; yn++)
+		for(xn = rCells.left; xn <= rCells.right; xn++)
 		{
-			return pOb;
-		}
-		else
-		{
-			pOb = pOb->GetNextUpdate();
+			pOb = Cells[xn + yn * CellWidth];
+
+			while(pOb)
+			{
+				if(pOb != pExclude && pOb->GetObjectType() == oType && pOb->TileIntersect(x,y))
+				{
+					return pOb;
+				}
+				pOb = pOb->GetNextCell();
+			}
 		}
 	}
 
@@ -3554,17 +4116,25 @@ Object *Area::FindObject(int x, int y, OBJECT_T oType)
 {
 	Object *pOb;
 	
-	pOb = UpdateSegments[x / UPDATE_SEGMENT_WIDTH + (y/UPDATE_SEGMENT_HEIGHT)*(Width / UPDATE_SEGMENT_WIDTH)];
+	RECT rCells;
+	int xn;
+	int yn;
 
-	while(pOb)
+	if(GetCellRange(x, y, x, y, &rCells))
 	{
-		if(pOb->GetObjectType() == oType && pOb->TileIntersect(x,y))
+		for(yn = rCells.top; yn <= rCells.bottom; yn++)
+		for(xn = rCells.left; xn <= rCells.right; xn++)
 		{
-			return pOb;
-		}
-		else
-		{
-			pOb = pOb->GetNextUpdate();
+			pOb = Cells[xn + yn * CellWidth];
+
+			while(pOb)
+			{
+				if(pOb->GetObjectType() == oType && pOb->TileIntersect(x,y))
+				{
+					return pOb;
+				}
+				pOb = pOb->GetNextCell();
+			}
 		}
 	}
 
@@ -3798,8 +4368,7 @@ void Area::Cut(RECT *rArea)
 		Header.ChunkOffsets[yn * ChunkWidth + xn] = 0;
 		if(BigMap[yn * this->ChunkWidth + xn])
 		{
-			delete BigMap[yn * this->ChunkWidth + xn];
-			BigMap[yn * this->ChunkWidth + xn] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	
 	}
@@ -3810,8 +4379,7 @@ void Area::Cut(RECT *rArea)
 		Header.ChunkOffsets[yn * ChunkWidth + xn] = 0;
 		if(BigMap[yn * this->ChunkWidth + xn])
 		{
-			delete BigMap[yn * this->ChunkWidth + xn];
-			BigMap[yn * this->ChunkWidth + xn] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	}
 	
@@ -3821,8 +4389,7 @@ void Area::Cut(RECT *rArea)
 		Header.ChunkOffsets[yn * ChunkWidth + xn] = 0;
 		if(BigMap[yn * this->ChunkWidth + xn])
 		{
-			delete BigMap[yn * this->ChunkWidth + xn];
-			BigMap[yn * this->ChunkWidth + xn] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	}
 
@@ -3832,8 +4399,7 @@ void Area::Cut(RECT *rArea)
 		Header.ChunkOffsets[yn * ChunkWidth + xn] = 0;
 		if(BigMap[yn * this->ChunkWidth + xn])
 		{
-			delete BigMap[yn * this->ChunkWidth + xn];
-			BigMap[yn * this->ChunkWidth + xn] = NULL;
+			RemoveChunk(xn, yn);
 		}
 	}
 }
@@ -3927,7 +4493,7 @@ void  Area::ImportStuff(FILE *fpImport)
 			{
 				Header.ChunkOffsets[xn + yn * this->ChunkWidth] = ftell(newfp);
 				pChunk->Save(newfp);
-				delete pChunk;
+				RemoveChunk(xn, yn);
 				pChunk = NULL;
 			}
 			else
@@ -3948,6 +4514,7 @@ void  Area::ImportStuff(FILE *fpImport)
 	
 	fclose(newfp);
 	
+	CloseStaticViews();
 	fclose(StaticFile);
 	
 	char filename[64];
@@ -3957,6 +4524,7 @@ void  Area::ImportStuff(FILE *fpImport)
 	rename("worldnew.bin",filename);
 	
 	StaticFile = SafeFileOpen(filename,"rb");
+	OpenStaticViews();
 	Describe("Done Combined Saving");
 
 	SetCurrentDirectory(Engine->GetRootDirectory());
@@ -4057,7 +4625,7 @@ void Area::Combine(FILE *fpImport)
 			{
 				Header.ChunkOffsets[xn + yn * this->ChunkWidth] = ftell(newfp);
 				pChunk->Save(newfp);
-				delete pChunk;
+				RemoveChunk(xn, yn);
 				pChunk = NULL;
 			}
 			else
@@ -4078,6 +4646,7 @@ void Area::Combine(FILE *fpImport)
 	
 	fclose(newfp);
 	
+	CloseStaticViews();
 	fclose(StaticFile);
 	
 	char filename[64];
@@ -4087,6 +4656,7 @@ void Area::Combine(FILE *fpImport)
 	rename("worldnew.bin",filename);
 	
 	StaticFile = SafeFileOpen(filename,"rb");
+	OpenStaticViews();
 	Describe("Done Combined Saving");
 
 	SetCurrentDirectory(Engine->GetRootDirectory());
@@ -4477,6 +5047,15 @@ void Area::ClearDynamic(RECT *pArea, OBJECT_T ToClear)
 
 void Area::ResetUpdate(int x, int y)
 {
+	Object *pOb;
+
+	pOb = UpdateSegments[x + y * this->UpdateWidth];
+	while(pOb)
+	{
+		RemoveFromCell(pOb);
+		pOb = pOb->GetNextUpdate();
+	}
+
 	UpdateSegments[x + y * this->UpdateWidth] = NULL;
 }
 
@@ -4631,6 +5210,10 @@ void Area::RemoveChunk(int x, int y)
 	{
 		delete pChunk;
 		BigMap[x + (y * ChunkWidth)] = NULL;
+		if(pResidency)
+		{
+			pResidency->Remove(x, y);
+		}
 	}
 	else
 	{
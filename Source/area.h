@@ -20,8 +20,21 @@ typedef struct
 
 } STATIC_FILE_HEADER_T;
 
+//tiles on a side of the cells objects are filed in for tile queries
+#define AREA_CELL_SIZE		8
+//how far from the tile it was filed at an object can still touch a
+//tile.  Walkers are filed at the tile they are stepping to, and large
+//creatures and doors cover the tile past their position.
+#define AREA_CELL_MARGIN	2
+//most objects one radius query hands back
+#define AREA_MAX_FOUND		256
+
 
 class Region;
+class PathGraph;
+class ChunkStreamer;
+class MappedArea;
+class ChunkResidency;
 class Creature;
 class Dungeon;
 class Thing;
@@ -70,6 +83,31 @@ private:
 
 	int AreaID;
 
+	PathGraph *pPathGraph;
+
+	ChunkStreamer *pStreamer;
+
+	//the converted static file, when there is an up to date one
+	MappedArea *pMapped;
+	//chunks read through each format, the loader thread counts too
+	LONG NumMappedLoads;
+	LONG NumBinLoads;
+
+	ChunkResidency *pResidency;
+
+	//the objects of the update lists again, in AREA_CELL_SIZE squares
+	Object **Cells;
+	int CellWidth;
+	int CellHeight;
+
+	void AddToCell(Object *pToAdd, int x, int y);
+	void RemoveFromCell(Object *pToRemove);
+	//the cells that can hold an object touching the tiles, FALSE if none
+	BOOL GetCellRange(int Left, int Top, int Right, int Bottom, RECT *rCells);
+
+	//a chunk of GenerateBase, run by its bake graph
+	static void BakeBaseChunk(int Stage, int TileX, int TileY, int Worker, void *pData);
+
 //************************************************************************************** 
 
 public:
@@ -126,6 +164,12 @@ public:
 	Object *FindNextThing(Object *pThing, int x, int y);
 	Object *FindObject(int x, int y, OBJECT_T oType);
 	Object *FindOtherObject(int x, int y, OBJECT_T oType, Object *pExclude);
+	//fill pFound with up to MaxFound objects of oType, or of any type for
+	//OBJECT_NONE, standing on tiles within Radius of x, y.  returns how
+	//many there are, which is more than MaxFound if some didn't fit
+	int FindInRadius(float x, float y, float Radius, OBJECT_T oType, Object **pFound, int MaxFound);
+	//fill pFound with the objects on the tiles the line crosses, returns how many
+	int FindOnLine(int xStart, int yStart, int xEnd, int yEnd, Object **pFound, int MaxFound);
 	
 
 	void CreateChunks();
@@ -144,6 +188,10 @@ public:
 	Object *GetStaticTarget(D3DVECTOR *vRayStart, D3DVECTOR *vRayEnd);
 	ZSTexture *GetBaseTexture() { return pBaseTexture; }
 	int GetID() { return AreaID; }
+	PathGraph *GetPathGraph() { return pPathGraph; }
+	ChunkStreamer *GetStreamer() { return pStreamer; }
+	ChunkResidency *GetResidency() { return pResidency; }
+	BOOL IsMapped() { return pMapped != NULL; }
 
 	BOOL CheckLOS(D3DVECTOR *vLineStart, D3DVECTOR *vLineEnd);
 	BOOL CheckChunkLOS(int xn, int yn, D3DVECTOR *vLineSTart, D3DVECTOR *vLineEnd);
@@ -179,6 +227,11 @@ public:
 	void LoadChunk(int x, int y);
 	void CleanUpChunks();
 
+	//the streamer and the mapped file hold their own handles on the
+	//static data, they have to be closed before the file is replaced
+	void OpenStaticViews();
+	void CloseStaticViews();
+
 	void ClearTile(int x, int y);
 
 	BYTE GetBlocking(int x, int y);
@@ -190,6 +243,11 @@ public:
 	
 	void RemoveFromUpdate(Object *pToRemove);
 	void RemoveFromUpdate(Object *pToRemove, int xUpdate, int yUpdate);
+
+	//refile an object that has moved without leaving the update list
+	void UpdateCell(Object *pToUpdate);
+	//empty the cells after the update lists have been thrown away
+	void ClearCells();
 	
 	void MakeWater(BOOL Vert);
 	void UnOccupyRegions();
@@ -218,6 +276,8 @@ public:
 	void SaveStaticHeader(FILE *fp, STATIC_FILE_HEADER_T *pSource);
 
 	void IllegalActivity(Object *pLawBreaker);
+
+	void OutputLoadStats(FILE *fp);
   
 // Constructors ---------------------------------------
 	Area();
@@ -233,7 +293,12 @@ public:
 	int AddOverlay(int x, int y, int num);
 
 // Editting
-	int GenerateBase(RECT *rArea);
+	//rDirty, in the units of rArea, rebakes only the chunks it touches and
+	//keeps the rest of the last world.bin.  NumThreads 0 uses every processor
+	int GenerateBase(RECT *rArea, RECT *rDirty = NULL, int NumThreads = 0);
+	//bakes on one thread and again on all of them, TRUE if the two
+	//world.bins match byte for byte
+	BOOL CheckBase(RECT *rArea);
 	void GenerateTerrain(RECT *rArea);
 	void SmoothBaseTerrain();
 	void ReBlock(RECT *rArea);
@@ -259,6 +324,9 @@ public:
 // Operators ------------------------------------------
 	friend class World;
 	friend class Combat;
+	friend class PathGraph;
+	friend class ChunkStreamer;
+	friend class ChunkResidency;
 
 };
 
@@ -0,0 +1,407 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				assetregistry.cpp				  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed name and pointer lookups over the engine's meshes
+//*			 and textures and the sound system's effects
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#include "assetregistry.h"
+#include "zsengine.h"
+#include "zsutilities.h"
+#include "profiler.h"
+
+//************** Constructors  ****************************************
+
+AssetRegistry::AssetRegistry(const char *NewKind)
+{
+	strncpy(Kind, NewKind, sizeof(Kind) - 1);
+	Kind[sizeof(Kind) - 1] = '\0';
+	NumEntries = 0;
+	MaxEntries = 0;
+	Entries = NULL;
+	ClearStats();
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+AssetRegistry::~AssetRegistry()
+{
+	Clear();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+int AssetRegistry::Find(const char *Name)
+{
+	ProfileZone Zone(ZONE_ASSET_LOOKUP);
+	unsigned int Hash;
+	int Slot;
+	int n;
+
+	InterlockedIncrement(&NumLookups);
+
+	if(Name)
+	{
+		Hash = HashString(Name);
+		for(Slot = NameTable.First(Hash); (n = NameTable.Get(Slot)) != HASH_EMPTY; Slot = NameTable.Next(Slot))
+		{
+			if(Entries[n].Hash == Hash && !strcmp(Entries[n].Name, Name))
+			{
+				return n;
+			}
+		}
+	}
+
+	InterlockedIncrement(&NumMisses);
+	return ASSET_NONE;
+}
+
+int AssetRegistry::Find(const void *pAsset)
+{
+	ProfileZone Zone(ZONE_ASSET_LOOKUP);
+	int Slot;
+	int n;
+
+	InterlockedIncrement(&NumReverseLookups);
+
+	if(pAsset)
+	{
+		for(Slot = AssetTable.First(HashPointer(pAsset)); (n = AssetTable.Get(Slot)) != HASH_EMPTY; Slot = AssetTable.Next(Slot))
+		{
+			if(Entries[n].pAsset == pAsset)
+			{
+				return n;
+			}
+		}
+	}
+
+	InterlockedIncrement(&NumMisses);
+	return ASSET_NONE;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void AssetRegistry::Reset(int NumAssets)
+{
+	if(NumAssets > MaxEntries)
+	{
+		if(Entries)
+		{
+			delete[] Entries;
+		}
+		MaxEntries = NumAssets;
+		Entries = new ASSET_ENTRY_T[MaxEntries];
+	}
+
+	NameTable.Reset(NumAssets);
+	AssetTable.Reset(NumAssets);
+
+	NumEntries = 0;
+}
+
+int AssetRegistry::Add(const char *Name, void *pAsset)
+{
+	ASSET_ENTRY_T *pEntry;
+	int Slot;
+	int n;
+
+	if(NumEntries >= MaxEntries || NumEntries * 2 >= NameTable.GetSize())
+	{
+		SafeExit("Asset registry reset too small");
+	}
+
+	n = NumEntries++;
+	pEntry = &Entries[n];
+	pEntry->pAsset = pAsset;
+	pEntry->Name[0] = '\0';
+	pEntry->Hash = 0;
+
+	//a name already taken keeps pointing at the first with it
+	if(Name)
+	{
+		strncpy(pEntry->Name, Name, ASSET_NAME_LENGTH - 1);
+		pEntry->Name[ASSET_NAME_LENGTH - 1] = '\0';
+		pEntry->Hash = HashString(pEntry->Name);
+
+		Slot = NameTable.First(pEntry->Hash);
+		while(NameTable.Get(Slot) != HASH_EMPTY &&
+			(Entries[NameTable.Get(Slot)].Hash != pEntry->Hash ||
+			strcmp(Entries[NameTable.Get(Slot)].Name, pEntry->Name)))
+		{
+			Slot = NameTable.Next(Slot);
+		}
+		if(NameTable.Get(Slot) == HASH_EMPTY)
+		{
+			NameTable.Set(Slot, n);
+		}
+	}
+
+	if(pAsset)
+	{
+		Slot = AssetTable.First(HashPointer(pAsset));
+		while(AssetTable.Get(Slot) != HASH_EMPTY && Entries[AssetTable.Get(Slot)].pAsset != pAsset)
+		{
+			Slot = AssetTable.Next(Slot);
+		}
+		if(AssetTable.Get(Slot) == HASH_EMPTY)
+		{
+			AssetTable.Set(Slot, n);
+		}
+	}
+
+	return n;
+}
+
+void AssetRegistry::Clear()
+{
+	if(Entries)
+	{
+		delete[] Entries;
+		Entries = NULL;
+	}
+	NameTable.Clear();
+	AssetTable.Clear();
+	NumEntries = 0;
+	MaxEntries = 0;
+}
+
+void AssetRegistry::ClearStats()
+{
+	NumLookups = 0;
+	NumMisses = 0;
+	NumReverseLookups = 0;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Output **************************************************
+
+void AssetRegistry::OutputStats(FILE *fp)
+{
+	fprintf(fp,"%-12s%i entries, %li by name, %li by pointer, %li missed\n",
+		Kind, NumEntries, (long)NumLookups, (long)NumReverseLookups, (long)NumMisses);
+}
+
+//end: Output **********************************************************
+
+
+
+//************ Debug ***************************************************
+
+//what ZSEngine::GetMeshNum and GetTextureNum did before the registry
+static int WalkMeshName(const char *Name)
+{
+	int n;
+
+	for(n = 0; n < Engine->GetNumMesh(); n++)
+	{
+		if(Engine->GetMesh(n) && !strcmp(Name, Engine->GetMesh(n)->GetName()))
+		{
+			return n;
+		}
+	}
+	return 0;
+}
+
+static int WalkMesh(ZSModelEx *pMesh)
+{
+	int n;
+
+	for(n = 0; n < Engine->GetNumMesh(); n++)
+	{
+		if(Engine->GetMesh(n) == pMesh)
+		{
+			return n;
+		}
+	}
+	return 0;
+}
+
+static int WalkTextureName(const char *Name)
+{
+	char Full[64];
+	int n;
+
+	strncpy(Full, Name, sizeof(Full) - 5);
+	Full[sizeof(Full) - 5] = '\0';
+	strcat(Full, ".bmp");
+	for(n = 0; n < Engine->GetNumTextures(); n++)
+	{
+		if(!strcmp(Full, Engine->GetTexture(n)->GetName()))
+		{
+			return n;
+		}
+	}
+	return 0;
+}
+
+static int WalkTexture(ZSTexture *pTexture)
+{
+	int n;
+
+	for(n = 0; n < Engine->GetNumTextures(); n++)
+	{
+		if(Engine->GetTexture(n) == pTexture)
+		{
+			return n;
+		}
+	}
+	return 0;
+}
+
+int BenchmarkAssetLookup(FILE *fpResults)
+{
+	ZSModelEx *pMesh;
+	ZSTexture *pTexture;
+	char Stem[64];
+	char *pC;
+	int NumLookups = 0;
+	int NumMismatches = 0;
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double WalkTime = 0.0;
+	double HashTime = 0.0;
+	int Walked;
+	int Hashed;
+	int n;
+
+	QueryPerformanceFrequency(&Frequency);
+
+	for(n = 0; n < Engine->GetNumMesh(); n++)
+	{
+		pMesh = Engine->GetMesh(n);
+		if(!pMesh)
+		{
+			continue;
+		}
+
+		QueryPerformanceCounter(&Start);
+		Walked = WalkMeshName(pMesh->GetName());
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		Hashed = Engine->GetMeshNum(pMesh->GetName());
+		QueryPerformanceCounter(&End);
+		HashTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(Walked != Hashed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"mesh %s: walk and registry disagree\n",pMesh->GetName());
+			}
+		}
+
+		QueryPerformanceCounter(&Start);
+		Walked = WalkMesh(pMesh);
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		Hashed = Engine->GetMeshNum(pMesh);
+		QueryPerformanceCounter(&End);
+		HashTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(Walked != Hashed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"mesh %i: walk and registry disagree\n",n);
+			}
+		}
+
+		NumLookups += 2;
+	}
+
+	for(n = 0; n < Engine->GetNumTextures(); n++)
+	{
+		pTexture = Engine->GetTexture(n);
+		strncpy(Stem, pTexture->GetName(), sizeof(Stem) - 1);
+		Stem[sizeof(Stem) - 1] = '\0';
+		pC = strrchr(Stem,'.');
+		if(pC)
+		{
+			*pC = '\0';
+		}
+
+		QueryPerformanceCounter(&Start);
+		Walked = WalkTextureName(Stem);
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		Hashed = Engine->GetTextureNum(Stem);
+		QueryPerformanceCounter(&End);
+		HashTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(Walked != Hashed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"texture %s: walk and registry disagree\n",Stem);
+			}
+		}
+
+		QueryPerformanceCounter(&Start);
+		Walked = WalkTexture(pTexture);
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		Hashed = Engine->GetTextureNum(pTexture);
+		QueryPerformanceCounter(&End);
+		HashTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(Walked != Hashed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"texture %i: walk and registry disagree\n",n);
+			}
+		}
+
+		NumLookups += 2;
+	}
+
+	if(fpResults && NumLookups)
+	{
+		WalkTime = WalkTime * 1000000.0 / (double)Frequency.QuadPart;
+		HashTime = HashTime * 1000000.0 / (double)Frequency.QuadPart;
+		fprintf(fpResults,"%i asset lookups, %i mismatches\n",NumLookups,NumMismatches);
+		fprintf(fpResults,"walk: total %.1f us, average %.3f us\n",WalkTime,WalkTime / (double)NumLookups);
+		fprintf(fpResults,"registry: total %.1f us, average %.3f us\n",HashTime,HashTime / (double)NumLookups);
+	}
+
+	return NumMismatches;
+}
+
+//end: Debug ***********************************************************
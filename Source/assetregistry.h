@@ -0,0 +1,113 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				assetregistry.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed name and pointer lookups over the engine's meshes
+//*			 and textures and the sound system's effects
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		the owner has to index its list again whenever the list or a
+//*		name in it changes
+//*********************************************************************
+//*********************************************************************
+#ifndef ASSETREGISTRY_H
+#define ASSETREGISTRY_H
+
+#include <windows.h>
+#include <stdio.h>
+#include "hashindex.h"
+
+//preprocessor defs ***********************************************
+
+//the longest name any of the lists hold, sound effects, plus one
+#define ASSET_NAME_LENGTH		48
+#define ASSET_NONE				HASH_EMPTY
+
+typedef struct
+{
+	char Name[ASSET_NAME_LENGTH];
+	unsigned int Hash;
+	void *pAsset;
+} ASSET_ENTRY_T;
+
+//*******************************CLASS********************************
+//**************          AssetRegistry          *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Interns the names of a list of assets.  An asset's handle
+//*			 is its place in the owner's list, which is also what saved
+//*			 games already store as MeshNum and TextureNum, so handles
+//*			 stay good from one run to the next while mesh.bin and
+//*			 textures.txt keep their order.  Where names repeat the
+//*			 first in the list wins, as the old walks did.
+//********************************************************************
+//*Invariants: lookups only read, so any thread may make them once the
+//*				 owner has finished indexing
+//********************************************************************
+class AssetRegistry
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	char Kind[16];
+
+	int NumEntries;
+	int MaxEntries;
+	ASSET_ENTRY_T *Entries;
+
+	HashIndex NameTable;
+	HashIndex AssetTable;
+
+	volatile LONG NumLookups;
+	volatile LONG NumMisses;
+	volatile LONG NumReverseLookups;
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	//ASSET_NONE if nothing has that name or is that asset
+	int Find(const char *Name);
+	int Find(const void *pAsset);
+
+	void *GetAsset(int Handle) { return Entries[Handle].pAsset; }
+	const char *GetName(int Handle) { return Entries[Handle].Name; }
+	int GetNumEntries() { return NumEntries; }
+
+	LONG GetNumLookups() { return NumLookups; }
+	LONG GetNumMisses() { return NumMisses; }
+	LONG GetNumReverseLookups() { return NumReverseLookups; }
+
+// Mutators -----------------------------------------
+	//empties the registry and makes room for NumAssets
+	void Reset(int NumAssets);
+	//the next handle in order.  A NULL name or asset keeps its place
+	//without being found by it
+	int Add(const char *Name, void *pAsset);
+
+	void Clear();
+	void ClearStats();
+
+// Output ---------------------------------------------
+	//a line of counts
+	void OutputStats(FILE *fp);
+
+// Constructors ---------------------------------------
+	AssetRegistry(const char *NewKind);
+
+// Destructor -----------------------------------------
+	~AssetRegistry();
+
+};
+
+//time every mesh and texture lookup by name and pointer against a walk
+//of the engine's lists, returns the number that disagree
+int BenchmarkAssetLookup(FILE *fpResults);
+
+#endif
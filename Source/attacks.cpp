@@ -9,6 +9,7 @@
 #include "zsWeapontrace.h"
 #include "missile.h"
 #include "items.h"
+#include "replay.h"
 
 
 //calculate base chance of succes with an attack, before any modifiers based on the type of attack
@@ -150,7 +151,7 @@ BOOL Parried(Creature *pAttacker, Creature *pDefender)
 			//chance % is (defender's armor skill - (attacker's skill - defender's armor skill))/2
 			int BlockPercent  = (pDefender->GetData(INDEX_ARMOR).Value - (pAttacker->GetWeaponSkill() - pDefender->GetData(INDEX_ARMOR).Value))/2;
 			BlockPercent += pGIShield->GetData("MAXDAMAGE").Value;
-			int BlockRoll = rand() % 100;
+			int BlockRoll = GameRand() % 100;
 			if(BlockRoll < BlockPercent)
 			{
 				//do shield blocked result
@@ -168,7 +169,7 @@ BOOL Parried(Creature *pAttacker, Creature *pDefender)
 			{
 			//off hand weapon used for parrying
 				int BlockPercent = ((pDefender->GetData(INDEX_ARMOR).Value - (pAttacker->GetWeaponSkill() - pDefender->GetData(INDEX_ARMOR).Value))/2) / 3;
-				int BlockRoll = rand() % 100;
+				int BlockRoll = GameRand() % 100;
 				if(BlockRoll < BlockPercent)
 				{
 					//do shield blocked result
@@ -213,7 +214,7 @@ BOOL Parried(Creature *pAttacker, Creature *pDefender)
 				ParryPercent += 10;
 			}
 
-			ParryRoll = rand() % 100;
+			ParryRoll = GameRand() % 100;
 /*
 #ifndef NDEBUG
 	sprintf(Blarg,"Parry change: %i  and parry roll: %i\n",ParryPercent, ParryRoll);
@@ -360,7 +361,7 @@ do
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -432,7 +433,7 @@ do
 	{
 		Engine->Sound()->PlayEffect(10);
 	}
-	AdditionalRoll = rand() % 100;
+	AdditionalRoll = GameRand() % 100;
 }while(AdditionalRoll < AdditionalChance && pDefender->GetData(INDEX_HITPOINTS).Value > 0 && PreludeWorld->InCombat());
 
 	if(NumHits <= 0)
@@ -545,7 +546,7 @@ while(pOb)
 		//penalty per opponent or so 
 		NumAttacks += 40;
 		
-		AttackRoll = rand() % 100;
+		AttackRoll = GameRand() % 100;
 
 		if(pCreature->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 		{
@@ -713,7 +714,7 @@ void RendAttack(Creature *pAttacker, Creature *pDefender)
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -898,7 +899,7 @@ void BrainAttack(Creature *pAttacker, Creature *pDefender)
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -972,7 +973,7 @@ void BrainAttack(Creature *pAttacker, Creature *pDefender)
 			int APLost;
 			int HalfBase;
 			HalfBase = (BaseDamage + 1) / 2;
-			APLost = (rand() % HalfBase) + HalfBase;
+			APLost = (GameRand() % HalfBase) + HalfBase;
 
 			pDefender->SetData(INDEX_ACTIONPOINTS, pDefender->GetData(INDEX_ACTIONPOINTS).Value - APLost);
 			char blarg[64];
@@ -1166,7 +1167,7 @@ while(pOb)
 		//penalty per opponent or so 
 		NumAttacks += 40;
 		
-		AttackRoll = rand() % 100;
+		AttackRoll = GameRand() % 100;
 
 		if(pCreature->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 		{
@@ -1470,7 +1471,7 @@ void TargettedAttack(Creature *pAttacker, Creature *pDefender)
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -1509,7 +1510,7 @@ void TargettedAttack(Creature *pAttacker, Creature *pDefender)
 			{
 				AmmoRange += (pItem->GetData("MAXDAMAGE").Value - pItem->GetData("MINDAMAGE").Value);
 				AmmoMin = pItem->GetData("MINDAMAGE").Value;
-				AmmoDamage = rand() % AmmoRange + AmmoMin;
+				AmmoDamage = GameRand() % AmmoRange + AmmoMin;
 			}
 
 			pAttacker->SetAmmoItemNumber(0);
@@ -1517,10 +1518,10 @@ void TargettedAttack(Creature *pAttacker, Creature *pDefender)
 
 		BaseDamage = pAttacker->GetDamage(FALSE) + AmmoDamage;
 
-		if(rand() % 100 < (pAttacker->GetWeaponSkill() / 3))
+		if(GameRand() % 100 < (pAttacker->GetWeaponSkill() / 3))
 		{
 			if(BaseDamage < 5) 
-				BaseDamage = 3 + (rand() % 3) + 1;
+				BaseDamage = 3 + (GameRand() % 3) + 1;
 			BaseDamage *= 1.5;
 			
 			char blargsuccess[64];
@@ -1568,7 +1569,7 @@ void TargettedAttack(Creature *pAttacker, Creature *pDefender)
 			}
 		}
 
-		pDefender->SetData(INDEX_MOVEPOINTS,pDefender->GetData(INDEX_MOVEPOINTS).Value + 1 + rand() % 3);
+		pDefender->SetData(INDEX_MOVEPOINTS,pDefender->GetData(INDEX_MOVEPOINTS).Value + 1 + GameRand() % 3);
 	
 		pDefender->TakeDamage(pAttacker,BaseDamage,(DAMAGE_T)pAttacker->GetData(INDEX_DAMAGETYPE).Value);
 
@@ -1705,7 +1706,7 @@ void DisarmAttack(Creature *pAttacker, Creature *pDefender)
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -1847,7 +1848,7 @@ int AbsorbBlow(Creature *pAttacker, Creature *pDefender, int Damage, int AbsorbM
 
 	//check for armor absorbtion
 	//calculate where blow landed
-	int BlowLandedRoll = rand() % 100;
+	int BlowLandedRoll = GameRand() % 100;
 	int BlowLanded = BLOW_LANDED_HEAD;
 	int ArmorNumber = 0;
 
@@ -1931,7 +1932,7 @@ int AbsorbBlow(Creature *pAttacker, Creature *pDefender, int Damage, int AbsorbM
 */				
 		if(AbsorbRange)
 		{
-			AbsorbAmount = rand() % AbsorbRange + pGIArmor->GetData("ARMORMIN").Value;
+			AbsorbAmount = GameRand() % AbsorbRange + pGIArmor->GetData("ARMORMIN").Value;
 		}
 
 		AbsorbAmount = (AbsorbAmount * AbsorbModifier) / 100;
@@ -0,0 +1,418 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				bakegraph.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  runs the stages of a world bake tile by tile on every
+//*			 processor, each tile starting as soon as the neighbours it
+//*			 reads have finished the stage before
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		a stage's jobs may only write their own tile.  anything shared
+//*		they call has to be safe from several threads at once
+//*********************************************************************
+//*********************************************************************
+#include "bakegraph.h"
+#include "zsutilities.h"
+#include "workerpool.h"
+#include <string.h>
+
+#define BAKE_COMPARE_BLOCK		65536
+
+static void ClipRect(RECT *pRect, int Width, int Height)
+{
+	if(pRect->left < 0) pRect->left = 0;
+	if(pRect->top < 0) pRect->top = 0;
+	if(pRect->right > Width) pRect->right = Width;
+	if(pRect->bottom > Height) pRect->bottom = Height;
+}
+
+//************** Constructors  ****************************************
+
+BakeGraph::BakeGraph(int NewWidth, int NewHeight)
+{
+	Width = NewWidth;
+	Height = NewHeight;
+	NumStages = 0;
+	memset(Stages, 0, sizeof(Stages));
+	Waiting = NULL;
+	Queue = NULL;
+	QueueHead = 0;
+	QueueTail = 0;
+	NumJobs = 0;
+	NumDone = 0;
+	pJobData = NULL;
+
+	InitializeCriticalSection(&csQueue);
+	hWake = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	SetThreads(0);
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+BakeGraph::~BakeGraph()
+{
+	CloseHandle(hWake);
+	DeleteCriticalSection(&csQueue);
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+DWORD BakeGraph::Seed(int TileX, int TileY)
+{
+	DWORD Seed;
+
+	//mixed so the tiles next to each other don't start on states next
+	//to each other
+	Seed = ((DWORD)TileX * 73856093 ^ (DWORD)TileY * 19349663) & 0xffffffff;
+	Seed = (Seed ^ (Seed >> 16)) * 0x7feb352d & 0xffffffff;
+	Seed = (Seed ^ (Seed >> 15)) * 0x846ca68b & 0xffffffff;
+	return Seed ^ (Seed >> 16);
+}
+
+int BakeGraph::Rand(DWORD *pState)
+{
+	*pState = (*pState * 214013 + 2531011) & 0xffffffff;
+	return (int)((*pState >> 16) & BAKE_RAND_MAX);
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+int BakeGraph::AddStage(const char *Name, BAKE_JOB_T Job, int Halo)
+{
+	BAKE_STAGE_T *pStage;
+
+	if(NumStages >= BAKE_MAX_STAGES)
+	{
+		SafeExit("too many bake stages\n");
+	}
+
+	pStage = &Stages[NumStages];
+	memset(pStage, 0, sizeof(BAKE_STAGE_T));
+	strncpy(pStage->Name, Name, sizeof(pStage->Name) - 1);
+	pStage->Job = Job;
+	pStage->Halo = NumStages ? Halo : 0;
+
+	return NumStages++;
+}
+
+void BakeGraph::SetThreads(int NumThreads)
+{
+	if(NumThreads < 1 || NumThreads > PreludeWorkers.GetNumThreads())
+	{
+		NumThreads = PreludeWorkers.GetNumThreads();
+	}
+	if(NumThreads > BAKE_MAX_THREADS)
+	{
+		NumThreads = BAKE_MAX_THREADS;
+	}
+	if(NumThreads < 1)
+	{
+		NumThreads = 1;
+	}
+	NumWorkers = NumThreads;
+}
+
+void BakeGraph::Run(RECT *rTiles, void *pData)
+{
+	RECT rStage;
+	int Halo;
+	int Count;
+	int sn;
+	int xn, yn;
+	int nx, ny;
+
+	if(!NumStages)
+	{
+		return;
+	}
+
+	//the last stage runs what was asked for, each stage before it as far
+	//again as the next one reaches
+	if(rTiles)
+	{
+		rStage = *rTiles;
+	}
+	else
+	{
+		rStage.left = 0;
+		rStage.top = 0;
+		rStage.right = Width;
+		rStage.bottom = Height;
+	}
+	ClipRect(&rStage, Width, Height);
+
+	for(sn = NumStages - 1; sn >= 0; sn--)
+	{
+		Stages[sn].rActive = rStage;
+		Stages[sn].NumJobs = 0;
+		Stages[sn].Busy = 0;
+		Stages[sn].Start = 0;
+		Stages[sn].End = 0;
+
+		rStage.left -= Stages[sn].Halo;
+		rStage.top -= Stages[sn].Halo;
+		rStage.right += Stages[sn].Halo;
+		rStage.bottom += Stages[sn].Halo;
+		ClipRect(&rStage, Width, Height);
+	}
+
+	if(Stages[NumStages - 1].rActive.left >= Stages[NumStages - 1].rActive.right ||
+		Stages[NumStages - 1].rActive.top >= Stages[NumStages - 1].rActive.bottom)
+	{
+		return;
+	}
+
+	Waiting = new int[NumStages * Width * Height];
+	memset(Waiting, 0, sizeof(int) * NumStages * Width * Height);
+
+	NumJobs = 0;
+	for(sn = 0; sn < NumStages; sn++)
+	{
+		rStage = Stages[sn].rActive;
+		Stages[sn].NumJobs = (rStage.right - rStage.left) * (rStage.bottom - rStage.top);
+		NumJobs += Stages[sn].NumJobs;
+
+		if(!sn)
+		{
+			continue;
+		}
+
+		//what each tile waits for from the stage before
+		Halo = Stages[sn].Halo;
+		for(yn = rStage.top; yn < rStage.bottom; yn++)
+		for(xn = rStage.left; xn < rStage.right; xn++)
+		{
+			Count = 0;
+			for(ny = yn - Halo; ny <= yn + Halo; ny++)
+			for(nx = xn - Halo; nx <= xn + Halo; nx++)
+			{
+				if(nx >= Stages[sn - 1].rActive.left && nx < Stages[sn - 1].rActive.right &&
+					ny >= Stages[sn - 1].rActive.top && ny < Stages[sn - 1].rActive.bottom)
+				{
+					Count++;
+				}
+			}
+			Waiting[sn * Width * Height + xn + yn * Width] = Count;
+		}
+	}
+
+	Queue = new int[NumJobs];
+	QueueHead = 0;
+	QueueTail = 0;
+	NumDone = 0;
+	pJobData = pData;
+
+	rStage = Stages[0].rActive;
+	for(yn = rStage.top; yn < rStage.bottom; yn++)
+	for(xn = rStage.left; xn < rStage.right; xn++)
+	{
+		Queue[QueueTail++] = xn + yn * Width;
+	}
+	SetEvent(hWake);
+
+	//a worker loop per pool job.  if the pool is busy they run one after
+	//another on this thread, the first does every tile and the rest find
+	//nothing left
+	PreludeWorkers.Run(WorkerJob, this, NumWorkers);
+
+	delete[] Queue;
+	Queue = NULL;
+	delete[] Waiting;
+	Waiting = NULL;
+	pJobData = NULL;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************  Workers  ***********************************************
+
+void BakeGraph::WorkerJob(int Worker, void *pGraph)
+{
+	((BakeGraph *)pGraph)->WorkerLoop(Worker);
+}
+
+void BakeGraph::WorkerLoop(int Worker)
+{
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	int Job;
+	int Stage;
+	int TileX;
+	int TileY;
+
+	while(TRUE)
+	{
+		EnterCriticalSection(&csQueue);
+		if(NumDone == NumJobs)
+		{
+			LeaveCriticalSection(&csQueue);
+			return;
+		}
+		if(QueueHead == QueueTail)
+		{
+			//whoever queues the next job sets it again
+			ResetEvent(hWake);
+			LeaveCriticalSection(&csQueue);
+			WaitForSingleObject(hWake, INFINITE);
+			continue;
+		}
+		Job = Queue[QueueHead++];
+		LeaveCriticalSection(&csQueue);
+
+		Stage = Job / (Width * Height);
+		TileX = (Job % (Width * Height)) % Width;
+		TileY = (Job % (Width * Height)) / Width;
+
+		QueryPerformanceCounter(&Start);
+		Stages[Stage].Job(Stage, TileX, TileY, Worker, pJobData);
+		QueryPerformanceCounter(&End);
+
+		EnterCriticalSection(&csQueue);
+		Finish(Stage, TileX, TileY, Start.QuadPart, End.QuadPart);
+		if(QueueHead != QueueTail || NumDone == NumJobs)
+		{
+			SetEvent(hWake);
+		}
+		LeaveCriticalSection(&csQueue);
+	}
+}
+
+void BakeGraph::Finish(int Stage, int TileX, int TileY, LONGLONG Start, LONGLONG End)
+{
+	BAKE_STAGE_T *pStage;
+	BAKE_STAGE_T *pNext;
+	int *pWaiting;
+	int Halo;
+	int xn, yn;
+
+	pStage = &Stages[Stage];
+	pStage->Busy += End - Start;
+	if(!pStage->Start || Start < pStage->Start)
+	{
+		pStage->Start = Start;
+	}
+	if(End > pStage->End)
+	{
+		pStage->End = End;
+	}
+	NumDone++;
+
+	if(Stage + 1 >= NumStages)
+	{
+		return;
+	}
+
+	pNext = &Stages[Stage + 1];
+	pWaiting = &Waiting[(Stage + 1) * Width * Height];
+	Halo = pNext->Halo;
+	for(yn = TileY - Halo; yn <= TileY + Halo; yn++)
+	for(xn = TileX - Halo; xn <= TileX + Halo; xn++)
+	{
+		if(xn >= pNext->rActive.left && xn < pNext->rActive.right &&
+			yn >= pNext->rActive.top && yn < pNext->rActive.bottom)
+		{
+			pWaiting[xn + yn * Width]--;
+			if(!pWaiting[xn + yn * Width])
+			{
+				Queue[QueueTail++] = (Stage + 1) * Width * Height + xn + yn * Width;
+			}
+		}
+	}
+}
+
+//end: Workers *********************************************************
+
+
+
+//************  Output  ************************************************
+
+void BakeGraph::LogTimes()
+{
+	LARGE_INTEGER Frequency;
+	double ToMS;
+	int sn;
+
+	QueryPerformanceFrequency(&Frequency);
+	ToMS = 1000.0 / (double)Frequency.QuadPart;
+
+	for(sn = 0; sn < NumStages; sn++)
+	{
+		LogPrintf(LOG_INFO, LOG_WORLD, "bake %-12s %6i tiles %10.2f ms busy %10.2f ms start to end, %i threads",
+			Stages[sn].Name,
+			Stages[sn].NumJobs,
+			(double)Stages[sn].Busy * ToMS,
+			(double)(Stages[sn].End - Stages[sn].Start) * ToMS,
+			NumWorkers);
+	}
+}
+
+BOOL BakeCompareFiles(const char *FileA, const char *FileB)
+{
+	FILE *fpA;
+	FILE *fpB;
+	BYTE *BlockA;
+	BYTE *BlockB;
+	size_t LengthA;
+	size_t LengthB;
+	long Offset;
+	BOOL Same;
+
+	fpA = fopen(FileA, "rb");
+	fpB = fopen(FileB, "rb");
+	if(!fpA || !fpB)
+	{
+		if(fpA) fclose(fpA);
+		if(fpB) fclose(fpB);
+		LogPrintf(LOG_WARNING, LOG_WORLD, "can't compare %s with %s", FileA, FileB);
+		return FALSE;
+	}
+
+	BlockA = new BYTE[BAKE_COMPARE_BLOCK];
+	BlockB = new BYTE[BAKE_COMPARE_BLOCK];
+	Offset = 0;
+	Same = TRUE;
+	do
+	{
+		LengthA = fread(BlockA, 1, BAKE_COMPARE_BLOCK, fpA);
+		LengthB = fread(BlockB, 1, BAKE_COMPARE_BLOCK, fpB);
+		if(LengthA != LengthB || memcmp(BlockA, BlockB, LengthA))
+		{
+			Same = FALSE;
+			break;
+		}
+		Offset += (long)LengthA;
+	} while(LengthA == BAKE_COMPARE_BLOCK);
+
+	delete[] BlockA;
+	delete[] BlockB;
+	fclose(fpA);
+	fclose(fpB);
+
+	if(!Same)
+	{
+		LogPrintf(LOG_WARNING, LOG_WORLD, "%s and %s differ within %i bytes of %li", FileA, FileB, BAKE_COMPARE_BLOCK, Offset);
+	}
+	return Same;
+}
+
+//end: Output **********************************************************
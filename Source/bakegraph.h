@@ -0,0 +1,139 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				bakegraph.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  runs the stages of a world bake tile by tile on the worker
+//*			 pool, each tile starting as soon as the neighbours it
+//*			 reads have finished the stage before
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		a stage's jobs may only write their own tile.  anything shared
+//*		they call has to be safe from several threads at once
+//*		only Area::GenerateBase bakes on it so far.  GenerateTerrain,
+//*		SmoothBaseTerrain, MakeWater, ReBlock and RegionObjects still
+//*		go a chunk at a time on the calling thread, drawing on rand()
+//*********************************************************************
+//*********************************************************************
+#ifndef BAKEGRAPH_H
+#define BAKEGRAPH_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define BAKE_MAX_THREADS		16
+#define BAKE_MAX_STAGES			4
+//Rand returns 0 to BAKE_RAND_MAX, the same on every build
+#define BAKE_RAND_MAX			0x7fff
+
+//Stage is the stage's index, Worker which thread runs it, from 0 to
+//GetNumWorkers() - 1, for anything a job needs its own copy of
+typedef void (*BAKE_JOB_T)(int Stage, int TileX, int TileY, int Worker, void *pData);
+
+typedef struct
+{
+	char Name[32];
+	BAKE_JOB_T Job;
+	//how many tiles out a job reads the stage before's results
+	int Halo;
+	//tiles run, in tiles
+	RECT rActive;
+	int NumJobs;
+	//summed over every job, and from the first start to the last finish
+	LONGLONG Busy;
+	LONGLONG Start;
+	LONGLONG End;
+} BAKE_STAGE_T;
+
+//*******************************CLASS********************************
+//**************          BakeGraph              *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  A grid of tiles and the stages each one goes through.  A
+//*			 tile's job for a stage waits for every tile within that
+//*			 stage's halo to finish the stage before, so it never reads
+//*			 a neighbour half done or has a neighbour read it half done.
+//*			 The order jobs finish in changes with the number of
+//*			 threads, what they write does not.
+//********************************************************************
+//*Invariants: Waiting, the queue and the counts are only touched
+//*				 inside csQueue while Run is going
+//********************************************************************
+class BakeGraph
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	int Width;
+	int Height;
+	int NumStages;
+	BAKE_STAGE_T Stages[BAKE_MAX_STAGES];
+	int NumWorkers;
+
+	//jobs still waiting on neighbours, a grid per stage
+	int *Waiting;
+	//jobs ready to run, each one goes in once so it never wraps
+	int *Queue;
+	int QueueHead;
+	int QueueTail;
+	int NumJobs;
+	int NumDone;
+	void *pJobData;
+
+	CRITICAL_SECTION csQueue;
+	//set while there is a job to take or nothing left to do
+	HANDLE hWake;
+
+	static void WorkerJob(int Worker, void *pGraph);
+	void WorkerLoop(int Worker);
+	//csQueue must be held
+	void Finish(int Stage, int TileX, int TileY, LONGLONG Start, LONGLONG End);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetNumStages() { return NumStages; }
+	int GetNumWorkers() { return NumWorkers; }
+	BAKE_STAGE_T *GetStage(int Stage) { return &Stages[Stage]; }
+
+	//the same tile always gets the same seed
+	static DWORD Seed(int TileX, int TileY);
+	//GameRand's generator on a state of the caller's own
+	static int Rand(DWORD *pState);
+
+// Mutators -----------------------------------------
+	//Halo is ignored for the first stage
+	int AddStage(const char *Name, BAKE_JOB_T Job, int Halo);
+
+	//threads to use, 0 for all of the worker pool's.  1 runs every job
+	//on the calling thread
+	void SetThreads(int NumThreads);
+
+	//runs the tiles of the last stage inside rTiles, NULL for all of
+	//them, and whatever earlier tiles they need
+	void Run(RECT *rTiles, void *pData);
+
+// Output ---------------------------------------------
+	//a line per stage
+	void LogTimes();
+
+// Constructors ---------------------------------------
+	BakeGraph(int NewWidth, int NewHeight);
+
+// Destructor -----------------------------------------
+	~BakeGraph();
+
+};
+
+//TRUE if the two files hold the same bytes
+BOOL BakeCompareFiles(const char *FileA, const char *FileB);
+
+#endif
@@ -0,0 +1,290 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				chunkresidency.cpp				  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  keep track of which chunks of an area are in memory and
+//*			 unload the least recently used ones
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		editor functions that empty BigMap directly are noticed lazily,
+//*		the first time Update passes over the emptied slot
+//*********************************************************************
+//*********************************************************************
+#include "chunkresidency.h"
+#include "area.h"
+#include <mmsystem.h>
+
+//************** Constructors  ****************************************
+
+ChunkResidency::ChunkResidency(Area *pNewArea, int NewChunkWidth, int NewChunkHeight, int NewBudget)
+{
+	int n;
+
+	pArea = pNewArea;
+	ChunkWidth = NewChunkWidth;
+	ChunkHeight = NewChunkHeight;
+	NumChunks = ChunkWidth * ChunkHeight;
+
+	Prev = new int[NumChunks];
+	Next = new int[NumChunks];
+	Listed = new BOOL[NumChunks];
+	LastUsed = new DWORD[NumChunks];
+	Bytes = new int[NumChunks];
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		Prev[n] = RESIDENCY_NONE;
+		Next[n] = RESIDENCY_NONE;
+		Listed[n] = FALSE;
+		LastUsed[n] = 0;
+		Bytes[n] = 0;
+	}
+
+	Head = RESIDENCY_NONE;
+	Tail = RESIDENCY_NONE;
+	NumResident = 0;
+	ResidentBytes = 0;
+	Budget = NewBudget;
+	Pinned = FALSE;
+	NumEvicted = 0;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+ChunkResidency::~ChunkResidency()
+{
+	delete[] Prev;
+	delete[] Next;
+	delete[] Listed;
+	delete[] LastUsed;
+	delete[] Bytes;
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void ChunkResidency::Link(int Index)
+{
+	Prev[Index] = RESIDENCY_NONE;
+	Next[Index] = Head;
+	if(Head != RESIDENCY_NONE)
+	{
+		Prev[Head] = Index;
+	}
+	Head = Index;
+	if(Tail == RESIDENCY_NONE)
+	{
+		Tail = Index;
+	}
+}
+
+void ChunkResidency::Unlink(int Index)
+{
+	if(Prev[Index] != RESIDENCY_NONE)
+	{
+		Next[Prev[Index]] = Next[Index];
+	}
+	else
+	{
+		Head = Next[Index];
+	}
+
+	if(Next[Index] != RESIDENCY_NONE)
+	{
+		Prev[Next[Index]] = Prev[Index];
+	}
+	else
+	{
+		Tail = Prev[Index];
+	}
+
+	Prev[Index] = RESIDENCY_NONE;
+	Next[Index] = RESIDENCY_NONE;
+}
+
+void ChunkResidency::Add(int x, int y)
+{
+	Chunk *pChunk;
+	int Index;
+
+	Index = x + y * ChunkWidth;
+	pChunk = pArea->BigMap[Index];
+	if(!pChunk)
+	{
+		return;
+	}
+
+	//already listed when an editor emptied the slot behind our back
+	if(Listed[Index])
+	{
+		Unlink(Index);
+		ResidentBytes -= Bytes[Index];
+	}
+	else
+	{
+		Listed[Index] = TRUE;
+		NumResident++;
+	}
+
+	Bytes[Index] = pChunk->GetSize();
+	ResidentBytes += Bytes[Index];
+	LastUsed[Index] = timeGetTime();
+	Link(Index);
+}
+
+void ChunkResidency::Remove(int x, int y)
+{
+	int Index;
+
+	Index = x + y * ChunkWidth;
+	if(!Listed[Index])
+	{
+		return;
+	}
+
+	Unlink(Index);
+	Listed[Index] = FALSE;
+	NumResident--;
+	ResidentBytes -= Bytes[Index];
+	Bytes[Index] = 0;
+}
+
+void ChunkResidency::Touch(int x, int y)
+{
+	int Index;
+
+	Index = x + y * ChunkWidth;
+	if(!Listed[Index])
+	{
+		Add(x, y);
+		return;
+	}
+
+	LastUsed[Index] = timeGetTime();
+	if(Head != Index)
+	{
+		Unlink(Index);
+		Link(Index);
+	}
+}
+
+void ChunkResidency::SetPin(RECT *rChunks)
+{
+	rPin = *rChunks;
+	Pinned = TRUE;
+}
+
+void ChunkResidency::Update(int CenterX, int CenterY, int Radius)
+{
+	DWORD Now;
+	RECT rKeep;
+	int Index;
+	int Before;
+	int Examined;
+	int Evicted;
+	int x;
+	int y;
+
+	Now = timeGetTime();
+
+	rKeep.left = CenterX - Radius - RESIDENCY_KEEP_MARGIN;
+	rKeep.right = CenterX + Radius + RESIDENCY_KEEP_MARGIN;
+	rKeep.top = CenterY - Radius - RESIDENCY_KEEP_MARGIN;
+	rKeep.bottom = CenterY + Radius + RESIDENCY_KEEP_MARGIN;
+
+	for(y = CenterY - Radius; y <= CenterY + Radius; y++)
+	for(x = CenterX - Radius; x <= CenterX + Radius; x++)
+	{
+		if(x >= 0 && y >= 0 && x < ChunkWidth && y < ChunkHeight && pArea->BigMap[x + y * ChunkWidth])
+		{
+			Touch(x, y);
+		}
+	}
+
+	Examined = 0;
+	Evicted = 0;
+	Index = Tail;
+
+	while(Index != RESIDENCY_NONE && Examined < RESIDENCY_MAX_EXAMINED && Evicted < RESIDENCY_EVICTIONS_PER_FRAME)
+	{
+		Before = Prev[Index];
+		Examined++;
+
+		x = Index % ChunkWidth;
+		y = Index / ChunkWidth;
+
+		if(!pArea->BigMap[Index])
+		{
+			Remove(x, y);
+		}
+		else
+		if(ResidentBytes <= Budget && Now - LastUsed[Index] < RESIDENCY_IDLE_TIME)
+		{
+			//everything further up was used more recently
+			break;
+		}
+		else
+		if((x >= rKeep.left && x <= rKeep.right && y >= rKeep.top && y <= rKeep.bottom) ||
+			(Pinned && x >= rPin.left && x <= rPin.right && y >= rPin.top && y <= rPin.bottom))
+		{
+			Touch(x, y);
+		}
+		else
+		{
+			//RemoveChunk takes it off the list
+			pArea->RemoveChunk(x, y);
+			NumEvicted++;
+			Evicted++;
+		}
+
+		Index = Before;
+	}
+}
+
+void ChunkResidency::Reset()
+{
+	int Index;
+	int NextIndex;
+
+	Index = Head;
+	while(Index != RESIDENCY_NONE)
+	{
+		NextIndex = Next[Index];
+		Prev[Index] = RESIDENCY_NONE;
+		Next[Index] = RESIDENCY_NONE;
+		Listed[Index] = FALSE;
+		Bytes[Index] = 0;
+		Index = NextIndex;
+	}
+
+	Head = RESIDENCY_NONE;
+	Tail = RESIDENCY_NONE;
+	NumResident = 0;
+	ResidentBytes = 0;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Debug ***************************************************
+
+void ChunkResidency::OutPutDebugInfo(FILE *fp)
+{
+	fprintf(fp,"resident chunks %i, %i bytes of %i budget\n", NumResident, ResidentBytes, Budget);
+	fprintf(fp,"evicted %i\n", NumEvicted);
+}
+
+//end: Debug ***********************************************************
@@ -0,0 +1,126 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				chunkresidency.h				  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  keep track of which chunks of an area are in memory and
+//*			 unload the least recently used ones
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		editor functions that empty BigMap directly are noticed lazily,
+//*		the first time Update passes over the emptied slot
+//*********************************************************************
+//*********************************************************************
+#ifndef CHUNKRESIDENCY_H
+#define CHUNKRESIDENCY_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define RESIDENCY_DEFAULT_BUDGET		(24 * 1024 * 1024)
+//chunks this far past the draw window are never unloaded
+#define RESIDENCY_KEEP_MARGIN			1
+//chunks untouched this long are unloaded even under budget
+#define RESIDENCY_IDLE_TIME				30000
+#define RESIDENCY_EVICTIONS_PER_FRAME	4
+//how far up from the old end of the list one Update looks
+#define RESIDENCY_MAX_EXAMINED			32
+#define RESIDENCY_NONE					-1
+
+class Area;
+
+//*******************************CLASS********************************
+//**************          ChunkResidency         *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  A list of the area's loaded chunks, most recently used
+//*			 first.  Chunks in the draw window are touched every frame
+//*			 and Update unloads from the other end while the area is
+//*			 over budget or a chunk has gone idle.  Chunks inside the
+//*			 pinned rectangle (the combat area) are never unloaded.
+//********************************************************************
+//*Invariants: a chunk is on the list once, ResidentBytes is the sum of
+//*				 Bytes over the list
+//********************************************************************
+class ChunkResidency
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	Area *pArea;
+	int ChunkWidth;
+	int ChunkHeight;
+	int NumChunks;
+
+	//the list, linked by chunk index
+	int *Prev;
+	int *Next;
+	BOOL *Listed;
+	DWORD *LastUsed;
+	int *Bytes;
+	int Head;	//most recent
+	int Tail;
+
+	int NumResident;
+	int ResidentBytes;
+	int Budget;
+
+	BOOL Pinned;
+	RECT rPin;
+
+	int NumEvicted;
+
+	void Link(int Index);
+	void Unlink(int Index);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetNumResident() { return NumResident; }
+	int GetResidentBytes() { return ResidentBytes; }
+	int GetBudget() { return Budget; }
+	int GetNumEvicted() { return NumEvicted; }
+
+	//walk the loaded chunks, most recently used first, RESIDENCY_NONE ends
+	int GetFirst() { return Head; }
+	int GetNext(int Index) { return Next[Index]; }
+
+// Mutators -----------------------------------------
+	//a chunk has been put into BigMap
+	void Add(int x, int y);
+	//a chunk has been taken out of BigMap
+	void Remove(int x, int y);
+	void Touch(int x, int y);
+
+	//touch the draw window and unload what the budget no longer covers
+	void Update(int CenterX, int CenterY, int Radius);
+
+	//in chunks
+	void SetPin(RECT *rChunks);
+	void ClearPin() { Pinned = FALSE; }
+
+	void SetBudget(int NewBudget) { Budget = NewBudget; }
+
+	//BigMap has been emptied
+	void Reset();
+
+// Constructors ---------------------------------------
+	ChunkResidency(Area *pNewArea, int NewChunkWidth, int NewChunkHeight, int NewBudget);
+
+// Destructor -----------------------------------------
+	~ChunkResidency();
+
+// Debug ----------------------------------------------
+	void OutPutDebugInfo(FILE *fp);
+
+};
+
+#endif
@@ -0,0 +1,560 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				chunkstreamer.cpp				  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  background loading of an area's static chunks ahead of
+//*			 the camera
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		objects are still read on the main thread, LoadObject is not
+//*		safe to call from the loader
+//*********************************************************************
+//*********************************************************************
+#include "chunkstreamer.h"
+#include "chunks.h"
+#include "area.h"
+#include "mappedarea.h"
+#include "chunkresidency.h"
+#include "zsutilities.h"
+#include "profiler.h"
+#include <mmsystem.h>
+#include <stdlib.h>
+
+//************** Constructors  ****************************************
+
+ChunkStreamer::ChunkStreamer(Area *pNewArea, const char *FileName)
+{
+	int n;
+
+	pArea = pNewArea;
+	pMapped = pArea->pMapped;
+	ChunkWidth = pArea->ChunkWidth;
+	ChunkHeight = pArea->ChunkHeight;
+	NumChunks = ChunkWidth * ChunkHeight;
+
+	ChunkOffsets = new int[NumChunks];
+	memcpy(ChunkOffsets, pArea->Header.ChunkOffsets, sizeof(int) * NumChunks);
+
+	State = new BYTE[NumChunks];
+	ReadyChunks = new Chunk *[NumChunks];
+	ObjectOffsets = new long[NumChunks];
+	RequestTimes = new DWORD[NumChunks];
+	Wanted = new BYTE[NumChunks];
+	for(n = 0; n < NumChunks; n++)
+	{
+		State[n] = STREAM_NONE;
+		ReadyChunks[n] = NULL;
+		ObjectOffsets[n] = 0;
+		RequestTimes[n] = 0;
+		Wanted[n] = FALSE;
+	}
+
+	//cancelled entries stay in the rings until they are passed over, leave
+	//room for each chunk twice
+	RequestSize = NumChunks * 2 + 1;
+	Requests = new int[RequestSize];
+	RequestHead = RequestTail = 0;
+
+	ReadySize = NumChunks * 2 + 1;
+	Ready = new int[ReadySize];
+	ReadyHead = ReadyTail = 0;
+
+	LastX = LastY = -1;
+	DirX = DirY = 0;
+
+	QueueDepth = 0;
+	NumRequested = 0;
+	NumLoaded = 0;
+	NumLinked = 0;
+	NumMisses = 0;
+	NumCancelled = 0;
+	TotalLatency = 0;
+	MaxLatency = 0;
+
+	InitializeCriticalSection(&csQueue);
+	hWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+	hThread = NULL;
+	Quit = FALSE;
+
+	fp = fopen(FileName, "rb");
+	if(!fp)
+	{
+		//the area falls back to reading every chunk itself
+		DEBUG_INFO("Chunk streamer could not open ");
+		DEBUG_INFO(FileName);
+		DEBUG_INFO("\n");
+		return;
+	}
+
+	hThread = CreateThread(NULL,
+			0,
+			(LPTHREAD_START_ROUTINE)LoaderThread,
+			(LPVOID)this,
+			0,
+			&ThreadID);
+
+	if(hThread)
+	{
+		SetThreadPriority(hThread, THREAD_PRIORITY_BELOW_NORMAL);
+	}
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+ChunkStreamer::~ChunkStreamer()
+{
+	int n;
+
+	if(hThread)
+	{
+		Quit = TRUE;
+		SetEvent(hWake);
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+		hThread = NULL;
+	}
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		if(ReadyChunks[n])
+		{
+			delete ReadyChunks[n];
+			ReadyChunks[n] = NULL;
+		}
+	}
+
+	if(fp)
+	{
+		fclose(fp);
+		fp = NULL;
+	}
+
+	CloseHandle(hWake);
+	DeleteCriticalSection(&csQueue);
+
+	delete[] ChunkOffsets;
+	delete[] State;
+	delete[] ReadyChunks;
+	delete[] ObjectOffsets;
+	delete[] RequestTimes;
+	delete[] Wanted;
+	delete[] Requests;
+	delete[] Ready;
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Loader Thread  *****************************************
+
+DWORD WINAPI ChunkStreamer::LoaderThread(LPVOID pStreamer)
+{
+	((ChunkStreamer *)pStreamer)->LoaderLoop();
+	ProfileThreadDone();
+	LogThreadDone();
+	return 0;
+}
+
+void ChunkStreamer::LoaderLoop()
+{
+	Chunk *pChunk;
+	const MAPPED_CHUNK_T *pRecord;
+	int Index;
+	long ObjectOffset;
+
+	while(!Quit)
+	{
+		WaitForSingleObject(hWake, INFINITE);
+
+		while(!Quit)
+		{
+			Index = -1;
+
+			EnterCriticalSection(&csQueue);
+			while(RequestHead != RequestTail)
+			{
+				Index = Requests[RequestHead];
+				RequestHead = (RequestHead + 1) % RequestSize;
+				if(State[Index] == STREAM_QUEUED)
+				{
+					State[Index] = STREAM_LOADING;
+					QueueDepth--;
+					break;
+				}
+				Index = -1;
+			}
+			LeaveCriticalSection(&csQueue);
+
+			if(Index == -1)
+			{
+				break;
+			}
+
+			pChunk = new Chunk;
+			pRecord = pMapped ? pMapped->GetChunk(Index % ChunkWidth, Index / ChunkWidth) : NULL;
+			if(pRecord)
+			{
+				pChunk->LoadMapped(pRecord);
+				ObjectOffset = pRecord->ObjectOffset;
+				InterlockedIncrement(&pArea->NumMappedLoads);
+			}
+			else
+			{
+				fseek(fp, ChunkOffsets[Index], SEEK_SET);
+				pChunk->LoadStatic(fp);
+				ObjectOffset = ftell(fp);
+				InterlockedIncrement(&pArea->NumBinLoads);
+			}
+
+			EnterCriticalSection(&csQueue);
+			if(State[Index] == STREAM_LOADING && (ReadyTail + 1) % ReadySize != ReadyHead)
+			{
+				State[Index] = STREAM_READY;
+				ReadyChunks[Index] = pChunk;
+				ObjectOffsets[Index] = ObjectOffset;
+				Ready[ReadyTail] = Index;
+				ReadyTail = (ReadyTail + 1) % ReadySize;
+				NumLoaded++;
+				pChunk = NULL;
+			}
+			else
+			{
+				State[Index] = STREAM_NONE;
+			}
+			LeaveCriticalSection(&csQueue);
+
+			if(pChunk)
+			{
+				delete pChunk;
+			}
+		}
+	}
+}
+
+//end: Loader Thread ***************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void ChunkStreamer::Request(int x, int y, DWORD Now)
+{
+	int Index;
+
+	if(x < 0 || y < 0 || x >= ChunkWidth || y >= ChunkHeight)
+	{
+		return;
+	}
+
+	Index = x + y * ChunkWidth;
+
+	if(State[Index] != STREAM_NONE || pArea->BigMap[Index] || !ChunkOffsets[Index])
+	{
+		return;
+	}
+
+	if((RequestTail + 1) % RequestSize == RequestHead)
+	{
+		return;
+	}
+
+	State[Index] = STREAM_QUEUED;
+	RequestTimes[Index] = Now;
+	Requests[RequestTail] = Index;
+	RequestTail = (RequestTail + 1) % RequestSize;
+	QueueDepth++;
+	NumRequested++;
+}
+
+void ChunkStreamer::Cancel(int Index)
+{
+	Wanted[Index] = FALSE;
+
+	switch(State[Index])
+	{
+	case STREAM_QUEUED:
+		State[Index] = STREAM_NONE;
+		QueueDepth--;
+		NumCancelled++;
+		break;
+	case STREAM_LOADING:
+		//the loader throws it away when it finishes
+		State[Index] = STREAM_CANCELLED;
+		NumCancelled++;
+		break;
+	case STREAM_READY:
+		delete ReadyChunks[Index];
+		ReadyChunks[Index] = NULL;
+		State[Index] = STREAM_NONE;
+		NumCancelled++;
+		break;
+	default:
+		break;
+	}
+}
+
+void ChunkStreamer::Link(int Index, Chunk *pChunk, long ObjectOffset)
+{
+	DWORD Latency;
+
+	Wanted[Index] = FALSE;
+
+	if(pArea->BigMap[Index])
+	{
+		delete pChunk;
+		return;
+	}
+
+	fseek(pArea->StaticFile, ObjectOffset, SEEK_SET);
+	pChunk->LoadObjects(pArea->StaticFile);
+
+	pArea->BigMap[Index] = pChunk;
+	if(pArea->pResidency)
+	{
+		pArea->pResidency->Add(Index % ChunkWidth, Index / ChunkWidth);
+	}
+
+	Latency = timeGetTime() - RequestTimes[Index];
+	TotalLatency += Latency;
+	if(Latency > MaxLatency)
+	{
+		MaxLatency = Latency;
+	}
+	NumLinked++;
+}
+
+void ChunkStreamer::Update(int CenterX, int CenterY, int Radius)
+{
+	Chunk *TakenChunks[STREAM_LINKS_PER_FRAME];
+	long TakenOffsets[STREAM_LINKS_PER_FRAME];
+	int Taken[STREAM_LINKS_PER_FRAME];
+	int NumTaken;
+	RECT rKeep;
+	DWORD Now;
+	int AheadX;
+	int AheadY;
+	int Index;
+	int x;
+	int y;
+	int n;
+	int OldTail;
+	int Reach;
+
+	if(!hThread)
+	{
+		return;
+	}
+
+	Now = timeGetTime();
+
+	//follow the camera, a jump bigger than the window is a teleport and
+	//says nothing about where it is headed
+	if(CenterX != LastX || CenterY != LastY)
+	{
+		if(LastX == -1 || abs(CenterX - LastX) > Radius || abs(CenterY - LastY) > Radius)
+		{
+			DirX = 0;
+			DirY = 0;
+		}
+		else
+		{
+			DirX = (CenterX > LastX) - (CenterX < LastX);
+			DirY = (CenterY > LastY) - (CenterY < LastY);
+		}
+		LastX = CenterX;
+		LastY = CenterY;
+	}
+
+	AheadX = CenterX + DirX * STREAM_LOOKAHEAD;
+	AheadY = CenterY + DirY * STREAM_LOOKAHEAD;
+
+	//the window and the window ahead of it, plus a margin
+	rKeep.left = min(CenterX, AheadX) - Radius - STREAM_CANCEL_MARGIN;
+	rKeep.right = max(CenterX, AheadX) + Radius + STREAM_CANCEL_MARGIN;
+	rKeep.top = min(CenterY, AheadY) - Radius - STREAM_CANCEL_MARGIN;
+	rKeep.bottom = max(CenterY, AheadY) + Radius + STREAM_CANCEL_MARGIN;
+
+	NumTaken = 0;
+
+	EnterCriticalSection(&csQueue);
+
+	//take finished chunks, anything the camera has left behind is dropped
+	while(ReadyHead != ReadyTail && NumTaken < STREAM_LINKS_PER_FRAME)
+	{
+		Index = Ready[ReadyHead];
+		ReadyHead = (ReadyHead + 1) % ReadySize;
+		if(State[Index] != STREAM_READY)
+		{
+			continue;
+		}
+
+		x = Index % ChunkWidth;
+		y = Index / ChunkWidth;
+		if(!Wanted[Index] && (x < rKeep.left || x > rKeep.right || y < rKeep.top || y > rKeep.bottom))
+		{
+			Cancel(Index);
+			continue;
+		}
+
+		Taken[NumTaken] = Index;
+		TakenChunks[NumTaken] = ReadyChunks[Index];
+		TakenOffsets[NumTaken] = ObjectOffsets[Index];
+		NumTaken++;
+		ReadyChunks[Index] = NULL;
+		State[Index] = STREAM_NONE;
+	}
+
+	//drop stale requests
+	for(n = RequestHead; n != RequestTail; n = (n + 1) % RequestSize)
+	{
+		Index = Requests[n];
+		if(State[Index] != STREAM_QUEUED || Wanted[Index])
+		{
+			continue;
+		}
+		x = Index % ChunkWidth;
+		y = Index / ChunkWidth;
+		if(x < rKeep.left || x > rKeep.right || y < rKeep.top || y > rKeep.bottom)
+		{
+			Cancel(Index);
+		}
+	}
+
+	OldTail = RequestTail;
+
+	//only the ring the camera is about to reach, the caller reads what is
+	//already in view itself.  standing still that is the border around the
+	//window, moving it is the window ahead
+	Reach = (DirX || DirY) ? Radius : Radius + 1;
+	for(y = AheadY - Reach; y <= AheadY + Reach; y++)
+	for(x = AheadX - Reach; x <= AheadX + Reach; x++)
+	{
+		if(abs(x - CenterX) > Radius || abs(y - CenterY) > Radius)
+		{
+			Request(x, y, Now);
+		}
+	}
+
+	LeaveCriticalSection(&csQueue);
+
+	if(RequestTail != OldTail)
+	{
+		SetEvent(hWake);
+	}
+
+	for(n = 0; n < NumTaken; n++)
+	{
+		Link(Taken[n], TakenChunks[n], TakenOffsets[n]);
+	}
+}
+
+void ChunkStreamer::Want(int x, int y)
+{
+	int Index;
+	int OldTail;
+
+	if(!hThread || x < 0 || y < 0 || x >= ChunkWidth || y >= ChunkHeight)
+	{
+		return;
+	}
+
+	Index = x + y * ChunkWidth;
+
+	EnterCriticalSection(&csQueue);
+	OldTail = RequestTail;
+	Request(x, y, timeGetTime());
+	if(State[Index] == STREAM_QUEUED || State[Index] == STREAM_LOADING || State[Index] == STREAM_READY)
+	{
+		Wanted[Index] = TRUE;
+	}
+	LeaveCriticalSection(&csQueue);
+
+	if(RequestTail != OldTail)
+	{
+		SetEvent(hWake);
+	}
+}
+
+BOOL ChunkStreamer::Claim(int x, int y)
+{
+	Chunk *pChunk;
+	long ObjectOffset;
+	int Index;
+
+	if(!hThread)
+	{
+		return FALSE;
+	}
+
+	Index = x + y * ChunkWidth;
+	pChunk = NULL;
+	ObjectOffset = 0;
+
+	EnterCriticalSection(&csQueue);
+	if(State[Index] == STREAM_READY)
+	{
+		pChunk = ReadyChunks[Index];
+		ObjectOffset = ObjectOffsets[Index];
+		ReadyChunks[Index] = NULL;
+		State[Index] = STREAM_NONE;
+	}
+	else
+	{
+		//reading it here is quicker than waiting behind the rest of the queue
+		Cancel(Index);
+		NumMisses++;
+	}
+	LeaveCriticalSection(&csQueue);
+
+	if(!pChunk)
+	{
+		return FALSE;
+	}
+
+	Link(Index, pChunk, ObjectOffset);
+	return TRUE;
+}
+
+void ChunkStreamer::Flush()
+{
+	int n;
+
+	EnterCriticalSection(&csQueue);
+	for(n = 0; n < NumChunks; n++)
+	{
+		Cancel(n);
+	}
+	RequestHead = RequestTail;
+	ReadyHead = ReadyTail;
+	QueueDepth = 0;
+	LeaveCriticalSection(&csQueue);
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Debug ***************************************************
+
+void ChunkStreamer::OutPutDebugInfo(FILE *fpOut)
+{
+	EnterCriticalSection(&csQueue);
+	fprintf(fpOut,"Chunk streamer: %s\n", hThread ? "running" : "off");
+	fprintf(fpOut,"queue depth %i\n", QueueDepth);
+	fprintf(fpOut,"requested %i, loaded %i, linked %i, cancelled %i, misses %i\n",
+		NumRequested, NumLoaded, NumLinked, NumCancelled, NumMisses);
+	fprintf(fpOut,"latency average %i ms, max %i ms\n", GetAverageLatency(), MaxLatency);
+	LeaveCriticalSection(&csQueue);
+}
+
+//end: Debug ***********************************************************
@@ -0,0 +1,167 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				chunkstreamer.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  background loading of an area's static chunks ahead of
+//*			 the camera
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		objects are still read on the main thread, LoadObject is not
+//*		safe to call from the loader
+//*********************************************************************
+//*********************************************************************
+#ifndef CHUNKSTREAMER_H
+#define CHUNKSTREAMER_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+//how many chunks past the draw window to read along the camera's motion
+#define STREAM_LOOKAHEAD		2
+//requests this far outside the wanted window are dropped
+#define STREAM_CANCEL_MARGIN	1
+//finished chunks handed to the area each frame
+#define STREAM_LINKS_PER_FRAME	2
+
+typedef enum
+{
+	STREAM_NONE = 0,
+	STREAM_QUEUED,
+	STREAM_LOADING,
+	STREAM_CANCELLED,	//cancelled while the loader had it
+	STREAM_READY,
+} STREAM_STATE_T;
+
+class Chunk;
+class Area;
+class MappedArea;
+
+//*******************************CLASS********************************
+//**************          ChunkStreamer          *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Read the static part of chunks on a loader thread with its
+//*			 own handle on the area file.  The main thread asks for the
+//*			 ring ahead of the camera each frame, takes finished chunks
+//*			 from the ready queue and reads their objects itself.  Chunks
+//*			 in view are never waited for, the main thread reads them.
+//********************************************************************
+//*Invariants: State, the ring indices and the ready chunk pointers are
+//*				 only touched inside csQueue.  A chunk is in at most one of
+//*				 the loader, the ready queue or the area's BigMap.
+//********************************************************************
+class ChunkStreamer
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	Area *pArea;
+	//the area's mapped file or NULL, it outlives the streamer
+	MappedArea *pMapped;
+	FILE *fp;
+	int ChunkWidth;
+	int ChunkHeight;
+	int NumChunks;
+	int *ChunkOffsets;
+
+	BYTE *State;
+	Chunk **ReadyChunks;
+	long *ObjectOffsets;
+	DWORD *RequestTimes;
+	//asked for through Want, kept whatever the camera does
+	BYTE *Wanted;
+
+	//rings of chunk indices, entries whose state has moved on are skipped
+	int *Requests;
+	int RequestSize;
+	int RequestHead;
+	int RequestTail;
+
+	int *Ready;
+	int ReadySize;
+	int ReadyHead;
+	int ReadyTail;
+
+	CRITICAL_SECTION csQueue;
+	HANDLE hWake;
+	HANDLE hThread;
+	DWORD ThreadID;
+	volatile BOOL Quit;
+
+	//camera tracking for the lookahead
+	int LastX;
+	int LastY;
+	int DirX;
+	int DirY;
+
+	//counters
+	int QueueDepth;
+	int NumRequested;
+	int NumLoaded;
+	int NumLinked;
+	int NumMisses;
+	int NumCancelled;
+	DWORD TotalLatency;
+	DWORD MaxLatency;
+
+	static DWORD WINAPI LoaderThread(LPVOID pStreamer);
+	void LoaderLoop();
+
+	//csQueue must be held
+	void Request(int x, int y, DWORD Now);
+	void Cancel(int Index);
+	//main thread, outside csQueue
+	void Link(int Index, Chunk *pChunk, long ObjectOffset);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	BOOL IsRunning() { return hThread != NULL; }
+
+	int GetQueueDepth() { return QueueDepth; }
+	int GetNumRequested() { return NumRequested; }
+	int GetNumLinked() { return NumLinked; }
+	int GetNumMisses() { return NumMisses; }
+	int GetNumCancelled() { return NumCancelled; }
+	DWORD GetMaxLatency() { return MaxLatency; }
+	DWORD GetAverageLatency() { return NumLinked ? TotalLatency / NumLinked : 0; }
+
+// Mutators -----------------------------------------
+	//keep the chunks just outside the window of Radius chunks around the
+	//center coming in, and hand finished chunks to BigMap.  the window
+	//itself is the caller's to read, through Claim
+	void Update(int CenterX, int CenterY, int Radius);
+
+	//queue a chunk for something other than the camera, the path graph,
+	//it is linked by Update when it is ready wherever the camera is
+	void Want(int x, int y);
+
+	//links the chunk if the loader has it ready, otherwise drops any pending
+	//request and counts a miss so the caller reads it itself
+	BOOL Claim(int x, int y);
+
+	//throw away everything queued or ready
+	void Flush();
+
+// Constructors ---------------------------------------
+	//opens its own handle on the area's static file, the offsets are copied
+	ChunkStreamer(Area *pNewArea, const char *FileName);
+
+// Destructor -----------------------------------------
+	~ChunkStreamer();
+
+// Debug ----------------------------------------------
+	void OutPutDebugInfo(FILE *fpOut);
+
+};
+
+#endif
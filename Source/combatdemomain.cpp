@@ -54,6 +54,10 @@
 #include "zsaskwin.h"
 #include "Mapwin.h"
 #include "journal.h"
+#include "scriptvm.h"
+#include "replay.h"
+#include "mesharchive.h"
+#include "workerpool.h"
 
 #include <mmsystem.h>
 
@@ -105,6 +109,7 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 	Chunk::InitTerrain();
 	
 	LoadFuncs();
+	InitScriptVM();
 
 	D3DXInitialize();
 	
@@ -297,15 +302,19 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 #ifndef NO_DDRAW
 	Engine->Graphics()->GetBBuffer()->Blt(NULL, Engine->Graphics()->GetPrimay(),NULL,NULL,NULL);
 #endif
-	fp = SafeFileOpen("mesh.bin","rb");
-	if(fp)
+	//mesh.zsa maps in place, it is only used while it matches mesh.bin
+	if(!Engine->LoadMeshArchive(MESH_ARCHIVE_FILE, "mesh.bin"))
 	{
-		fclose(fp);
-		Engine->LoadMeshes("mesh.bin");
-	}
-	else
-	{
-		Engine->ImportMeshes();
+		fp = SafeFileOpen("mesh.bin","rb");
+		if(fp)
+		{
+			fclose(fp);
+			Engine->LoadMeshes("mesh.bin");
+		}
+		else
+		{
+			Engine->ImportMeshes();
+		}
 	}
 
 //	}
@@ -537,6 +546,14 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 	else
 		PreludeWorld->SetDrawShadows(FALSE);
 
+	//record each session played to REPLAY_FILE_NAME, for the headless
+	//build to play back
+	BOOL Record = FALSE;
+	fseek(fp, 0, SEEK_SET);
+	if(SeekTo(fp,"RECORD"))
+	{
+		Record = (BOOL)GetInt(fp);
+	}
 	
 	fclose(fp);
 
@@ -560,6 +577,12 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 		PreludeEvents.SaveEvents("events.bin");
 	}
 
+	if(ScriptCheck)
+	{
+		DEBUG_INFO("Checking compiled scripts\n");
+		ScriptProgram::CheckAll("scriptcheck.txt");
+	}
+
 	delete pProgressText;
 
 //*************************
@@ -789,7 +812,14 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 				PreludeWorld->SetGameState(GAME_STATE_NORMAL);
 				PreludeEvents.RunEvent(0);
 
+				if(Record)
+				{
+					PreludeReplay.StartRecording(REPLAY_FILE_NAME, REPLAY_SAVE_NAME, pMain->GetFrameRate());
+				}
+
 				pMain->GoModal();
+
+				PreludeReplay.StopRecording();
 				
 				while(PreludeParty.GetMember(0))
 				{
@@ -827,7 +857,14 @@ int WINAPI WinMain(HINSTANCE hinstance, HINSTANCE hprevinstance, LPSTR lpcmdline
 				Describe(VERSION_NUMBER);
 				Describe("Press 'F1' for help");
 
+				if(Record)
+				{
+					PreludeReplay.StartRecording(REPLAY_FILE_NAME, REPLAY_SAVE_NAME, pMain->GetFrameRate());
+				}
+
 				pMain->GoModal();
+
+				PreludeReplay.StopRecording();
 				
 				while(PreludeParty.GetMember(0))
 				{
@@ -952,6 +989,11 @@ void OnExit(void)
 	sprintf(blarg, "End Script Blocks: %i\nargs: %i\n", G_NumBlocks, G_NumArgs);
 	DEBUG_INFO(blarg);
 
+	//the workers log as they go
+	PreludeWorkers.Stop();
+
+	LogShutdown();
+
 	if(ExitErrorMessage)
 	{
 		MessageBox(NULL, ExitErrorMessage, "Fatal Error", MB_OK | MB_ICONSTOP);
@@ -57,6 +57,8 @@
 #include "path.h"
 #include "zssaychar.h"
 #include "zsmessage.h"
+#include "replay.h"
+#include "profiler.h"
 
 #define WALK_DIVISOR 6.0f
 
@@ -108,6 +110,9 @@ Creature::Creature()
 {
 	FrameAdd = 0;
 	LastPlacedTime = 0;
+	LastOffScreenTime = 0;
+	OffScreenCatchUp = 0;
+	OffScreenEntry = -1;
 	DamageOverride = 0;
 	SecondaryDamageOverride = 0;
 	Acted = FALSE;
@@ -154,6 +159,7 @@ Creature::Creature()
 	{
 		((Creature *)pNext)->SetPrev(this);
 	}
+	LinkedAtHead();
 
 	pTexture = NULL;
 	
@@ -178,6 +184,9 @@ Creature::Creature(Thing *pFromThing)
 {
 	FrameAdd = 0;
 	LastPlacedTime = 0;
+	LastOffScreenTime = 0;
+	OffScreenCatchUp = 0;
+	OffScreenEntry = -1;
 	AmmoItemNumber = 0;
 	DamageOverride = 0;
 	SecondaryDamageOverride = 0;
@@ -281,6 +290,7 @@ Creature::Creature(Thing *pFromThing)
 	{
 		((Creature *)pNext)->SetPrev(this);
 	}
+	LinkedAtHead();
 
 	pMesh = pFrom->pMesh;
 	Large = pFrom->Large;
@@ -324,6 +334,7 @@ Creature::~Creature()
 {
 	if(PreludeWorld)
 	{
+		PreludeWorld->ForgetOffScreenCreature(this);
 		if(AreaIn != -1)
 			PreludeWorld->GetArea(AreaIn)->RemoveFromUpdate(this);
 		if(PreludeWorld->GetGameState() == GAME_STATE_COMBAT)
@@ -1424,6 +1435,10 @@ void Creature::AddToWorld()
 int Creature::SetData(int fieldnum, int NewValue)
 {
 	//set the value at the index provide to be equal to the value passed
+	if((fieldnum == INDEX_ID || fieldnum == INDEX_UID) && DataFields[fieldnum].Value != NewValue)
+	{
+		ChangingFindKey();
+	}
 	DataFields[fieldnum].Value = NewValue;
 	//done
 	if(pPortrait)
@@ -1435,22 +1450,23 @@ int Creature::SetData(int fieldnum, int NewValue)
 
 int Creature::SetData(char *fieldname, int NewValue)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		if((n == INDEX_ID || n == INDEX_UID) && DataFields[n].Value != NewValue)
 		{
-			DataFields[n].Value = NewValue;
-			if(pPortrait)
-			{
-				pPortrait->Dirty();
-			}
-			return TRUE;
+			ChangingFindKey();
 		}
-		fn += 32;
+		DataFields[n].Value = NewValue;
+		if(pPortrait)
+		{
+			pPortrait->Dirty();
+		}
+		return TRUE;
 	}
 
 	//display error
@@ -1474,22 +1490,19 @@ int Creature::SetData(int fieldnum, float NewfValue)
 
 int Creature::SetData(char *fieldname, float NewfValue)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		DataFields[n].fValue = NewfValue;
+		if(pPortrait)
 		{
-			DataFields[n].fValue = NewfValue;
-			if(pPortrait)
-			{
-				pPortrait->Dirty();
-			}
-			return TRUE;
+			pPortrait->Dirty();
 		}
-		fn += 32;
+		return TRUE;
 	}
 
 	
@@ -1501,6 +1514,10 @@ int Creature::SetData(char *fieldname, float NewfValue)
 int Creature::SetData(int fieldnum, char *NewString)
 {
 	//set the value at the index provide to be equal to the value passed
+	if(fieldnum == INDEX_NAME)
+	{
+		ChangingFindKey();
+	}
 	if(DataFields[fieldnum].String)
 		delete[] DataFields[fieldnum].String;
 	DataFields[fieldnum].String = NewString;
@@ -1514,24 +1531,25 @@ int Creature::SetData(int fieldnum, char *NewString)
 
 int Creature::SetData(char *fieldname, char *NewString)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		if(n == INDEX_NAME)
 		{
-			if(DataFields[n].String)
-				delete[] DataFields[n].String;
-			DataFields[n].String = NewString;
-			if(pPortrait)
-			{
-				pPortrait->Dirty();
-			}
-			return TRUE;
+			ChangingFindKey();
 		}
-		fn += 32;
+		if(DataFields[n].String)
+			delete[] DataFields[n].String;
+		DataFields[n].String = NewString;
+		if(pPortrait)
+		{
+			pPortrait->Dirty();
+		}
+		return TRUE;
 	}
 
 //	FATAL_ERROR("Failed to find field: %s",fieldname);
@@ -1552,22 +1570,19 @@ int Creature::SetData(int fieldnum, D3DVECTOR *NewpVector)
 
 int Creature::SetData(char *fieldname, D3DVECTOR *NewpVector)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		DataFields[n].pVector = NewpVector;
+		if(pPortrait)
 		{
-			DataFields[n].pVector = NewpVector;
-			if(pPortrait)
-			{
-				pPortrait->Dirty();
-			}
-			return TRUE;
+			pPortrait->Dirty();
 		}
-		fn += 32;
+		return TRUE;
 	}
 	//display error
 
@@ -1592,11 +1607,19 @@ BOOL Creature::AdvanceFrame()
 
 void Creature::UpdateOffScreen()
 {
-	if(this->AreaIn == -1)
+	int Num;
+
+	ReleaseOffScreenTexture();
+
+	Num = CheckSchedule(PreludeWorld->GetHour());
+	if(Num != -1)
 	{
-	
+		MoveToLocator(Num);
 	}
+}
 
+void Creature::ReleaseOffScreenTexture()
+{
 	if(pTexture)
 	{
 		if(!Engine->GetTextureNum(pTexture))
@@ -1617,86 +1640,92 @@ void Creature::UpdateOffScreen()
 			}
 		}
 	}
+}
 
-	Locator *pLocator;
-	if(NumLocators)
+int Creature::CheckSchedule(int Hour)
+{
+	for(int n = 0; n < NumLocators; n++)
 	{
-		int Hour = PreludeWorld->GetHour();
-		for(int n = 0; n < NumLocators; n++)
-		{
-			if((Schedule[n].GetStart() < Schedule[n].GetEnd() &&
-				 (Schedule[n].GetStart() <= Hour && Schedule[n].GetEnd() >= Hour))
-				 ||
-				(Schedule[n].GetStart() > Schedule[n].GetEnd() &&
-				 (Schedule[n].GetStart() <= Hour || Schedule[n].GetEnd() >= Hour)))
-			{
-				RECT rLoc;
-				Schedule[n].GetBounds(&rLoc);
-				D3DVECTOR *pPosition;
-				pPosition = this->GetPosition();
-				if(pPosition->x >= (float)rLoc.left &&
-					pPosition->y >= (float)rLoc.top &&
-					pPosition->x <= (float)rLoc.right &&
-					pPosition->y <= (float)rLoc.bottom
-					&& this->AreaIn == Schedule[n].GetArea())
-				{
-					//do nothing if
-				}
-				else
-				{
-					pLocator = &Schedule[n];
-					int NewX;
-					int NewY;
-					NewX = (rand() % (rLoc.right - rLoc.left)) + rLoc.left;
-					NewY = (rand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
-					BOOL Small;
-					Small = (rLoc.right - rLoc.left == 1) && (rLoc.bottom - rLoc.top == 1);
-					for(int nswitch = 0; nswitch < 20; nswitch++)
-					{
-						if(Small || (!Large && PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY))
-									|| 
-									(Large && PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY)
-										&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX+1,NewY)
-										&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY+1)
-										&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX+1,NewY+1)))
-						{
-							if(this->AreaIn != -1)
-								PreludeWorld->GetArea(this->AreaIn)->RemoveFromUpdate(this);
-							pPosition->x = (float)NewX + 0.5f;
-							pPosition->y = (float)NewY + 0.5f;
-							pPosition->z = PreludeWorld->GetArea(pLocator->GetArea())->GetTileHeight(pPosition->x,pPosition->y);
-							this->SetRegionIn(PreludeWorld->GetArea(pLocator->GetArea())->GetRegion(pPosition));
-							this->SetAreaIn(PreludeWorld->GetAreaNum(PreludeWorld->GetArea(pLocator->GetArea())));
-							PreludeWorld->GetArea(pLocator->GetArea())->AddToUpdate(this);
-							this->ClearActions();
-							RECT rUpdate;
-							rUpdate.left = (PreludeWorld->GetScreenX() * CHUNK_TILE_WIDTH) - 16;
-							rUpdate.right = rUpdate.left + 32;
-							rUpdate.top = (PreludeWorld->GetScreenY() * CHUNK_TILE_HEIGHT) - 16;
-							rUpdate.bottom = rUpdate.top + 32;
-
-							if(this->GetPosition()->x > rUpdate.left &&
-								this->GetPosition()->y > rUpdate.top &&
-								this->GetPosition()->x < rUpdate.right &&
-								this->GetPosition()->y < rUpdate.bottom)
-							{
-								this->CreateTexture();
-							}
-							break;
-						}
-						else
-						{
-							NewX = (rand() % (rLoc.right - rLoc.left)) + rLoc.left;
-							NewY = (rand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
-						}	
-					}
-					
-				}
-				break;
+		if((Schedule[n].GetStart() < Schedule[n].GetEnd() &&
+			 (Schedule[n].GetStart() <= Hour && Schedule[n].GetEnd() >= Hour))
+			 ||
+			(Schedule[n].GetStart() > Schedule[n].GetEnd() &&
+			 (Schedule[n].GetStart() <= Hour || Schedule[n].GetEnd() >= Hour)))
+		{
+			RECT rLoc;
+			Schedule[n].GetBounds(&rLoc);
+			D3DVECTOR *pPosition;
+			pPosition = this->GetPosition();
+			if(pPosition->x >= (float)rLoc.left &&
+				pPosition->y >= (float)rLoc.top &&
+				pPosition->x <= (float)rLoc.right &&
+				pPosition->y <= (float)rLoc.bottom
+				&& this->AreaIn == Schedule[n].GetArea())
+			{
+				//do nothing if
+				return -1;
 			}
+			return n;
 		}
 	}
+	return -1;
+}
+
+void Creature::MoveToLocator(int Num)
+{
+	Locator *pLocator;
+	RECT rLoc;
+	D3DVECTOR *pPosition;
+
+	pLocator = &Schedule[Num];
+	pLocator->GetBounds(&rLoc);
+	pPosition = this->GetPosition();
 
+	int NewX;
+	int NewY;
+	NewX = (GameRand() % (rLoc.right - rLoc.left)) + rLoc.left;
+	NewY = (GameRand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
+	BOOL Small;
+	Small = (rLoc.right - rLoc.left == 1) && (rLoc.bottom - rLoc.top == 1);
+	for(int nswitch = 0; nswitch < 20; nswitch++)
+	{
+		if(Small || (!Large && PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY))
+					|| 
+					(Large && PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY)
+						&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX+1,NewY)
+						&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY+1)
+						&& PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX+1,NewY+1)))
+		{
+			if(this->AreaIn != -1)
+				PreludeWorld->GetArea(this->AreaIn)->RemoveFromUpdate(this);
+			pPosition->x = (float)NewX + 0.5f;
+			pPosition->y = (float)NewY + 0.5f;
+			pPosition->z = PreludeWorld->GetArea(pLocator->GetArea())->GetTileHeight(pPosition->x,pPosition->y);
+			this->SetRegionIn(PreludeWorld->GetArea(pLocator->GetArea())->GetRegion(pPosition));
+			this->SetAreaIn(PreludeWorld->GetAreaNum(PreludeWorld->GetArea(pLocator->GetArea())));
+			PreludeWorld->GetArea(pLocator->GetArea())->AddToUpdate(this);
+			this->ClearActions();
+			RECT rUpdate;
+			rUpdate.left = (PreludeWorld->GetScreenX() * CHUNK_TILE_WIDTH) - 16;
+			rUpdate.right = rUpdate.left + 32;
+			rUpdate.top = (PreludeWorld->GetScreenY() * CHUNK_TILE_HEIGHT) - 16;
+			rUpdate.bottom = rUpdate.top + 32;
+
+			if(this->GetPosition()->x > rUpdate.left &&
+				this->GetPosition()->y > rUpdate.top &&
+				this->GetPosition()->x < rUpdate.right &&
+				this->GetPosition()->y < rUpdate.bottom)
+			{
+				this->CreateTexture();
+			}
+			break;
+		}
+		else
+		{
+			NewX = (GameRand() % (rLoc.right - rLoc.left)) + rLoc.left;
+			NewY = (GameRand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
+		}	
+	}
 }
 
 
@@ -1704,6 +1733,8 @@ void Creature::UpdateOffScreen()
 //	Update this creature based on its current action
 ACTION_RESULT_T Creature::Update(void)
 {
+	ProfileZone UpdateZone(ZONE_CREATURE_UPDATE);
+
 	if(!pTexture)
 	{
 		CreateTexture();
@@ -2227,14 +2258,14 @@ int Creature::TakeDamage(Thing *pDamageSource, int DamageAmount, DAMAGE_T Damage
 		{
 			if(GetData(INDEX_SEX).Value)
 			{
-				if(rand() % 2)
+				if(GameRand() % 2)
 					Engine->Sound()->PlayEffect(24);
 				else
 					Engine->Sound()->PlayEffect(25);
 			}
 			else
 			{
-				if(rand() % 2)
+				if(GameRand() % 2)
 					Engine->Sound()->PlayEffect(20);
 				else
 					Engine->Sound()->PlayEffect(21);
@@ -2246,21 +2277,21 @@ int Creature::TakeDamage(Thing *pDamageSource, int DamageAmount, DAMAGE_T Damage
 
 	//done
 	int ChanceToExclaim;
-	ChanceToExclaim = rand() % 100;
+	ChanceToExclaim = GameRand() % 100;
 	if(FinalDamage && (ChanceToExclaim < 30 || FinalDamage > 10))
 	{
 		if(!GetData(INDEX_TYPE).Value)
 		{
 			if(GetData(INDEX_SEX).Value)
 			{
-				if(rand() % 2)
+				if(GameRand() % 2)
 					Engine->Sound()->PlayEffect(24);
 				else
 					Engine->Sound()->PlayEffect(25);
 			}
 			else
 			{
-				if(rand() % 2)
+				if(GameRand() % 2)
 					Engine->Sound()->PlayEffect(20);
 				else
 					Engine->Sound()->PlayEffect(21);
@@ -2723,10 +2754,12 @@ ACTION_RESULT_T Creature::MoveTo()
 
 	if(PreludeWorld->GetGameState() != GAME_STATE_COMBAT)
 	{
+		//long routes only get pathed a few chunks ahead, MoveTo picks up
+		//again from the end of the path
 		if(!Large)
-			pPath->FindPath(StartX,StartY,EndX,EndY, 0.0f, this);
+			pPath->FindLongPath(StartX,StartY,EndX,EndY, 0.0f, this);
 		else
-			pPath->FindLargePath(StartX,StartY,EndX,EndY, 0.0f, this);
+			pPath->FindLargeLongPath(StartX,StartY,EndX,EndY, 0.0f, this);
 	}
 	else
 	{
@@ -3353,7 +3386,7 @@ ACTION_RESULT_T Creature::MoveIn()
 			if(Distance < CanSeeDistance)
 			{
 				ULONG TimeNow;
-				TimeNow = timeGetTime();
+				TimeNow = GameTime();
 				if(TimeNow - LastChecked > PATH_CHECK_TIME)
 				{
 					LastChecked = TimeNow;
@@ -3553,7 +3586,7 @@ ACTION_RESULT_T Creature::MoveNoRotate()
 			if(Distance < CanSeeDistance)
 			{
 				ULONG TimeNow;
-				TimeNow = timeGetTime();
+				TimeNow = GameTime();
 				if(TimeNow - LastChecked > PATH_CHECK_TIME)
 				{
 					LastChecked = TimeNow;
@@ -4378,7 +4411,7 @@ ACTION_RESULT_T Creature::Attack()
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData(INDEX_BATTLESTATUS).Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -4428,7 +4461,7 @@ ACTION_RESULT_T Creature::Attack()
 			{
 				DamageRange += (pItem->GetData("MAXDAMAGE").Value - pItem->GetData("MINDAMAGE").Value);
 				MinDamage = pItem->GetData("MINDAMAGE").Value;
-				BaseDamage = (rand() % DamageRange) + MinDamage;
+				BaseDamage = (GameRand() % DamageRange) + MinDamage;
 			}
 
 			SetAmmoItemNumber(0);
@@ -4568,7 +4601,7 @@ ACTION_RESULT_T Creature::Attack()
 		{
 			((Creature *)pDefender)->TakeDamage(this,BaseDamage,(DAMAGE_T)GetData(INDEX_DAMAGETYPE).Value);
 		}
-		if(rand() % 3)
+		if(GameRand() % 3)
 			pDefender->ImproveSkill(INDEX_ARMOR);
 
 		pCurAction->Finish();
@@ -4747,7 +4780,7 @@ ACTION_RESULT_T Creature::SecondaryAttack()
 
 	int AttackRoll;
 
-	AttackRoll = rand() % 100;
+	AttackRoll = GameRand() % 100;
 
 	if(pDefender->GetData("BATTLESTATUS").Value == CREATURE_STATE_UNCONSCIOUS)
 	{
@@ -4854,7 +4887,7 @@ ACTION_RESULT_T Creature::SecondaryAttack()
 		
 		((Creature *)pDefender)->TakeDamage(this,BaseDamage,(DAMAGE_T)GetData(INDEX_DAMAGETYPE).Value);
 
-		if(rand() % 3)
+		if(GameRand() % 3)
 			pDefender->ImproveSkill(INDEX_ARMOR);
 
 		pCurAction->Finish();
@@ -5229,7 +5262,7 @@ ACTION_RESULT_T Creature::Drop()
 
 	vDropAt = *pNewGI->GetOwner()->GetPosition();
 	pNewGI->SetPosition(&vDropAt);
-	pNewGI->SetAngle(((float)(rand() %100)  / 100.0f) * PI_MUL_2);
+	pNewGI->SetAngle(((float)(GameRand() %100)  / 100.0f) * PI_MUL_2);
 	pNewGI->SetRegionIn(Valley->GetRegion(&vDropAt));
 	Valley->AddToUpdate(pNewGI);
 	if(pNewGI->GetOwner())
@@ -5415,7 +5448,7 @@ ACTION_RESULT_T Creature::Die()
 				if(pGI->GetData(INDEX_TYPE).Value == ITEM_TYPE_ARMOR)
 				{
 					int pRand;
-					pRand = rand() % 100;
+					pRand = GameRand() % 100;
 					if(pRand < 33)
 					{
 						Drop = TRUE;
@@ -5432,7 +5465,7 @@ ACTION_RESULT_T Creature::Die()
 					pNewGI->SetItem(pGI->GetCompressed());
 					pNewGI->SetPosition(this->GetPosition());
 					pNewGI->SetLocation(LOCATION_WORLD);
-					pNewGI->SetAngle(((float)(rand() %100)  / 100.0f) * PI_MUL_2);
+					pNewGI->SetAngle(((float)(GameRand() %100)  / 100.0f) * PI_MUL_2);
 					pNewGI->SetOwner(PreludeParty.GetLeader());
 					Valley->AddToUpdate((Object *)pNewGI);
 				}
@@ -5457,7 +5490,7 @@ ACTION_RESULT_T Creature::Die()
 						pNewGI->SetItem((Item *)pSA->GetValue());
 						pNewGI->SetPosition(this->GetPosition());
 						pNewGI->SetLocation(LOCATION_WORLD);
-						pNewGI->SetAngle(((float)(rand() %100)  / 100.0f) * PI_MUL_2);
+						pNewGI->SetAngle(((float)(GameRand() %100)  / 100.0f) * PI_MUL_2);
 						pNewGI->SetOwner(PreludeParty.GetLeader());
 						Valley->AddToUpdate((Object *)pNewGI);
 					}
@@ -5468,7 +5501,7 @@ ACTION_RESULT_T Creature::Die()
 					pNewGI->SetItem(pGI->GetCompressed());
 					pNewGI->SetPosition(this->GetPosition());
 					pNewGI->SetLocation(LOCATION_WORLD);
-					pNewGI->SetAngle(((float)(rand() %100)  / 100.0f) * PI_MUL_2);
+					pNewGI->SetAngle(((float)(GameRand() %100)  / 100.0f) * PI_MUL_2);
 					pNewGI->SetOwner(PreludeParty.GetLeader());
 					Valley->AddToUpdate((Object *)pNewGI);
 				}
@@ -5839,7 +5872,7 @@ ACTION_RESULT_T Creature::Think()
 				Distance = GetDistance(this->GetPosition(),PreludeParty.GetMember(n)->GetPosition());
 				if(Distance < CanSeeDistance)
 				{
-					TimeNow = timeGetTime();
+					TimeNow = GameTime();
 					if(TimeNow - LastChecked > PATH_CHECK_TIME)
 					{
 						LastChecked = TimeNow;
@@ -5931,12 +5964,12 @@ ACTION_RESULT_T Creature::Think()
 							InsertAction(ACTION_ROTATE, NULL, (void *)(int)Schedule[n].GetAngle(), FALSE);
 						default:
 						case 0:
-							if(!(rand() % 5))
+							if(!(GameRand() % 5))
 							{
 								int NewX;
 								int NewY;
-								NewX = (rand() % (rLoc.right - rLoc.left)) + rLoc.left;
-								NewY = (rand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
+								NewX = (GameRand() % (rLoc.right - rLoc.left)) + rLoc.left;
+								NewY = (GameRand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
 								BOOL Small;
 								Small = (rLoc.right - rLoc.left == 1) && (rLoc.bottom - rLoc.top == 1);
 								if(Small || (!Large && PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY))
@@ -6381,7 +6414,7 @@ ACTION_RESULT_T Creature::Open()
 
 					if(Confirm(ZSWindow::GetMain(), "Pick the Lock?","yes","no"))
 					{
-						if(!(rand() % 3))
+						if(!(GameRand() % 3))
 							this->ImproveSkill(INDEX_TINKER);
 
 						//check to see if anyone notices
@@ -6448,7 +6481,7 @@ ACTION_RESULT_T Creature::Open()
 							{
 								TinkerChance = (TinkerSkill - LockValue) * 10;
 								int nrand;
-								nrand = rand() % 100;
+								nrand = GameRand() % 100;
 								if(nrand < TinkerChance)
 								{
 									sprintf(blarg,"%s picks the lock.", pPicker->GetData(INDEX_NAME).String);
@@ -6604,7 +6637,7 @@ ACTION_RESULT_T Creature::Open()
 					{
 						TinkerChance = (TinkerSkill - LockValue) * 10;
 						int nrand;
-						nrand = rand() % 100;
+						nrand = GameRand() % 100;
 						if(TinkerChance > 0 && nrand < TinkerChance)
 						{
 							sprintf(blarg,"%s picks the lock.", pPicker->GetData(INDEX_NAME).String);
@@ -6763,14 +6796,14 @@ ACTION_RESULT_T Creature::PickPocket()
 				if(!pGI)
 					pGI = (GameItem *)pTarget->GetContents();
 				
-				if(pGI && (rand() % 100) < GrabbedChance)
+				if(pGI && (GameRand() % 100) < GrabbedChance)
 				{
 					Item *pItem;
 					pItem = pGI->GetItem();
 					if(pItem->GetData("WEIGHT").Value < MaxWeight)
 					{
 						int Quantity;
-						Quantity = (rand() % pGI->GetQuantity()) + 1;
+						Quantity = (GameRand() % pGI->GetQuantity()) + 1;
 
 						if(pGI->GetData("DROPOVERRIDE").Value)
 						{
@@ -6885,6 +6918,7 @@ int Creature::EnterCombat()
 int Creature::SetFirst(Creature *NewFirst)
 {
 	pFirst = NewFirst;
+	InvalidateFind(OBJECT_CREATURE);
 	return TRUE;
 }
 
@@ -7820,46 +7854,13 @@ int DeleteCreatures()
 
 Creature *Creature::FindCreature(const char *Name)
 {
-	Creature *pCreature;
-	pCreature = pFirst;
-
-	while(pCreature)
-	{
-		if(!strcmp(pCreature->GetData(INDEX_NAME).String,Name))
-		{
-			return pCreature;
-		}
-		else
-		{
-			pCreature = (Creature *)pCreature->GetNext();
-		}
-	}
-
-	//GOT_HERE("unable to find creature name %s",Name);
-
-	return FALSE;
+	return (Creature *)Thing::Find(pFirst, Name);
 }
 
+//despite the name this matches the creature's ID field, not its UID
 Creature *Creature::FindCreature(int UID)
 {
-	Creature *pCreature;
-	pCreature = pFirst;
-
-	while(pCreature)
-	{
-		if(pCreature->GetData(INDEX_ID).Value == UID)
-		{
-			return pCreature;
-		}
-		else
-		{
-			pCreature = (Creature *)pCreature->GetNext();
-		}
-	}
-
-//	GOT_HERE("unable to find creature with ID %i",UID);
-
-	return FALSE;
+	return (Creature *)Thing::Find(pFirst, UID);
 }
 
 void Creature::InitTextures()
@@ -9209,6 +9210,7 @@ int Creature::Give(Thing *ToReceive, int Quantity)
 
 Creature& Creature::operator = (Creature &OtherThing)
 {
+	ChangingFindKey();
 	for(int n = 0; n < NumFields; n++)
 	{
 		switch(DataTypes[n])
@@ -9479,7 +9481,7 @@ void Creature::PlaceByLocator()
 	while(pCreature)
 	{
 		int newangle;
-		newangle = rand() % NORTHWEST + 1;
+		newangle = GameRand() % NORTHWEST + 1;
 		pCreature->SetAngle(DIRECTIONANGLES[newangle]);
 		if(pCreature->GetNumLocators())
 		{	
@@ -9503,8 +9505,8 @@ void Creature::PlaceByLocator()
 					{
 						for(int nn = 0; nn < 20; nn++)
 						{
-							NewX = (rand() % (rLoc.right - rLoc.left)) + rLoc.left;
-							NewY = (rand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
+							NewX = (GameRand() % (rLoc.right - rLoc.left)) + rLoc.left;
+							NewY = (GameRand() % (rLoc.bottom - rLoc.top)) + rLoc.top;
 							if(PreludeWorld->GetArea(pLocator->GetArea())->IsClear(NewX,NewY))
 							{
 								break;
@@ -9583,6 +9585,8 @@ void Creature::Sort()
 		pCreature = (Creature *)pCreature->GetNext();
 	}
 
+	InvalidateFind(OBJECT_CREATURE);
+
 	DEBUG_INFO("Creatures area sorted\n");
 
 }
@@ -10866,7 +10870,7 @@ int Creature::GetDamage(BOOL OffHand, BOOL Average)
 	}
 	else
 	{
-		Damage = MinDamage + (rand() % DamageRange);
+		Damage = MinDamage + (GameRand() % DamageRange);
 	}
 
 	//easy
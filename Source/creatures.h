@@ -230,6 +230,13 @@ private:
 	//last time manually placed
 	unsigned long LastPlacedTime;
 
+	//last time the offscreen scheduler ticked this creature, and how
+	//much game time that tick had to make up
+	unsigned long LastOffScreenTime;
+	unsigned long OffScreenCatchUp;
+	//where the offscreen scheduler last put it in its pass, -1 for nowhere
+	int OffScreenEntry;
+
 	//last target location
 	D3DVECTOR vLastTarget;
 
@@ -247,6 +254,9 @@ public:
 	D3DVECTOR GetLastTarget() { return vLastTarget; };
 
 	unsigned long GetLastPlacedTime() { return LastPlacedTime; }
+	unsigned long GetLastOffScreenTime() { return LastOffScreenTime; }
+	unsigned long GetOffScreenCatchUp() { return OffScreenCatchUp; }
+	int GetOffScreenEntry() { return OffScreenEntry; }
 
 	void SetAmmoItemNumber(int n) { AmmoItemNumber = n; }
 	BOOL HasAmmo();
@@ -337,6 +347,14 @@ public:
 
    ACTION_RESULT_T Update(void);				
 	void UpdateOffScreen(void);	
+	//the pieces of UpdateOffScreen
+	void ReleaseOffScreenTexture();
+	//which locator the creature should be moved to at this hour, -1 if
+	//it is where it belongs.  Only reads the creature, safe off the main thread
+	int CheckSchedule(int Hour);
+	void MoveToLocator(int Num);
+	void SetOffScreenTime(unsigned long NewTime, unsigned long CatchUp) { LastOffScreenTime = NewTime; OffScreenCatchUp = CatchUp; }
+	void SetOffScreenEntry(int NewEntry) { OffScreenEntry = NewEntry; }
 
    //actions that may be performed on creatures
    int Use(Thing *pUser);
@@ -473,6 +491,8 @@ public:
 
 int LoadCreatures(FILE *fp);
 int SaveCreatures(FILE *fp);
+int LoadBinCreatures(FILE *fp);
+int SaveBinCreatures(FILE *fp);
 int DeleteCreatures();
 Creature *LoadCreature(FILE *fp);
 void ReImportCreatures(FILE *fp);
@@ -0,0 +1,403 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				debuglog.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  buffered logging to debug.txt, each thread writes into its
+//*			 own ring and a background thread writes the rings out
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		lines from different threads come out grouped by thread within
+//*		each write, not strictly in time order
+//*********************************************************************
+//*********************************************************************
+#include "debuglog.h"
+#include "zsutilities.h"
+#include <stdarg.h>
+#include <string.h>
+
+#ifdef NDEBUG
+int LogLevel = LOG_INFO;
+#else
+int LogLevel = LOG_DEBUG;
+#endif
+int LogCategories = LOG_ALL;
+
+static LOG_RING_T Rings[LOG_MAX_THREADS];
+//one past the highest ring ever taken, as far as the writer looks
+static volatile LONG NumRings = 0;
+static __declspec(thread) LOG_RING_T *pThreadRing = NULL;
+
+//messages dropped for want of a ring or of room in one
+static volatile LONG NumLost = 0;
+
+static FILE *fpLog = NULL;
+static BOOL Initialized = FALSE;
+static CRITICAL_SECTION csWrite;
+static HANDLE hWake = NULL;
+static HANDLE hWriter = NULL;
+static volatile BOOL Quit = FALSE;
+static DWORD StartTime = 0;
+
+static const char *LevelNames[] = { "error", "warning", "info", "debug" };
+static const char *CategoryNames[LOG_NUM_CATEGORIES] = { "general", "script", "world", "creature", "combat", "engine", "file" };
+
+//************** Writing  *********************************************
+
+static void WriteRecord(LOG_RECORD_T *pRecord)
+{
+	int n;
+
+	if(pRecord->Flags & LOG_RECORD_HEADER)
+	{
+		for(n = 0; n < LOG_NUM_CATEGORIES; n++)
+		{
+			if(pRecord->Category & (1 << n))
+			{
+				break;
+			}
+		}
+		fprintf(fpLog, "%8lu %s %s: ", (unsigned long)pRecord->Time,
+			LevelNames[pRecord->Level],
+			n < LOG_NUM_CATEGORIES ? CategoryNames[n] : "general");
+	}
+	fputs(pRecord->Text, fpLog);
+}
+
+//the caller holds csWrite
+static void Drain()
+{
+	LOG_RING_T *pRing;
+	LONG Head;
+	LONG Tail;
+	LONG Lost;
+	int Num;
+	int n;
+
+	Num = NumRings;
+	if(Num > LOG_MAX_THREADS)
+	{
+		Num = LOG_MAX_THREADS;
+	}
+
+	for(n = 0; n < Num; n++)
+	{
+		pRing = &Rings[n];
+		Head = pRing->Head;
+		Tail = pRing->Tail;
+		while(Tail != Head)
+		{
+			WriteRecord(&pRing->Records[Tail & (LOG_RING_SIZE - 1)]);
+			Tail++;
+		}
+		InterlockedExchange((LONG *)&pRing->Tail, Tail);
+	}
+
+	Lost = InterlockedExchange((LONG *)&NumLost, 0);
+	if(Lost)
+	{
+		fprintf(fpLog, "%ld log messages lost\n", (long)Lost);
+	}
+	fflush(fpLog);
+}
+
+static DWORD WINAPI WriterThread(LPVOID pParam)
+{
+	while(!Quit)
+	{
+		WaitForSingleObject(hWake, LOG_WRITE_INTERVAL);
+
+		EnterCriticalSection(&csWrite);
+		Drain();
+		LeaveCriticalSection(&csWrite);
+	}
+	return 0;
+}
+
+//************** Logging  *********************************************
+
+static LOG_RING_T *GetRing()
+{
+	LONG Num;
+	int n;
+
+	if(!pThreadRing)
+	{
+		for(n = 0; n < LOG_MAX_THREADS; n++)
+		{
+			if(!Rings[n].InUse && InterlockedCompareExchange(&Rings[n].InUse, 1, 0) == 0)
+			{
+				break;
+			}
+		}
+		if(n >= LOG_MAX_THREADS)
+		{
+			return NULL;
+		}
+		Rings[n].ThreadID = GetCurrentThreadId();
+
+		Num = NumRings;
+		while(Num <= n && InterlockedCompareExchange(&NumRings, n + 1, Num) != Num)
+		{
+			Num = NumRings;
+		}
+		pThreadRing = &Rings[n];
+	}
+	return pThreadRing;
+}
+
+void LogThreadDone()
+{
+	if(pThreadRing)
+	{
+		pThreadRing = NULL;
+		LogReleaseThread(GetCurrentThreadId());
+	}
+}
+
+void LogReleaseThread(DWORD ThreadID)
+{
+	int n;
+
+	for(n = 0; n < LOG_MAX_THREADS; n++)
+	{
+		if(Rings[n].InUse && Rings[n].ThreadID == ThreadID)
+		{
+			Rings[n].ThreadID = 0;
+			InterlockedExchange(&Rings[n].InUse, 0);
+			return;
+		}
+	}
+}
+
+static void Write(int Level, int Category, const char *Text, int Flags)
+{
+	LOG_RING_T *pRing;
+	LOG_RECORD_T *pRecord;
+	DWORD Time;
+	LONG Head;
+	int Length;
+	int NumRecords;
+	int Tries;
+	int n;
+
+	pRing = GetRing();
+	if(!pRing)
+	{
+		InterlockedIncrement((LONG *)&NumLost);
+		return;
+	}
+
+	//the records of one message are published together so the writer
+	//never splits them
+	Length = strlen(Text);
+	NumRecords = (Length + LOG_TEXT_LENGTH - 2) / (LOG_TEXT_LENGTH - 1);
+	if(NumRecords < 1)
+	{
+		NumRecords = 1;
+	}
+	if(NumRecords > LOG_RING_SIZE / 2)
+	{
+		NumRecords = LOG_RING_SIZE / 2;
+	}
+
+	Tries = 0;
+	while(pRing->Head + NumRecords - pRing->Tail > LOG_RING_SIZE)
+	{
+		if(!hWriter)
+		{
+			//not started or already stopped, write it out here if we can
+			if(!fpLog)
+			{
+				InterlockedIncrement((LONG *)&NumLost);
+				return;
+			}
+			LogFlush();
+		}
+		else
+		{
+			SetEvent(hWake);
+			if(++Tries > LOG_FULL_WAIT)
+			{
+				InterlockedIncrement((LONG *)&NumLost);
+				return;
+			}
+			Sleep(1);
+		}
+	}
+
+	Time = GetTickCount() - StartTime;
+	Head = pRing->Head;
+	for(n = 0; n < NumRecords; n++)
+	{
+		pRecord = &pRing->Records[(Head + n) & (LOG_RING_SIZE - 1)];
+		pRecord->Level = (BYTE)Level;
+		pRecord->Flags = (BYTE)(n ? LOG_RECORD_MORE : Flags);
+		pRecord->Category = (WORD)Category;
+		pRecord->Time = Time;
+		strncpy(pRecord->Text, Text, LOG_TEXT_LENGTH - 1);
+		pRecord->Text[LOG_TEXT_LENGTH - 1] = '\0';
+		Text += strlen(pRecord->Text);
+	}
+	InterlockedExchange((LONG *)&pRing->Head, Head + NumRecords);
+
+	if(!hWriter)
+	{
+		if(fpLog)
+		{
+			LogFlush();
+		}
+	}
+	else
+	if(Level == LOG_ERROR || pRing->Head - pRing->Tail >= LOG_RING_SIZE / 2)
+	{
+		SetEvent(hWake);
+	}
+}
+
+void LogWrite(int Level, int Category, const char *Text)
+{
+	if(!LOG_ENABLED(Level, Category))
+	{
+		return;
+	}
+	Write(Level, Category, Text, 0);
+}
+
+void LogPrintf(int Level, int Category, const char *Format, ...)
+{
+	char Text[LOG_FORMAT_LENGTH + 1];
+	va_list Args;
+	int Length;
+
+	if(!LOG_ENABLED(Level, Category))
+	{
+		return;
+	}
+
+	va_start(Args, Format);
+	Length = _vsnprintf(Text, LOG_FORMAT_LENGTH - 1, Format, Args);
+	va_end(Args);
+
+	if(Length < 0 || Length > LOG_FORMAT_LENGTH - 1)
+	{
+		Length = LOG_FORMAT_LENGTH - 1;
+	}
+	Text[Length] = '\0';
+	if(!Length || Text[Length - 1] != '\n')
+	{
+		Text[Length] = '\n';
+		Text[Length + 1] = '\0';
+	}
+
+	Write(Level, Category, Text, LOG_RECORD_HEADER);
+}
+
+//************** Control  *********************************************
+
+void LogInit(const char *FileName)
+{
+	FILE *fp;
+	DWORD ThreadID;
+
+	if(Initialized)
+	{
+		return;
+	}
+
+	fpLog = fopen(FileName, "wt");
+	if(!fpLog)
+	{
+		FATAL_ERROR("Failed to create debug file.");
+		return;
+	}
+
+	fp = fopen("gui.ini","rt");
+	if(fp)
+	{
+		if(SeekTo(fp,"LOGLEVEL"))
+		{
+			LogLevel = GetInt(fp);
+		}
+		fseek(fp,0,SEEK_SET);
+		if(SeekTo(fp,"LOGCATEGORIES"))
+		{
+			LogCategories = GetInt(fp);
+		}
+		fclose(fp);
+	}
+
+	StartTime = GetTickCount();
+	InitializeCriticalSection(&csWrite);
+	Initialized = TRUE;
+
+	Quit = FALSE;
+	hWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+	hWriter = CreateThread(NULL,
+			0,
+			(LPTHREAD_START_ROUTINE)WriterThread,
+			NULL,
+			0,
+			&ThreadID);
+
+	if(hWriter)
+	{
+		SetThreadPriority(hWriter, THREAD_PRIORITY_BELOW_NORMAL);
+	}
+
+	LogFlush();
+}
+
+void LogShutdown()
+{
+	if(hWriter)
+	{
+		Quit = TRUE;
+		SetEvent(hWake);
+		WaitForSingleObject(hWriter, INFINITE);
+		CloseHandle(hWriter);
+		hWriter = NULL;
+	}
+	if(hWake)
+	{
+		CloseHandle(hWake);
+		hWake = NULL;
+	}
+
+	//the file stays open for whatever is logged on the way out
+	LogFlush();
+}
+
+void LogFlush()
+{
+	if(!Initialized)
+	{
+		return;
+	}
+
+	EnterCriticalSection(&csWrite);
+	Drain();
+	LeaveCriticalSection(&csWrite);
+}
+
+FILE *LogGetFile()
+{
+	if(!Initialized)
+	{
+		return NULL;
+	}
+
+	EnterCriticalSection(&csWrite);
+	Drain();
+	return fpLog;
+}
+
+void LogReleaseFile()
+{
+	fflush(fpLog);
+	LeaveCriticalSection(&csWrite);
+}
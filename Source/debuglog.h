@@ -0,0 +1,115 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				debuglog.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  buffered logging to debug.txt, each thread writes into its
+//*			 own ring and a background thread writes the rings out
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		lines from different threads come out grouped by thread within
+//*		each write, not strictly in time order
+//*********************************************************************
+//*********************************************************************
+#ifndef DEBUGLOG_H
+#define DEBUGLOG_H
+
+#include <windows.h>
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+typedef enum
+{
+	LOG_ERROR,
+	LOG_WARNING,
+	LOG_INFO,
+	LOG_DEBUG,
+} LOG_LEVEL_T;
+
+//categories, a message may be in more than one
+#define LOG_GENERAL				0x0001
+#define LOG_SCRIPT				0x0002
+#define LOG_WORLD					0x0004
+#define LOG_CREATURE				0x0008
+#define LOG_COMBAT				0x0010
+#define LOG_ENGINE				0x0020
+#define LOG_FILE					0x0040
+#define LOG_NUM_CATEGORIES		7
+#define LOG_ALL					0xffff
+
+#define LOG_MAX_THREADS			16
+//records in each thread's ring, a power of two
+#define LOG_RING_SIZE			128
+//a longer message takes several records
+#define LOG_TEXT_LENGTH			120
+//milliseconds between writes when nobody wakes the writer
+#define LOG_WRITE_INTERVAL		50
+//milliseconds a thread waits for room in a full ring before dropping
+#define LOG_FULL_WAIT			100
+//longest message LogPrintf formats
+#define LOG_FORMAT_LENGTH		1024
+
+//record flags
+#define LOG_RECORD_HEADER		0x01	//starts a LogPrintf line
+#define LOG_RECORD_MORE			0x02	//carries on the record before it
+
+typedef struct
+{
+	BYTE Level;
+	BYTE Flags;
+	WORD Category;
+	DWORD Time;
+	char Text[LOG_TEXT_LENGTH];
+} LOG_RECORD_T;
+
+//Head is only moved by the thread that owns the ring and Tail only by
+//the writer, each publishes its move with an interlocked exchange.
+//a ring given back keeps its unwritten records, the next thread to take
+//it carries on from Head
+typedef struct
+{
+	volatile LONG Head;
+	volatile LONG Tail;
+	volatile LONG InUse;
+	DWORD ThreadID;
+	LOG_RECORD_T Records[LOG_RING_SIZE];
+} LOG_RING_T;
+
+//messages above the level or outside the categories are thrown away
+//before they are formatted
+extern int LogLevel;
+extern int LogCategories;
+
+#define LOG_ENABLED(Level, Category)	((Level) <= LogLevel && ((Category) & LogCategories))
+
+//opens the file and starts the writer, reads LOGLEVEL and LOGCATEGORIES
+//from gui.ini.  anything logged before this is written once it is called
+void LogInit(const char *FileName);
+//writes everything out and stops the writer, later messages are
+//written as they come
+void LogShutdown();
+//writes out everything logged so far from every thread
+void LogFlush();
+
+//gives the calling thread's ring back for another thread to take, call
+//it last thing in a thread procedure that logs.  LogReleaseThread does
+//the same for a thread stopped with TerminateThread
+void LogThreadDone();
+void LogReleaseThread(DWORD ThreadID);
+
+//the text goes out as it is
+void LogWrite(int Level, int Category, const char *Text);
+//one line, headed with the time, level and category
+void LogPrintf(int Level, int Category, const char *Format, ...);
+
+//flushes and hands over the file for a dump straight to it, nothing else
+//is written until LogReleaseFile.  NULL before LogInit
+FILE *LogGetFile();
+void LogReleaseFile();
+
+#endif
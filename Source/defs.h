@@ -29,26 +29,20 @@
 #ifndef NDEBUG
 	#define FATAL_ERROR(message)	{ MessageBox(NULL, message, "Fatal Error", MB_OK | MB_ICONSTOP); exit(1); }
 	#define GOT_HERE(message)		{ MessageBox(NULL, message, "Got Here", MB_OK); }
-	#define DEBUG_INFO(message)	{	FILE *fp; \
-												fp = fopen(DEBUG_FILE_NAME,"a+t"); \
-												fprintf(fp, message); \
-												fclose(fp); }
-	#define INIT_DEBUG() {	FILE *fp; \
-									fp = fopen(DEBUG_FILE_NAME,"wt"); \
-									if(!fp) \
-									{ \
-										FATAL_ERROR("Failed to create debug file."); \
-									} \
-									fclose(fp); }
 #endif
 
 #ifdef NDEBUG
 	#define FATAL_ERROR(message)
 	#define GOT_HERE(message)
-	#define DEBUG_INFO(message)
-	#define INIT_DEBUG()
 #endif
 
+//debug messages go through the log in every build, release only keeps
+//LOG_INFO and up unless gui.ini says otherwise
+#include "debuglog.h"
+
+#define DEBUG_INFO(message)	{ if(LOG_ENABLED(LOG_DEBUG, LOG_GENERAL)) LogWrite(LOG_DEBUG, LOG_GENERAL, message); }
+#define INIT_DEBUG()				LogInit(DEBUG_FILE_NAME)
+
 //3d math stuff
 #define DEGRAD_CONSTANT   0.01744f
 #define RADDEG_CONSTANT	57.32484f
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include "flags.h"
 #include "zsmessage.h"
+#include "replay.h"
 
 EventManager PreludeEvents;
 #define EVENT_CHECK_TIME	20
@@ -251,21 +252,36 @@ void EventManager::LoadEvents(const char *filename)
 	FILE *fp;
 	fp = SafeFileOpen(filename,"rb");
 
+	FreeEvents();
+
 	fread(&NumEvents,sizeof(NumEvents),1,fp);
 
-	if(SBEvents)
-	{
-		delete[] SBEvents;
-	}
-	
 	SBEvents = new ScriptBlock[NumEvents];
 
 	for(int n = 0; n < NumEvents; n++)
 	{
-		SBEvents[n].Load(fp);
+		SBEvents[n].Load(fp, pEventScripts);
 	}
 
 	fclose(fp);
+
+	ReportScripts(filename);
+}
+
+void EventManager::FreeEvents()
+{
+	if(SBEvents)
+	{
+		delete[] SBEvents;
+		SBEvents = NULL;
+	}
+	pEventScripts->Clear();
+}
+
+void EventManager::ReportScripts(const char *filename)
+{
+	LogPrintf(LOG_INFO, LOG_SCRIPT, "%s: %i events in %i bytes of script memory, %i heap allocations instead of %i",
+		filename, NumEvents, pEventScripts->GetHeapBytes(), pEventScripts->GetNumChunks(), pEventScripts->GetNumPieces());
 }
 
 void EventManager::SaveEvents(const char *filename)
@@ -294,6 +310,8 @@ void EventManager::ImportEvents(const char *filename)
 		TwiceNum++;
 	}
 	NumEvents = TwiceNum /2;
+
+	FreeEvents();
 	
 	SBEvents = new ScriptBlock[NumEvents];
 
@@ -311,10 +329,12 @@ void EventManager::ImportEvents(const char *filename)
 		}
 
 		SeekTo(fp,"#");
-		SBEvents[n].Import(fp);
+		SBEvents[n].Import(fp, pEventScripts);
 	}
 
 	fclose(fp);
+
+	ReportScripts(filename);
 }
 
 void EventManager::DoTimed(unsigned long CurTime)
@@ -929,6 +949,7 @@ EventManager::EventManager()
 {
 	ForceRandom = FALSE;
 	SBEvents = NULL;
+	pEventScripts = new ScriptManager;
 	NumEvents = 0;
 	epTimed = NULL;
 	epStartCombat = NULL;
@@ -989,6 +1010,7 @@ EventManager::~EventManager()
 	{
 		delete[] SBEvents;
 	}
+	delete pEventScripts;
 	//delete the lists
 
 
@@ -1040,7 +1062,7 @@ BOOL EventManager::CheckForRandomEvent()
 
 
 	int EventRoll;
-	EventRoll = (rand() % 100) + 2;
+	EventRoll = (GameRand() % 100) + 2;
 	
 	if(!ForceRandom && EventRoll > ChanceForEvent)
 	{
@@ -1171,7 +1193,7 @@ int EventManager::RandomSleep()
 	LastSleepTime = PreludeWorld->GetTotalTime();
 
 	int Chance;
-	Chance = rand() % ChanceMod;
+	Chance = GameRand() % ChanceMod;
 
 	if(Chance <= TimesSinceSleepCalled)
 	{
@@ -4,6 +4,7 @@
 #include "objects.h"
 
 class ScriptBlock;
+class ScriptManager;
 
 typedef enum
 {
@@ -99,6 +100,8 @@ private:
 
 	//the master list of events
 	ScriptBlock *SBEvents;
+	//everything loaded from the events file, freed together
+	ScriptManager *pEventScripts;
 
 	//events that are not area based
 	Event *epTimed;
@@ -113,11 +116,17 @@ private:
 	void AddEvent(Event **ListStart, Event *ToAdd);
 	void RemoveEvent(Event **ListStart, Event *ToAdd);
 
+	//drops the old events before a load
+	void FreeEvents();
+	//logs what loading the events cost the heap
+	void ReportScripts(const char *filename);
+
 public:
 
 	void Clear();
 
 	ScriptBlock *GetEvent(int num);
+	int GetNumEvents() { return NumEvents; }
 
 	void RunEvent(int Num);
 
@@ -0,0 +1,183 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				fieldschema.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed field name to index maps for the thing data files
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#include "fieldschema.h"
+#include <string.h>
+
+//************** static Members *********************************
+
+FieldSchema FieldSchema::Schemas[MAX_FIELD_SCHEMAS];
+int FieldSchema::NumSchemas = 0;
+FieldSchema *FieldSchema::pLastSchema = NULL;
+
+//************** Constructors  ****************************************
+
+FieldSchema::FieldSchema()
+{
+	Names = NULL;
+	NumFields = 0;
+	Hashes = NULL;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+FieldSchema::~FieldSchema()
+{
+	Clear();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+int FieldSchema::Find(const char *FieldName)
+{
+	unsigned int Hash;
+	int Slot;
+	int n;
+
+	Hash = HashString(FieldName);
+	for(Slot = Table.First(Hash); (n = Table.Get(Slot)) != HASH_EMPTY; Slot = Table.Next(Slot))
+	{
+		if(Hashes[n] == Hash && !strcmp(&Names[n * FIELD_NAME_LENGTH], FieldName))
+		{
+			return n;
+		}
+	}
+
+	return -1;
+}
+
+FieldSchema *FieldSchema::Get(char *FieldNames, int NumFieldNames)
+{
+	int n;
+
+	//a thing may use fewer fields than its class, callers check the index
+	//against their own count
+	if(pLastSchema && pLastSchema->Names == FieldNames && NumFieldNames <= pLastSchema->NumFields)
+	{
+		return pLastSchema;
+	}
+
+	for(n = 0; n < NumSchemas; n++)
+	{
+		if(Schemas[n].Names == FieldNames)
+		{
+			if(Schemas[n].NumFields < NumFieldNames)
+			{
+				Schemas[n].Build(FieldNames, NumFieldNames);
+			}
+			pLastSchema = &Schemas[n];
+			return pLastSchema;
+		}
+	}
+
+	if(NumSchemas >= MAX_FIELD_SCHEMAS)
+	{
+		return NULL;
+	}
+
+	Schemas[NumSchemas].Build(FieldNames, NumFieldNames);
+	pLastSchema = &Schemas[NumSchemas];
+	NumSchemas++;
+
+	return pLastSchema;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void FieldSchema::Clear()
+{
+	if(Hashes)
+	{
+		delete[] Hashes;
+		Hashes = NULL;
+	}
+	Table.Clear();
+	Names = NULL;
+	NumFields = 0;
+}
+
+void FieldSchema::Build(char *NewNames, int NewNumFields)
+{
+	int Slot;
+	int Other;
+	int n;
+
+	Clear();
+
+	Names = NewNames;
+	NumFields = NewNumFields;
+
+	Hashes = new unsigned int[NumFields > 0 ? NumFields : 1];
+	Table.Reset(NumFields);
+
+	for(n = 0; n < NumFields; n++)
+	{
+		Hashes[n] = HashString(&Names[n * FIELD_NAME_LENGTH]);
+		for(Slot = Table.First(Hashes[n]); (Other = Table.Get(Slot)) != HASH_EMPTY; Slot = Table.Next(Slot))
+		{
+			//a repeated name keeps the first index, as the old search did
+			if(Hashes[Other] == Hashes[n] &&
+				!strcmp(&Names[Other * FIELD_NAME_LENGTH], &Names[n * FIELD_NAME_LENGTH]))
+			{
+				break;
+			}
+		}
+		if(Other == HASH_EMPTY)
+		{
+			Table.Set(Slot, n);
+		}
+	}
+}
+
+void FieldSchema::Rebuild(char *FieldNames, int NumFieldNames)
+{
+	int n;
+
+	for(n = 0; n < NumSchemas; n++)
+	{
+		if(Schemas[n].Names == FieldNames)
+		{
+			Schemas[n].Build(FieldNames, NumFieldNames);
+			pLastSchema = &Schemas[n];
+			return;
+		}
+	}
+
+	Get(FieldNames, NumFieldNames);
+}
+
+void FieldSchema::ClearAll()
+{
+	for(int n = 0; n < NumSchemas; n++)
+	{
+		Schemas[n].Clear();
+	}
+	NumSchemas = 0;
+	pLastSchema = NULL;
+}
+
+//end: Mutators ********************************************************
@@ -0,0 +1,82 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				fieldschema.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed field name to index maps for the thing data files
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#ifndef FIELDSCHEMA_H
+#define FIELDSCHEMA_H
+
+#include "defs.h"
+#include "hashindex.h"
+
+//preprocessor defs ***********************************************
+
+//one per field name array, creatures, items and spellbooks today
+#define MAX_FIELD_SCHEMAS		8
+#define FIELD_NAME_LENGTH		32
+
+//*******************************CLASS********************************
+//**************          FieldSchema            *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Map the field names of one class of thing to their index.
+//*			 Things of a class share a single field name array, so the
+//*			 schema is keyed by that array and built when
+//*			 LoadFieldNames fills it.
+//********************************************************************
+//*Invariants: Table holds every field of Names exactly once and is at
+//*				 most half full
+//********************************************************************
+class FieldSchema
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	char *Names;
+	int NumFields;
+	unsigned int *Hashes;
+	HashIndex Table;
+
+	static FieldSchema Schemas[MAX_FIELD_SCHEMAS];
+	static int NumSchemas;
+	static FieldSchema *pLastSchema;
+
+	void Build(char *NewNames, int NewNumFields);
+	void Clear();
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	//the field's index, or -1
+	int Find(const char *FieldName);
+
+	//the schema for a field name array, built on first use if LoadFieldNames
+	//never saw it.  NULL only when every slot is taken.
+	static FieldSchema *Get(char *FieldNames, int NumFieldNames);
+
+// Mutators -----------------------------------------
+	//called whenever a field name array is (re)loaded
+	static void Rebuild(char *FieldNames, int NumFieldNames);
+	static void ClearAll();
+
+// Constructors ---------------------------------------
+	FieldSchema();
+
+// Destructor -----------------------------------------
+	~FieldSchema();
+
+};
+
+#endif
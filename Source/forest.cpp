@@ -1,4 +1,5 @@
 #include "forest.h"
+#include "bakegraph.h"
 #include <assert.h>
 
 void Forest::Load(const char *ForestName)
@@ -57,9 +58,21 @@ void Forest::Load(const char *ForestName)
 }
 
 
+//the editor's fills draw from one generator, the bakes pass their own
+static DWORD EditSeed = 1;
+
 ZSModelEx *Forest::GetTree(float Density, int x, int y)
 {
-	//seed the random number generator with x + y + x % y
+	return GetTree(Density, x, y, &EditSeed);
+}
+
+ZSModelEx *Forest::GetShrub(float Density, int x, int y)
+{
+	return GetShrub(Density, x, y, &EditSeed);
+}
+
+ZSModelEx *Forest::GetTree(float Density, int x, int y, DWORD *pSeed)
+{
 	if(Density < 0.01 || !NumTrees)
 	{
 		return NULL;
@@ -69,18 +82,18 @@ ZSModelEx *Forest::GetTree(float Density, int x, int y)
 
 	int Tree;
 
-	PercentResult = (float)(rand() % 500)/100.0f;
+	PercentResult = (float)(BakeGraph::Rand(pSeed) % 500)/100.0f;
 
 	if(PercentResult < Density)
 	{
-		Tree = rand() % NumTrees;
+		Tree = BakeGraph::Rand(pSeed) % NumTrees;
 		return Trees[Tree];
 	}
 
 	return NULL;
 }
 
-ZSModelEx *Forest::GetShrub(float Density, int x, int y)
+ZSModelEx *Forest::GetShrub(float Density, int x, int y, DWORD *pSeed)
 {
 	if(Density < 0.01f || !NumShrubs)
 	{
@@ -91,11 +104,11 @@ ZSModelEx *Forest::GetShrub(float Density, int x, int y)
 
 	int Tree;
 
-	PercentResult = (float)(rand() % 300)/100.0f;
+	PercentResult = (float)(BakeGraph::Rand(pSeed) % 300)/100.0f;
 
 	if(PercentResult < Density)
 	{
-		Tree = rand() % NumShrubs;
+		Tree = BakeGraph::Rand(pSeed) % NumShrubs;
 		return Shrubs[Tree];
 	}
 
@@ -21,6 +21,12 @@ public:
 
 	ZSModelEx *GetShrub(float Density, int x, int y);
 
+	//the same, drawing from a generator of the caller's, see BakeGraph::Rand.
+	//the ones above share a generator of their own
+	ZSModelEx *GetTree(float Density, int x, int y, DWORD *pSeed);
+
+	ZSModelEx *GetShrub(float Density, int x, int y, DWORD *pSeed);
+
 	ZSModelEx *GetTree();
 
 	ZSModelEx *GetShrub();
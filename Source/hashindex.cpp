@@ -0,0 +1,80 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				hashindex.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the string hash and open addressed table behind every
+//*			 name lookup
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#include "hashindex.h"
+
+int HashIndex::NoSlots[1] = { HASH_EMPTY };
+
+//************** Constructors  ****************************************
+
+HashIndex::HashIndex()
+{
+	Mask = 0;
+	Slots = NoSlots;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+HashIndex::~HashIndex()
+{
+	Clear();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void HashIndex::Reset(int NumKeys)
+{
+	int NewSize;
+	int n;
+
+	NewSize = HASH_MIN_SIZE;
+	while(NewSize < NumKeys * 2)
+	{
+		NewSize *= 2;
+	}
+
+	if(NewSize != GetSize())
+	{
+		Clear();
+		Slots = new int[NewSize];
+		Mask = NewSize - 1;
+	}
+
+	for(n = 0; n < NewSize; n++)
+	{
+		Slots[n] = HASH_EMPTY;
+	}
+}
+
+void HashIndex::Clear()
+{
+	if(Slots != NoSlots)
+	{
+		delete[] Slots;
+		Slots = NoSlots;
+	}
+	Mask = 0;
+}
+
+//end: Mutators ********************************************************
@@ -0,0 +1,103 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				hashindex.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the string hash and open addressed table behind every
+//*			 name lookup: flags, thing fields and lists, script labels
+//*			 and functions, and assets
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		keys are never removed, owners reset and fill the table again
+//*********************************************************************
+//*********************************************************************
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <windows.h>
+
+//preprocessor defs ***********************************************
+
+#define HASH_EMPTY				-1
+#define HASH_MIN_SIZE			16
+
+//FNV-1a
+inline unsigned int HashString(const char *String)
+{
+	unsigned int Hash = 2166136261u;
+	while(*String)
+	{
+		Hash ^= (unsigned char)*String;
+		Hash *= 16777619u;
+		String++;
+	}
+	return Hash;
+}
+
+//Knuth's multiplicative hash, for keys that are already numbers
+inline unsigned int HashInt(unsigned int Key)
+{
+	return Key * 2654435761u;
+}
+
+inline unsigned int HashPointer(const void *pKey)
+{
+	return HashInt((unsigned int)((size_t)pKey >> 4));
+}
+
+//*******************************CLASS********************************
+//**************          HashIndex              *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  An open addressed, linearly probed table of indices into
+//*			 an array its owner keeps.  The table only knows slots, the
+//*			 owner compares keys:
+//*
+//*				for(Slot = Index.First(Hash); (n = Index.Get(Slot)) != HASH_EMPTY; Slot = Index.Next(Slot))
+//*					if(the key of n matches) found n
+//*				Index.Set(Slot, n) adds n where the search stopped
+//********************************************************************
+//*Invariants: at most half full once Reset has sized it for the keys
+//*				 that go in, so every search reaches an empty slot
+//********************************************************************
+class HashIndex
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	int Mask;
+	int *Slots;
+
+	//what an index that has never been reset searches, a single empty slot
+	static int NoSlots[1];
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	inline int First(unsigned int Hash) { return (int)(Hash & (unsigned int)Mask); }
+	inline int Next(int Slot) { return (Slot + 1) & Mask; }
+	inline int Get(int Slot) { return Slots[Slot]; }
+	int GetSize() { return Slots == NoSlots ? 0 : Mask + 1; }
+
+// Mutators -----------------------------------------
+	inline void Set(int Slot, int Value) { Slots[Slot] = Value; }
+
+	//empties the table and sizes it for NumKeys
+	void Reset(int NumKeys);
+	void Clear();
+
+// Constructors ---------------------------------------
+	HashIndex();
+
+// Destructor -----------------------------------------
+	~HashIndex();
+
+};
+
+#endif
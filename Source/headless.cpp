@@ -0,0 +1,809 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				headless.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the Win32 calls declared in headless.h, on POSIX
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		every wait shares one lock and condition, which is plenty for
+//*		the handful of threads the game runs but would not scale
+//*********************************************************************
+//*********************************************************************
+#include "headless.h"
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#undef fopen
+
+typedef enum
+{
+	HANDLE_THREAD,
+	HANDLE_EVENT,
+	HANDLE_FILE,
+	HANDLE_MAPPING,
+	HANDLE_FIND,
+} HANDLE_TYPE_T;
+
+//threads and events are signalled under WaitLock, so a wait on several
+//of them sees a consistent state
+typedef struct
+{
+	HANDLE_TYPE_T Type;
+	BOOL Signaled;
+	BOOL ManualReset;
+
+	pthread_t Thread;
+	LPTHREAD_START_ROUTINE pStart;
+	LPVOID pParam;
+
+	int File;
+	DWORD Size;
+
+	DIR *pDir;
+	char Directory[MAX_PATH];
+	char Pattern[MAX_PATH];
+} HEADLESS_HANDLE_T;
+
+#define MAX_MAPPED_VIEWS	64
+
+typedef struct
+{
+	LPCVOID pBase;
+	size_t Size;
+} MAPPED_VIEW_T;
+
+static pthread_mutex_t WaitLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t WaitChanged = PTHREAD_COND_INITIALIZER;
+
+static MAPPED_VIEW_T Views[MAX_MAPPED_VIEWS];
+static pthread_mutex_t ViewLock = PTHREAD_MUTEX_INITIALIZER;
+
+static HEADLESS_HANDLE_T *NewHandle(HANDLE_TYPE_T Type)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	pHandle = new HEADLESS_HANDLE_T;
+	memset(pHandle, 0, sizeof(HEADLESS_HANDLE_T));
+	pHandle->Type = Type;
+	pHandle->File = -1;
+	return pHandle;
+}
+
+//************** Threads  *********************************************
+
+static void *ThreadStart(void *pParam)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	pHandle = (HEADLESS_HANDLE_T *)pParam;
+	pHandle->pStart(pHandle->pParam);
+
+	pthread_mutex_lock(&WaitLock);
+	pHandle->Signaled = TRUE;
+	pthread_cond_broadcast(&WaitChanged);
+	pthread_mutex_unlock(&WaitLock);
+	return NULL;
+}
+
+HANDLE CreateThread(void *lpThreadAttributes, DWORD dwStackSize, LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	pHandle = NewHandle(HANDLE_THREAD);
+	pHandle->ManualReset = TRUE;
+	pHandle->pStart = lpStartAddress;
+	pHandle->pParam = lpParameter;
+
+	if(pthread_create(&pHandle->Thread, NULL, ThreadStart, pHandle))
+	{
+		delete pHandle;
+		return NULL;
+	}
+	if(lpThreadId)
+	{
+		*lpThreadId = (DWORD)(ULONG_PTR)pHandle;
+	}
+	return pHandle;
+}
+
+BOOL SetThreadPriority(HANDLE hThread, int nPriority)
+{
+	//only root may raise a thread, lowering it does no harm
+	return TRUE;
+}
+
+DWORD GetCurrentThreadId()
+{
+	return (DWORD)(ULONG_PTR)pthread_self();
+}
+
+//************** Events  **********************************************
+
+HANDLE CreateEvent(void *lpEventAttributes, BOOL bManualReset, BOOL bInitialState, LPCSTR lpName)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	pHandle = NewHandle(HANDLE_EVENT);
+	pHandle->ManualReset = bManualReset;
+	pHandle->Signaled = bInitialState;
+	return pHandle;
+}
+
+BOOL SetEvent(HANDLE hEvent)
+{
+	pthread_mutex_lock(&WaitLock);
+	((HEADLESS_HANDLE_T *)hEvent)->Signaled = TRUE;
+	pthread_cond_broadcast(&WaitChanged);
+	pthread_mutex_unlock(&WaitLock);
+	return TRUE;
+}
+
+BOOL ResetEvent(HANDLE hEvent)
+{
+	pthread_mutex_lock(&WaitLock);
+	((HEADLESS_HANDLE_T *)hEvent)->Signaled = FALSE;
+	pthread_mutex_unlock(&WaitLock);
+	return TRUE;
+}
+
+DWORD WaitForMultipleObjects(DWORD nCount, const HANDLE *lpHandles, BOOL bWaitAll, DWORD dwMilliseconds)
+{
+	HEADLESS_HANDLE_T *pHandle;
+	struct timespec Until;
+	DWORD Result;
+	DWORD n;
+	BOOL Ready;
+
+	clock_gettime(CLOCK_REALTIME, &Until);
+	Until.tv_sec += dwMilliseconds / 1000;
+	Until.tv_nsec += (dwMilliseconds % 1000) * 1000000;
+	if(Until.tv_nsec >= 1000000000)
+	{
+		Until.tv_sec++;
+		Until.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&WaitLock);
+	while(TRUE)
+	{
+		Result = WAIT_TIMEOUT;
+		Ready = bWaitAll;
+		for(n = 0; n < nCount; n++)
+		{
+			if(((HEADLESS_HANDLE_T *)lpHandles[n])->Signaled)
+			{
+				if(!bWaitAll)
+				{
+					Result = WAIT_OBJECT_0 + n;
+					Ready = TRUE;
+					break;
+				}
+			}
+			else
+			if(bWaitAll)
+			{
+				Ready = FALSE;
+				break;
+			}
+		}
+
+		if(Ready)
+		{
+			if(bWaitAll)
+			{
+				Result = WAIT_OBJECT_0;
+			}
+			//auto reset events let one waiter through each
+			for(n = 0; n < nCount; n++)
+			{
+				pHandle = (HEADLESS_HANDLE_T *)lpHandles[n];
+				if(!pHandle->ManualReset && (bWaitAll || Result == WAIT_OBJECT_0 + n))
+				{
+					pHandle->Signaled = FALSE;
+				}
+			}
+			break;
+		}
+
+		if(!dwMilliseconds)
+		{
+			break;
+		}
+		if(dwMilliseconds == INFINITE)
+		{
+			pthread_cond_wait(&WaitChanged, &WaitLock);
+		}
+		else
+		if(pthread_cond_timedwait(&WaitChanged, &WaitLock, &Until) == ETIMEDOUT)
+		{
+			dwMilliseconds = 0;
+		}
+	}
+	pthread_mutex_unlock(&WaitLock);
+	return Result;
+}
+
+DWORD WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds)
+{
+	return WaitForMultipleObjects(1, &hHandle, FALSE, dwMilliseconds);
+}
+
+BOOL CloseHandle(HANDLE hObject)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	pHandle = (HEADLESS_HANDLE_T *)hObject;
+	if(!pHandle || hObject == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	switch(pHandle->Type)
+	{
+		case HANDLE_THREAD:
+			//a thread still running carries on without its handle
+			pthread_detach(pHandle->Thread);
+			if(!pHandle->Signaled)
+			{
+				return TRUE;
+			}
+			break;
+		case HANDLE_FILE:
+			close(pHandle->File);
+			break;
+		case HANDLE_FIND:
+			closedir(pHandle->pDir);
+			break;
+		default:
+			break;
+	}
+	delete pHandle;
+	return TRUE;
+}
+
+//************** Locks  ***********************************************
+
+void InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	pthread_mutexattr_t Attributes;
+	pthread_mutex_t *pMutex;
+
+	//a critical section may be entered again by the thread holding it
+	pMutex = new pthread_mutex_t;
+	pthread_mutexattr_init(&Attributes);
+	pthread_mutexattr_settype(&Attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(pMutex, &Attributes);
+	pthread_mutexattr_destroy(&Attributes);
+	lpCriticalSection->pLock = pMutex;
+}
+
+void DeleteCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	pthread_mutex_destroy((pthread_mutex_t *)lpCriticalSection->pLock);
+	delete (pthread_mutex_t *)lpCriticalSection->pLock;
+	lpCriticalSection->pLock = NULL;
+}
+
+void EnterCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	pthread_mutex_lock((pthread_mutex_t *)lpCriticalSection->pLock);
+}
+
+void LeaveCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
+{
+	pthread_mutex_unlock((pthread_mutex_t *)lpCriticalSection->pLock);
+}
+
+LONG InterlockedIncrement(LONG volatile *Addend)
+{
+	return __sync_add_and_fetch(Addend, 1);
+}
+
+LONG InterlockedDecrement(LONG volatile *Addend)
+{
+	return __sync_sub_and_fetch(Addend, 1);
+}
+
+LONG InterlockedExchange(LONG volatile *Target, LONG Value)
+{
+	__sync_synchronize();
+	return __sync_lock_test_and_set(Target, Value);
+}
+
+LONG InterlockedExchangeAdd(LONG volatile *Addend, LONG Value)
+{
+	return __sync_fetch_and_add(Addend, Value);
+}
+
+LONG InterlockedCompareExchange(LONG volatile *Destination, LONG Exchange, LONG Comperand)
+{
+	return __sync_val_compare_and_swap(Destination, Comperand, Exchange);
+}
+
+void Sleep(DWORD dwMilliseconds)
+{
+	struct timespec Wait;
+
+	if(!dwMilliseconds)
+	{
+		sched_yield();
+		return;
+	}
+	Wait.tv_sec = dwMilliseconds / 1000;
+	Wait.tv_nsec = (dwMilliseconds % 1000) * 1000000;
+	while(nanosleep(&Wait, &Wait) && errno == EINTR);
+}
+
+void GetSystemInfo(LPSYSTEM_INFO lpSystemInfo)
+{
+	long Processors;
+
+	memset(lpSystemInfo, 0, sizeof(SYSTEM_INFO));
+	Processors = sysconf(_SC_NPROCESSORS_ONLN);
+	lpSystemInfo->dwNumberOfProcessors = Processors > 0 ? (DWORD)Processors : 1;
+	lpSystemInfo->dwPageSize = (DWORD)sysconf(_SC_PAGESIZE);
+	lpSystemInfo->dwAllocationGranularity = lpSystemInfo->dwPageSize;
+}
+
+//************** Startup  *********************************************
+
+//the game's globals open data files as they are constructed, so the game
+//directory has to be current before any of them run
+static void __attribute__((constructor(101))) ChangeToGameDirectory()
+{
+	const char *Dir;
+
+	Dir = getenv("PRELUDE_DIR");
+	if(Dir && chdir(Dir))
+	{
+		fprintf(stderr, "can't change to game directory %s\n", Dir);
+		exit(1);
+	}
+}
+
+//************** Time  ************************************************
+
+static DWORD RealTime()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (DWORD)(Now.tv_sec * 1000 + Now.tv_nsec / 1000000);
+}
+
+DWORD GetTickCount()
+{
+	return RealTime();
+}
+
+DWORD timeGetTime()
+{
+	return GetTickCount();
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	lpPerformanceCount->QuadPart = (LONGLONG)Now.tv_sec * 1000000000 + Now.tv_nsec;
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency)
+{
+	lpFrequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+LONG CompareFileTime(const FILETIME *lpFileTime1, const FILETIME *lpFileTime2)
+{
+	ULONGLONG A;
+	ULONGLONG B;
+
+	A = ((ULONGLONG)lpFileTime1->dwHighDateTime << 32) | lpFileTime1->dwLowDateTime;
+	B = ((ULONGLONG)lpFileTime2->dwHighDateTime << 32) | lpFileTime2->dwLowDateTime;
+	if(A < B)
+	{
+		return -1;
+	}
+	return A > B ? 1 : 0;
+}
+
+//************** Paths  ***********************************************
+
+//finds Name in Directory whatever its case, FALSE if nothing matches
+static BOOL MatchName(const char *Directory, char *Name)
+{
+	struct dirent *pEntry;
+	DIR *pDir;
+	BOOL Found;
+
+	pDir = opendir(*Directory ? Directory : ".");
+	if(!pDir)
+	{
+		return FALSE;
+	}
+
+	Found = FALSE;
+	while((pEntry = readdir(pDir)))
+	{
+		if(!strcasecmp(pEntry->d_name, Name))
+		{
+			strcpy(Name, pEntry->d_name);
+			Found = TRUE;
+			break;
+		}
+	}
+	closedir(pDir);
+	return Found;
+}
+
+const char *HeadlessPath(const char *FileName, char *Resolved)
+{
+	struct stat Info;
+	char *pStart;
+	char *pEnd;
+	char Saved;
+	int n;
+
+	for(n = 0; FileName[n] && n < MAX_PATH - 1; n++)
+	{
+		Resolved[n] = FileName[n] == '\\' ? '/' : FileName[n];
+	}
+	Resolved[n] = '\0';
+
+	if(!stat(Resolved, &Info))
+	{
+		return Resolved;
+	}
+
+	//put each part in the case it has on disk, a part that is not there
+	//at all is left as it was asked for
+	pStart = Resolved;
+	if(*pStart == '/')
+	{
+		pStart++;
+	}
+	while(*pStart)
+	{
+		pEnd = strchr(pStart, '/');
+		if(!pEnd)
+		{
+			pEnd = pStart + strlen(pStart);
+		}
+		Saved = *pEnd;
+		*pEnd = '\0';
+
+		if(stat(Resolved, &Info) && strcmp(pStart, ".") && strcmp(pStart, ".."))
+		{
+			if(pStart > Resolved)
+			{
+				pStart[-1] = '\0';
+				MatchName(pStart - 1 == Resolved ? "/" : Resolved, pStart);
+				pStart[-1] = '/';
+			}
+			else
+			{
+				MatchName("", pStart);
+			}
+		}
+
+		*pEnd = Saved;
+		if(!Saved)
+		{
+			break;
+		}
+		pStart = pEnd + 1;
+	}
+	return Resolved;
+}
+
+FILE *HeadlessOpen(const char *FileName, const char *Mode)
+{
+	char Resolved[MAX_PATH];
+
+	return fopen(HeadlessPath(FileName, Resolved), Mode);
+}
+
+BOOL SetCurrentDirectory(LPCSTR lpPathName)
+{
+	char Resolved[MAX_PATH];
+
+	return !chdir(HeadlessPath(lpPathName, Resolved));
+}
+
+DWORD GetCurrentDirectory(DWORD nBufferLength, LPSTR lpBuffer)
+{
+	if(!getcwd(lpBuffer, nBufferLength))
+	{
+		return 0;
+	}
+	return strlen(lpBuffer);
+}
+
+//************** Files  ***********************************************
+
+static void ToFileTime(time_t Time, FILETIME *pFileTime)
+{
+	ULONGLONG Ticks;
+
+	//100ns ticks since 1601
+	Ticks = ((ULONGLONG)Time + 11644473600ULL) * 10000000;
+	pFileTime->dwLowDateTime = (DWORD)Ticks;
+	pFileTime->dwHighDateTime = (DWORD)(Ticks >> 32);
+}
+
+HANDLE CreateFile(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, void *lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+	HEADLESS_HANDLE_T *pHandle;
+	char Resolved[MAX_PATH];
+	int Flags;
+	int File;
+
+	if((dwDesiredAccess & GENERIC_READ) && (dwDesiredAccess & GENERIC_WRITE))
+	{
+		Flags = O_RDWR;
+	}
+	else
+	{
+		Flags = (dwDesiredAccess & GENERIC_WRITE) ? O_WRONLY : O_RDONLY;
+	}
+
+	switch(dwCreationDisposition)
+	{
+		case CREATE_NEW:
+			Flags |= O_CREAT | O_EXCL;
+			break;
+		case CREATE_ALWAYS:
+			Flags |= O_CREAT | O_TRUNC;
+			break;
+		case OPEN_ALWAYS:
+			Flags |= O_CREAT;
+			break;
+		default:
+			break;
+	}
+
+	File = open(HeadlessPath(lpFileName, Resolved), Flags, 0644);
+	if(File < 0)
+	{
+		return INVALID_HANDLE_VALUE;
+	}
+
+	pHandle = NewHandle(HANDLE_FILE);
+	pHandle->File = File;
+	return pHandle;
+}
+
+BOOL ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, void *lpOverlapped)
+{
+	ssize_t Read;
+
+	Read = read(((HEADLESS_HANDLE_T *)hFile)->File, lpBuffer, nNumberOfBytesToRead);
+	if(lpNumberOfBytesRead)
+	{
+		*lpNumberOfBytesRead = Read > 0 ? (DWORD)Read : 0;
+	}
+	return Read >= 0;
+}
+
+DWORD GetFileSize(HANDLE hFile, LPDWORD lpFileSizeHigh)
+{
+	struct stat Info;
+
+	if(fstat(((HEADLESS_HANDLE_T *)hFile)->File, &Info))
+	{
+		return INVALID_FILE_SIZE;
+	}
+	if(lpFileSizeHigh)
+	{
+		*lpFileSizeHigh = (DWORD)((ULONGLONG)Info.st_size >> 32);
+	}
+	return (DWORD)Info.st_size;
+}
+
+HANDLE CreateFileMapping(HANDLE hFile, void *lpAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow, LPCSTR lpName)
+{
+	HEADLESS_HANDLE_T *pHandle;
+
+	//the mapping only remembers the file, the view does the work
+	pHandle = NewHandle(HANDLE_MAPPING);
+	pHandle->File = ((HEADLESS_HANDLE_T *)hFile)->File;
+	pHandle->Size = dwMaximumSizeLow ? dwMaximumSizeLow : GetFileSize(hFile, NULL);
+	return pHandle;
+}
+
+LPVOID MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow, size_t dwNumberOfBytesToMap)
+{
+	HEADLESS_HANDLE_T *pHandle;
+	void *pBase;
+	size_t Size;
+	int n;
+
+	pHandle = (HEADLESS_HANDLE_T *)hFileMappingObject;
+	Size = dwNumberOfBytesToMap ? dwNumberOfBytesToMap : pHandle->Size - dwFileOffsetLow;
+	//a copy on write view can be written, the changes stay private
+	pBase = mmap(NULL, Size, (dwDesiredAccess & FILE_MAP_COPY) ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, pHandle->File, dwFileOffsetLow);
+	if(pBase == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	pthread_mutex_lock(&ViewLock);
+	for(n = 0; n < MAX_MAPPED_VIEWS; n++)
+	{
+		if(!Views[n].pBase)
+		{
+			Views[n].pBase = pBase;
+			Views[n].Size = Size;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&ViewLock);
+
+	if(n == MAX_MAPPED_VIEWS)
+	{
+		munmap(pBase, Size);
+		return NULL;
+	}
+	return pBase;
+}
+
+BOOL UnmapViewOfFile(LPCVOID lpBaseAddress)
+{
+	int n;
+
+	pthread_mutex_lock(&ViewLock);
+	for(n = 0; n < MAX_MAPPED_VIEWS; n++)
+	{
+		if(Views[n].pBase == lpBaseAddress)
+		{
+			munmap((void *)Views[n].pBase, Views[n].Size);
+			Views[n].pBase = NULL;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&ViewLock);
+	return n < MAX_MAPPED_VIEWS;
+}
+
+BOOL GetFileAttributesEx(LPCSTR lpFileName, GET_FILEEX_INFO_LEVELS fInfoLevelId, LPVOID lpFileInformation)
+{
+	WIN32_FILE_ATTRIBUTE_DATA *pData;
+	char Resolved[MAX_PATH];
+	struct stat Info;
+
+	if(stat(HeadlessPath(lpFileName, Resolved), &Info))
+	{
+		return FALSE;
+	}
+
+	pData = (WIN32_FILE_ATTRIBUTE_DATA *)lpFileInformation;
+	pData->dwFileAttributes = S_ISDIR(Info.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+	ToFileTime(Info.st_ctime, &pData->ftCreationTime);
+	ToFileTime(Info.st_atime, &pData->ftLastAccessTime);
+	ToFileTime(Info.st_mtime, &pData->ftLastWriteTime);
+	pData->nFileSizeHigh = (DWORD)((ULONGLONG)Info.st_size >> 32);
+	pData->nFileSizeLow = (DWORD)Info.st_size;
+	return TRUE;
+}
+
+BOOL FindNextFile(HANDLE hFindFile, LPWIN32_FIND_DATA lpFindFileData)
+{
+	HEADLESS_HANDLE_T *pHandle;
+	WIN32_FILE_ATTRIBUTE_DATA Data;
+	struct dirent *pEntry;
+	//the directory and the name can each be up to MAX_PATH
+	char Path[MAX_PATH * 2];
+
+	pHandle = (HEADLESS_HANDLE_T *)hFindFile;
+	while((pEntry = readdir(pHandle->pDir)))
+	{
+		if(fnmatch(pHandle->Pattern, pEntry->d_name, FNM_CASEFOLD))
+		{
+			continue;
+		}
+
+		memset(lpFindFileData, 0, sizeof(WIN32_FIND_DATA));
+		strncpy(lpFindFileData->cFileName, pEntry->d_name, MAX_PATH - 1);
+		snprintf(Path, sizeof(Path), "%s/%s", pHandle->Directory, pEntry->d_name);
+		if(GetFileAttributesEx(Path, GetFileExInfoStandard, &Data))
+		{
+			lpFindFileData->dwFileAttributes = Data.dwFileAttributes;
+			lpFindFileData->ftCreationTime = Data.ftCreationTime;
+			lpFindFileData->ftLastAccessTime = Data.ftLastAccessTime;
+			lpFindFileData->ftLastWriteTime = Data.ftLastWriteTime;
+			lpFindFileData->nFileSizeHigh = Data.nFileSizeHigh;
+			lpFindFileData->nFileSizeLow = Data.nFileSizeLow;
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
+
+HANDLE FindFirstFile(LPCSTR lpFileName, LPWIN32_FIND_DATA lpFindFileData)
+{
+	HEADLESS_HANDLE_T *pHandle;
+	char Resolved[MAX_PATH];
+	char *pSlash;
+
+	HeadlessPath(lpFileName, Resolved);
+
+	pHandle = NewHandle(HANDLE_FIND);
+	pSlash = strrchr(Resolved, '/');
+	if(pSlash)
+	{
+		*pSlash = '\0';
+		strcpy(pHandle->Directory, *Resolved ? Resolved : "/");
+		strcpy(pHandle->Pattern, pSlash + 1);
+	}
+	else
+	{
+		strcpy(pHandle->Directory, ".");
+		strcpy(pHandle->Pattern, Resolved);
+	}
+
+	pHandle->pDir = opendir(pHandle->Directory);
+	if(!pHandle->pDir)
+	{
+		delete pHandle;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	if(!FindNextFile(pHandle, lpFindFileData))
+	{
+		CloseHandle(pHandle);
+		return INVALID_HANDLE_VALUE;
+	}
+	return pHandle;
+}
+
+BOOL FindClose(HANDLE hFindFile)
+{
+	return CloseHandle(hFindFile);
+}
+
+//************** Desktop  *********************************************
+
+int MessageBox(HWND hWnd, LPCSTR lpText, LPCSTR lpCaption, UINT uType)
+{
+	fprintf(stderr, "%s: %s\n", lpCaption ? lpCaption : "Message", lpText);
+	return (uType & MB_YESNO) == MB_YESNO ? IDYES : IDOK;
+}
+
+int ShowCursor(BOOL bShow)
+{
+	return bShow ? 0 : -1;
+}
+
+BOOL GetCursorPos(LPPOINT lpPoint)
+{
+	lpPoint->x = 0;
+	lpPoint->y = 0;
+	return TRUE;
+}
+
+BOOL TextOut(HDC hdc, int x, int y, LPCSTR lpString, int c)
+{
+	return TRUE;
+}
+
+void OutputDebugString(LPCSTR lpOutputString)
+{
+	fputs(lpOutputString, stderr);
+}
@@ -0,0 +1,562 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				headless.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the part of Win32 the simulation uses, for headless builds
+//*			 on systems without it.  Reached through the stand in headers
+//*			 in Source\Headless, never included directly
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		COM interfaces from the DirectX headers come out as objects
+//*		whose every method does nothing and returns 0, so anything
+//*		that reads back what a device or surface wrote has to be kept
+//*		out of headless builds
+//*********************************************************************
+//*********************************************************************
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#ifndef _WIN32
+#define _WIN32
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstdio>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+
+//preprocessor defs ***********************************************
+
+#define WINAPI
+#define APIENTRY
+#define CALLBACK
+#define PASCAL
+#define FAR
+#define NEAR
+#define far
+#define near
+#define __stdcall
+#define __cdecl
+#define _cdecl
+#define CONST const
+#define WINVER 0x0500
+
+//__declspec(thread) is the only one the source needs to work
+#define __declspec(x) HEADLESS_DECLSPEC_##x
+#define HEADLESS_DECLSPEC_thread __thread
+#define HEADLESS_DECLSPEC_dllimport
+#define HEADLESS_DECLSPEC_dllexport
+#define HEADLESS_DECLSPEC_selectany
+
+#define TRUE	1
+#define FALSE	0
+
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef long LONG;
+typedef unsigned long ULONG;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef int INT;
+typedef unsigned int UINT;
+typedef short SHORT;
+typedef unsigned short USHORT;
+typedef unsigned char UCHAR;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef char TCHAR;
+typedef float FLOAT;
+typedef void VOID;
+typedef long HRESULT;
+typedef long LONG_PTR;
+typedef unsigned long ULONG_PTR;
+typedef unsigned long DWORD_PTR;
+typedef unsigned long UINT_PTR;
+typedef long LRESULT;
+typedef UINT_PTR WPARAM;
+typedef LONG_PTR LPARAM;
+typedef WORD ATOM;
+typedef DWORD COLORREF;
+typedef DWORD FOURCC;
+
+typedef void *PVOID;
+typedef void *LPVOID;
+typedef const void *LPCVOID;
+typedef char *LPSTR;
+typedef const char *LPCSTR;
+typedef LPSTR LPTSTR;
+typedef LPCSTR LPCTSTR;
+typedef WCHAR *LPWSTR;
+typedef const WCHAR *LPCWSTR;
+typedef BYTE *LPBYTE;
+typedef WORD *LPWORD;
+typedef DWORD *LPDWORD;
+typedef LONG *LPLONG;
+typedef BOOL *LPBOOL;
+
+#define DECLARE_HANDLE(name) typedef void *name
+DECLARE_HANDLE(HANDLE);
+DECLARE_HANDLE(HWND);
+DECLARE_HANDLE(HINSTANCE);
+DECLARE_HANDLE(HMODULE);
+DECLARE_HANDLE(HDC);
+DECLARE_HANDLE(HGDIOBJ);
+DECLARE_HANDLE(HBITMAP);
+DECLARE_HANDLE(HBRUSH);
+DECLARE_HANDLE(HFONT);
+DECLARE_HANDLE(HPALETTE);
+DECLARE_HANDLE(HMENU);
+DECLARE_HANDLE(HICON);
+DECLARE_HANDLE(HCURSOR);
+DECLARE_HANDLE(HGLOBAL);
+DECLARE_HANDLE(HKEY);
+DECLARE_HANDLE(HMMIO);
+#define HMONITOR_DECLARED
+DECLARE_HANDLE(HMONITOR);
+
+#define INVALID_HANDLE_VALUE	((HANDLE)(LONG_PTR)-1)
+#define INFINITE				0xFFFFFFFF
+#define MAX_PATH				260
+
+typedef union
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct tagRECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} RECT, *PRECT, *LPRECT;
+typedef const RECT *LPCRECT;
+
+typedef struct tagPOINT
+{
+	LONG x;
+	LONG y;
+} POINT, *LPPOINT;
+
+typedef struct tagSIZE
+{
+	LONG cx;
+	LONG cy;
+} SIZE, *LPSIZE;
+
+typedef struct _FILETIME
+{
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME, *LPFILETIME;
+
+#define MAKEWORD(a, b)	((WORD)(((BYTE)(a)) | ((WORD)((BYTE)(b))) << 8))
+#define MAKELONG(a, b)	((LONG)(((WORD)(a)) | ((DWORD)((WORD)(b))) << 16))
+#define LOWORD(l)		((WORD)((DWORD_PTR)(l) & 0xffff))
+#define HIWORD(l)		((WORD)((DWORD_PTR)(l) >> 16))
+#define RGB(r,g,b)		((COLORREF)(((BYTE)(r) | ((WORD)((BYTE)(g)) << 8)) | (((DWORD)(BYTE)(b)) << 16)))
+#define MAKEFOURCC(a,b,c,d)	((DWORD)(BYTE)(a) | ((DWORD)(BYTE)(b) << 8) | ((DWORD)(BYTE)(c) << 16) | ((DWORD)(BYTE)(d) << 24))
+#define mmioFOURCC(a,b,c,d)	MAKEFOURCC(a,b,c,d)
+#define TEXT(s)			s
+
+#define ZeroMemory(p, n)		memset((p), 0, (n))
+#define FillMemory(p, n, c)	memset((p), (c), (n))
+#define CopyMemory(d, s, n)	memcpy((d), (s), (n))
+#define MoveMemory(d, s, n)	memmove((d), (s), (n))
+
+#define stricmp			strcasecmp
+#define _stricmp		strcasecmp
+#define strcmpi			strcasecmp
+#define strnicmp		strncasecmp
+#define _strnicmp		strncasecmp
+#define _vsnprintf		vsnprintf
+#define _snprintf		snprintf
+
+//file positions are plain offsets, as they are under Visual C
+#define fpos_t			long
+#define fgetpos(fp, pPos)	((*(pPos) = ftell(fp)) < 0)
+#define fsetpos(fp, pPos)	fseek((fp), *(pPos), SEEK_SET)
+
+//COM, the interfaces in the DirectX headers come out as do nothing objects
+typedef struct _GUID
+{
+	DWORD Data1;
+	WORD Data2;
+	WORD Data3;
+	BYTE Data4[8];
+} GUID, IID, CLSID;
+typedef GUID *LPGUID;
+typedef const GUID *LPCGUID;
+typedef const GUID &REFGUID;
+typedef const IID &REFIID;
+typedef const CLSID &REFCLSID;
+
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8) \
+	static const GUID name = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+
+#define MAKE_HRESULT(sev,fac,code)	((HRESULT)(((unsigned long)(sev) << 31) | ((unsigned long)(fac) << 16) | ((unsigned long)(code))))
+#define SEVERITY_ERROR			1
+#define FACILITY_WIN32			7
+#define ERROR_READ_FAULT		30L
+#define S_OK					((HRESULT)0L)
+#define S_FALSE					((HRESULT)1L)
+#define E_FAIL					((HRESULT)0x80004005L)
+#define E_NOTIMPL				((HRESULT)0x80004001L)
+#define E_NOINTERFACE			((HRESULT)0x80004002L)
+#define E_OUTOFMEMORY			((HRESULT)0x8007000EL)
+#define E_INVALIDARG			((HRESULT)0x80070057L)
+#define CLASS_E_NOAGGREGATION	((HRESULT)0x80040110L)
+#define SUCCEEDED(hr)			(((HRESULT)(hr)) >= 0)
+#define FAILED(hr)				(((HRESULT)(hr)) < 0)
+
+#define interface					struct
+#define STDMETHOD(method)			virtual HRESULT method
+#define STDMETHOD_(type,method)	virtual type method
+#define PURE						{ return 0; }
+#define THIS_
+#define THIS						void
+#define DECLARE_INTERFACE(iface)	struct iface
+#define DECLARE_INTERFACE_(iface, baseiface)	struct iface : public baseiface
+
+struct IUnknown
+{
+	virtual HRESULT QueryInterface(REFIID riid, void **ppvObject) { return E_NOINTERFACE; }
+	virtual ULONG AddRef() { return 1; }
+	virtual ULONG Release() { return 0; }
+};
+typedef IUnknown *LPUNKNOWN;
+
+//GDI and multimedia types the headers declare members of, the ones read
+//straight from files keep their Win32 sizes
+typedef struct tagPALETTEENTRY
+{
+	BYTE peRed;
+	BYTE peGreen;
+	BYTE peBlue;
+	BYTE peFlags;
+} PALETTEENTRY, *LPPALETTEENTRY;
+
+typedef struct _RGNDATAHEADER
+{
+	DWORD dwSize;
+	DWORD iType;
+	DWORD nCount;
+	DWORD nRgnSize;
+	RECT rcBound;
+} RGNDATAHEADER;
+
+typedef struct _RGNDATA
+{
+	RGNDATAHEADER rdh;
+	char Buffer[1];
+} RGNDATA, *LPRGNDATA;
+#define RDH_RECTANGLES	1
+
+#pragma pack(push, 2)
+typedef struct tagBITMAPFILEHEADER
+{
+	WORD bfType;
+	DWORD bfSize;
+	WORD bfReserved1;
+	WORD bfReserved2;
+	DWORD bfOffBits;
+} BITMAPFILEHEADER;
+#pragma pack(pop)
+
+typedef struct tagBITMAPINFOHEADER
+{
+	DWORD biSize;
+	int32_t biWidth;
+	int32_t biHeight;
+	WORD biPlanes;
+	WORD biBitCount;
+	DWORD biCompression;
+	DWORD biSizeImage;
+	int32_t biXPelsPerMeter;
+	int32_t biYPelsPerMeter;
+	DWORD biClrUsed;
+	DWORD biClrImportant;
+} BITMAPINFOHEADER;
+
+typedef struct tagRGBQUAD
+{
+	BYTE rgbBlue;
+	BYTE rgbGreen;
+	BYTE rgbRed;
+	BYTE rgbReserved;
+} RGBQUAD;
+
+typedef struct tagBITMAPINFO
+{
+	BITMAPINFOHEADER bmiHeader;
+	RGBQUAD bmiColors[1];
+} BITMAPINFO, *LPBITMAPINFO;
+
+typedef struct tagTEXTMETRICA
+{
+	int32_t tmHeight;
+	int32_t tmAscent;
+	int32_t tmDescent;
+	int32_t tmInternalLeading;
+	int32_t tmExternalLeading;
+	int32_t tmAveCharWidth;
+	int32_t tmMaxCharWidth;
+	int32_t tmWeight;
+	int32_t tmOverhang;
+	int32_t tmDigitizedAspectX;
+	int32_t tmDigitizedAspectY;
+	BYTE tmFirstChar;
+	BYTE tmLastChar;
+	BYTE tmDefaultChar;
+	BYTE tmBreakChar;
+	BYTE tmItalic;
+	BYTE tmUnderlined;
+	BYTE tmStruckOut;
+	BYTE tmPitchAndFamily;
+	BYTE tmCharSet;
+} TEXTMETRIC;
+
+typedef struct tagLOGFONTA
+{
+	int32_t lfHeight;
+	int32_t lfWidth;
+	int32_t lfEscapement;
+	int32_t lfOrientation;
+	int32_t lfWeight;
+	BYTE lfItalic;
+	BYTE lfUnderline;
+	BYTE lfStrikeOut;
+	BYTE lfCharSet;
+	BYTE lfOutPrecision;
+	BYTE lfClipPrecision;
+	BYTE lfQuality;
+	BYTE lfPitchAndFamily;
+	CHAR lfFaceName[32];
+} LOGFONT;
+
+typedef struct _ABC
+{
+	int abcA;
+	UINT abcB;
+	int abcC;
+} ABC;
+
+typedef struct tWAVEFORMATEX
+{
+	WORD wFormatTag;
+	WORD nChannels;
+	DWORD nSamplesPerSec;
+	DWORD nAvgBytesPerSec;
+	WORD nBlockAlign;
+	WORD wBitsPerSample;
+	WORD cbSize;
+} WAVEFORMATEX, *LPWAVEFORMATEX;
+typedef const WAVEFORMATEX *LPCWAVEFORMATEX;
+
+typedef struct _MMCKINFO
+{
+	FOURCC ckid;
+	DWORD cksize;
+	FOURCC fccType;
+	DWORD dwDataOffset;
+	DWORD dwFlags;
+} MMCKINFO, *LPMMCKINFO;
+
+typedef struct _MMIOINFO
+{
+	DWORD dwFlags;
+	FOURCC fccIOProc;
+	void *pIOProc;
+	UINT wErrorRet;
+	void *htask;
+	LONG cchBuffer;
+	char *pchBuffer;
+	char *pchNext;
+	char *pchEndRead;
+	char *pchEndWrite;
+	LONG lBufOffset;
+	LONG lDiskOffset;
+	DWORD adwInfo[3];
+	DWORD dwReserved1;
+	DWORD dwReserved2;
+	HMMIO hmmio;
+} MMIOINFO, *LPMMIOINFO;
+
+//message boxes go to stderr
+#define MB_OK			0x00000000L
+#define MB_OKCANCEL		0x00000001L
+#define MB_YESNO		0x00000004L
+#define MB_ICONERROR	0x00000010L
+#define MB_ICONSTOP		MB_ICONERROR
+#define MB_ICONWARNING	0x00000030L
+#define IDOK			1
+#define IDCANCEL		2
+#define IDYES			6
+#define IDNO			7
+
+//threads and synchronisation **************************************
+
+typedef DWORD (WINAPI *PTHREAD_START_ROUTINE)(LPVOID lpThreadParameter);
+typedef PTHREAD_START_ROUTINE LPTHREAD_START_ROUTINE;
+
+#define THREAD_PRIORITY_LOWEST			-2
+#define THREAD_PRIORITY_BELOW_NORMAL	-1
+#define THREAD_PRIORITY_NORMAL			0
+#define THREAD_PRIORITY_ABOVE_NORMAL	1
+#define THREAD_PRIORITY_HIGHEST			2
+#define CREATE_SUSPENDED				0x00000004
+
+#define WAIT_OBJECT_0	0x00000000L
+#define WAIT_TIMEOUT	0x00000102L
+#define WAIT_FAILED		0xFFFFFFFF
+
+//the lock lives in the platform layer, the source only ever holds a pointer
+typedef struct
+{
+	void *pLock;
+} CRITICAL_SECTION, *LPCRITICAL_SECTION;
+
+typedef struct _SYSTEM_INFO
+{
+	WORD wProcessorArchitecture;
+	WORD wReserved;
+	DWORD dwPageSize;
+	LPVOID lpMinimumApplicationAddress;
+	LPVOID lpMaximumApplicationAddress;
+	DWORD_PTR dwActiveProcessorMask;
+	DWORD dwNumberOfProcessors;
+	DWORD dwProcessorType;
+	DWORD dwAllocationGranularity;
+	WORD wProcessorLevel;
+	WORD wProcessorRevision;
+} SYSTEM_INFO, *LPSYSTEM_INFO;
+
+HANDLE CreateThread(void *lpThreadAttributes, DWORD dwStackSize, LPTHREAD_START_ROUTINE lpStartAddress, LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId);
+BOOL SetThreadPriority(HANDLE hThread, int nPriority);
+DWORD GetCurrentThreadId();
+HANDLE CreateEvent(void *lpEventAttributes, BOOL bManualReset, BOOL bInitialState, LPCSTR lpName);
+BOOL SetEvent(HANDLE hEvent);
+BOOL ResetEvent(HANDLE hEvent);
+DWORD WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds);
+DWORD WaitForMultipleObjects(DWORD nCount, const HANDLE *lpHandles, BOOL bWaitAll, DWORD dwMilliseconds);
+BOOL CloseHandle(HANDLE hObject);
+
+void InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void DeleteCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void EnterCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+void LeaveCriticalSection(LPCRITICAL_SECTION lpCriticalSection);
+
+LONG InterlockedIncrement(LONG volatile *Addend);
+LONG InterlockedDecrement(LONG volatile *Addend);
+LONG InterlockedExchange(LONG volatile *Target, LONG Value);
+LONG InterlockedExchangeAdd(LONG volatile *Addend, LONG Value);
+LONG InterlockedCompareExchange(LONG volatile *Destination, LONG Exchange, LONG Comperand);
+
+void Sleep(DWORD dwMilliseconds);
+void GetSystemInfo(LPSYSTEM_INFO lpSystemInfo);
+
+//time *************************************************************
+
+DWORD GetTickCount();
+DWORD timeGetTime();
+BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency);
+LONG CompareFileTime(const FILETIME *lpFileTime1, const FILETIME *lpFileTime2);
+
+//files ************************************************************
+
+#define GENERIC_READ				0x80000000L
+#define GENERIC_WRITE				0x40000000L
+#define FILE_SHARE_READ				0x00000001
+#define FILE_SHARE_WRITE			0x00000002
+#define CREATE_NEW					1
+#define CREATE_ALWAYS				2
+#define OPEN_EXISTING				3
+#define OPEN_ALWAYS					4
+#define FILE_ATTRIBUTE_DIRECTORY	0x00000010
+#define FILE_ATTRIBUTE_NORMAL		0x00000080
+#define FILE_FLAG_SEQUENTIAL_SCAN	0x08000000
+#define INVALID_FILE_SIZE			((DWORD)0xFFFFFFFF)
+#define PAGE_READONLY				0x02
+#define PAGE_WRITECOPY				0x08
+#define FILE_MAP_COPY				0x0001
+#define FILE_MAP_READ				0x0004
+
+typedef enum
+{
+	GetFileExInfoStandard,
+} GET_FILEEX_INFO_LEVELS;
+
+typedef struct _WIN32_FILE_ATTRIBUTE_DATA
+{
+	DWORD dwFileAttributes;
+	FILETIME ftCreationTime;
+	FILETIME ftLastAccessTime;
+	FILETIME ftLastWriteTime;
+	DWORD nFileSizeHigh;
+	DWORD nFileSizeLow;
+} WIN32_FILE_ATTRIBUTE_DATA;
+
+typedef struct _WIN32_FIND_DATA
+{
+	DWORD dwFileAttributes;
+	FILETIME ftCreationTime;
+	FILETIME ftLastAccessTime;
+	FILETIME ftLastWriteTime;
+	DWORD nFileSizeHigh;
+	DWORD nFileSizeLow;
+	DWORD dwReserved0;
+	DWORD dwReserved1;
+	CHAR cFileName[MAX_PATH];
+	CHAR cAlternateFileName[14];
+} WIN32_FIND_DATA, *LPWIN32_FIND_DATA;
+
+HANDLE CreateFile(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, void *lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
+BOOL ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, void *lpOverlapped);
+DWORD GetFileSize(HANDLE hFile, LPDWORD lpFileSizeHigh);
+HANDLE CreateFileMapping(HANDLE hFile, void *lpAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow, LPCSTR lpName);
+LPVOID MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow, size_t dwNumberOfBytesToMap);
+BOOL UnmapViewOfFile(LPCVOID lpBaseAddress);
+BOOL GetFileAttributesEx(LPCSTR lpFileName, GET_FILEEX_INFO_LEVELS fInfoLevelId, LPVOID lpFileInformation);
+HANDLE FindFirstFile(LPCSTR lpFileName, LPWIN32_FIND_DATA lpFindFileData);
+BOOL FindNextFile(HANDLE hFindFile, LPWIN32_FIND_DATA lpFindFileData);
+BOOL FindClose(HANDLE hFindFile);
+BOOL SetCurrentDirectory(LPCSTR lpPathName);
+DWORD GetCurrentDirectory(DWORD nBufferLength, LPSTR lpBuffer);
+
+//the data files are named in any case and with backslashes, every
+//path the source opens goes through HeadlessPath first
+const char *HeadlessPath(const char *FileName, char *Resolved);
+FILE *HeadlessOpen(const char *FileName, const char *Mode);
+#define fopen HeadlessOpen
+
+//the desktop **********************************************************
+
+#define SM_CXSCREEN		0
+#define SM_CYSCREEN		1
+
+
+int MessageBox(HWND hWnd, LPCSTR lpText, LPCSTR lpCaption, UINT uType);
+int ShowCursor(BOOL bShow);
+BOOL GetCursorPos(LPPOINT lpPoint);
+BOOL TextOut(HDC hdc, int x, int y, LPCSTR lpString, int c);
+void OutputDebugString(LPCSTR lpOutputString);
+
+#endif
@@ -0,0 +1,764 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				headlessdx.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  DirectDraw, Direct3D, DirectInput and D3DX for headless builds.
+//*			 Surfaces and vertex buffers are plain memory so the code that
+//*			 fills them still runs, the device keeps the state it is given
+//*			 and draws nothing, input devices report nothing pressed.
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		textures loaded from files are blank at the size of the file,
+//*		nothing is ever blitted or read back from the back buffer
+//*********************************************************************
+//*********************************************************************
+#ifdef HEADLESS
+
+#include "zsengine.h"
+#include <d3dx.h>
+
+//the surface format when nobody asks for one
+#define DEFAULT_BIT_COUNT		16
+#define DEFAULT_TEXTURE_SIZE	256
+#define MAX_TRANSFORMS			24
+#define MAX_RENDER_STATES		256
+#define MAX_TEXTURE_STAGES		8
+#define MAX_LIGHTS				8
+
+static BOOL SameGUID(REFGUID A, REFGUID B)
+{
+	return !memcmp(&A, &B, sizeof(GUID));
+}
+
+static void SetPixelFormat(DDPIXELFORMAT *pFormat, int BitCount, DWORD RMask, DWORD GMask, DWORD BMask, DWORD AMask)
+{
+	memset(pFormat, 0, sizeof(DDPIXELFORMAT));
+	pFormat->dwSize = sizeof(DDPIXELFORMAT);
+	pFormat->dwFlags = DDPF_RGB | (AMask ? DDPF_ALPHAPIXELS : 0);
+	pFormat->dwRGBBitCount = BitCount;
+	pFormat->dwRBitMask = RMask;
+	pFormat->dwGBitMask = GMask;
+	pFormat->dwBBitMask = BMask;
+	pFormat->dwRGBAlphaBitMask = AMask;
+}
+
+static void SetPixelFormat(DDPIXELFORMAT *pFormat, D3DX_SURFACEFORMAT Format)
+{
+	switch(Format)
+	{
+		case D3DX_SF_A8R8G8B8:
+			SetPixelFormat(pFormat, 32, 0xff0000, 0xff00, 0xff, 0xff000000);
+			break;
+		case D3DX_SF_X8R8G8B8:
+		case D3DX_SF_R8G8B8:
+			SetPixelFormat(pFormat, 32, 0xff0000, 0xff00, 0xff, 0);
+			break;
+		case D3DX_SF_R5G6B5:
+			SetPixelFormat(pFormat, 16, 0xf800, 0x07e0, 0x001f, 0);
+			break;
+		case D3DX_SF_R5G5B5:
+			SetPixelFormat(pFormat, 16, 0x7c00, 0x03e0, 0x001f, 0);
+			break;
+		case D3DX_SF_X4R4G4B4:
+			SetPixelFormat(pFormat, 16, 0x0f00, 0x00f0, 0x000f, 0);
+			break;
+		case D3DX_SF_A4R4G4B4:
+			SetPixelFormat(pFormat, 16, 0x0f00, 0x00f0, 0x000f, 0xf000);
+			break;
+		default:
+			SetPixelFormat(pFormat, 16, 0x7c00, 0x03e0, 0x001f, 0x8000);
+			break;
+	}
+}
+
+//*******************************CLASS********************************
+//**************          NullSurface             *********************
+//********************************************************************
+class NullSurface : public IDirectDrawSurface7
+{
+private:
+	ULONG References;
+	DDSURFACEDESC2 Desc;
+	BYTE *pBits;
+
+public:
+	NullSurface(LPDDSURFACEDESC2 pDesc)
+	{
+		References = 1;
+		memset(&Desc, 0, sizeof(DDSURFACEDESC2));
+		Desc.dwSize = sizeof(DDSURFACEDESC2);
+		Desc.dwFlags = DDSD_CAPS | DDSD_WIDTH | DDSD_HEIGHT | DDSD_PITCH | DDSD_PIXELFORMAT;
+		Desc.ddsCaps = pDesc->ddsCaps;
+		Desc.dwWidth = (pDesc->dwFlags & DDSD_WIDTH) ? pDesc->dwWidth : 0;
+		Desc.dwHeight = (pDesc->dwFlags & DDSD_HEIGHT) ? pDesc->dwHeight : 0;
+		if(pDesc->dwFlags & DDSD_PIXELFORMAT)
+		{
+			Desc.ddpfPixelFormat = pDesc->ddpfPixelFormat;
+		}
+		else
+		{
+			SetPixelFormat(&Desc.ddpfPixelFormat, DEFAULT_BIT_COUNT, 0xf800, 0x07e0, 0x001f, 0);
+		}
+		if(!Desc.ddpfPixelFormat.dwRGBBitCount)
+		{
+			Desc.ddpfPixelFormat.dwRGBBitCount = DEFAULT_BIT_COUNT;
+		}
+		if(pDesc->dwFlags & DDSD_CKSRCBLT)
+		{
+			Desc.dwFlags |= DDSD_CKSRCBLT;
+			Desc.ddckCKSrcBlt = pDesc->ddckCKSrcBlt;
+		}
+
+		Desc.lPitch = ((Desc.dwWidth * Desc.ddpfPixelFormat.dwRGBBitCount / 8) + 3) & ~3;
+		pBits = NULL;
+		if(Desc.lPitch && Desc.dwHeight)
+		{
+			pBits = new BYTE[Desc.lPitch * Desc.dwHeight];
+			memset(pBits, 0, Desc.lPitch * Desc.dwHeight);
+		}
+		Desc.lpSurface = pBits;
+	}
+
+	virtual ~NullSurface()
+	{
+		if(pBits)
+		{
+			delete[] pBits;
+		}
+	}
+
+	HRESULT QueryInterface(REFIID riid, LPVOID *ppvObj)
+	{
+		AddRef();
+		*ppvObj = this;
+		return S_OK;
+	}
+
+	ULONG AddRef()
+	{
+		return ++References;
+	}
+
+	ULONG Release()
+	{
+		if(!--References)
+		{
+			delete this;
+			return 0;
+		}
+		return References;
+	}
+
+	HRESULT GetAttachedSurface(LPDDSCAPS2 pCaps, LPDIRECTDRAWSURFACE7 *ppSurface)
+	{
+		*ppSurface = new NullSurface(&Desc);
+		return S_OK;
+	}
+
+	HRESULT GetDC(HDC *phDC)
+	{
+		//nothing to draw into with GDI
+		return E_FAIL;
+	}
+
+	HRESULT GetPixelFormat(LPDDPIXELFORMAT pFormat)
+	{
+		*pFormat = Desc.ddpfPixelFormat;
+		return S_OK;
+	}
+
+	HRESULT GetSurfaceDesc(LPDDSURFACEDESC2 pDesc)
+	{
+		*pDesc = Desc;
+		return S_OK;
+	}
+
+	HRESULT Lock(LPRECT pRect, LPDDSURFACEDESC2 pDesc, DWORD Flags, HANDLE hEvent)
+	{
+		*pDesc = Desc;
+		if(pRect && pBits)
+		{
+			pDesc->lpSurface = pBits + pRect->top * Desc.lPitch + pRect->left * (Desc.ddpfPixelFormat.dwRGBBitCount / 8);
+		}
+		return pBits ? S_OK : E_FAIL;
+	}
+};
+
+//*******************************CLASS********************************
+//**************          NullVertexBuffer        *********************
+//********************************************************************
+class NullVertexBuffer : public IDirect3DVertexBuffer7
+{
+private:
+	ULONG References;
+	D3DVERTEXBUFFERDESC Desc;
+	BYTE *pVertices;
+
+	static int VertexSize(DWORD FVF)
+	{
+		int Size;
+
+		switch(FVF & D3DFVF_POSITION_MASK)
+		{
+			case D3DFVF_XYZRHW:
+				Size = 16;
+				break;
+			case D3DFVF_XYZB1:
+			case D3DFVF_XYZB2:
+			case D3DFVF_XYZB3:
+			case D3DFVF_XYZB4:
+			case D3DFVF_XYZB5:
+				Size = 12 + 4 * (((FVF & D3DFVF_POSITION_MASK) - D3DFVF_XYZB1) / 2 + 1);
+				break;
+			default:
+				Size = 12;
+				break;
+		}
+		if(FVF & D3DFVF_NORMAL)
+		{
+			Size += 12;
+		}
+		if(FVF & D3DFVF_RESERVED1)
+		{
+			Size += 4;
+		}
+		if(FVF & D3DFVF_DIFFUSE)
+		{
+			Size += 4;
+		}
+		if(FVF & D3DFVF_SPECULAR)
+		{
+			Size += 4;
+		}
+		//two coordinates for each set, the only kind the game uses
+		Size += 8 * ((FVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT);
+		return Size;
+	}
+
+public:
+	NullVertexBuffer(LPD3DVERTEXBUFFERDESC pDesc)
+	{
+		int Size;
+
+		References = 1;
+		Desc = *pDesc;
+		Size = VertexSize(Desc.dwFVF) * Desc.dwNumVertices;
+		pVertices = new BYTE[Size];
+		memset(pVertices, 0, Size);
+	}
+
+	virtual ~NullVertexBuffer()
+	{
+		delete[] pVertices;
+	}
+
+	ULONG AddRef()
+	{
+		return ++References;
+	}
+
+	ULONG Release()
+	{
+		if(!--References)
+		{
+			delete this;
+			return 0;
+		}
+		return References;
+	}
+
+	HRESULT Lock(DWORD Flags, LPVOID *ppData, LPDWORD pSize)
+	{
+		*ppData = pVertices;
+		if(pSize)
+		{
+			*pSize = VertexSize(Desc.dwFVF) * Desc.dwNumVertices;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetVertexBufferDesc(LPD3DVERTEXBUFFERDESC pDesc)
+	{
+		*pDesc = Desc;
+		return S_OK;
+	}
+};
+
+//*******************************CLASS********************************
+//**************          NullDevice              *********************
+//********************************************************************
+class NullDevice : public IDirect3DDevice7
+{
+private:
+	D3DMATRIX Transforms[MAX_TRANSFORMS];
+	D3DVIEWPORT7 Viewport;
+	D3DMATERIAL7 Material;
+	DWORD RenderStates[MAX_RENDER_STATES];
+	LPDIRECTDRAWSURFACE7 Textures[MAX_TEXTURE_STAGES];
+	D3DLIGHT7 Lights[MAX_LIGHTS];
+	BOOL LightEnabled[MAX_LIGHTS];
+
+public:
+	NullDevice()
+	{
+		int n;
+
+		memset((void *)Transforms, 0, sizeof(Transforms));
+		for(n = 0; n < MAX_TRANSFORMS; n++)
+		{
+			Transforms[n]._11 = Transforms[n]._22 = Transforms[n]._33 = Transforms[n]._44 = 1.0f;
+		}
+		memset(&Viewport, 0, sizeof(Viewport));
+		memset(&Material, 0, sizeof(Material));
+		memset(RenderStates, 0, sizeof(RenderStates));
+		memset(Textures, 0, sizeof(Textures));
+		memset((void *)Lights, 0, sizeof(Lights));
+		memset(LightEnabled, 0, sizeof(LightEnabled));
+	}
+
+	HRESULT GetCaps(LPD3DDEVICEDESC7 pDesc)
+	{
+		memset(pDesc, 0, sizeof(D3DDEVICEDESC7));
+		pDesc->dwMaxTextureWidth = 2048;
+		pDesc->dwMaxTextureHeight = 2048;
+		pDesc->dwMaxActiveLights = MAX_LIGHTS;
+		pDesc->wMaxSimultaneousTextures = MAX_TEXTURE_STAGES;
+		return S_OK;
+	}
+
+	HRESULT SetTransform(D3DTRANSFORMSTATETYPE State, LPD3DMATRIX pMatrix)
+	{
+		if(State < MAX_TRANSFORMS)
+		{
+			Transforms[State] = *pMatrix;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetTransform(D3DTRANSFORMSTATETYPE State, LPD3DMATRIX pMatrix)
+	{
+		if(State >= MAX_TRANSFORMS)
+		{
+			return E_INVALIDARG;
+		}
+		*pMatrix = Transforms[State];
+		return S_OK;
+	}
+
+	HRESULT SetViewport(LPD3DVIEWPORT7 pViewport)
+	{
+		Viewport = *pViewport;
+		return S_OK;
+	}
+
+	HRESULT GetViewport(LPD3DVIEWPORT7 pViewport)
+	{
+		*pViewport = Viewport;
+		return S_OK;
+	}
+
+	HRESULT SetMaterial(LPD3DMATERIAL7 pMaterial)
+	{
+		Material = *pMaterial;
+		return S_OK;
+	}
+
+	HRESULT GetMaterial(LPD3DMATERIAL7 pMaterial)
+	{
+		*pMaterial = Material;
+		return S_OK;
+	}
+
+	HRESULT SetLight(DWORD Index, LPD3DLIGHT7 pLight)
+	{
+		if(Index < MAX_LIGHTS)
+		{
+			Lights[Index] = *pLight;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetLight(DWORD Index, LPD3DLIGHT7 pLight)
+	{
+		if(Index >= MAX_LIGHTS)
+		{
+			return E_INVALIDARG;
+		}
+		*pLight = Lights[Index];
+		return S_OK;
+	}
+
+	HRESULT LightEnable(DWORD Index, BOOL Enable)
+	{
+		if(Index < MAX_LIGHTS)
+		{
+			LightEnabled[Index] = Enable;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetLightEnable(DWORD Index, BOOL *pEnable)
+	{
+		*pEnable = Index < MAX_LIGHTS ? LightEnabled[Index] : FALSE;
+		return S_OK;
+	}
+
+	HRESULT SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
+	{
+		if(State < MAX_RENDER_STATES)
+		{
+			RenderStates[State] = Value;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetRenderState(D3DRENDERSTATETYPE State, LPDWORD pValue)
+	{
+		*pValue = State < MAX_RENDER_STATES ? RenderStates[State] : 0;
+		return S_OK;
+	}
+
+	HRESULT SetTexture(DWORD Stage, LPDIRECTDRAWSURFACE7 pTexture)
+	{
+		if(Stage < MAX_TEXTURE_STAGES)
+		{
+			Textures[Stage] = pTexture;
+		}
+		return S_OK;
+	}
+
+	HRESULT GetTexture(DWORD Stage, LPDIRECTDRAWSURFACE7 *ppTexture)
+	{
+		*ppTexture = Stage < MAX_TEXTURE_STAGES ? Textures[Stage] : NULL;
+		if(*ppTexture)
+		{
+			(*ppTexture)->AddRef();
+		}
+		return S_OK;
+	}
+
+	HRESULT GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE State, LPDWORD pValue)
+	{
+		*pValue = 0;
+		return S_OK;
+	}
+};
+
+//*******************************CLASS********************************
+//**************          NullDirect3D            *********************
+//********************************************************************
+class NullDirect3D : public IDirect3D7
+{
+public:
+	HRESULT CreateDevice(REFCLSID rclsid, LPDIRECTDRAWSURFACE7 pTarget, LPDIRECT3DDEVICE7 *ppDevice)
+	{
+		*ppDevice = new NullDevice;
+		return S_OK;
+	}
+
+	HRESULT CreateVertexBuffer(LPD3DVERTEXBUFFERDESC pDesc, LPDIRECT3DVERTEXBUFFER7 *ppBuffer, DWORD Flags)
+	{
+		*ppBuffer = new NullVertexBuffer(pDesc);
+		return S_OK;
+	}
+};
+
+//*******************************CLASS********************************
+//**************          NullDirectDraw          *********************
+//********************************************************************
+class NullDirectDraw : public IDirectDraw7
+{
+public:
+	HRESULT QueryInterface(REFIID riid, LPVOID *ppvObj)
+	{
+		if(SameGUID(riid, IID_IDirect3D7))
+		{
+			*ppvObj = new NullDirect3D;
+			return S_OK;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+
+	HRESULT CreateClipper(DWORD Flags, LPDIRECTDRAWCLIPPER *ppClipper, IUnknown *pOuter)
+	{
+		*ppClipper = new IDirectDrawClipper;
+		return S_OK;
+	}
+
+	HRESULT CreateSurface(LPDDSURFACEDESC2 pDesc, LPDIRECTDRAWSURFACE7 *ppSurface, IUnknown *pOuter)
+	{
+		DDSURFACEDESC2 Desc;
+
+		//the primary surface is the size of the screen
+		Desc = *pDesc;
+		if((Desc.ddsCaps.dwCaps & DDSCAPS_PRIMARYSURFACE) && Engine && Engine->Graphics())
+		{
+			Desc.dwFlags |= DDSD_WIDTH | DDSD_HEIGHT;
+			Desc.dwWidth = Engine->Graphics()->GetWidth();
+			Desc.dwHeight = Engine->Graphics()->GetHeight();
+		}
+		*ppSurface = new NullSurface(&Desc);
+		return S_OK;
+	}
+};
+
+//************** DirectX entry points  ********************************
+
+HRESULT WINAPI DirectDrawCreateEx(GUID *lpGuid, LPVOID *lplpDD, REFIID iid, IUnknown *pUnkOuter)
+{
+	*lplpDD = new NullDirectDraw;
+	return S_OK;
+}
+
+//*******************************CLASS********************************
+//**************          NullInputDevice         *********************
+//********************************************************************
+class NullInputDevice : public IDirectInputDevice7A
+{
+public:
+	HRESULT GetDeviceState(DWORD Size, LPVOID pData)
+	{
+		memset(pData, 0, Size);
+		return S_OK;
+	}
+
+	HRESULT GetDeviceData(DWORD ObjectSize, LPDIDEVICEOBJECTDATA pData, LPDWORD pInOut, DWORD Flags)
+	{
+		*pInOut = 0;
+		return S_OK;
+	}
+};
+
+class NullDirectInput : public IDirectInput7A
+{
+public:
+	HRESULT CreateDeviceEx(REFGUID rguid, REFIID riid, LPVOID *ppvObj, LPUNKNOWN pOuter)
+	{
+		*ppvObj = new NullInputDevice;
+		return S_OK;
+	}
+};
+
+HRESULT WINAPI DirectInputCreateEx(HINSTANCE hinst, DWORD dwVersion, REFIID riidltf, LPVOID *ppvOut, LPUNKNOWN punkOuter)
+{
+	*ppvOut = new NullDirectInput;
+	return S_OK;
+}
+
+const DIDATAFORMAT c_dfDIMouse = { sizeof(DIDATAFORMAT), sizeof(DIOBJECTDATAFORMAT), DIDF_RELAXIS, sizeof(DIMOUSESTATE), 0, NULL };
+const DIDATAFORMAT c_dfDIKeyboard = { sizeof(DIDATAFORMAT), sizeof(DIOBJECTDATAFORMAT), DIDF_RELAXIS, 256, 0, NULL };
+
+//************** D3DX textures  ***************************************
+
+static DWORD PowerOfTwo(DWORD Size)
+{
+	DWORD Power;
+
+	for(Power = 1; Power < Size; Power <<= 1);
+	return Power;
+}
+
+HRESULT WINAPI D3DXInitialize()
+{
+	return S_OK;
+}
+
+HRESULT WINAPI D3DXUninitialize()
+{
+	return S_OK;
+}
+
+HRESULT WINAPI D3DXCheckTextureRequirements(LPDIRECT3DDEVICE7 pd3dDevice, LPDWORD pFlags, LPDWORD pWidth, LPDWORD pHeight, D3DX_SURFACEFORMAT *pPixelFormat)
+{
+	if(pWidth && *pWidth != (DWORD)D3DX_DEFAULT)
+	{
+		*pWidth = PowerOfTwo(*pWidth);
+	}
+	if(pHeight && *pHeight != (DWORD)D3DX_DEFAULT)
+	{
+		*pHeight = PowerOfTwo(*pHeight);
+	}
+	return S_OK;
+}
+
+HRESULT WINAPI D3DXCreateTexture(LPDIRECT3DDEVICE7 pd3dDevice, LPDWORD pFlags, LPDWORD pWidth, LPDWORD pHeight, D3DX_SURFACEFORMAT *pPixelFormat, LPDIRECTDRAWPALETTE pDDPal, LPDIRECTDRAWSURFACE7 *ppDDSurf, LPDWORD pNumMipMaps)
+{
+	DDSURFACEDESC2 Desc;
+
+	memset(&Desc, 0, sizeof(Desc));
+	Desc.dwSize = sizeof(Desc);
+	Desc.dwFlags = DDSD_CAPS | DDSD_WIDTH | DDSD_HEIGHT | DDSD_PIXELFORMAT;
+	Desc.ddsCaps.dwCaps = DDSCAPS_TEXTURE;
+
+	if(*pWidth == (DWORD)D3DX_DEFAULT || !*pWidth)
+	{
+		*pWidth = DEFAULT_TEXTURE_SIZE;
+	}
+	if(*pHeight == (DWORD)D3DX_DEFAULT || !*pHeight)
+	{
+		*pHeight = DEFAULT_TEXTURE_SIZE;
+	}
+	D3DXCheckTextureRequirements(pd3dDevice, pFlags, pWidth, pHeight, pPixelFormat);
+	Desc.dwWidth = *pWidth;
+	Desc.dwHeight = *pHeight;
+
+	if(pPixelFormat && *pPixelFormat == D3DX_SF_UNKNOWN)
+	{
+		*pPixelFormat = D3DX_SF_A1R5G5B5;
+	}
+	SetPixelFormat(&Desc.ddpfPixelFormat, pPixelFormat ? *pPixelFormat : D3DX_SF_A1R5G5B5);
+
+	*ppDDSurf = new NullSurface(&Desc);
+	if(pNumMipMaps)
+	{
+		*pNumMipMaps = 1;
+	}
+	return S_OK;
+}
+
+HRESULT WINAPI D3DXCreateTextureFromFile(LPDIRECT3DDEVICE7 pd3dDevice, LPDWORD pFlags, LPDWORD pWidth, LPDWORD pHeight, D3DX_SURFACEFORMAT *pPixelFormat, LPDIRECTDRAWPALETTE pDDPal, LPDIRECTDRAWSURFACE7 *ppDDSurf, LPDWORD pNumMipMaps, LPSTR pSrcName, D3DX_FILTERTYPE filterType)
+{
+	BITMAPFILEHEADER FileHeader;
+	BITMAPINFOHEADER InfoHeader;
+	FILE *fp;
+
+	//the texture takes the size of the bitmap, its pixels are left blank
+	fp = fopen(pSrcName, "rb");
+	if(!fp)
+	{
+		return E_FAIL;
+	}
+	if(fread(&FileHeader, sizeof(FileHeader), 1, fp) == 1 && FileHeader.bfType == 0x4d42 &&
+		fread(&InfoHeader, sizeof(InfoHeader), 1, fp) == 1)
+	{
+		if(*pWidth == (DWORD)D3DX_DEFAULT)
+		{
+			*pWidth = InfoHeader.biWidth;
+		}
+		if(*pHeight == (DWORD)D3DX_DEFAULT)
+		{
+			*pHeight = InfoHeader.biHeight < 0 ? -InfoHeader.biHeight : InfoHeader.biHeight;
+		}
+	}
+	fclose(fp);
+
+	return D3DXCreateTexture(pd3dDevice, pFlags, pWidth, pHeight, pPixelFormat, pDDPal, ppDDSurf, pNumMipMaps);
+}
+
+HRESULT WINAPI D3DXLoadTextureFromSurface(LPDIRECT3DDEVICE7 pd3dDevice, LPDIRECTDRAWSURFACE7 pTexture, DWORD mipMapLevel, LPDIRECTDRAWSURFACE7 pSurfaceSrc, RECT *pSrcRect, RECT *pDestRect, D3DX_FILTERTYPE filterType)
+{
+	return S_OK;
+}
+
+//************** D3DX math  *******************************************
+//row vectors, as D3DX has them, out may be the same as an input
+
+D3DXMATRIX* WINAPI D3DXMatrixMultiply(D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2)
+{
+	D3DMATRIX Result;
+
+	D3DMatrixMultiply(&Result, (D3DMATRIX *)pM1, (D3DMATRIX *)pM2);
+	*(D3DMATRIX *)pOut = Result;
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixInverse(D3DXMATRIX *pOut, float *pfDeterminant, const D3DXMATRIX *pM)
+{
+	D3DMATRIX Result;
+	float Determinant;
+
+	//D3DMatrixInverse hands back the reciprocal of the determinant
+	D3DMatrixInverse(&Result, &Determinant, (D3DMATRIX *)pM);
+	Determinant = 1.0f / Determinant;
+	if(pfDeterminant)
+	{
+		*pfDeterminant = Determinant;
+	}
+	if(Determinant == 0.0f)
+	{
+		return NULL;
+	}
+	*(D3DMATRIX *)pOut = Result;
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixScaling(D3DXMATRIX *pOut, float sx, float sy, float sz)
+{
+	D3DMatrixScaling((D3DMATRIX *)pOut, sx, sy, sz);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixTranslation(D3DXMATRIX *pOut, float x, float y, float z)
+{
+	D3DMatrixTranslation((D3DMATRIX *)pOut, x, y, z);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixRotationY(D3DXMATRIX *pOut, float angle)
+{
+	D3DMatrixRotationY((D3DMATRIX *)pOut, angle);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixRotationZ(D3DXMATRIX *pOut, float angle)
+{
+	D3DMatrixRotationZ((D3DMATRIX *)pOut, angle);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixRotationAxis(D3DXMATRIX *pOut, const D3DXVECTOR3 *pV, float angle)
+{
+	D3DVECTOR Axis;
+
+	//D3DMatrixRotationAxis normalises the axis in place
+	Axis = *pV;
+	D3DMatrixRotationAxis((D3DMATRIX *)pOut, &Axis, angle);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixLookAt(D3DXMATRIX *pOut, const D3DXVECTOR3 *pEye, const D3DXVECTOR3 *pAt, const D3DXVECTOR3 *pUp)
+{
+	D3DVECTOR Eye;
+	D3DVECTOR At;
+	D3DVECTOR Up;
+
+	Eye = *pEye;
+	At = *pAt;
+	Up = *pUp;
+	D3DMatrixLookAt((D3DMATRIX *)pOut, &Eye, &At, &Up);
+	return pOut;
+}
+
+D3DXMATRIX* WINAPI D3DXMatrixOrtho(D3DXMATRIX *pOut, float w, float h, float zn, float zf)
+{
+	D3DMATRIX *pMat = (D3DMATRIX *)pOut;
+
+	memset((void *)pMat, 0, sizeof(D3DMATRIX));
+	pMat->_11 = 2.0f / w;
+	pMat->_22 = 2.0f / h;
+	pMat->_33 = 1.0f / (zf - zn);
+	pMat->_43 = zn / (zn - zf);
+	pMat->_44 = 1.0f;
+	return pOut;
+}
+
+D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pOut, const D3DXVECTOR3 *pV, const D3DXMATRIX *pM)
+{
+	const D3DMATRIX *pMat = (const D3DMATRIX *)pM;
+	D3DXVECTOR4 Result;
+
+	Result.x = pV->x * pMat->_11 + pV->y * pMat->_21 + pV->z * pMat->_31 + pMat->_41;
+	Result.y = pV->x * pMat->_12 + pV->y * pMat->_22 + pV->z * pMat->_32 + pMat->_42;
+	Result.z = pV->x * pMat->_13 + pV->y * pMat->_23 + pV->z * pMat->_33 + pMat->_43;
+	Result.w = pV->x * pMat->_14 + pV->y * pMat->_24 + pV->z * pMat->_34 + pMat->_44;
+	*pOut = Result;
+	return pOut;
+}
+
+#endif
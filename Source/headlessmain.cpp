@@ -0,0 +1,543 @@
+//*********************************************************************
+//*                                                                   *
+//**************              headlessmain.cpp       *********************
+//**                                                                  *
+//**                                                                  *
+//*********************************************************************
+//*                                                                   *
+//*Revision:
+//*Revisor:
+//*Purpose:
+//*		command line driver for the headless build.  loads the world the
+//*		way WinMain does, runs it for a number of fixed length ticks or
+//*		plays back a recorded session, and reports how long each part of
+//*		World::Update took
+//*********************************************************************
+//*Outstanding issues:
+//*		without a saved game there is no party, so only what is placed
+//*		around the starting view gets updated
+//*********************************************************************
+//*********************************************************************
+#ifdef HEADLESS
+
+#include "defs.h"
+#include "registration.h"
+#include "mainwindow.h"
+#include "zsengine.h"
+#include "zsutilities.h"
+#include "creatures.h"
+#include "items.h"
+#include "spells.h"
+#include "world.h"
+#include "script.h"
+#include "scriptfuncs.h"
+#include "scriptvm.h"
+#include "events.h"
+#include "party.h"
+#include "path.h"
+#include "blood.h"
+#include "combatmanager.h"
+#include "zswindow.h"
+#include "replay.h"
+#include "profiler.h"
+#include "mesharchive.h"
+#include "mappedarea.h"
+#include "area.h"
+#include "assetregistry.h"
+#include "thingindex.h"
+#include "workerpool.h"
+
+#define MASTER_ITEM_FILE		"items.txt"
+#define MASTER_CREATURE_FILE	"creatures.txt"
+
+#define DEFAULT_TICKS			1000
+#define DEFAULT_TICK_LENGTH		33
+//the game clock starts here rather than at 0 so nothing sees a zero time
+#define HEADLESS_START_TIME		100000
+
+ZSMainWindow *pMain = NULL;
+
+void OnExit(void);
+
+static void Usage()
+{
+	printf("usage: prelude-headless [options]\n");
+	printf("  -g <file>   saved game to load before running\n");
+	printf("  -n <ticks>  number of ticks to run, default %i\n", DEFAULT_TICKS);
+	printf("  -t <ms>     length of a tick in milliseconds, default %i\n", DEFAULT_TICK_LENGTH);
+	printf("  -r <file>   play back a recorded session instead, see RECORD in gui.ini\n");
+	printf("  -p <file>   write a trace of every zone run, for chrome://tracing\n");
+	printf("  -w <file>   write every path search the run makes\n");
+	printf("  -s <file>   after the run, time the path searches written by -w\n");
+	printf("  -m          convert mesh.bin to %s, time loading both and exit\n", MESH_ARCHIVE_FILE);
+	printf("  -q          with -m, quantize positions and normals\n");
+	printf("  -a          convert each area's .bin to .sta, time reading both, then run on the .sta\n");
+	printf("  -b          after the run, time the hashed lookups against the old walks\n");
+	printf("  -v          run every event and character through the script compiler and the\n");
+	printf("              interpreter, write what differs to scriptcheck.txt and exit\n");
+	printf("  -h          this message\n");
+	printf("runs in the game directory, or in $PRELUDE_DIR if that is set\n");
+}
+
+static void LoadWorld()
+{
+	FILE *fp;
+	Creature *pCreature;
+	int Temp;
+
+	Engine->Graphics()->CreateProjectionMatrix(8.5f, 8.5f, VIEW_DEPTH*4);
+	Engine->Graphics()->SetRenderState(D3DRENDERSTATE_LIGHTING, TRUE);
+
+	Engine->LoadTextures();
+	Engine->Graphics()->SetUpCircles();
+
+	PreludeWorld = new World;
+
+	pMain = new ZSMainWindow;
+	pMain->SetText("Main Window");
+	pMain->SetDrawWorld(FALSE);
+
+	if(!Engine->LoadMeshArchive(MESH_ARCHIVE_FILE, "mesh.bin"))
+	{
+		fp = fopen("mesh.bin","rb");
+		if(fp)
+		{
+			fclose(fp);
+			Engine->LoadMeshes("mesh.bin");
+		}
+		else
+		{
+			Engine->ImportMeshes();
+		}
+	}
+
+	DEBUG_INFO("about to load items\n");
+
+	fp = fopen("items.bin","rb");
+	if(!fp)
+	{
+		fp = SafeFileOpen(MASTER_ITEM_FILE,"rt");
+		LoadItems(fp);
+		fclose(fp);
+		fp = SafeFileOpen("items.bin","wb");
+		SaveBinItems(fp);
+	}
+	else
+	{
+		LoadBinItems(fp);
+	}
+	fclose(fp);
+
+	PreludeSpells.Init();
+	PreludeSpells.Load("newspells.bin");
+
+	DEBUG_INFO("About to load Creatures\n");
+
+	fp = fopen("creatures.bin","rb");
+	if(!fp)
+	{
+		fp = SafeFileOpen(MASTER_CREATURE_FILE,"rt");
+		LoadCreatures(fp);
+		fclose(fp);
+		fp = SafeFileOpen("creatures.bin","wb");
+		SaveBinCreatures(fp);
+	}
+	else
+	{
+		LoadBinCreatures(fp);
+	}
+	fclose(fp);
+
+	pCreature = Creature::GetFirst();
+	while(pCreature)
+	{
+		pCreature->ReEquip();
+		pCreature = (Creature *)pCreature->GetNext();
+	}
+
+	SetCurrentDirectory(".\\Areas");
+	fp = fopen("valley.bin","rb");
+	if(!fp)
+	{
+		PreludeWorld->BringUpToDate();
+	}
+	else
+	{
+		SetCurrentDirectory(Engine->GetRootDirectory());
+		fclose(fp);
+		PreludeWorld->Load("worldbase.bin");
+	}
+	SetCurrentDirectory(Engine->GetRootDirectory());
+
+	fp = SafeFileOpen("gui.ini","rt");
+	SeekTo(fp,"DIFFICULTY");
+	PreludeWorld->SetDifficulty(GetInt(fp));
+	SeekTo(fp,"XPCONFIRM");
+	Temp = GetInt(fp);
+	PreludeWorld->SetXPConfirm(Temp);
+	fclose(fp);
+
+	//nothing to draw it on
+	Blood::DisableBlood();
+
+	DEBUG_INFO("Loading Events\n");
+
+	fp = fopen("events.bin","rb");
+	if(fp)
+	{
+		fclose(fp);
+		PreludeEvents.LoadEvents("events.bin");
+	}
+	else
+	{
+		PreludeEvents.ImportEvents("events.txt");
+		PreludeEvents.SaveEvents("events.bin");
+	}
+}
+
+//returns how many chunks came out of the two formats different, a failed
+//conversion counts one
+static int ConvertAreas()
+{
+	Area *pArea;
+	char BinName[512];
+	char MapName[512];
+	int NumMismatches = 0;
+	int Result;
+	int n;
+
+	for(n = 0; n < PreludeWorld->GetNumAreas(); n++)
+	{
+		pArea = PreludeWorld->GetArea(n);
+		sprintf(BinName,"%s\\Areas\\%s.bin",Engine->GetRootDirectory(),pArea->GetName());
+		sprintf(MapName,"%s\\Areas\\%s.sta",Engine->GetRootDirectory(),pArea->GetName());
+
+		//the mapping and the loader thread hold the old .sta open
+		pArea->CloseStaticViews();
+
+		Result = ConvertAreaToMapped(BinName, MapName);
+		if(Result < 0)
+		{
+			printf("can't convert %s to %s\n", BinName, MapName);
+			NumMismatches++;
+		}
+		else
+		{
+			printf("%i chunks written to %s\n", Result, MapName);
+			Result = BenchmarkAreaLoad(BinName, MapName, stdout);
+			NumMismatches += Result < 0 ? 1 : Result;
+		}
+
+		pArea->OpenStaticViews();
+	}
+
+	return NumMismatches;
+}
+
+int main(int argc, char **argv)
+{
+	const char *SaveGame = NULL;
+	const char *Session = NULL;
+	const char *Trace = NULL;
+	const char *PathsOut = NULL;
+	const char *PathsIn = NULL;
+	int NumTicks = DEFAULT_TICKS;
+	int TickLength = DEFAULT_TICK_LENGTH;
+	BOOL ConvertMeshes = FALSE;
+	BOOL Quantize = FALSE;
+	BOOL Benchmark = FALSE;
+	BOOL ConvertStatic = FALSE;
+	BOOL CheckScripts = FALSE;
+	int NumMismatches = 0;
+	DWORD Check;
+	int n;
+
+	for(n = 1; n < argc; n++)
+	{
+		if(!strcmp(argv[n], "-g") && n + 1 < argc)
+		{
+			SaveGame = argv[++n];
+		}
+		else
+		if(!strcmp(argv[n], "-n") && n + 1 < argc)
+		{
+			NumTicks = atoi(argv[++n]);
+		}
+		else
+		if(!strcmp(argv[n], "-t") && n + 1 < argc)
+		{
+			TickLength = atoi(argv[++n]);
+		}
+		else
+		if(!strcmp(argv[n], "-r") && n + 1 < argc)
+		{
+			Session = argv[++n];
+		}
+		else
+		if(!strcmp(argv[n], "-p") && n + 1 < argc)
+		{
+			Trace = argv[++n];
+		}
+		else
+		if(!strcmp(argv[n], "-w") && n + 1 < argc)
+		{
+			PathsOut = argv[++n];
+		}
+		else
+		if(!strcmp(argv[n], "-s") && n + 1 < argc)
+		{
+			PathsIn = argv[++n];
+		}
+		else
+		if(!strcmp(argv[n], "-m"))
+		{
+			ConvertMeshes = TRUE;
+		}
+		else
+		if(!strcmp(argv[n], "-q"))
+		{
+			Quantize = TRUE;
+		}
+		else
+		if(!strcmp(argv[n], "-b"))
+		{
+			Benchmark = TRUE;
+		}
+		else
+		if(!strcmp(argv[n], "-a"))
+		{
+			ConvertStatic = TRUE;
+		}
+		else
+		if(!strcmp(argv[n], "-v"))
+		{
+			CheckScripts = TRUE;
+		}
+		else
+		{
+			Usage();
+			return strcmp(argv[n], "-h") ? 1 : 0;
+		}
+	}
+
+	if(Session)
+	{
+		if(!PreludeReplay.Load(Session))
+		{
+			printf("can't read session %s\n", Session);
+			return 1;
+		}
+		SaveGame = PreludeReplay.GetSaveName();
+		NumTicks = PreludeReplay.GetLength();
+		TickLength = (int)PreludeReplay.GetTickLength();
+		StartFixedTicks(PreludeReplay.GetStart(), PreludeReplay.GetTickLength());
+	}
+	else
+	{
+		//the game clock only moves when a tick says so, which keeps runs
+		//with the same data comparable
+		StartFixedTicks(HEADLESS_START_TIME, TickLength);
+		SeedGameRand(0);
+	}
+
+	if(NumTicks < 1 || TickLength < 1)
+	{
+		Usage();
+		return 1;
+	}
+
+	INIT_DEBUG();
+
+	Register();
+
+	FillDistanceTable();
+
+	srand(0);
+
+	if(atexit(OnExit))
+	{
+		DEBUG_INFO("failed to register exit normal function\n");
+		exit(1);
+	}
+
+	Chunk::InitTerrain();
+
+	LoadFuncs();
+	InitScriptVM();
+
+	D3DXInitialize();
+
+	Engine = new ZSEngine;
+	Engine->Init(NULL);
+
+	if(ConvertMeshes)
+	{
+		//the meshes look their textures up as they load
+		Engine->LoadTextures();
+		n = ConvertMeshesToArchive("mesh.bin", MESH_ARCHIVE_FILE, Quantize);
+		if(n < 0)
+		{
+			printf("can't convert mesh.bin to %s\n", MESH_ARCHIVE_FILE);
+			return 1;
+		}
+		printf("%i meshes written to %s\n", n, MESH_ARCHIVE_FILE);
+		return BenchmarkMeshLoad("mesh.bin", MESH_ARCHIVE_FILE, stdout) ? 2 : 0;
+	}
+
+	LoadWorld();
+
+	if(ConvertStatic)
+	{
+		n = ConvertAreas();
+		if(n)
+		{
+			printf("%i chunks differ between the .bin and the .sta\n", n);
+			return 2;
+		}
+	}
+
+	if(SaveGame)
+	{
+		PreludeWorld->LoadGame(SaveGame);
+	}
+	PreludeWorld->SetGameState(GAME_STATE_NORMAL);
+
+	if(CheckScripts)
+	{
+		n = ScriptProgram::CheckAll("scriptcheck.txt");
+		if(n)
+		{
+			printf("%i differences between the compiled and interpreted scripts, see scriptcheck.txt\n", n);
+			return 2;
+		}
+		printf("compiled scripts match the interpreter\n");
+		return 0;
+	}
+
+	if(Session)
+	{
+		PreludeReplay.StartPlayback();
+	}
+
+	PreludeReplay.StartTiming(NumTicks);
+	if(Trace)
+	{
+		ProfileStartCapture();
+	}
+	if(PathsOut)
+	{
+		RecordPaths(PathsOut);
+	}
+
+	for(n = 0; n < NumTicks; n++)
+	{
+		PreludeWorld->Update();
+		PreludeReplay.EndTick();
+	}
+
+	if(Session)
+	{
+		//taken before anything below can touch the world or the clock
+		Check = Replay::WorldCheck();
+		PreludeReplay.StopPlayback();
+	}
+
+	if(Trace && !ProfileStopCapture(Trace))
+	{
+		printf("can't write trace %s\n", Trace);
+	}
+	StopRecordingPaths();
+
+	printf("ticks       %i x %i ms\n", NumTicks, TickLength);
+	printf("game time   %i:%02i\n", PreludeWorld->GetHour(), PreludeWorld->GetMinute());
+	PreludeReplay.OutputTimes(stdout);
+	Engine->OutputAssetStats(stdout);
+	for(n = 0; n < PreludeWorld->GetNumAreas(); n++)
+	{
+		PreludeWorld->GetArea(n)->OutputLoadStats(stdout);
+	}
+
+	if(PathsIn)
+	{
+		printf("\n");
+		if(!BenchmarkPaths(PathsIn, stdout))
+		{
+			printf("no path searches in %s\n", PathsIn);
+		}
+	}
+
+	if(Benchmark)
+	{
+		printf("\n");
+		NumMismatches += BenchmarkAssetLookup(stdout);
+		NumMismatches += BenchmarkThingFind(stdout);
+		NumMismatches += BenchmarkScriptImport(stdout);
+		if(NumMismatches)
+		{
+			printf("%i lookups disagree with the walks\n", NumMismatches);
+			return 2;
+		}
+	}
+
+	if(Session && PreludeReplay.GetCheck())
+	{
+		if(Check != PreludeReplay.GetCheck())
+		{
+			printf("replay diverged, %lu recorded, %lu played\n", (unsigned long)PreludeReplay.GetCheck(), (unsigned long)Check);
+			return 2;
+		}
+		printf("replay matched\n");
+	}
+
+	return 0;
+}
+
+void OnExit(void)
+{
+	D3DXUninitialize();
+
+	ClearStack();
+
+	PreludeEvents.Clear();
+	PreludeFlags.Clear();
+
+	if(PreludeWorld)
+	{
+		if(PreludeWorld->GetCombat())
+			PreludeWorld->GetCombat()->Kill();
+		delete PreludeWorld;
+		PreludeWorld = NULL;
+	}
+
+	DeleteCreatures();
+	DeleteItems();
+
+	if(Engine)
+	{
+		delete Engine;
+		Engine = NULL;
+	}
+
+	if(pMain)
+	{
+		delete pMain;
+		pMain = NULL;
+	}
+
+	ZSWindow::Shutdown();
+
+	Action::ReleaseAll();
+
+	//the workers log as they go
+	PreludeWorkers.Stop();
+
+	LogShutdown();
+
+	if(ExitErrorMessage)
+	{
+		MessageBox(NULL, ExitErrorMessage, "Fatal Error", MB_OK | MB_ICONSTOP);
+		delete[] ExitErrorMessage;
+	}
+}
+
+#endif
@@ -0,0 +1,278 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				heightfield.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  a mesh's heights on a regular grid, rasterized once and
+//*			 read back with bilinear filtering
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		where triangles overlap seen from above the highest one wins,
+//*		so overhangs and cave roofs bake as solid
+//*********************************************************************
+//*********************************************************************
+#include "heightfield.h"
+#include "ZSModel.h"
+#include "workerpool.h"
+#include <float.h>
+#include <math.h>
+
+//one band of rows for one thread
+typedef struct
+{
+	ZSModel *pMesh;
+	float *pHeights;
+	float *pVertices;
+	int FirstRow;
+	int EndRow;
+	int Width;
+	double Left;
+	double Top;
+	double Step;
+} HEIGHTFIELD_BAND_T;
+
+static double Lowest(double a, double b, double c)
+{
+	if(b < a) a = b;
+	if(c < a) a = c;
+	return a;
+}
+
+static double Highest(double a, double b, double c)
+{
+	if(b > a) a = b;
+	if(c > a) a = c;
+	return a;
+}
+
+static void BakeBand(HEIGHTFIELD_BAND_T *pBand)
+{
+	unsigned short *pTriangle;
+	float *pA;
+	float *pB;
+	float *pC;
+	float *pHeight;
+	double ax, ay, bx, by, cx, cy;
+	double Area;
+	double WA, WB, WC;
+	double px, py;
+	double z;
+	int Left, Right, Top, Bottom;
+	int n;
+	int xn, yn;
+
+	for(n = pBand->FirstRow * pBand->Width; n < pBand->EndRow * pBand->Width; n++)
+	{
+		pBand->pHeights[n] = -FLT_MAX;
+	}
+
+	pTriangle = pBand->pMesh->trianglelist;
+	for(n = 0; n < pBand->pMesh->numtriangles; n++, pTriangle += 3)
+	{
+		pA = &pBand->pVertices[pTriangle[0] * 3];
+		pB = &pBand->pVertices[pTriangle[1] * 3];
+		pC = &pBand->pVertices[pTriangle[2] * 3];
+
+		//in samples
+		ax = (pA[0] - pBand->Left) / pBand->Step;
+		ay = (pA[1] - pBand->Top) / pBand->Step;
+		bx = (pB[0] - pBand->Left) / pBand->Step;
+		by = (pB[1] - pBand->Top) / pBand->Step;
+		cx = (pC[0] - pBand->Left) / pBand->Step;
+		cy = (pC[1] - pBand->Top) / pBand->Step;
+
+		//edge on from above
+		Area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+		if(fabs(Area) < 1e-12)
+		{
+			continue;
+		}
+
+		Top = (int)ceil(Lowest(ay, by, cy) - HEIGHTFIELD_EDGE);
+		Bottom = (int)floor(Highest(ay, by, cy) + HEIGHTFIELD_EDGE);
+		if(Top < pBand->FirstRow) Top = pBand->FirstRow;
+		if(Bottom >= pBand->EndRow) Bottom = pBand->EndRow - 1;
+		if(Top > Bottom)
+		{
+			continue;
+		}
+
+		Left = (int)ceil(Lowest(ax, bx, cx) - HEIGHTFIELD_EDGE);
+		Right = (int)floor(Highest(ax, bx, cx) + HEIGHTFIELD_EDGE);
+		if(Left < 0) Left = 0;
+		if(Right >= pBand->Width) Right = pBand->Width - 1;
+
+		for(yn = Top; yn <= Bottom; yn++)
+		{
+			py = (double)yn;
+			pHeight = &pBand->pHeights[yn * pBand->Width];
+			for(xn = Left; xn <= Right; xn++)
+			{
+				px = (double)xn;
+				WA = ((bx - px) * (cy - py) - (by - py) * (cx - px)) / Area;
+				WB = ((cx - px) * (ay - py) - (cy - py) * (ax - px)) / Area;
+				WC = 1.0 - WA - WB;
+				if(WA < -HEIGHTFIELD_EDGE || WB < -HEIGHTFIELD_EDGE || WC < -HEIGHTFIELD_EDGE)
+				{
+					continue;
+				}
+				z = WA * pA[2] + WB * pB[2] + WC * pC[2];
+				if((float)z > pHeight[xn])
+				{
+					pHeight[xn] = (float)z;
+				}
+			}
+		}
+	}
+
+	for(n = pBand->FirstRow * pBand->Width; n < pBand->EndRow * pBand->Width; n++)
+	{
+		if(pBand->pHeights[n] == -FLT_MAX)
+		{
+			pBand->pHeights[n] = 0.0f;
+		}
+	}
+}
+
+static void BakeBandJob(int Band, void *pBands)
+{
+	BakeBand(&((HEIGHTFIELD_BAND_T *)pBands)[Band]);
+}
+
+//************** Constructors  ****************************************
+
+HeightField::HeightField()
+{
+	Heights = NULL;
+	Width = 0;
+	Height = 0;
+	Left = 0.0f;
+	Top = 0.0f;
+	Step = 1.0f;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+HeightField::~HeightField()
+{
+	Clear();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+float HeightField::Sample(float x, float y)
+{
+	float fx;
+	float fy;
+	float Top;
+	float Bottom;
+	int x0, y0, x1, y1;
+
+	if(!Heights)
+	{
+		return 0.0f;
+	}
+
+	fx = (x - Left) / Step;
+	fy = (y - this->Top) / Step;
+	if(fx < 0.0f) fx = 0.0f;
+	if(fy < 0.0f) fy = 0.0f;
+	if(fx > (float)(Width - 1)) fx = (float)(Width - 1);
+	if(fy > (float)(Height - 1)) fy = (float)(Height - 1);
+
+	x0 = (int)fx;
+	y0 = (int)fy;
+	x1 = (x0 + 1 < Width) ? x0 + 1 : x0;
+	y1 = (y0 + 1 < Height) ? y0 + 1 : y0;
+	fx -= (float)x0;
+	fy -= (float)y0;
+
+	Top = Heights[x0 + y0 * Width] + (Heights[x1 + y0 * Width] - Heights[x0 + y0 * Width]) * fx;
+	Bottom = Heights[x0 + y1 * Width] + (Heights[x1 + y1 * Width] - Heights[x0 + y1 * Width]) * fx;
+	return Top + (Bottom - Top) * fy;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+BOOL HeightField::Bake(ZSModel *pMesh, int Frame, float NewLeft, float NewTop, float NewStep, int NewWidth, int NewHeight)
+{
+	HEIGHTFIELD_BAND_T Bands[HEIGHTFIELD_MAX_BANDS];
+	int NumBands;
+	int n;
+
+	Clear();
+
+	if(!pMesh || !pMesh->stridedVertexArray || !pMesh->trianglelist ||
+		Frame < 0 || Frame >= pMesh->numframes ||
+		NewWidth < 1 || NewHeight < 1 || NewStep <= 0.0f)
+	{
+		return FALSE;
+	}
+
+	Width = NewWidth;
+	Height = NewHeight;
+	Left = NewLeft;
+	Top = NewTop;
+	Step = NewStep;
+	Heights = new float[Width * Height];
+
+	NumBands = PreludeWorkers.GetNumThreads();
+	if(NumBands > HEIGHTFIELD_MAX_BANDS)
+	{
+		NumBands = HEIGHTFIELD_MAX_BANDS;
+	}
+	if(NumBands > Height)
+	{
+		NumBands = Height;
+	}
+	if(NumBands < 1)
+	{
+		NumBands = 1;
+	}
+
+	for(n = 0; n < NumBands; n++)
+	{
+		Bands[n].pMesh = pMesh;
+		Bands[n].pHeights = Heights;
+		Bands[n].pVertices = pMesh->stridedVertexArray[Frame];
+		Bands[n].FirstRow = (Height * n) / NumBands;
+		Bands[n].EndRow = (Height * (n + 1)) / NumBands;
+		Bands[n].Width = Width;
+		Bands[n].Left = (double)Left;
+		Bands[n].Top = (double)Top;
+		Bands[n].Step = (double)Step;
+	}
+
+	PreludeWorkers.Run(BakeBandJob, Bands, NumBands);
+
+	return TRUE;
+}
+
+void HeightField::Clear()
+{
+	if(Heights)
+	{
+		delete[] Heights;
+		Heights = NULL;
+	}
+	Width = 0;
+	Height = 0;
+}
+
+//end: Mutators ********************************************************
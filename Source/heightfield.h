@@ -0,0 +1,95 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				heightfield.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  a mesh's heights on a regular grid, rasterized once and
+//*			 read back with bilinear filtering
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		where triangles overlap seen from above the highest one wins,
+//*		so overhangs and cave roofs bake as solid
+//*********************************************************************
+//*********************************************************************
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include "defs.h"
+
+//preprocessor defs ***********************************************
+
+//most bands a bake is cut into for the worker pool
+#define HEIGHTFIELD_MAX_BANDS		8
+//samples along the longer side when a mesh bakes itself for GetZ
+#define HEIGHTFIELD_MESH_SAMPLES	1600
+//a sample this far outside a triangle, as a fraction of it, is still
+//inside, so samples on a shared edge are never missed
+#define HEIGHTFIELD_EDGE			0.0001
+
+class ZSModel;
+
+//*******************************CLASS********************************
+//**************          HeightField            *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Heights of one frame of a mesh, sampled from above at
+//*			 Left + x * Step, Top + y * Step.  Samples no triangle
+//*			 covers are 0.
+//********************************************************************
+//*Invariants: Heights holds Width * Height samples, row by row
+//********************************************************************
+class HeightField
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	float *Heights;
+	int Width;
+	int Height;
+	float Left;
+	float Top;
+	float Step;
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetWidth() { return Width; }
+	int GetHeight() { return Height; }
+	float GetLeft() { return Left; }
+	float GetTop() { return Top; }
+	float GetStep() { return Step; }
+
+	//the sample itself, 0 off the edge
+	float GetHeight(int x, int y)
+	{
+		if(x < 0 || y < 0 || x >= Width || y >= Height)
+		{
+			return 0.0f;
+		}
+		return Heights[x + y * Width];
+	}
+
+	//between samples, clamped to the edge of the field
+	float Sample(float x, float y);
+
+// Mutators -----------------------------------------
+	//rasterizes every triangle of the frame, the rows split over the
+	//worker pool.  FALSE if there was nothing to bake
+	BOOL Bake(ZSModel *pMesh, int Frame, float NewLeft, float NewTop, float NewStep, int NewWidth, int NewHeight);
+	void Clear();
+
+// Constructors ---------------------------------------
+	HeightField();
+
+// Destructor -----------------------------------------
+	~HeightField();
+
+};
+
+#endif
@@ -606,6 +606,7 @@ int Item::GrabToCursor(Thing *pGrabber)
 int Item::SetFirst(Item *pNewFirst)
 {
 	pFirstItem = pNewFirst;
+	InvalidateFind(OBJECT_ITEM);
 	return TRUE;
 }
 
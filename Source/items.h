@@ -115,6 +115,8 @@ public:
 
 int LoadItems(FILE *fp);
 int SaveItems(FILE *fp);
+int LoadBinItems(FILE *fp);
+int SaveBinItems(FILE *fp);
 int DeleteItems();
 
 
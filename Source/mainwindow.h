@@ -31,6 +31,7 @@ private:
 	ZSScriptWin *pScriptWin;
 	ZSText *pFPS;
 	ZSText *pDrawTime;
+	ZSText *pProfile;
 	ZSText *pTargetString;
 	PeopleEditWin* pPeopleEdit;
 	ZSDescribe *pDescribe;
@@ -64,6 +65,9 @@ private:
 
 	BOOL DrawWorld;
 	BOOL Pathing;
+	//where MainPath was asked for, a recorded session finds it again
+	int PathToX;
+	int PathToY;
 	BOOL ShowFrames;
 	int FrameRate;
 	float ScrollFactor;
@@ -108,7 +112,7 @@ public:
 	int GoModal();
 
 	int GetFrameRate() { return FrameRate; }
-	int SetFrameRate(int NewRate) { FrameRate = NewRate; }
+	int SetFrameRate(int NewRate) { FrameRate = NewRate; return FrameRate; }
 	
 	void SetDrawWorld(BOOL NewState) { DrawWorld = NewState; }
 	void SetSpeaker(Object *pNewSpeaker) { pSpeaker = pNewSpeaker; }
@@ -140,7 +144,8 @@ public:
 	void SetTargetString();
 
 	void TabToNextTarget();
-	//~ZSMainWindow();
+	//WinMain and the headless driver delete pMain as it is
+	virtual ~ZSMainWindow() { }
 };
 
 #endif
\ No newline at end of file
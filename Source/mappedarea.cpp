@@ -0,0 +1,443 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				mappedarea.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  memory mapped copy of an area's static chunk data
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		objects are not in the mapped file, they are still read from
+//*		the .bin at each record's ObjectOffset
+//*********************************************************************
+//*********************************************************************
+#include "mappedarea.h"
+#include "zsutilities.h"
+
+#define ALIGN_MAPPED(n)	(((n) + MAPPED_AREA_ALIGN - 1) & ~(MAPPED_AREA_ALIGN - 1))
+
+//************** Constructors  ****************************************
+
+MappedArea::MappedArea()
+{
+	hFile = INVALID_HANDLE_VALUE;
+	hMapping = NULL;
+	pView = NULL;
+	ViewSize = 0;
+	pHeader = NULL;
+	Table = NULL;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+MappedArea::~MappedArea()
+{
+	Close();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+BOOL MappedArea::GetBinStamp(const char *BinName, DWORD *pSize, FILETIME *pTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA Data;
+
+	if(!GetFileAttributesEx(BinName, GetFileExInfoStandard, &Data))
+	{
+		return FALSE;
+	}
+
+	*pSize = Data.nFileSizeLow;
+	*pTime = Data.ftLastWriteTime;
+	return TRUE;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+BOOL MappedArea::Open(const char *MapName, const char *BinName, int ChunkWidth, int ChunkHeight)
+{
+	DWORD BinSize;
+	FILETIME BinTime;
+	int NumChunks;
+	int n;
+
+	Close();
+
+	hFile = CreateFile(MapName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(hFile == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	ViewSize = GetFileSize(hFile, NULL);
+	if(ViewSize < sizeof(MAPPED_AREA_HEADER_T))
+	{
+		Close();
+		return FALSE;
+	}
+
+	hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(!hMapping)
+	{
+		Close();
+		return FALSE;
+	}
+
+	pView = (BYTE *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if(!pView)
+	{
+		DEBUG_INFO("Could not map ");
+		DEBUG_INFO(MapName);
+		DEBUG_INFO("\n");
+		Close();
+		return FALSE;
+	}
+
+	pHeader = (MAPPED_AREA_HEADER_T *)pView;
+
+	if(pHeader->Magic != MAPPED_AREA_MAGIC ||
+		pHeader->Version != MAPPED_AREA_VERSION ||
+		pHeader->HeaderSize != sizeof(MAPPED_AREA_HEADER_T) ||
+		pHeader->RecordSize != sizeof(MAPPED_CHUNK_T) ||
+		pHeader->ChunkWidth != ChunkWidth ||
+		pHeader->ChunkHeight != ChunkHeight)
+	{
+		DEBUG_INFO(MapName);
+		DEBUG_INFO(" is from another version or area, ignoring it\n");
+		Close();
+		return FALSE;
+	}
+
+	if(!GetBinStamp(BinName, &BinSize, &BinTime) ||
+		BinSize != pHeader->BinSize ||
+		CompareFileTime(&BinTime, &pHeader->BinTime))
+	{
+		DEBUG_INFO(MapName);
+		DEBUG_INFO(" is older than its .bin, convert it again\n");
+		Close();
+		return FALSE;
+	}
+
+	NumChunks = ChunkWidth * ChunkHeight;
+	if(pHeader->TableOffset % MAPPED_AREA_ALIGN ||
+		(DWORD)pHeader->TableOffset + NumChunks * sizeof(int) > ViewSize)
+	{
+		Close();
+		return FALSE;
+	}
+
+	Table = (int *)(pView + pHeader->TableOffset);
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		if(Table[n] && (Table[n] % MAPPED_AREA_ALIGN || (DWORD)Table[n] + sizeof(MAPPED_CHUNK_T) > ViewSize))
+		{
+			DEBUG_INFO(MapName);
+			DEBUG_INFO(" has a bad chunk table\n");
+			Close();
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+void MappedArea::Close()
+{
+	if(pView)
+	{
+		UnmapViewOfFile(pView);
+		pView = NULL;
+	}
+	if(hMapping)
+	{
+		CloseHandle(hMapping);
+		hMapping = NULL;
+	}
+	if(hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	pHeader = NULL;
+	Table = NULL;
+	ViewSize = 0;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Tools ***************************************************
+
+//the .bin header, as Area::LoadHeader reads it
+static int *ReadBinHeader(FILE *fp, MAPPED_AREA_HEADER_T *pHeader)
+{
+	int *Offsets;
+
+	fread(pHeader->Name,sizeof(char),32,fp);
+	fread(&pHeader->Width,sizeof(int),1,fp);
+	fread(&pHeader->Height,sizeof(int),1,fp);
+	fread(&pHeader->ChunkWidth,sizeof(int),1,fp);
+	fread(&pHeader->ChunkHeight,sizeof(int),1,fp);
+
+	if(pHeader->ChunkWidth <= 0 || pHeader->ChunkHeight <= 0)
+	{
+		return NULL;
+	}
+
+	Offsets = new int[pHeader->ChunkWidth * pHeader->ChunkHeight];
+	fread(Offsets,sizeof(int),pHeader->ChunkWidth * pHeader->ChunkHeight,fp);
+
+	return Offsets;
+}
+
+int ConvertAreaToMapped(const char *BinName, const char *MapName)
+{
+	MAPPED_AREA_HEADER_T Header;
+	MAPPED_CHUNK_T *pRecord;
+	Chunk *pChunk;
+	FILE *fpBin;
+	FILE *fpMap;
+	int *Offsets;
+	int *Table;
+	int NumChunks;
+	int NumWritten;
+	int Position;
+	char Padding[MAPPED_AREA_ALIGN];
+	int n;
+
+	ZeroMemory(&Header, sizeof(Header));
+	ZeroMemory(Padding, MAPPED_AREA_ALIGN);
+
+	if(!MappedArea::GetBinStamp(BinName, &Header.BinSize, &Header.BinTime))
+	{
+		return -1;
+	}
+
+	fpBin = fopen(BinName,"rb");
+	if(!fpBin)
+	{
+		return -1;
+	}
+
+	Offsets = ReadBinHeader(fpBin, &Header);
+	if(!Offsets)
+	{
+		fclose(fpBin);
+		return -1;
+	}
+
+	fpMap = fopen(MapName,"wb");
+	if(!fpMap)
+	{
+		delete[] Offsets;
+		fclose(fpBin);
+		return -1;
+	}
+
+	NumChunks = Header.ChunkWidth * Header.ChunkHeight;
+
+	Header.Magic = MAPPED_AREA_MAGIC;
+	Header.Version = MAPPED_AREA_VERSION;
+	Header.HeaderSize = sizeof(MAPPED_AREA_HEADER_T);
+	Header.RecordSize = sizeof(MAPPED_CHUNK_T);
+	Header.TableOffset = ALIGN_MAPPED(sizeof(MAPPED_AREA_HEADER_T));
+
+	Table = new int[NumChunks];
+	ZeroMemory(Table, sizeof(int) * NumChunks);
+
+	//header and table go in last, once the record offsets are known
+	Position = ALIGN_MAPPED(Header.TableOffset + NumChunks * sizeof(int));
+	fseek(fpMap, Position, SEEK_SET);
+
+	pChunk = new Chunk;
+	pRecord = new MAPPED_CHUNK_T;
+	NumWritten = 0;
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		if(!Offsets[n])
+		{
+			continue;
+		}
+
+		fseek(fpBin, Offsets[n], SEEK_SET);
+		pChunk->LoadStatic(fpBin);
+
+		ZeroMemory(pRecord, sizeof(MAPPED_CHUNK_T));
+		pChunk->SaveMapped(pRecord);
+		pRecord->ObjectOffset = ftell(fpBin);
+
+		Table[n] = Position;
+		fwrite(pRecord, sizeof(MAPPED_CHUNK_T), 1, fpMap);
+		Position += sizeof(MAPPED_CHUNK_T);
+		fwrite(Padding, ALIGN_MAPPED(Position) - Position, 1, fpMap);
+		Position = ALIGN_MAPPED(Position);
+
+		NumWritten++;
+	}
+
+	fseek(fpMap, 0, SEEK_SET);
+	fwrite(&Header, sizeof(Header), 1, fpMap);
+	fseek(fpMap, Header.TableOffset, SEEK_SET);
+	fwrite(Table, sizeof(int), NumChunks, fpMap);
+
+	fclose(fpMap);
+	fclose(fpBin);
+
+	delete pRecord;
+	delete pChunk;
+	delete[] Table;
+	delete[] Offsets;
+
+	return NumWritten;
+}
+
+int BenchmarkAreaLoad(const char *BinName, const char *MapName, FILE *fpResults)
+{
+	MAPPED_AREA_HEADER_T Header;
+	MappedArea Mapped;
+	MAPPED_CHUNK_T *pFromBin;
+	MAPPED_CHUNK_T *pFromMap;
+	const MAPPED_CHUNK_T *pRecord;
+	Chunk *pChunk;
+	FILE *fpBin;
+	int *Offsets;
+	int NumChunks;
+	int NumLoaded;
+	int NumMismatches;
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double BinTime;
+	double MapTime;
+	int n;
+
+	QueryPerformanceFrequency(&Frequency);
+
+	//the .bin, as Area::LoadChunk reads it
+	QueryPerformanceCounter(&Start);
+
+	fpBin = fopen(BinName,"rb");
+	if(!fpBin)
+	{
+		return -1;
+	}
+
+	Offsets = ReadBinHeader(fpBin, &Header);
+	if(!Offsets)
+	{
+		fclose(fpBin);
+		return -1;
+	}
+
+	NumChunks = Header.ChunkWidth * Header.ChunkHeight;
+	pChunk = new Chunk;
+	NumLoaded = 0;
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		if(Offsets[n])
+		{
+			fseek(fpBin, Offsets[n], SEEK_SET);
+			pChunk->LoadStatic(fpBin);
+			NumLoaded++;
+		}
+	}
+
+	QueryPerformanceCounter(&End);
+	BinTime = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+
+	//the mapped file
+	QueryPerformanceCounter(&Start);
+
+	if(!Mapped.Open(MapName, BinName, Header.ChunkWidth, Header.ChunkHeight))
+	{
+		delete pChunk;
+		delete[] Offsets;
+		fclose(fpBin);
+		return -1;
+	}
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		pRecord = Mapped.GetChunk(n % Header.ChunkWidth, n / Header.ChunkWidth);
+		if(pRecord)
+		{
+			pChunk->LoadMapped(pRecord);
+		}
+	}
+
+	QueryPerformanceCounter(&End);
+	MapTime = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+
+	//both have to leave every chunk the same
+	pFromBin = new MAPPED_CHUNK_T;
+	pFromMap = new MAPPED_CHUNK_T;
+	NumMismatches = 0;
+
+	for(n = 0; n < NumChunks; n++)
+	{
+		pRecord = Mapped.GetChunk(n % Header.ChunkWidth, n / Header.ChunkWidth);
+		if(!Offsets[n] || !pRecord)
+		{
+			if(Offsets[n] || pRecord)
+			{
+				NumMismatches++;
+			}
+			continue;
+		}
+
+		fseek(fpBin, Offsets[n], SEEK_SET);
+		pChunk->LoadStatic(fpBin);
+		ZeroMemory(pFromBin, sizeof(MAPPED_CHUNK_T));
+		pChunk->SaveMapped(pFromBin);
+		pFromBin->ObjectOffset = ftell(fpBin);
+
+		pChunk->LoadMapped(pRecord);
+		ZeroMemory(pFromMap, sizeof(MAPPED_CHUNK_T));
+		pChunk->SaveMapped(pFromMap);
+		pFromMap->ObjectOffset = pRecord->ObjectOffset;
+
+		if(memcmp(pFromBin, pFromMap, sizeof(MAPPED_CHUNK_T)))
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"chunk %i, %i differs\n", n % Header.ChunkWidth, n / Header.ChunkWidth);
+			}
+		}
+	}
+
+	if(fpResults)
+	{
+		fprintf(fpResults,"%s: %i chunks, %i mismatches\n", Header.Name, NumLoaded, NumMismatches);
+		fprintf(fpResults,"bin: %.1f ms, %.3f ms per chunk\n", BinTime, NumLoaded ? BinTime / (double)NumLoaded : 0.0);
+		fprintf(fpResults,"mapped: %.1f ms, %.3f ms per chunk\n", MapTime, NumLoaded ? MapTime / (double)NumLoaded : 0.0);
+	}
+
+	delete pFromBin;
+	delete pFromMap;
+	delete pChunk;
+	delete[] Offsets;
+	fclose(fpBin);
+
+	return NumMismatches;
+}
+
+//end: Tools ***********************************************************
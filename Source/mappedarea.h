@@ -0,0 +1,118 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				mappedarea.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  memory mapped copy of an area's static chunk data
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		objects are not in the mapped file, they are still read from
+//*		the .bin at each record's ObjectOffset
+//*********************************************************************
+//*********************************************************************
+#ifndef MAPPEDAREA_H
+#define MAPPEDAREA_H
+
+#include "defs.h"
+#include "chunks.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define MAPPED_AREA_MAGIC		0x414d535a	//"ZSMA"
+#define MAPPED_AREA_VERSION		1
+//the header, table and every record start on this boundary
+#define MAPPED_AREA_ALIGN		16
+
+//File layout:
+//	MAPPED_AREA_HEADER_T
+//	int table of ChunkWidth * ChunkHeight record offsets, 0 for no chunk
+//	MAPPED_CHUNK_T records
+typedef struct
+{
+	DWORD Magic;
+	int Version;
+	int HeaderSize;
+	int RecordSize;
+	char Name[32];
+	int Width;
+	int Height;
+	int ChunkWidth;
+	int ChunkHeight;
+	//the .bin this came from, once the .bin changes the file is stale
+	DWORD BinSize;
+	FILETIME BinTime;
+	int TableOffset;
+} MAPPED_AREA_HEADER_T;
+
+//*******************************CLASS********************************
+//**************          MappedArea             *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Map a converted area file read only and hand out its chunk
+//*			 records in place.  Nothing is read until a record is
+//*			 touched, and records are safe to use from any thread.
+//********************************************************************
+//*Invariants: while open every table entry is 0 or an aligned record
+//*				 lying wholly inside the view
+//********************************************************************
+class MappedArea
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	HANDLE hFile;
+	HANDLE hMapping;
+	BYTE *pView;
+	DWORD ViewSize;
+	MAPPED_AREA_HEADER_T *pHeader;
+	int *Table;
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	BOOL IsOpen() { return pView != NULL; }
+
+	const MAPPED_CHUNK_T *GetChunk(int x, int y)
+	{
+		if(!pView || x < 0 || y < 0 || x >= pHeader->ChunkWidth || y >= pHeader->ChunkHeight)
+		{
+			return NULL;
+		}
+		if(!Table[x + y * pHeader->ChunkWidth])
+		{
+			return NULL;
+		}
+		return (const MAPPED_CHUNK_T *)(pView + Table[x + y * pHeader->ChunkWidth]);
+	}
+
+	static BOOL GetBinStamp(const char *BinName, DWORD *pSize, FILETIME *pTime);
+
+// Mutators -----------------------------------------
+	//fails, leaving the area on the .bin, if the file is missing, from
+	//another version, a different size of area or older than the .bin
+	BOOL Open(const char *MapName, const char *BinName, int ChunkWidth, int ChunkHeight);
+	void Close();
+
+// Constructors ---------------------------------------
+	MappedArea();
+
+// Destructor -----------------------------------------
+	~MappedArea();
+
+};
+
+//offline tools
+//write the mapped file for a .bin, returns the number of chunks or -1
+int ConvertAreaToMapped(const char *BinName, const char *MapName);
+//read every chunk of the area through both formats, returns the number
+//of chunks that came out different or -1
+int BenchmarkAreaLoad(const char *BinName, const char *MapName, FILE *fpResults);
+
+#endif
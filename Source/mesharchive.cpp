@@ -0,0 +1,894 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				mesharchive.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  every mesh in one memory mapped file, the meshes' arrays
+//*			 pointing straight into the view
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		quantized positions and normals have to be unpacked, so those
+//*		arrays are copied out of the view when the archive opens
+//*********************************************************************
+//*********************************************************************
+#include "mesharchive.h"
+#include "mappedarea.h"
+#include "zsengine.h"
+#include "zsutilities.h"
+#include <math.h>
+
+#define ALIGN_MESH(n)	(((n) + MESH_ARCHIVE_ALIGN - 1) & ~(MESH_ARCHIVE_ALIGN - 1))
+
+#define QUANTIZED_POSITION_MAX	65535
+#define QUANTIZED_NORMAL_MAX	127
+
+//the converter rounds its own copy through these, so the tree it writes
+//fits what the archive unpacks
+static float UnpackPosition(float Min, float Step, unsigned short Packed)
+{
+	return Min + (float)Packed * Step;
+}
+
+static float UnpackNormal(signed char Packed)
+{
+	return (float)Packed / (float)QUANTIZED_NORMAL_MAX;
+}
+
+//************** Constructors  ****************************************
+
+MeshArchive::MeshArchive()
+{
+	hFile = INVALID_HANDLE_VALUE;
+	hMapping = NULL;
+	pView = NULL;
+	ViewSize = 0;
+	pHeader = NULL;
+	Table = NULL;
+	Fixups = NULL;
+	Pointers = NULL;
+	Unpacked = NULL;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+MeshArchive::~MeshArchive()
+{
+	Close();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+//an empty block may be 0, anything else has to be aligned and inside
+static BOOL BlockInView(int Offset, int Size, DWORD ViewSize)
+{
+	if(!Size)
+	{
+		return TRUE;
+	}
+	return Offset > 0 && Size > 0 && !(Offset % MESH_ARCHIVE_ALIGN) &&
+		(DWORD)Offset + (DWORD)Size <= ViewSize;
+}
+
+BOOL MeshArchive::CheckEntry(MESH_ARCHIVE_ENTRY_T *pEntry)
+{
+	int PositionSize;
+	int NormalSize;
+
+	if(pEntry->NumFrames < 0 || pEntry->NumVertex < 0 || pEntry->NumTriangles < 0 ||
+		pEntry->NumBVHNodes < 0 || pEntry->NumBVHNodes > pEntry->NumTriangles * 2)
+	{
+		return FALSE;
+	}
+
+	if(pHeader->Flags & MESH_ARCHIVE_QUANTIZED)
+	{
+		PositionSize = pEntry->NumVertex * 3 * sizeof(unsigned short);
+		NormalSize = pEntry->NumVertex * 3 * sizeof(signed char);
+	}
+	else
+	{
+		PositionSize = pEntry->NumVertex * 3 * sizeof(float);
+		NormalSize = pEntry->NumVertex * 3 * sizeof(float);
+	}
+
+	if(pEntry->NumFrames &&
+		(pEntry->FrameStride < PositionSize || pEntry->FrameStride % MESH_ARCHIVE_ALIGN ||
+		 pEntry->BoxStride < pEntry->NumBVHNodes * 6 * (int)sizeof(float) || pEntry->BoxStride % MESH_ARCHIVE_ALIGN))
+	{
+		return FALSE;
+	}
+
+	return (!pEntry->EquipmentOffset || BlockInView(pEntry->EquipmentOffset, 10 * sizeof(EquipmentLocator), ViewSize)) &&
+		BlockInView(pEntry->TriangleOffset, pEntry->NumTriangles * 3 * sizeof(unsigned short), ViewSize) &&
+		BlockInView(pEntry->UVOffset, pEntry->NumVertex * 2 * sizeof(float), ViewSize) &&
+		BlockInView(pEntry->NormalOffset, NormalSize, ViewSize) &&
+		BlockInView(pEntry->BVHNodeOffset, pEntry->NumBVHNodes * sizeof(BVHNode), ViewSize) &&
+		BlockInView(pEntry->BVHTriangleOffset, pEntry->NumBVHNodes ? pEntry->NumTriangles * sizeof(int) : 0, ViewSize) &&
+		BlockInView(pEntry->FrameOffset, pEntry->NumFrames * pEntry->FrameStride, ViewSize) &&
+		BlockInView(pEntry->BoxOffset, pEntry->NumBVHNodes ? pEntry->NumFrames * pEntry->BoxStride : 0, ViewSize);
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+BOOL MeshArchive::Open(const char *ArchiveName, const char *BinName)
+{
+	MESH_ARCHIVE_ENTRY_T *pEntry;
+	DWORD BinSize;
+	FILETIME BinTime;
+	unsigned short *pPacked;
+	signed char *pNormal;
+	float **ppPointer;
+	float *pUnpacked;
+	int NumPointers;
+	int NumUnpacked;
+	int n, fn, vn;
+
+	Close();
+
+	hFile = CreateFile(ArchiveName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(hFile == INVALID_HANDLE_VALUE)
+	{
+		return FALSE;
+	}
+
+	ViewSize = GetFileSize(hFile, NULL);
+	if(ViewSize < sizeof(MESH_ARCHIVE_HEADER_T))
+	{
+		Close();
+		return FALSE;
+	}
+
+	//copy on write, so a mesh that moves its vertices doesn't need its
+	//own copy of everything
+	hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if(!hMapping)
+	{
+		Close();
+		return FALSE;
+	}
+
+	pView = (BYTE *)MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+	if(!pView)
+	{
+		DEBUG_INFO("Could not map ");
+		DEBUG_INFO(ArchiveName);
+		DEBUG_INFO("\n");
+		Close();
+		return FALSE;
+	}
+
+	pHeader = (MESH_ARCHIVE_HEADER_T *)pView;
+
+	if(pHeader->Magic != MESH_ARCHIVE_MAGIC ||
+		pHeader->Version != MESH_ARCHIVE_VERSION ||
+		pHeader->HeaderSize != sizeof(MESH_ARCHIVE_HEADER_T) ||
+		pHeader->EntrySize != sizeof(MESH_ARCHIVE_ENTRY_T) ||
+		pHeader->NumMesh < 0)
+	{
+		DEBUG_INFO(ArchiveName);
+		DEBUG_INFO(" is from another version, ignoring it\n");
+		Close();
+		return FALSE;
+	}
+
+	if(!MappedArea::GetBinStamp(BinName, &BinSize, &BinTime) ||
+		BinSize != pHeader->BinSize ||
+		CompareFileTime(&BinTime, &pHeader->BinTime))
+	{
+		DEBUG_INFO(ArchiveName);
+		DEBUG_INFO(" is older than its mesh file, convert it again\n");
+		Close();
+		return FALSE;
+	}
+
+	if(pHeader->TableOffset % MESH_ARCHIVE_ALIGN ||
+		(DWORD)pHeader->TableOffset + pHeader->NumMesh * sizeof(MESH_ARCHIVE_ENTRY_T) > ViewSize)
+	{
+		Close();
+		return FALSE;
+	}
+
+	Table = (MESH_ARCHIVE_ENTRY_T *)(pView + pHeader->TableOffset);
+
+	NumPointers = 0;
+	NumUnpacked = 0;
+	for(n = 0; n < pHeader->NumMesh; n++)
+	{
+		if(!CheckEntry(&Table[n]))
+		{
+			DEBUG_INFO(ArchiveName);
+			DEBUG_INFO(" has a bad mesh table\n");
+			Close();
+			return FALSE;
+		}
+		NumPointers += Table[n].NumFrames * 2;
+		NumUnpacked += Table[n].NumVertex * 3 * (Table[n].NumFrames + 1);
+	}
+
+	//one allocation for all the frame tables, and one for whatever
+	//has to be unpacked
+	Fixups = new MESH_ARCHIVE_FIXUP_T[pHeader->NumMesh ? pHeader->NumMesh : 1];
+	Pointers = new float *[NumPointers ? NumPointers : 1];
+	if(pHeader->Flags & MESH_ARCHIVE_QUANTIZED)
+	{
+		Unpacked = new float[NumUnpacked ? NumUnpacked : 1];
+	}
+
+	ppPointer = Pointers;
+	pUnpacked = Unpacked;
+	for(n = 0; n < pHeader->NumMesh; n++)
+	{
+		pEntry = &Table[n];
+
+		Fixups[n].Frames = ppPointer;
+		ppPointer += pEntry->NumFrames;
+		Fixups[n].Boxes = pEntry->NumBVHNodes ? ppPointer : NULL;
+		ppPointer += pEntry->NumFrames;
+
+		for(fn = 0; fn < pEntry->NumFrames; fn++)
+		{
+			if(pEntry->NumBVHNodes)
+			{
+				Fixups[n].Boxes[fn] = (float *)(pView + pEntry->BoxOffset + fn * pEntry->BoxStride);
+			}
+		}
+
+		if(!(pHeader->Flags & MESH_ARCHIVE_QUANTIZED))
+		{
+			for(fn = 0; fn < pEntry->NumFrames; fn++)
+			{
+				Fixups[n].Frames[fn] = (float *)(pView + pEntry->FrameOffset + fn * pEntry->FrameStride);
+			}
+			Fixups[n].Normals = (float *)(pView + pEntry->NormalOffset);
+			continue;
+		}
+
+		for(fn = 0; fn < pEntry->NumFrames; fn++)
+		{
+			Fixups[n].Frames[fn] = pUnpacked;
+			pPacked = (unsigned short *)(pView + pEntry->FrameOffset + fn * pEntry->FrameStride);
+			for(vn = 0; vn < pEntry->NumVertex * 3; vn += 3)
+			{
+				pUnpacked[vn] = UnpackPosition(pEntry->PositionMin[0], pEntry->PositionStep[0], pPacked[vn]);
+				pUnpacked[vn + 1] = UnpackPosition(pEntry->PositionMin[1], pEntry->PositionStep[1], pPacked[vn + 1]);
+				pUnpacked[vn + 2] = UnpackPosition(pEntry->PositionMin[2], pEntry->PositionStep[2], pPacked[vn + 2]);
+			}
+			pUnpacked += pEntry->NumVertex * 3;
+		}
+
+		Fixups[n].Normals = pUnpacked;
+		pNormal = (signed char *)(pView + pEntry->NormalOffset);
+		for(vn = 0; vn < pEntry->NumVertex * 3; vn++)
+		{
+			pUnpacked[vn] = UnpackNormal(pNormal[vn]);
+		}
+		pUnpacked += pEntry->NumVertex * 3;
+	}
+
+	return TRUE;
+}
+
+void MeshArchive::Close()
+{
+	if(Fixups)
+	{
+		delete[] Fixups;
+		Fixups = NULL;
+	}
+	if(Pointers)
+	{
+		delete[] Pointers;
+		Pointers = NULL;
+	}
+	if(Unpacked)
+	{
+		delete[] Unpacked;
+		Unpacked = NULL;
+	}
+	if(pView)
+	{
+		UnmapViewOfFile(pView);
+		pView = NULL;
+	}
+	if(hMapping)
+	{
+		CloseHandle(hMapping);
+		hMapping = NULL;
+	}
+	if(hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+	pHeader = NULL;
+	Table = NULL;
+	ViewSize = 0;
+}
+
+ZSModelEx *MeshArchive::CreateMesh(int Mesh)
+{
+	MESH_ARCHIVE_ENTRY_T *pEntry;
+	ZSModelEx *pMesh;
+
+	if(!pView || Mesh < 0 || Mesh >= pHeader->NumMesh)
+	{
+		return NULL;
+	}
+
+	pEntry = &Table[Mesh];
+	pMesh = new ZSModelEx;
+
+	pMesh->numframes = pEntry->NumFrames;
+	pMesh->numvertex = pEntry->NumVertex;
+	pMesh->numtriangles = pEntry->NumTriangles;
+	pMesh->numWeaponSlotsDefined = pEntry->NumWeaponSlots;
+	pMesh->equipmentRegistrationMark = pEntry->RegistrationMark;
+
+	pMesh->equipmentlist = pEntry->EquipmentOffset ? (EquipmentLocator *)(pView + pEntry->EquipmentOffset) : NULL;
+	pMesh->trianglelist = (unsigned short *)(pView + pEntry->TriangleOffset);
+	pMesh->stridedUV = (float *)(pView + pEntry->UVOffset);
+	pMesh->stridedNormals = Fixups[Mesh].Normals;
+	pMesh->stridedVertexArray = Fixups[Mesh].Frames;
+	pMesh->stridedDataInfo.normal.lpvData = pMesh->stridedNormals;
+	pMesh->stridedDataInfo.textureCoords[0].lpvData = pMesh->stridedUV;
+	pMesh->mapped = true;
+
+	if(pEntry->NumBVHNodes)
+	{
+		pMesh->bvhnodes = (BVHNode *)(pView + pEntry->BVHNodeOffset);
+		pMesh->numbvhnodes = pEntry->NumBVHNodes;
+		pMesh->bvhtriangles = (int *)(pView + pEntry->BVHTriangleOffset);
+		pMesh->bvhbounds = Fixups[Mesh].Boxes;
+		pMesh->boundingradius = pEntry->BoundingRadius;
+		pMesh->bvhmapped = true;
+	}
+
+	memcpy(pMesh->filename, pEntry->Name, MESH_NAME_LENGTH);
+	pMesh->pTexture = Engine->GetTexture(pEntry->Texture);
+
+	pMesh->leftbound = pEntry->Bounds[0];
+	pMesh->rightbound = pEntry->Bounds[1];
+	pMesh->topbound = pEntry->Bounds[2];
+	pMesh->bottombound = pEntry->Bounds[3];
+	pMesh->frontbound = pEntry->Bounds[4];
+	pMesh->backbound = pEntry->Bounds[5];
+
+	pMesh->xscale = pEntry->Scale[0];
+	pMesh->yscale = pEntry->Scale[1];
+	pMesh->zscale = pEntry->Scale[2];
+	pMesh->rangemin = pEntry->RangeMin;
+	pMesh->rangemax = pEntry->RangeMax;
+	pMesh->Blocking = (BYTE)pEntry->Blocking;
+
+	return pMesh;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Tools ***************************************************
+
+//a mesh as ZSModelEx::LoadEx reads it, keeping the texture's name
+//rather than looking it up
+static BOOL ReadBinMesh(FILE *fp, ZSModelEx *pMesh, char *TextureName)
+{
+	char *pC;
+
+	if(!pMesh->Load(fp))
+	{
+		return FALSE;
+	}
+
+	fread(pMesh->filename,MESH_NAME_LENGTH,1,fp);
+	ConvertToLowerCase(pMesh->filename);
+
+	fread(TextureName,TEXTURE_NAME_LENGTH,1,fp);
+	TextureName[TEXTURE_NAME_LENGTH - 1] = '\0';
+	pC = strchr(TextureName,'.');
+	if(pC)
+		*pC = '\0';
+
+	fread(&pMesh->leftbound, sizeof(float),1,fp);
+	fread(&pMesh->rightbound, sizeof(float),1,fp);
+	fread(&pMesh->topbound, sizeof(float),1,fp);
+	fread(&pMesh->bottombound, sizeof(float),1,fp);
+	fread(&pMesh->frontbound, sizeof(float),1,fp);
+	fread(&pMesh->backbound, sizeof(float),1,fp);
+
+	fread(&pMesh->xscale, sizeof(float),1,fp);
+	fread(&pMesh->yscale, sizeof(float),1,fp);
+	fread(&pMesh->zscale, sizeof(float),1,fp);
+
+	fread(&pMesh->rangemin, sizeof(int),1,fp);
+	fread(&pMesh->rangemax, sizeof(int),1,fp);
+
+	return fread(&pMesh->Blocking, sizeof(BYTE),1,fp) == 1;
+}
+
+//writes a block at the next aligned place, returns its offset or 0 for
+//an empty one
+static int WriteBlock(FILE *fp, int *pPosition, const void *pData, int Size)
+{
+	char Padding[MESH_ARCHIVE_ALIGN];
+	int Offset;
+
+	if(!Size)
+	{
+		return 0;
+	}
+
+	ZeroMemory(Padding, MESH_ARCHIVE_ALIGN);
+	Offset = *pPosition;
+	fwrite(pData, Size, 1, fp);
+	*pPosition += Size;
+	fwrite(Padding, ALIGN_MESH(*pPosition) - *pPosition, 1, fp);
+	*pPosition = ALIGN_MESH(*pPosition);
+
+	return Offset;
+}
+
+//rounds the mesh's positions and normals to what the archive will hold,
+//and rebuilds its tree around the rounded positions
+static void QuantizeMesh(ZSModelEx *pMesh, MESH_ARCHIVE_ENTRY_T *pEntry, unsigned short *pPositions, signed char *pNormals)
+{
+	float Lowest[3];
+	float Highest[3];
+	float Value;
+	int Packed;
+	int fn, vn, j;
+
+	for(j = 0; j < 3; j++)
+	{
+		Lowest[j] = 0.0f;
+		Highest[j] = 0.0f;
+	}
+	for(fn = 0; fn < pMesh->numframes; fn++)
+	for(vn = 0; vn < pMesh->numvertex * 3; vn += 3)
+	for(j = 0; j < 3; j++)
+	{
+		Value = pMesh->stridedVertexArray[fn][vn + j];
+		if((!fn && !vn) || Value < Lowest[j]) Lowest[j] = Value;
+		if((!fn && !vn) || Value > Highest[j]) Highest[j] = Value;
+	}
+
+	for(j = 0; j < 3; j++)
+	{
+		pEntry->PositionMin[j] = Lowest[j];
+		pEntry->PositionStep[j] = (Highest[j] - Lowest[j]) / (float)QUANTIZED_POSITION_MAX;
+	}
+
+	for(fn = 0; fn < pMesh->numframes; fn++)
+	for(vn = 0; vn < pMesh->numvertex * 3; vn += 3)
+	for(j = 0; j < 3; j++)
+	{
+		Packed = 0;
+		if(pEntry->PositionStep[j] > 0.0f)
+		{
+			Packed = (int)floor((pMesh->stridedVertexArray[fn][vn + j] - Lowest[j]) / pEntry->PositionStep[j] + 0.5f);
+			if(Packed < 0) Packed = 0;
+			if(Packed > QUANTIZED_POSITION_MAX) Packed = QUANTIZED_POSITION_MAX;
+		}
+		pPositions[fn * pMesh->numvertex * 3 + vn + j] = (unsigned short)Packed;
+		pMesh->stridedVertexArray[fn][vn + j] = UnpackPosition(Lowest[j], pEntry->PositionStep[j], (unsigned short)Packed);
+	}
+
+	for(vn = 0; vn < pMesh->numvertex * 3; vn++)
+	{
+		Packed = (int)floor(pMesh->stridedNormals[vn] * (float)QUANTIZED_NORMAL_MAX + 0.5f);
+		if(Packed < -QUANTIZED_NORMAL_MAX) Packed = -QUANTIZED_NORMAL_MAX;
+		if(Packed > QUANTIZED_NORMAL_MAX) Packed = QUANTIZED_NORMAL_MAX;
+		pNormals[vn] = (signed char)Packed;
+		pMesh->stridedNormals[vn] = UnpackNormal((signed char)Packed);
+	}
+
+	pMesh->BuildBVH();
+}
+
+int ConvertMeshesToArchive(const char *BinName, const char *ArchiveName, BOOL Quantize)
+{
+	MESH_ARCHIVE_HEADER_T Header;
+	MESH_ARCHIVE_ENTRY_T *Table;
+	MESH_ARCHIVE_ENTRY_T *pEntry;
+	ZSModelEx *pMesh;
+	unsigned short *pPositions;
+	signed char *pNormals;
+	FILE *fpBin;
+	FILE *fpArchive;
+	int NumMesh;
+	int Position;
+	int Size;
+	int n, fn;
+
+	ZeroMemory(&Header, sizeof(Header));
+
+	if(!MappedArea::GetBinStamp(BinName, &Header.BinSize, &Header.BinTime))
+	{
+		return -1;
+	}
+
+	fpBin = fopen(BinName,"rb");
+	if(!fpBin)
+	{
+		return -1;
+	}
+
+	if(fread(&NumMesh, sizeof(NumMesh), 1, fpBin) != 1 || NumMesh < 0 || NumMesh > MAX_MESH)
+	{
+		fclose(fpBin);
+		return -1;
+	}
+
+	fpArchive = fopen(ArchiveName,"wb");
+	if(!fpArchive)
+	{
+		fclose(fpBin);
+		return -1;
+	}
+
+	Header.Magic = MESH_ARCHIVE_MAGIC;
+	Header.Version = MESH_ARCHIVE_VERSION;
+	Header.HeaderSize = sizeof(MESH_ARCHIVE_HEADER_T);
+	Header.EntrySize = sizeof(MESH_ARCHIVE_ENTRY_T);
+	Header.NumMesh = NumMesh;
+	Header.Flags = Quantize ? MESH_ARCHIVE_QUANTIZED : 0;
+	Header.TableOffset = ALIGN_MESH(sizeof(MESH_ARCHIVE_HEADER_T));
+
+	Table = new MESH_ARCHIVE_ENTRY_T[NumMesh ? NumMesh : 1];
+	ZeroMemory(Table, sizeof(MESH_ARCHIVE_ENTRY_T) * NumMesh);
+
+	//header and table go in last, once the block offsets are known
+	Position = ALIGN_MESH(Header.TableOffset + NumMesh * sizeof(MESH_ARCHIVE_ENTRY_T));
+	fseek(fpArchive, Position, SEEK_SET);
+
+	pMesh = new ZSModelEx;
+
+	for(n = 0; n < NumMesh; n++)
+	{
+		pEntry = &Table[n];
+		if(!ReadBinMesh(fpBin, pMesh, pEntry->Texture))
+		{
+			delete pMesh;
+			delete[] Table;
+			fclose(fpArchive);
+			fclose(fpBin);
+			return -1;
+		}
+
+		memcpy(pEntry->Name, pMesh->filename, MESH_NAME_LENGTH);
+		pEntry->NumFrames = pMesh->numframes;
+		pEntry->NumVertex = pMesh->numvertex;
+		pEntry->NumTriangles = pMesh->numtriangles;
+		pEntry->NumWeaponSlots = pMesh->numWeaponSlotsDefined;
+		pEntry->RegistrationMark = pMesh->equipmentRegistrationMark;
+		pEntry->Bounds[0] = pMesh->leftbound;
+		pEntry->Bounds[1] = pMesh->rightbound;
+		pEntry->Bounds[2] = pMesh->topbound;
+		pEntry->Bounds[3] = pMesh->bottombound;
+		pEntry->Bounds[4] = pMesh->frontbound;
+		pEntry->Bounds[5] = pMesh->backbound;
+		pEntry->Scale[0] = pMesh->xscale;
+		pEntry->Scale[1] = pMesh->yscale;
+		pEntry->Scale[2] = pMesh->zscale;
+		pEntry->RangeMin = pMesh->rangemin;
+		pEntry->RangeMax = pMesh->rangemax;
+		pEntry->Blocking = pMesh->Blocking;
+
+		pPositions = NULL;
+		pNormals = NULL;
+		if(Quantize)
+		{
+			pPositions = new unsigned short[pMesh->numframes * pMesh->numvertex * 3 + 1];
+			pNormals = new signed char[pMesh->numvertex * 3 + 1];
+			QuantizeMesh(pMesh, pEntry, pPositions, pNormals);
+		}
+
+		pEntry->NumBVHNodes = pMesh->numbvhnodes;
+		pEntry->BoundingRadius = pMesh->boundingradius;
+
+		if(pMesh->equipmentlist)
+		{
+			pEntry->EquipmentOffset = WriteBlock(fpArchive, &Position, pMesh->equipmentlist, 10 * sizeof(EquipmentLocator));
+		}
+		pEntry->TriangleOffset = WriteBlock(fpArchive, &Position, pMesh->trianglelist, pMesh->numtriangles * 3 * sizeof(unsigned short));
+		pEntry->UVOffset = WriteBlock(fpArchive, &Position, pMesh->stridedUV, pMesh->numvertex * 2 * sizeof(float));
+		if(Quantize)
+		{
+			pEntry->NormalOffset = WriteBlock(fpArchive, &Position, pNormals, pMesh->numvertex * 3 * sizeof(signed char));
+		}
+		else
+		{
+			pEntry->NormalOffset = WriteBlock(fpArchive, &Position, pMesh->stridedNormals, pMesh->numvertex * 3 * sizeof(float));
+		}
+		if(pMesh->numbvhnodes)
+		{
+			pEntry->BVHNodeOffset = WriteBlock(fpArchive, &Position, pMesh->bvhnodes, pMesh->numbvhnodes * sizeof(BVHNode));
+			pEntry->BVHTriangleOffset = WriteBlock(fpArchive, &Position, pMesh->bvhtriangles, pMesh->numtriangles * sizeof(int));
+		}
+
+		Size = pMesh->numvertex * 3 * (Quantize ? sizeof(unsigned short) : sizeof(float));
+		pEntry->FrameStride = ALIGN_MESH(Size);
+		for(fn = 0; fn < pMesh->numframes; fn++)
+		{
+			if(Quantize)
+			{
+				Size = WriteBlock(fpArchive, &Position, &pPositions[fn * pMesh->numvertex * 3], Size);
+			}
+			else
+			{
+				Size = WriteBlock(fpArchive, &Position, pMesh->stridedVertexArray[fn], Size);
+			}
+			if(!fn)
+			{
+				pEntry->FrameOffset = Size;
+			}
+			Size = pMesh->numvertex * 3 * (Quantize ? sizeof(unsigned short) : sizeof(float));
+		}
+
+		Size = pMesh->numbvhnodes * 6 * sizeof(float);
+		pEntry->BoxStride = ALIGN_MESH(Size);
+		for(fn = 0; fn < pMesh->numframes && pMesh->numbvhnodes; fn++)
+		{
+			Size = WriteBlock(fpArchive, &Position, pMesh->bvhbounds[fn], Size);
+			if(!fn)
+			{
+				pEntry->BoxOffset = Size;
+			}
+			Size = pMesh->numbvhnodes * 6 * sizeof(float);
+		}
+
+		if(pPositions)
+		{
+			delete[] pPositions;
+			delete[] pNormals;
+		}
+		pMesh->Clear();
+	}
+
+	fseek(fpArchive, 0, SEEK_SET);
+	fwrite(&Header, sizeof(Header), 1, fpArchive);
+	fseek(fpArchive, Header.TableOffset, SEEK_SET);
+	fwrite(Table, sizeof(MESH_ARCHIVE_ENTRY_T), NumMesh, fpArchive);
+
+	fclose(fpArchive);
+	fclose(fpBin);
+
+	delete pMesh;
+	delete[] Table;
+
+	return NumMesh;
+}
+
+//how far apart two runs of floats get, or -1 if one is missing
+static float LargestDifference(const float *pA, const float *pB, int Length)
+{
+	float Largest;
+	int n;
+
+	if(!Length)
+	{
+		return 0.0f;
+	}
+	if(!pA || !pB)
+	{
+		return -1.0f;
+	}
+
+	Largest = 0.0f;
+	for(n = 0; n < Length; n++)
+	{
+		if((float)fabs(pA[n] - pB[n]) > Largest)
+		{
+			Largest = (float)fabs(pA[n] - pB[n]);
+		}
+	}
+	return Largest;
+}
+
+//positions and normals may be off by a step when the archive is
+//quantized, the rest has to match exactly
+static BOOL SameMesh(ZSModelEx *pA, ZSModelEx *pB, const MESH_ARCHIVE_ENTRY_T *pEntry, BOOL Quantized, float *pPositionError, float *pNormalError)
+{
+	float Difference;
+	float Step;
+	int fn, j;
+
+	if(strcmp(pA->filename, pB->filename) ||
+		pA->numframes != pB->numframes ||
+		pA->numvertex != pB->numvertex ||
+		pA->numtriangles != pB->numtriangles ||
+		pA->numWeaponSlotsDefined != pB->numWeaponSlotsDefined ||
+		memcmp(&pA->equipmentRegistrationMark, &pB->equipmentRegistrationMark, sizeof(EquipmentLocator)) ||
+		(pA->equipmentlist == NULL) != (pB->equipmentlist == NULL) ||
+		(pA->equipmentlist && memcmp(pA->equipmentlist, pB->equipmentlist, 10 * sizeof(EquipmentLocator))) ||
+		memcmp(pA->trianglelist, pB->trianglelist, pA->numtriangles * 3 * sizeof(unsigned short)) ||
+		memcmp(pA->stridedUV, pB->stridedUV, pA->numvertex * 2 * sizeof(float)) ||
+		pA->pTexture != pB->pTexture ||
+		pA->leftbound != pB->leftbound || pA->rightbound != pB->rightbound ||
+		pA->topbound != pB->topbound || pA->bottombound != pB->bottombound ||
+		pA->frontbound != pB->frontbound || pA->backbound != pB->backbound ||
+		pA->xscale != pB->xscale || pA->yscale != pB->yscale || pA->zscale != pB->zscale ||
+		pA->rangemin != pB->rangemin || pA->rangemax != pB->rangemax ||
+		pA->Blocking != pB->Blocking)
+	{
+		return FALSE;
+	}
+
+	if(!Quantized)
+	{
+		if(pA->numbvhnodes != pB->numbvhnodes ||
+			pA->boundingradius != pB->boundingradius ||
+			memcmp(pA->stridedNormals, pB->stridedNormals, pA->numvertex * 3 * sizeof(float)) ||
+			(pA->numbvhnodes && memcmp(pA->bvhnodes, pB->bvhnodes, pA->numbvhnodes * sizeof(BVHNode))) ||
+			(pA->numbvhnodes && memcmp(pA->bvhtriangles, pB->bvhtriangles, pA->numtriangles * sizeof(int))))
+		{
+			return FALSE;
+		}
+		for(fn = 0; fn < pA->numframes; fn++)
+		{
+			if(memcmp(pA->stridedVertexArray[fn], pB->stridedVertexArray[fn], pA->numvertex * 3 * sizeof(float)) ||
+				(pA->numbvhnodes && memcmp(pA->bvhbounds[fn], pB->bvhbounds[fn], pA->numbvhnodes * 6 * sizeof(float))))
+			{
+				return FALSE;
+			}
+		}
+		return TRUE;
+	}
+
+	Step = 0.0f;
+	for(j = 0; j < 3; j++)
+	{
+		if(pEntry->PositionStep[j] > Step)
+		{
+			Step = pEntry->PositionStep[j];
+		}
+	}
+
+	for(fn = 0; fn < pA->numframes; fn++)
+	{
+		Difference = LargestDifference(pA->stridedVertexArray[fn], pB->stridedVertexArray[fn], pA->numvertex * 3);
+		if(Difference < 0.0f || Difference > Step)
+		{
+			return FALSE;
+		}
+		if(Difference > *pPositionError)
+		{
+			*pPositionError = Difference;
+		}
+	}
+
+	Difference = LargestDifference(pA->stridedNormals, pB->stridedNormals, pA->numvertex * 3);
+	if(Difference < 0.0f || Difference > 1.0f / (float)QUANTIZED_NORMAL_MAX)
+	{
+		return FALSE;
+	}
+	if(Difference > *pNormalError)
+	{
+		*pNormalError = Difference;
+	}
+
+	return TRUE;
+}
+
+int BenchmarkMeshLoad(const char *BinName, const char *ArchiveName, FILE *fpResults)
+{
+	MeshArchive Archive;
+	ZSModelEx **FromBin;
+	ZSModelEx **FromArchive;
+	FILE *fpBin;
+	int NumMesh;
+	int NumMismatches;
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double BinTime;
+	double ArchiveTime;
+	float PositionError;
+	float NormalError;
+	int n;
+
+	QueryPerformanceFrequency(&Frequency);
+
+	//mesh.bin, as ZSEngine::LoadMeshes reads it
+	QueryPerformanceCounter(&Start);
+
+	fpBin = fopen(BinName,"rb");
+	if(!fpBin)
+	{
+		return -1;
+	}
+
+	if(fread(&NumMesh, sizeof(NumMesh), 1, fpBin) != 1 || NumMesh < 0 || NumMesh > MAX_MESH)
+	{
+		fclose(fpBin);
+		return -1;
+	}
+
+	FromBin = new ZSModelEx *[NumMesh ? NumMesh : 1];
+	for(n = 0; n < NumMesh; n++)
+	{
+		FromBin[n] = new ZSModelEx;
+		FromBin[n]->LoadEx(fpBin);
+	}
+	fclose(fpBin);
+
+	QueryPerformanceCounter(&End);
+	BinTime = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+
+	//the archive
+	QueryPerformanceCounter(&Start);
+
+	if(!Archive.Open(ArchiveName, BinName) || Archive.GetNumMesh() != NumMesh)
+	{
+		for(n = 0; n < NumMesh; n++)
+		{
+			delete FromBin[n];
+		}
+		delete[] FromBin;
+		return -1;
+	}
+
+	FromArchive = new ZSModelEx *[NumMesh ? NumMesh : 1];
+	for(n = 0; n < NumMesh; n++)
+	{
+		FromArchive[n] = Archive.CreateMesh(n);
+	}
+
+	QueryPerformanceCounter(&End);
+	ArchiveTime = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+
+	//both have to leave every mesh the same
+	NumMismatches = 0;
+	PositionError = 0.0f;
+	NormalError = 0.0f;
+	for(n = 0; n < NumMesh; n++)
+	{
+		if(!SameMesh(FromBin[n], FromArchive[n], Archive.GetEntry(n), Archive.IsQuantized(), &PositionError, &NormalError))
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"mesh %i, %s differs\n", n, FromBin[n]->filename);
+			}
+		}
+	}
+
+	if(fpResults)
+	{
+		fprintf(fpResults,"%s: %i meshes, %i mismatches\n", ArchiveName, NumMesh, NumMismatches);
+		fprintf(fpResults,"bin: %.1f ms, %.3f ms per mesh\n", BinTime, NumMesh ? BinTime / (double)NumMesh : 0.0);
+		fprintf(fpResults,"archive: %.1f ms, %.3f ms per mesh\n", ArchiveTime, NumMesh ? ArchiveTime / (double)NumMesh : 0.0);
+		if(Archive.IsQuantized())
+		{
+			fprintf(fpResults,"quantized: positions within %g, normals within %g\n", PositionError, NormalError);
+		}
+	}
+
+	for(n = 0; n < NumMesh; n++)
+	{
+		delete FromArchive[n];
+		delete FromBin[n];
+	}
+	delete[] FromArchive;
+	delete[] FromBin;
+
+	return NumMismatches;
+}
+
+//end: Tools ***********************************************************
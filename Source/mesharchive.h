@@ -0,0 +1,169 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				mesharchive.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  every mesh in one memory mapped file, the meshes' arrays
+//*			 pointing straight into the view
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		quantized positions and normals have to be unpacked, so those
+//*		arrays are copied out of the view when the archive opens
+//*********************************************************************
+//*********************************************************************
+#ifndef MESHARCHIVE_H
+#define MESHARCHIVE_H
+
+#include "defs.h"
+#include "ZSmodelEx.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define MESH_ARCHIVE_MAGIC		0x324d535a	//"ZSM2"
+#define MESH_ARCHIVE_VERSION	2
+//the header, table and every block start on this boundary
+#define MESH_ARCHIVE_ALIGN		16
+#define MESH_ARCHIVE_FILE		"mesh.zsa"
+
+//positions are stored as three unsigned shorts across each mesh's
+//bounds and normals as three signed bytes
+#define MESH_ARCHIVE_QUANTIZED	0x0001
+
+//File layout:
+//	MESH_ARCHIVE_HEADER_T
+//	MESH_ARCHIVE_ENTRY_T table, one per mesh
+//	each mesh's blocks: equipment, triangles, uvs, normals, bounding
+//	volume tree nodes and triangles, then every frame's positions and
+//	every frame's tree boxes
+typedef struct
+{
+	DWORD Magic;
+	int Version;
+	int HeaderSize;
+	int EntrySize;
+	int NumMesh;
+	DWORD Flags;
+	//the mesh.bin this came from, once it changes the archive is stale
+	DWORD BinSize;
+	FILETIME BinTime;
+	int TableOffset;
+} MESH_ARCHIVE_HEADER_T;
+
+typedef struct
+{
+	char Name[MESH_NAME_LENGTH];
+	//without its extension, as Engine->GetTexture wants it
+	char Texture[TEXTURE_NAME_LENGTH];
+	int NumFrames;
+	int NumVertex;
+	int NumTriangles;
+	int NumWeaponSlots;
+	EquipmentLocator RegistrationMark;
+	//left, right, top, bottom, front, back
+	float Bounds[6];
+	float Scale[3];
+	int RangeMin;
+	int RangeMax;
+	int Blocking;
+	int NumBVHNodes;
+	float BoundingRadius;
+	//from the start of the file, 0 for none
+	int EquipmentOffset;
+	int TriangleOffset;
+	int UVOffset;
+	int NormalOffset;
+	int BVHNodeOffset;
+	int BVHTriangleOffset;
+	//frame n is at FrameOffset + n * FrameStride, its boxes at
+	//BoxOffset + n * BoxStride
+	int FrameOffset;
+	int FrameStride;
+	int BoxOffset;
+	int BoxStride;
+	//a quantized position is PositionMin + q * PositionStep
+	float PositionMin[3];
+	float PositionStep[3];
+} MESH_ARCHIVE_ENTRY_T;
+
+//where one mesh's arrays ended up once the archive is open
+typedef struct
+{
+	float **Frames;
+	float **Boxes;
+	float *Normals;
+} MESH_ARCHIVE_FIXUP_T;
+
+//*******************************CLASS********************************
+//**************          MeshArchive            *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Map a mesh archive copy on write and hand out meshes whose
+//*			 arrays are the archive's.  A mesh that changes its
+//*			 vertices gets private pages, the file is never written.
+//********************************************************************
+//*Invariants: while open every entry's blocks are aligned and lie
+//*				 wholly inside the view
+//********************************************************************
+class MeshArchive
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	HANDLE hFile;
+	HANDLE hMapping;
+	BYTE *pView;
+	DWORD ViewSize;
+	MESH_ARCHIVE_HEADER_T *pHeader;
+	MESH_ARCHIVE_ENTRY_T *Table;
+
+	MESH_ARCHIVE_FIXUP_T *Fixups;
+	//every mesh's frame and box pointers
+	float **Pointers;
+	//quantized positions and normals, unpacked
+	float *Unpacked;
+
+	BOOL CheckEntry(MESH_ARCHIVE_ENTRY_T *pEntry);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	BOOL IsOpen() { return pView != NULL; }
+	int GetNumMesh() { return pView ? pHeader->NumMesh : 0; }
+	BOOL IsQuantized() { return pView && (pHeader->Flags & MESH_ARCHIVE_QUANTIZED); }
+	const MESH_ARCHIVE_ENTRY_T *GetEntry(int Mesh) { return &Table[Mesh]; }
+
+// Mutators -----------------------------------------
+	//fails if the file is missing, from another version or older than
+	//BinName
+	BOOL Open(const char *ArchiveName, const char *BinName);
+	void Close();
+
+	//a new mesh whose arrays are the archive's.  It lets go of them
+	//when it is cleared or deleted, which can be before or after Close,
+	//but it must not be drawn once the archive is closed
+	ZSModelEx *CreateMesh(int Mesh);
+
+// Constructors ---------------------------------------
+	MeshArchive();
+
+// Destructor -----------------------------------------
+	~MeshArchive();
+
+};
+
+//offline tools
+//write an archive of every mesh in a mesh.bin, returns the number of
+//meshes or -1
+int ConvertMeshesToArchive(const char *BinName, const char *ArchiveName, BOOL Quantize);
+//load every mesh both ways, returns the number that came out different
+//or -1
+int BenchmarkMeshLoad(const char *BinName, const char *ArchiveName, FILE *fpResults);
+
+#endif
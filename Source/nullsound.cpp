@@ -0,0 +1,151 @@
+//*********************************************************************
+//*                                                                   *
+//**************              nullsound.cpp          *********************
+//**                                                                  *
+//**                                                                  *
+//*********************************************************************
+//*                                                                   *
+//*Revision:
+//*Revisor:
+//*Purpose:
+//*		ZSSoundSystem for headless builds, which have no sound card and
+//*		no BASS.  loads nothing, plays nothing, and keeps the settings
+//*		the options screen reads back
+//*********************************************************************
+//*Outstanding issues:
+//*
+//*********************************************************************
+//*********************************************************************
+#ifdef HEADLESS
+
+#include "ZSsound.h"
+#include "zsutilities.h"
+
+void SoundEffect::SetVolume(long lVol)
+{
+	return;
+}
+
+void SoundEffect::Load(const char *Filename)
+{
+	strncpy(Name, Filename, MAX_SOUND_NAME - 1);
+	Name[MAX_SOUND_NAME - 1] = '\0';
+}
+
+void SoundEffect::Play()
+{
+	return;
+}
+
+void SoundEffect::Stop()
+{
+	return;
+}
+
+void MusicSuite::Load(FILE *fp)
+{
+	NumFiles = 0;
+	PatternLength = 0;
+	Name[0] = '\0';
+	CurSegment = 0;
+}
+
+int ZSSoundSystem::PlayMusic(int n)
+{
+	return FALSE;
+}
+
+int ZSSoundSystem::PlayMusic(const char *SuiteName)
+{
+	return FALSE;
+}
+
+int ZSSoundSystem::PlayEffect(int n)
+{
+	return FALSE;
+}
+
+int ZSSoundSystem::PlayEffect(const char *EffectName)
+{
+	return FALSE;
+}
+
+int ZSSoundSystem::Init(HWND hWindow)
+{
+	DEBUG_INFO("Headless, no sound\n");
+
+	FXOn = FALSE;
+	MusicOn = FALSE;
+	NumFX = 0;
+	NumMusic = 0;
+	MusicPlaying = 0;
+
+	return TRUE;
+}
+
+void ZSSoundSystem::ShutDown()
+{
+	return;
+}
+
+void ZSSoundSystem::StartMusic(const char *area)
+{
+	return;
+}
+
+void ZSSoundSystem::StopMusic()
+{
+	return;
+}
+
+void ZSSoundSystem::PauseMusic()
+{
+	return;
+}
+
+void ZSSoundSystem::UnPauseMusic()
+{
+	return;
+}
+
+void ZSSoundSystem::SetMusic(BOOL OnOff)
+{
+	MusicOn = OnOff;
+}
+
+void ZSSoundSystem::SetFX(BOOL OnOff)
+{
+	FXOn = OnOff;
+}
+
+void ZSSoundSystem::SetFXVolume(int NewVolume)
+{
+	FXVolume = NewVolume;
+}
+
+void ZSSoundSystem::SetMusicVolume(int NewVolume)
+{
+	MusicVolume = NewVolume;
+}
+
+void ZSSoundSystem::SetMasterVolume(int NewVolume)
+{
+	MasterVolume = NewVolume;
+}
+
+MusicSuite *ZSSoundSystem::GetSuite(int n)
+{
+	return NULL;
+}
+
+MusicSuite *ZSSoundSystem::GetSuite(const char *SuiteName)
+{
+	return NULL;
+}
+
+void ZSSoundSystem::Update()
+{
+	return;
+}
+
+#endif
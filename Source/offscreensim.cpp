@@ -0,0 +1,426 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				offscreensim.cpp				  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  schedule ticks for the creatures the player can't see,
+//*			 as many as fit in a fixed slice of each frame
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		moving a creature to its locator touches the areas and the
+//*		chunk cache so it stays on the main thread, only the schedule
+//*		checks are spread over the workers
+//*********************************************************************
+//*********************************************************************
+#include "offscreensim.h"
+#include "creatures.h"
+#include "world.h"
+#include "replay.h"
+#include "profiler.h"
+#include "workerpool.h"
+#include <mmsystem.h>
+#include <stdlib.h>
+
+static int CompareBuckets(const void *pA, const void *pB)
+{
+	return ((OFFSCREEN_ENTRY_T *)pA)->Bucket - ((OFFSCREEN_ENTRY_T *)pB)->Bucket;
+}
+
+//************** Constructors  ****************************************
+
+OffScreenSim::OffScreenSim(int NewBudget)
+{
+	Entries = NULL;
+	MaxEntries = 0;
+	NumEntries = 0;
+	Cursor = 0;
+	Checked = 0;
+	CheckedHour = -1;
+	NumBuckets = 0;
+
+	QueryPerformanceFrequency(&Frequency);
+	SetBudget(NewBudget);
+
+	PassStart = 0;
+	LastPassTime = 0;
+	NumPasses = 0;
+	NumTicked = 0;
+	NumMoved = 0;
+	NumForks = 0;
+	TotalCatchUp = 0;
+	MaxCatchUp = 0;
+	LastAverageCatchUp = 0;
+	LastMaxCatchUp = 0;
+	LastFrameTicks = 0;
+
+	WorkStart = 0;
+	WorkEnd = 0;
+	WorkSize = 0;
+	WorkHour = 0;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+OffScreenSim::~OffScreenSim()
+{
+	if(Entries)
+	{
+		delete[] Entries;
+		Entries = NULL;
+	}
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Workers  ***********************************************
+
+void OffScreenSim::CheckSlice(int Slice, void *pSim)
+{
+	OffScreenSim *pThis;
+	int Start;
+	int End;
+
+	pThis = (OffScreenSim *)pSim;
+	Start = pThis->WorkStart + Slice * pThis->WorkSize;
+	End = Start + pThis->WorkSize;
+	if(End > pThis->WorkEnd)
+	{
+		End = pThis->WorkEnd;
+	}
+	if(Start < End)
+	{
+		pThis->Check(Start, End, pThis->WorkHour);
+	}
+}
+
+//end: Workers *********************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void OffScreenSim::SetBudget(int NewBudget)
+{
+	Budget = NewBudget;
+	BudgetTicks = Frequency.QuadPart * (LONGLONG)Budget / 1000000;
+}
+
+void OffScreenSim::Rebuild(int CurArea)
+{
+	Creature *pCreature;
+	int NumCreatures;
+	int SegX;
+	int SegY;
+	int Order;
+	int n;
+
+	NumCreatures = 0;
+	pCreature = Creature::GetFirst();
+	while(pCreature)
+	{
+		NumCreatures++;
+		pCreature = (Creature *)pCreature->GetNext();
+	}
+
+	if(NumCreatures > MaxEntries)
+	{
+		if(Entries)
+		{
+			delete[] Entries;
+		}
+		MaxEntries = NumCreatures + NumCreatures / 4;
+		Entries = new OFFSCREEN_ENTRY_T[MaxEntries];
+	}
+
+	n = 0;
+	pCreature = Creature::GetFirst();
+	while(pCreature)
+	{
+		SegX = (int)pCreature->GetPosition()->x / UPDATE_SEGMENT_WIDTH;
+		SegY = (int)pCreature->GetPosition()->y / UPDATE_SEGMENT_HEIGHT;
+		if(SegX < 0) SegX = 0;
+		if(SegY < 0) SegY = 0;
+		if(SegX >= WORLD_USEG_WIDTH) SegX = WORLD_USEG_WIDTH - 1;
+		if(SegY >= WORLD_USEG_HEIGHT) SegY = WORLD_USEG_HEIGHT - 1;
+
+		//the area the player is in goes first, then the limbo of area -1
+		if(pCreature->GetAreaIn() == CurArea)
+		{
+			Order = 0;
+		}
+		else
+		{
+			Order = pCreature->GetAreaIn() + 2;
+		}
+
+		Entries[n].pCreature = pCreature;
+		Entries[n].Bucket = Order * WORLD_USEG_WIDTH * WORLD_USEG_HEIGHT + SegX + SegY * WORLD_USEG_WIDTH;
+		Entries[n].Locator = OFFSCREEN_NO_MOVE;
+		n++;
+		pCreature = (Creature *)pCreature->GetNext();
+	}
+	NumEntries = n;
+
+	qsort(Entries, NumEntries, sizeof(OFFSCREEN_ENTRY_T), CompareBuckets);
+
+	NumBuckets = 0;
+	for(n = 0; n < NumEntries; n++)
+	{
+		Entries[n].pCreature->SetOffScreenEntry(n);
+		if(!n || Entries[n].Bucket != Entries[n - 1].Bucket)
+		{
+			NumBuckets++;
+		}
+	}
+
+	Cursor = 0;
+	Checked = 0;
+}
+
+void OffScreenSim::Check(int Start, int End, int Hour)
+{
+	int n;
+
+	for(n = Start; n < End; n++)
+	{
+		if(Entries[n].pCreature)
+		{
+			Entries[n].Locator = Entries[n].pCreature->CheckSchedule(Hour);
+		}
+		else
+		{
+			Entries[n].Locator = OFFSCREEN_NO_MOVE;
+		}
+	}
+}
+
+void OffScreenSim::Fork(int Start, int End, int Hour)
+{
+	int Slices;
+
+	Slices = PreludeWorkers.GetNumThreads();
+	if(Slices > OFFSCREEN_MAX_SLICES)
+	{
+		Slices = OFFSCREEN_MAX_SLICES;
+	}
+
+	if(Slices < 2 || End - Start < OFFSCREEN_MIN_PARALLEL)
+	{
+		Check(Start, End, Hour);
+		return;
+	}
+
+	WorkStart = Start;
+	WorkEnd = End;
+	WorkSize = (End - Start + Slices - 1) / Slices;
+	WorkHour = Hour;
+
+	//nothing else may run until the workers are done reading creatures
+	PreludeWorkers.Run(CheckSlice, this, Slices);
+	NumForks++;
+}
+
+void OffScreenSim::Tick(int Index, int CurArea, RECT *rOnScreen, unsigned long GameTime)
+{
+	Creature *pCreature;
+	unsigned long CatchUp;
+	int CX;
+	int CY;
+
+	pCreature = Entries[Index].pCreature;
+	if(!pCreature)
+	{
+		return;
+	}
+
+	CX = (int)pCreature->GetPosition()->x / UPDATE_SEGMENT_WIDTH;
+	CY = (int)pCreature->GetPosition()->y / UPDATE_SEGMENT_HEIGHT;
+
+	if(pCreature->GetAreaIn() == CurArea
+		&& CX >= rOnScreen->left
+		&& CX <= rOnScreen->right
+		&& CY >= rOnScreen->top
+		&& CY <= rOnScreen->bottom)
+	{
+		//the world's own update is running it, there is nothing to make up
+		pCreature->SetOffScreenTime(GameTime, 0);
+		return;
+	}
+
+	pCreature->ReleaseOffScreenTexture();
+
+	if(Entries[Index].Locator != OFFSCREEN_NO_MOVE)
+	{
+		pCreature->MoveToLocator(Entries[Index].Locator);
+		NumMoved++;
+
+		CX = (int)pCreature->GetPosition()->x / UPDATE_SEGMENT_WIDTH;
+		CY = (int)pCreature->GetPosition()->y / UPDATE_SEGMENT_HEIGHT;
+	}
+
+	//a loaded game may have put the clock back
+	CatchUp = 0;
+	if(pCreature->GetLastOffScreenTime() && pCreature->GetLastOffScreenTime() < GameTime)
+	{
+		CatchUp = GameTime - pCreature->GetLastOffScreenTime();
+	}
+	pCreature->SetOffScreenTime(GameTime, CatchUp);
+
+	TotalCatchUp += CatchUp;
+	if(CatchUp > MaxCatchUp)
+	{
+		MaxCatchUp = CatchUp;
+	}
+	NumTicked++;
+
+	//post update clean texture if necessary
+	if(pCreature->GetAreaIn() != CurArea || CX < rOnScreen->left || CX > rOnScreen->right || CY < rOnScreen->top || CY > rOnScreen->bottom)
+	{
+		if(pCreature->GetData(INDEX_TYPE).Value == 0)
+		{
+			if(pCreature->GetTexture())
+			{
+				delete pCreature->GetTexture();
+				pCreature->SetTexture(NULL);
+			}
+		}
+	}
+}
+
+void OffScreenSim::Update(int CurArea, RECT *rOnScreen, int Hour, unsigned long GameTime)
+{
+	LARGE_INTEGER Start;
+	LARGE_INTEGER Now;
+	DWORD Time;
+	int End;
+	int Ticks;
+
+	Time = ::GameTime();
+
+	if(Cursor >= NumEntries)
+	{
+		//with few creatures a pass ends every frame, don't go round again at once
+		if(PassStart && Time - PassStart < OFFSCREEN_MIN_PASS_TIME)
+		{
+			LastFrameTicks = 0;
+			return;
+		}
+
+		if(PassStart && NumEntries)
+		{
+			NumPasses++;
+			LastPassTime = Time - PassStart;
+			LastAverageCatchUp = NumTicked ? TotalCatchUp / NumTicked : 0;
+			LastMaxCatchUp = MaxCatchUp;
+		}
+		TotalCatchUp = 0;
+		MaxCatchUp = 0;
+		NumTicked = 0;
+
+		Rebuild(CurArea);
+		PassStart = Time;
+	}
+
+	QueryPerformanceCounter(&Start);
+	Ticks = 0;
+
+	while(Cursor < NumEntries)
+	{
+		if(Cursor >= Checked || CheckedHour != Hour)
+		{
+			End = Cursor + OFFSCREEN_BATCH;
+			if(End > NumEntries)
+			{
+				End = NumEntries;
+			}
+			Fork(Cursor, End, Hour);
+			Checked = End;
+			CheckedHour = Hour;
+		}
+
+		Tick(Cursor, CurArea, rOnScreen, GameTime);
+		Cursor++;
+		Ticks++;
+
+		//a fixed tick does the same work however fast the machine is
+		if(FixedTicks())
+		{
+			if(Ticks >= OFFSCREEN_FIXED_TICKS)
+			{
+				break;
+			}
+			continue;
+		}
+
+		QueryPerformanceCounter(&Now);
+		if(Now.QuadPart - Start.QuadPart >= BudgetTicks)
+		{
+			break;
+		}
+	}
+
+	LastFrameTicks = Ticks;
+}
+
+void OffScreenSim::Remove(Creature *pCreature)
+{
+	int n;
+
+	//the entry may be from before a Reset, or taken since by another
+	n = pCreature->GetOffScreenEntry();
+	if(n >= 0 && n < NumEntries && Entries[n].pCreature == pCreature)
+	{
+		Entries[n].pCreature = NULL;
+	}
+	pCreature->SetOffScreenEntry(-1);
+}
+
+void OffScreenSim::Reset()
+{
+	NumEntries = 0;
+	Cursor = 0;
+	Checked = 0;
+	CheckedHour = -1;
+	NumBuckets = 0;
+	PassStart = 0;
+	TotalCatchUp = 0;
+	MaxCatchUp = 0;
+	NumTicked = 0;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Debug ***************************************************
+
+void OffScreenSim::OutPutDebugInfo(FILE *fp)
+{
+	int n;
+	Creature *pCreature;
+
+	fprintf(fp,"offscreen creatures %i in %i buckets, %i workers, budget %i us\n", NumEntries, NumBuckets, PreludeWorkers.GetNumThreads(), Budget);
+	fprintf(fp,"passes %i, last pass %lu ms, %i ticked last frame, %i moved, %i forks\n", NumPasses, (unsigned long)LastPassTime, LastFrameTicks, NumMoved, NumForks);
+	fprintf(fp,"catch up over last pass: average %lu max %lu game minutes\n", LastAverageCatchUp, LastMaxCatchUp);
+
+	for(n = 0; n < NumEntries; n++)
+	{
+		pCreature = Entries[n].pCreature;
+		if(pCreature)
+		{
+			fprintf(fp,"%s: area %i bucket %i, catch up %lu\n", pCreature->GetData(INDEX_NAME).String, pCreature->GetAreaIn(), Entries[n].Bucket, pCreature->GetOffScreenCatchUp());
+		}
+	}
+}
+
+//end: Debug ***********************************************************
@@ -0,0 +1,149 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				offscreensim.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  schedule ticks for the creatures the player can't see,
+//*			 as many as fit in a fixed slice of each frame
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		moving a creature to its locator touches the areas and the
+//*		chunk cache so it stays on the main thread, only the schedule
+//*		checks are spread over the workers
+//*********************************************************************
+//*********************************************************************
+#ifndef OFFSCREENSIM_H
+#define OFFSCREENSIM_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+//microseconds of each frame given to offscreen creatures
+#define OFFSCREEN_DEFAULT_BUDGET	1000
+//creatures ticked each frame instead, when the clock runs in fixed ticks
+#define OFFSCREEN_FIXED_TICKS		64
+//most slices a batch is cut into for the shared workers
+#define OFFSCREEN_MAX_SLICES		5
+//creatures checked by the workers at a time
+#define OFFSCREEN_BATCH				256
+//smaller batches are not worth waking the workers for
+#define OFFSCREEN_MIN_PARALLEL		64
+//a pass over everyone does not start again sooner than this
+#define OFFSCREEN_MIN_PASS_TIME		500
+#define OFFSCREEN_NO_MOVE			-1
+
+class Creature;
+class OffScreenSim;
+
+typedef struct
+{
+	Creature *pCreature;	//NULL once deleted during the pass
+	int Bucket;				//area, then update segment
+	int Locator;			//from the check, OFFSCREEN_NO_MOVE if in place
+} OFFSCREEN_ENTRY_T;
+
+//*******************************CLASS********************************
+//**************          OffScreenSim           *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Sweep every creature once per pass, in order of area and
+//*			 update segment with the current area first.  Each frame the
+//*			 next batch of creatures has its schedule checked across the
+//*			 shared worker pool and the main thread, then the main
+//*			 thread moves the ones that are out of place until the
+//*			 frame's budget is spent.
+//********************************************************************
+//*Invariants: entries [Cursor, Checked) were checked at CheckedHour,
+//*				 no creature is read by a worker while the main thread
+//*				 runs game code
+//********************************************************************
+class OffScreenSim
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	OFFSCREEN_ENTRY_T *Entries;
+	int MaxEntries;
+	int NumEntries;
+	int Cursor;
+	int Checked;
+	int CheckedHour;
+	int NumBuckets;
+
+	LARGE_INTEGER Frequency;
+	LONGLONG BudgetTicks;
+	int Budget;
+
+	//the batch being checked on the worker pool
+	int WorkStart;
+	int WorkEnd;
+	int WorkSize;
+	int WorkHour;
+
+	//stats
+	DWORD PassStart;
+	DWORD LastPassTime;
+	int NumPasses;
+	int NumTicked;
+	int NumMoved;
+	int NumForks;
+	//catch up is in game minutes
+	unsigned long TotalCatchUp;
+	unsigned long MaxCatchUp;
+	//the last finished pass
+	unsigned long LastAverageCatchUp;
+	unsigned long LastMaxCatchUp;
+	int LastFrameTicks;
+
+	//a slice of the batch, for the worker pool
+	static void CheckSlice(int Slice, void *pSim);
+
+	void Rebuild(int CurArea);
+	void Check(int Start, int End, int Hour);
+	void Fork(int Start, int End, int Hour);
+	void Tick(int Index, int CurArea, RECT *rOnScreen, unsigned long GameTime);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetNumEntries() { return NumEntries; }
+	int GetBudget() { return Budget; }
+	//milliseconds the last full pass took
+	DWORD GetLastPassTime() { return LastPassTime; }
+	//game minutes a creature went without a tick, over the last pass
+	unsigned long GetAverageCatchUp() { return LastAverageCatchUp; }
+	unsigned long GetMaxCatchUp() { return LastMaxCatchUp; }
+
+// Mutators -----------------------------------------
+	//rOnScreen is the world's update rect, in update segments
+	void Update(int CurArea, RECT *rOnScreen, int Hour, unsigned long GameTime);
+
+	//a creature is being deleted
+	void Remove(Creature *pCreature);
+
+	//the creature list has been replaced
+	void Reset();
+
+	//in microseconds
+	void SetBudget(int NewBudget);
+
+// Constructors ---------------------------------------
+	OffScreenSim(int NewBudget);
+
+// Destructor -----------------------------------------
+	~OffScreenSim();
+
+// Debug ----------------------------------------------
+	void OutPutDebugInfo(FILE *fp);
+
+};
+
+#endif
@@ -5,7 +5,7 @@
 //********************************************************************* 
 //********************************************************************* 
 //*                                                                                                                                      * 
-//*Revision: 0.085                                                                                       * 
+//*Revision: 0.086                                                                                       * 
 //*Revisor:                                               
 //*Purpose:                        
 //********************************************************************* 
@@ -17,6 +17,7 @@
 //0.084	added seperate pathing types
 //0.085 switched from dynamic memory to a static fund of nodes
 //		switched to joint closed/open list
+//0.086 open list is now a binary heap, membership through a per-search node grid
 
 #include "path.h"
 #include "world.h"
@@ -25,160 +26,180 @@
 #include "objects.h"
 #include "combatmanager.h"
 #include "creatures.h"
+#include "pathgraph.h"
+#include "profiler.h"
 #include <assert.h>
 
 #define PATH_MESH_NUMBER 2
-#define MAX_HEIGHT_DIFFERENCE	0.75f
 
 int DistanceTable[MAX_PATH_LENGTH][MAX_PATH_LENGTH];
 
 #define COMBATPATHCONVERT(x,y) (y - ConvertY) * COMBAT_WIDTH + (x - ConvertX)
 
 int UsedNodes;
-NODE NodeList[8008]; //padded by eight for the surrounding nodes
-int WorstNode;
+NODE NodeList[MAX_PATH_NODES]; //padded by eight for the surrounding nodes
 
-NODE *ClosedList;
-NODE *OpenList;
+//the open list is a binary heap ordered on value, ties broken by the order
+//nodes were added so searches pop in the same sequence the old sorted list did
+NODE *OpenHeap[MAX_PATH_NODES];
+int OpenCount;
+int NodeOrder;
 
-void InitNodes()
+//dense grid of the tiles a search can reach, centered between start and goal.
+//a cell only belongs to the current search if its generation matches.
+typedef struct
+{
+	unsigned int Generation;
+	NODE *pNode;
+} PATH_CELL_T;
+
+PATH_CELL_T NodeGrid[PATH_GRID_WIDTH * PATH_GRID_WIDTH];
+unsigned int SearchGeneration = 0;
+int GridOriginX;
+int GridOriginY;
+
+void InitNodes(int StartX, int StartY, int GoalX, int GoalY)
 {
 	UsedNodes = 0;
-	WorstNode = 0;
-	ClosedList = NULL;
-	OpenList = NULL;
+	OpenCount = 0;
+	NodeOrder = 0;
+	GridOriginX = (StartX + GoalX) / 2 - PATH_GRID_RADIUS;
+	GridOriginY = (StartY + GoalY) / 2 - PATH_GRID_RADIUS;
+
+	SearchGeneration++;
+	if(!SearchGeneration)
+	{
+		//the stamp wrapped around, old cells could look current again
+		memset(NodeGrid,0,sizeof(NodeGrid));
+		SearchGeneration = 1;
+	}
 }
 
-NODE *GetNewNode()
+PATH_CELL_T *GetCell(int x, int y)
 {
-	UsedNodes++;
-	NodeList[UsedNodes].parent = NULL;
-	NodeList[UsedNodes].pNext = NULL;
-	NodeList[UsedNodes].pPrev = NULL;
-	return &NodeList[UsedNodes]; 
+	int gx;
+	int gy;
+	gx = x - GridOriginX;
+	gy = y - GridOriginY;
+
+	if(gx < 0 || gy < 0 || gx >= PATH_GRID_WIDTH || gy >= PATH_GRID_WIDTH)
+	{
+		return NULL;
+	}
+	return &NodeGrid[gx + gy * PATH_GRID_WIDTH];
 }
 
-NODE *InOpen(int x,int y)
+NODE *FindNode(int x, int y)
 {
-	NODE *pNode;
-	pNode = OpenList;
-
-	while(pNode)
+	PATH_CELL_T *pCell;
+	pCell = GetCell(x,y);
+	if(pCell && pCell->Generation == SearchGeneration)
 	{
-		if(pNode->x == x && pNode->y == y)
-		{
-			return pNode;
-		}
-		else
-		{
-			pNode = pNode->pNext;
-		}
+		return pCell->pNode;
 	}
 	return NULL;
 }
 
-NODE *InClosed(int x, int y)
+NODE *GetNewNode(int x, int y)
 {
-	NODE *pNode;
-	pNode = ClosedList;
-	while(pNode)
+	PATH_CELL_T *pCell;
+	pCell = GetCell(x,y);
+	if(!pCell || UsedNodes >= MAX_PATH_NODES - 1)
 	{
-		if(pNode->x == x && pNode->y == y)
-		{
-			return pNode;
-		}
-		else
-		{
-			pNode = pNode->pNext;
-		}
+		return NULL;
 	}
-	return FALSE;
+
+	UsedNodes++;
+	NODE *pNode;
+	pNode = &NodeList[UsedNodes];
+	pNode->x = x;
+	pNode->y = y;
+	pNode->parent = NULL;
+	pNode->HeapIndex = NODE_CLOSED;
+	pCell->Generation = SearchGeneration;
+	pCell->pNode = pNode;
+	return pNode; 
 }
 
-void RemoveFromList(NODE *pNode)
+inline BOOL NodeBefore(NODE *pA, NODE *pB)
 {
-	if(!pNode->pPrev)
+	return pA->value < pB->value || (pA->value == pB->value && pA->order < pB->order);
+}
+
+void HeapUp(int Index)
+{
+	NODE *pNode;
+	pNode = OpenHeap[Index];
+	int Parent;
+
+	while(Index > 0)
 	{
-		if(OpenList == pNode)
+		Parent = (Index - 1) / 2;
+		if(!NodeBefore(pNode, OpenHeap[Parent]))
 		{
-			OpenList = pNode->pNext;
-		}
-		else
-		if(ClosedList == pNode)
-		{
-			ClosedList = pNode->pNext;
+			break;
 		}
+		OpenHeap[Index] = OpenHeap[Parent];
+		OpenHeap[Index]->HeapIndex = Index;
+		Index = Parent;
 	}
-	else
-	{
-		pNode->pPrev->pNext = pNode->pNext;
-	}
-
-	if(pNode->pNext)
-	{
-		pNode->pNext->pPrev = pNode->pPrev;
-	}
-
-	pNode->pNext = NULL;
-	pNode->pPrev = NULL;
+	OpenHeap[Index] = pNode;
+	pNode->HeapIndex = Index;
 }
 
-void AddToOpen(NODE  *pAdd)
+void HeapDown(int Index)
 {
-	if(OpenList)
+	NODE *pNode;
+	pNode = OpenHeap[Index];
+	int Child;
+
+	while((Child = Index * 2 + 1) < OpenCount)
 	{
-		NODE *pNode;
-		pNode = OpenList;
-		if(pNode->value > pAdd->value)
+		if(Child + 1 < OpenCount && NodeBefore(OpenHeap[Child + 1], OpenHeap[Child]))
 		{
-			pAdd->pNext = OpenList;
-			OpenList = pAdd;
-			pAdd->pPrev = NULL;
-			pNode->pPrev = pAdd;
-			return;
+			Child++;
 		}
-		else
-		while(pNode->pNext)
+		if(!NodeBefore(OpenHeap[Child], pNode))
 		{
-			if(pNode->pNext->value > pAdd->value)
-			{
-				pAdd->pPrev = pNode;
-				pAdd->pNext = pNode->pNext;
-				pNode->pNext = pAdd;
-				pAdd->pNext->pPrev = pAdd;
-				return;
-			}
-			pNode = pNode->pNext;
+			break;
 		}
-		pNode->pNext = pAdd;
-		pAdd->pPrev = pNode;
-		pAdd->pNext = NULL;
-		return;
+		OpenHeap[Index] = OpenHeap[Child];
+		OpenHeap[Index]->HeapIndex = Index;
+		Index = Child;
 	}
-	else
+	OpenHeap[Index] = pNode;
+	pNode->HeapIndex = Index;
+}
+
+//adds a closed node to the open list, or repositions a node already on it
+//whose value has just improved
+void AddToOpen(NODE *pAdd)
+{
+	pAdd->order = NodeOrder++;
+	if(pAdd->HeapIndex == NODE_CLOSED)
 	{
-		OpenList = pAdd;
-		pAdd->pPrev = NULL;
-		pAdd->pNext = NULL;
+		OpenHeap[OpenCount] = pAdd;
+		pAdd->HeapIndex = OpenCount;
+		OpenCount++;
 	}
-	return;
+	HeapUp(pAdd->HeapIndex);
 }
 
-void AddToClose(NODE *pNode)
+//removes the best node from the open list, closing it
+NODE *PopOpen()
 {
-	if(!InClosed(pNode->x,pNode->y))
+	NODE *pNode;
+	pNode = OpenHeap[0];
+	OpenCount--;
+	if(OpenCount)
 	{
-		pNode->pPrev = NULL;
-		pNode->pNext = ClosedList;
-		if(ClosedList)
-		{
-			ClosedList->pPrev = pNode;
-		}
-		ClosedList = pNode;
+		OpenHeap[0] = OpenHeap[OpenCount];
+		HeapDown(0);
 	}
+	pNode->HeapIndex = NODE_CLOSED;
+	return pNode;
 }
 
-
 inline int Distance(int x1,int y1, int x2, int y2)
 {
 	//use manHattandistance;
@@ -239,6 +260,8 @@ BOOL CanTravelLarge(int FromX, int FromY, int ToX, int ToY, float FromHeight, Ob
 BOOL CanTravelLargeObject(int FromX, int FromY, int ToX, int ToY, float FromHeight,Object *pTraveller);
 
 FILE *pathdebug;
+extern FILE *fpPathRecord;
+void RecordPath(int x1, int y1, int x2, int y2, float fRange, BOOL (*TravelFunc)(int,int,int,int, float, Object *));
 
 
 //in sorted order
@@ -247,11 +270,7 @@ void AddNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 	int newvalue;
 	NODE *child;
 
-	child = InOpen(x,y);
-	if(!child)
-	{
-		child = InClosed(x,y);
-	}
+	child = FindNode(x,y);
 	
 	int Travelled;
 	if(np->x == x || np->y == y)
@@ -280,9 +299,11 @@ void AddNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 
 	if(!child)
 	{
-		child = GetNewNode();
-		child->x = x;
-		child->y = y;
+		child = GetNewNode(x,y);
+		if(!child)
+		{
+			return;
+		}
 		child->gone = np->gone + Travelled;
 		child->left = Distance(x,y,dx,dy);
 		child->value = child->gone + child->left;
@@ -307,7 +328,6 @@ void AddNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 			child->value = child->gone + child->left;
 			child->parent = np;
 			child->fromdir = FromDir;
-			RemoveFromList(child);
 			AddToOpen(child);
 		}
 	}
@@ -320,11 +340,7 @@ void AddLargeNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 	int newvalue;
 	NODE *child;
 
-	child = InOpen(x,y);
-	if(!child)
-	{
-		child = InClosed(x,y);
-	}
+	child = FindNode(x,y);
 	
 	int Travelled;
 	if(np->x == x || np->y == y)
@@ -353,9 +369,11 @@ void AddLargeNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 
 	if(!child)
 	{
-		child = GetNewNode();
-		child->x = x;
-		child->y = y;
+		child = GetNewNode(x,y);
+		if(!child)
+		{
+			return;
+		}
 		child->gone = np->gone + Travelled;
 		child->left = LargeDistance(x,y,dx,dy);
 		child->value = child->gone + child->left;
@@ -380,7 +398,6 @@ void AddLargeNode(int x, int y, int dx, int dy, DIRECTION_T FromDir, NODE *np)
 			child->value = child->gone + child->left;
 			child->parent = np;
 			child->fromdir = FromDir;
-			RemoveFromList(child);
 			AddToOpen(child);
 		}
 	}
@@ -617,6 +634,8 @@ void Path::Draw(Thing *pActive)
 //************ Mutators ************************************************
 BOOL Path::FindPath(int x1, int y1, int x2, int y2, BOOL (*TravelFunc)(int,int,int,int,float, Object *), float fRangeNeeded, Object *pTrav)
 {
+	ProfileZone PathZone(ZONE_PATH);
+
 	//confirm that all parameters lie within the actual world
 	
 	pTraveller = pTrav;
@@ -628,14 +647,17 @@ BOOL Path::FindPath(int x1, int y1, int x2, int y2, BOOL (*TravelFunc)(int,int,i
 		return FALSE;
 	}
 
-	InitNodes();
+	if(fpPathRecord)
+	{
+		RecordPath(x1,y1,x2,y2,fRangeNeeded,TravelFunc);
+	}
+
+	InitNodes(x1,y1,x2,y2);
 	NODE *np = NULL;
 	NODE *child = NULL;
 	int dx = x2;
 	int dy = y2;
-	np = GetNewNode();  //start
-	np->x = x1;
-	np->y = y1;
+	np = GetNewNode(x1,y1);  //start
 	np->gone = 0;
 	np->left = Distance(x1,y1,dx,dy);
 	np->value = np->gone+np->left;
@@ -645,11 +667,9 @@ BOOL Path::FindPath(int x1, int y1, int x2, int y2, BOOL (*TravelFunc)(int,int,i
 	int checked = 0;
 	int pathoffset;
 
-	while(OpenList && checked < MaxDepth)
+	while(OpenCount && checked < MaxDepth)
 	{
-		np = OpenList;
-		RemoveFromList(np);
-		AddToClose(np);
+		np = PopOpen();
 
 		if((np->x == dx && np->y == dy) ||
 			np->left <= RangeNeeded)
@@ -799,6 +819,48 @@ BOOL Path::FindLargePath(int x1, int y1, int x2, int y2, float frange, Object *p
 	return FindPath(x1,y1,x2,y2, CanTravelLarge,  frange,pTrav);
 }//for creatures of size 2
 	
+BOOL Path::FindLongPath(int x1, int y1, int x2, int y2, BOOL (*TravelFunc)(int,int,int,int,float, Object *), float fRangeNeeded, Object *pTrav)
+{
+	ProfileZone PathZone(ZONE_PATH);
+
+	if((abs(x1-x2) < LONG_PATH_MIN_DISTANCE && abs(y1-y2) < LONG_PATH_MIN_DISTANCE) ||
+		!Valley->GetPathGraph())
+	{
+		return FindPath(x1,y1,x2,y2, TravelFunc, fRangeNeeded, pTrav);
+	}
+
+	int WayX;
+	int WayY;
+	switch(Valley->GetPathGraph()->FindRoute(x1,y1,x2,y2,LONG_PATH_REFINE_CHUNKS,&WayX,&WayY))
+	{
+	case ROUTE_NONE:
+		PathLength = 666;
+		return FALSE;
+	case ROUTE_NOT_RESIDENT:
+		//the graph is still waiting on chunks, search the tiles meanwhile
+		return FindPath(x1,y1,x2,y2, TravelFunc, fRangeNeeded, pTrav);
+	default:
+		break;
+	}
+
+	if(WayX == x2 && WayY == y2)
+	{
+		return FindPath(x1,y1,x2,y2, TravelFunc, fRangeNeeded, pTrav);
+	}
+	
+	return FindPath(x1,y1,WayX,WayY, TravelFunc, 0.0f, pTrav);
+}
+
+BOOL Path::FindLongPath(int x1, int y1, int x2, int y2, float frange, Object *pTrav)
+{
+	return FindLongPath(x1,y1,x2,y2, CanTravel, frange, pTrav);
+}
+
+BOOL Path::FindLargeLongPath(int x1, int y1, int x2, int y2, float frange, Object *pTrav)
+{
+	return FindLongPath(x1,y1,x2,y2, CanTravelLarge, frange, pTrav);
+}//for creatures of size 2
+
 //find a path around moveable objects
 BOOL Path::FindPathObjects(int x1, int y1, int x2, int y2, float frange, Object *pTrav)
 {
@@ -838,6 +900,128 @@ BOOL Path::LargePathAround()
 
 //************ Debug ***************************************************
 
+//searches can be recorded while playing and replayed later against the same
+//area to time the search core without the rest of the game running
+typedef enum
+{
+	PATH_TYPE_NORMAL = 0,
+	PATH_TYPE_LARGE,
+	PATH_TYPE_OBJECTS,
+	PATH_TYPE_LARGE_OBJECTS,
+} PATH_TYPE_T;
+
+FILE *fpPathRecord = NULL;
+
+void RecordPaths(const char *filename)
+{
+	StopRecordingPaths();
+	fpPathRecord = fopen(filename,"wt");
+}
+
+void StopRecordingPaths()
+{
+	if(fpPathRecord)
+	{
+		fclose(fpPathRecord);
+		fpPathRecord = NULL;
+	}
+}
+
+void RecordPath(int x1, int y1, int x2, int y2, float fRange, BOOL (*TravelFunc)(int,int,int,int, float, Object *))
+{
+	PATH_TYPE_T Type;
+	if(TravelFunc == CanTravelLarge)
+		Type = PATH_TYPE_LARGE;
+	else
+	if(TravelFunc == CanTravelObject)
+		Type = PATH_TYPE_OBJECTS;
+	else
+	if(TravelFunc == CanTravelLargeObject)
+		Type = PATH_TYPE_LARGE_OBJECTS;
+	else
+		Type = PATH_TYPE_NORMAL;
+
+	fprintf(fpPathRecord,"%i %i %i %i %f %i\n",x1,y1,x2,y2,fRange,Type);
+}
+
+//replays every recorded search against the loaded area and writes the timings
+//returns the number of searches replayed
+int BenchmarkPaths(const char *filename, FILE *fpResults)
+{
+	FILE *fp;
+	fp = fopen(filename,"rt");
+	if(!fp)
+	{
+		return 0;
+	}
+
+	Path BenchPath;
+	int x1, y1, x2, y2, Type;
+	float fRange;
+	int NumSearches = 0;
+	int NumFound = 0;
+	BOOL Found;
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double Elapsed;
+	double Total = 0.0;
+	double Worst = 0.0;
+
+	QueryPerformanceFrequency(&Frequency);
+
+	while(fscanf(fp,"%i %i %i %i %f %i",&x1,&y1,&x2,&y2,&fRange,&Type) == 6)
+	{
+		QueryPerformanceCounter(&Start);
+		switch(Type)
+		{
+		case PATH_TYPE_LARGE:
+			Found = BenchPath.FindLargePath(x1,y1,x2,y2,fRange);
+			break;
+		case PATH_TYPE_OBJECTS:
+			Found = BenchPath.FindPathObjects(x1,y1,x2,y2,fRange);
+			break;
+		case PATH_TYPE_LARGE_OBJECTS:
+			Found = BenchPath.FindLargePathObjects(x1,y1,x2,y2,fRange);
+			break;
+		default:
+			Found = BenchPath.FindPath(x1,y1,x2,y2,fRange);
+			break;
+		}
+		QueryPerformanceCounter(&End);
+
+		Elapsed = (double)(End.QuadPart - Start.QuadPart) * 1000000.0 / (double)Frequency.QuadPart;
+		Total += Elapsed;
+		if(Elapsed > Worst)
+		{
+			Worst = Elapsed;
+		}
+		NumSearches++;
+		if(Found)
+		{
+			NumFound++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"%i %i -> %i %i: %i steps, %.1f us\n",x1,y1,x2,y2,BenchPath.GetLength(),Elapsed);
+			}
+		}
+		else
+		if(fpResults)
+		{
+			fprintf(fpResults,"%i %i -> %i %i: failed, %.1f us\n",x1,y1,x2,y2,Elapsed);
+		}
+	}
+	fclose(fp);
+
+	if(fpResults && NumSearches)
+	{
+		fprintf(fpResults,"%i searches, %i found, total %.1f ms, average %.1f us, worst %.1f us\n",
+			NumSearches, NumFound, Total / 1000.0, Total / (double)NumSearches, Worst);
+	}
+
+	return NumSearches;
+}
+
 //end: Debug ***********************************************************
 
 //helpers
@@ -909,6 +1093,8 @@ BOOL CanTravelLargeObject(int FromX, int FromY, int ToX, int ToY, float FromHeig
 //for Combat
 BOOL Path::FindCombatPath(int x1, int y1, int x2, int y2, float fRange, Object *pTrav)
 {
+	ProfileZone PathZone(ZONE_PATH);
+
 	//confirm that all parameters lie within the actual world
 	pTraveller = pTrav;
 	RangeNeeded = (int)(fRange * 10.0f);
@@ -942,14 +1128,12 @@ BOOL Path::FindCombatPath(int x1, int y1, int x2, int y2, float fRange, Object *
 	CreatureArea = PreludeWorld->GetCombat()->CreatureArea;
 	Combat *pCombat = PreludeWorld->GetCombat();
 
-	InitNodes();
+	InitNodes(x1,y1,x2,y2);
 	NODE *np = NULL;
 	NODE *child = NULL;
 	int dx = x2;
 	int dy = y2;
-	np = GetNewNode();  //start
-	np->x = x1;
-	np->y = y1;
+	np = GetNewNode(x1,y1);  //start
 	np->gone = 0;
 	np->left = Distance(x1,y1,dx,dy);
 	np->value = np->gone+np->left;
@@ -965,11 +1149,9 @@ BOOL Path::FindCombatPath(int x1, int y1, int x2, int y2, float fRange, Object *
 	ConvertY = pCombat->rCombat.top;
 
 
-	while(OpenList && checked < MaxDepth)
+	while(OpenCount && checked < MaxDepth)
 	{
-		np = OpenList;
-		RemoveFromList(np);
-		AddToClose(np);
+		np = PopOpen();
 
 		if(np->left <= RangeNeeded && pCombat->CheckLineOfSight(np->x,np->y,x2,y2, NULL,NULL))
 		{
@@ -1108,8 +1290,58 @@ BOOL Path::FindCombatPath(int x1, int y1, int x2, int y2, float fRange, Object *
 
 }
 
+BOOL Path::FindCombatFloodPath(int x1, int y1, int x2, int y2, Object *pTrav)
+{
+	ProfileZone PathZone(ZONE_PATH);
+
+	Combat *pCombat = PreludeWorld->GetCombat();
+	int pathoffset;
+
+	if(!pTrav || pTrav != pCombat->GetActiveCombatant() || !pCombat->IsFloodFrom(x1,y1))
+	{
+		return FALSE;
+	}
+
+	PathLength = pCombat->GetFloodPath(x2, y2, PathX, PathY, dirtravel, MAX_PATH_LENGTH);
+	if(PathLength < 0)
+	{
+		PathLength = 666;
+		return FALSE;
+	}
+
+	pTraveller = pTrav;
+	RangeNeeded = 0;
+	ActionPoints = ((Creature *)pTrav)->GetData(INDEX_ACTIONPOINTS).Value;
+	MovePoints = ((Creature *)pTrav)->GetData(INDEX_MOVEPOINTS).Value;
+
+	for(pathoffset = 1; pathoffset <= PathLength; pathoffset++)
+	{
+		switch(dirtravel[pathoffset])
+		{
+		case N:
+		case S:
+		case E:
+		case W:
+			MPUsed[pathoffset] = MovePoints;
+			break;
+		default:
+			MPUsed[pathoffset] = MovePoints + MovePoints / 2;
+			break;
+		}
+	}
+
+	StartX = x1;
+	StartY = y1;
+	EndX = x2;
+	EndY = y2;
+
+	return TRUE;
+}
+
 BOOL Path::FindLargeCombatPath(int x1, int y1, int x2, int y2, float fRange, Object *pTrav)
 {
+	ProfileZone PathZone(ZONE_PATH);
+
 	//confirm that all parameters lie within the actual world
 	pTraveller = pTrav;
 	RangeNeeded = (int)(fRange * 10.0f);
@@ -1143,14 +1375,12 @@ BOOL Path::FindLargeCombatPath(int x1, int y1, int x2, int y2, float fRange, Obj
 	CreatureArea = PreludeWorld->GetCombat()->CreatureArea;
 	Combat *pCombat = PreludeWorld->GetCombat();
 
-	InitNodes();
+	InitNodes(x1,y1,x2,y2);
 	NODE *np = NULL;
 	NODE *child = NULL;
 	int dx = x2;
 	int dy = y2;
-	np = GetNewNode();  //start
-	np->x = x1;
-	np->y = y1;
+	np = GetNewNode(x1,y1);  //start
 	np->gone = 0;
 	np->left = LargeDistance(x1,y1,dx,dy);
 	np->value = np->gone+np->left;
@@ -1166,11 +1396,9 @@ BOOL Path::FindLargeCombatPath(int x1, int y1, int x2, int y2, float fRange, Obj
 	ConvertY = pCombat->rCombat.top;
 
 
-	while(OpenList && checked < MaxDepth)
+	while(OpenCount && checked < MaxDepth)
 	{
-		np = OpenList;
-		RemoveFromList(np);
-		AddToClose(np);
+		np = PopOpen();
 
 		if(np->left <= RangeNeeded && pCombat->CheckLineOfSight(np->x,np->y,x2,y2, pTrav, NULL))
 		{
@@ -23,6 +23,17 @@
 
 #define MAX_PATH_LENGTH 256
 #define MAX_PATH_DEPTH_SEARCH 8000
+#define MAX_PATH_NODES	(MAX_PATH_DEPTH_SEARCH + 8)
+
+//start and goal are at most half a path length apart, so a grid this far
+//around their midpoint keeps every node inside the distance table
+#define PATH_GRID_RADIUS	(MAX_PATH_LENGTH - MAX_PATH_LENGTH / 4 - 1)
+#define PATH_GRID_WIDTH		(PATH_GRID_RADIUS * 2 + 1)
+
+#define NODE_CLOSED	-1
+
+//steepest step a traveller can take between neighbouring tiles
+#define MAX_HEIGHT_DIFFERENCE	0.75f
 
 
 
@@ -49,10 +60,10 @@ struct NODE
 	
 	NODE *parent;
 
-	NODE *pNext;
-	NODE *pPrev;
+	int HeapIndex; //position in the open heap, NODE_CLOSED when not on it
+	int order;	//insertion order, breaks ties between equal values
 	
-	NODE() { x = 0; y = 0; gone = 0; left = 0; value = 0; fromdir = DIR_NONE; parent = NULL; }
+	NODE() { x = 0; y = 0; gone = 0; left = 0; value = 0; fromdir = DIR_NONE; parent = NULL; HeapIndex = NODE_CLOSED; order = 0; }
 };
 
 class Object;
@@ -85,6 +96,7 @@ private:
 	int MaxDepth;
 
 	BOOL FindPath(int x1, int y1, int x2, int y2,  BOOL (*TravelFunc)(int,int,int,int, float, Object *),float fRangeNeeded = 0.0f, Object *pTrav = NULL);
+	BOOL FindLongPath(int x1, int y1, int x2, int y2,  BOOL (*TravelFunc)(int,int,int,int, float, Object *),float fRangeNeeded = 0.0f, Object *pTrav = NULL);
 		
 //************************************************************************************** 
 
@@ -114,6 +126,11 @@ public:
 	//find a path, ignoring moveable objects
 	BOOL FindPath(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL);
 	BOOL FindLargePath(int x1, int y1, int x2, int y2, float fRange = 0.0f,Object *pTrav = NULL); //for creatures of size 2
+
+	//plan across chunks on the portal graph, only the next few chunks are pathed
+	//at tile level.  Call again from the end of the path to continue.
+	BOOL FindLongPath(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL);
+	BOOL FindLargeLongPath(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL); //for creatures of size 2
 	
 	//find a path around moveable objects
 	BOOL FindPathObjects(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL);
@@ -122,6 +139,9 @@ public:
 	//for Combat
 	BOOL FindCombatPath(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL);
 	BOOL FindLargeCombatPath(int x1, int y1, int x2, int y2, float fRange = 0.0f, Object *pTrav = NULL);
+	//read the cheapest way back out of the combat flood, FALSE if the traveller
+	//isn't standing where the active combatant's flood started
+	BOOL FindCombatFloodPath(int x1, int y1, int x2, int y2, Object *pTrav);
 
 	//find a path around the current node
 	BOOL PathAround();
@@ -172,6 +192,11 @@ extern int DistanceTable[MAX_PATH_LENGTH][MAX_PATH_LENGTH];
 void FillDistanceTable();
 
 extern inline int Distance(int x1,int y1, int x2, int y2);
-extern void InitNodes();
+extern void InitNodes(int StartX, int StartY, int GoalX, int GoalY);
+
+//recording and replay of searches for timing
+void RecordPaths(const char *filename);
+void StopRecordingPaths();
+int BenchmarkPaths(const char *filename, FILE *fpResults);
 
 #endif
@@ -0,0 +1,893 @@
+//*********************************************************************
+//*********************************************************************
+//**************              pathgraph.cpp         *******************
+//*********************************************************************
+//*********************************************************************
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision: 0.001
+//*Revisor:
+//*Purpose:  portal graph over chunk borders for long range path planning
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#include "pathgraph.h"
+#include "path.h"
+#include "area.h"
+#include "chunkstreamer.h"
+#include "debuglog.h"
+#include <math.h>
+
+#define PORTAL_NO_ROUTE		0xFFFF
+#define CHUNK_TILES			(CHUNK_TILE_WIDTH * CHUNK_TILE_HEIGHT)
+#define GRAPH_GOAL_NODE		-1
+
+//search nodes for the abstract graph
+typedef struct
+{
+	int ChunkIndex;	//GRAPH_GOAL_NODE for the goal tile itself
+	int Portal;
+	int Gone;
+	int Value;
+	int Parent;
+	int HeapIndex;
+} GRAPH_NODE_T;
+
+GRAPH_NODE_T GraphNodes[MAX_GRAPH_SEARCH_NODES];
+int GraphHeap[MAX_GRAPH_SEARCH_NODES];
+int NumGraphNodes;
+int GraphOpenCount;
+int GraphGoalNode;
+
+void GraphHeapUp(int Index)
+{
+	int Node;
+	int Parent;
+	Node = GraphHeap[Index];
+
+	while(Index > 0)
+	{
+		Parent = (Index - 1) / 2;
+		if(GraphNodes[GraphHeap[Parent]].Value <= GraphNodes[Node].Value)
+		{
+			break;
+		}
+		GraphHeap[Index] = GraphHeap[Parent];
+		GraphNodes[GraphHeap[Index]].HeapIndex = Index;
+		Index = Parent;
+	}
+	GraphHeap[Index] = Node;
+	GraphNodes[Node].HeapIndex = Index;
+}
+
+void GraphHeapDown(int Index)
+{
+	int Node;
+	int Child;
+	Node = GraphHeap[Index];
+
+	while((Child = Index * 2 + 1) < GraphOpenCount)
+	{
+		if(Child + 1 < GraphOpenCount && GraphNodes[GraphHeap[Child + 1]].Value < GraphNodes[GraphHeap[Child]].Value)
+		{
+			Child++;
+		}
+		if(GraphNodes[Node].Value <= GraphNodes[GraphHeap[Child]].Value)
+		{
+			break;
+		}
+		GraphHeap[Index] = GraphHeap[Child];
+		GraphNodes[GraphHeap[Index]].HeapIndex = Index;
+		Index = Child;
+	}
+	GraphHeap[Index] = Node;
+	GraphNodes[Node].HeapIndex = Index;
+}
+
+void GraphAddToOpen(int Node)
+{
+	if(GraphNodes[Node].HeapIndex == NODE_CLOSED)
+	{
+		GraphHeap[GraphOpenCount] = Node;
+		GraphNodes[Node].HeapIndex = GraphOpenCount;
+		GraphOpenCount++;
+	}
+	GraphHeapUp(GraphNodes[Node].HeapIndex);
+}
+
+int GraphPopOpen()
+{
+	int Node;
+	Node = GraphHeap[0];
+	GraphOpenCount--;
+	if(GraphOpenCount)
+	{
+		GraphHeap[0] = GraphHeap[GraphOpenCount];
+		GraphHeapDown(0);
+	}
+	GraphNodes[Node].HeapIndex = NODE_CLOSED;
+	return Node;
+}
+
+//straight line estimate in the same units as the tile costs
+inline int GraphDistance(int x1, int y1, int x2, int y2)
+{
+	int a = abs(x2 - x1);
+	int b = abs(y2 - y1);
+	if(a > b)
+		return a * 10 + b * 4;
+	return b * 10 + a * 4;
+}
+
+//************** Constructors  ****************************************
+
+PathGraph::PathGraph(Area *pNewArea, int NewChunkWidth, int NewChunkHeight)
+{
+	pArea = pNewArea;
+	ChunkWidth = NewChunkWidth;
+	ChunkHeight = NewChunkHeight;
+	SearchGeneration = 0;
+	NumBuilt = 0;
+	Missing = FALSE;
+
+	Chunks = new PORTAL_CHUNK_T *[ChunkWidth * ChunkHeight];
+	memset(Chunks, 0, sizeof(PORTAL_CHUNK_T *) * ChunkWidth * ChunkHeight);
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+void PathGraph::Clear()
+{
+	int n;
+	for(n = 0; n < ChunkWidth * ChunkHeight; n++)
+	{
+		if(Chunks[n])
+		{
+			if(Chunks[n]->Edges)
+			{
+				delete[] Chunks[n]->Edges;
+			}
+			delete Chunks[n];
+			Chunks[n] = NULL;
+		}
+	}
+	NumBuilt = 0;
+}
+
+PathGraph::~PathGraph()
+{
+	Clear();
+	delete[] Chunks;
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+PORTAL_CHUNK_T *PathGraph::GetPortals(int ChunkX, int ChunkY)
+{
+	if(ChunkX < 0 || ChunkY < 0 || ChunkX >= ChunkWidth || ChunkY >= ChunkHeight)
+	{
+		return NULL;
+	}
+
+	PORTAL_CHUNK_T *pPortals;
+	pPortals = Chunks[ChunkX + ChunkY * ChunkWidth];
+
+	//the running search holds indices into the portals of chunks it has
+	//reached, those stay as they are until it is done
+	if(pPortals && pPortals->Dirty && pPortals->SearchGeneration == SearchGeneration)
+	{
+		return pPortals;
+	}
+
+	if(!pPortals || pPortals->Dirty)
+	{
+		if(!BuildChunk(ChunkX, ChunkY))
+		{
+			Missing = TRUE;
+			return NULL;
+		}
+		pPortals = Chunks[ChunkX + ChunkY * ChunkWidth];
+	}
+	return pPortals;
+}
+
+int PathGraph::FindPortal(PORTAL_CHUNK_T *pPortals, int x, int y)
+{
+	int n;
+	for(n = 0; n < pPortals->NumPortals; n++)
+	{
+		if(pPortals->Portals[n].x == x && pPortals->Portals[n].y == y)
+		{
+			return n;
+		}
+	}
+	return -1;
+}
+
+//a chunk that isn't in memory is asked of the streamer rather than read
+//here, so the main thread doesn't stall on it and it comes in under the
+//residency budget.  pMissing says whether there is a chunk to wait for
+Chunk *PathGraph::AcquireChunk(int ChunkX, int ChunkY, BOOL *pMissing)
+{
+	*pMissing = FALSE;
+
+	if(ChunkX < 0 || ChunkY < 0 || ChunkX >= ChunkWidth || ChunkY >= ChunkHeight)
+	{
+		return NULL;
+	}
+
+	Chunk *pChunk;
+	pChunk = pArea->GetChunk(ChunkX, ChunkY);
+	if(!pChunk && pArea->StaticFile && pArea->Header.ChunkOffsets[ChunkX + ChunkY * ChunkWidth])
+	{
+		*pMissing = TRUE;
+		if(pArea->pStreamer)
+		{
+			pArea->pStreamer->Want(ChunkX, ChunkY);
+		}
+	}
+	return pChunk;
+}
+
+ROUTE_T PathGraph::FindRoute(int x1, int y1, int x2, int y2, int MaxChunks, int *pWayX, int *pWayY)
+{
+	int StartChunkX = x1 / CHUNK_TILE_WIDTH;
+	int StartChunkY = y1 / CHUNK_TILE_HEIGHT;
+	int GoalChunkX = x2 / CHUNK_TILE_WIDTH;
+	int GoalChunkY = y2 / CHUNK_TILE_HEIGHT;
+
+	if(abs(GoalChunkX - StartChunkX) <= MaxChunks && abs(GoalChunkY - StartChunkY) <= MaxChunks)
+	{
+		*pWayX = x2;
+		*pWayY = y2;
+		return ROUTE_FOUND;
+	}
+
+	//a new generation first, so nothing from the last search is held back
+	//from a rebuild
+	SearchGeneration++;
+	if(!SearchGeneration)
+	{
+		int n;
+		for(n = 0; n < ChunkWidth * ChunkHeight; n++)
+		{
+			if(Chunks[n])
+			{
+				Chunks[n]->SearchGeneration = 0;
+			}
+		}
+		SearchGeneration = 1;
+	}
+
+	Missing = FALSE;
+
+	PORTAL_CHUNK_T *pStart;
+	PORTAL_CHUNK_T *pGoal;
+	pStart = GetPortals(StartChunkX, StartChunkY);
+	pGoal = GetPortals(GoalChunkX, GoalChunkY);
+
+	//walking costs from the start and goal tiles to the portals of their chunks
+	unsigned short StartCosts[CHUNK_TILES];
+	unsigned short GoalCosts[CHUNK_TILES];
+	Chunk *pStartChunk;
+	Chunk *pGoalChunk;
+	BOOL StartMissing;
+	BOOL GoalMissing;
+
+	pStartChunk = AcquireChunk(StartChunkX, StartChunkY, &StartMissing);
+	pGoalChunk = AcquireChunk(GoalChunkX, GoalChunkY, &GoalMissing);
+
+	if(Missing || StartMissing || GoalMissing)
+	{
+		return ROUTE_NOT_RESIDENT;
+	}
+
+	if(!pStart || !pGoal || !pStart->NumPortals || !pGoal->NumPortals || !pStartChunk || !pGoalChunk)
+	{
+		return ROUTE_NONE;
+	}
+
+	LocalCosts(pStartChunk, x1 % CHUNK_TILE_WIDTH, y1 % CHUNK_TILE_HEIGHT, StartCosts);
+	LocalCosts(pGoalChunk, x2 % CHUNK_TILE_WIDTH, y2 % CHUNK_TILE_HEIGHT, GoalCosts);
+
+	NumGraphNodes = 0;
+	GraphOpenCount = 0;
+
+	//the goal gets its own node so it can be reached from any goal chunk portal
+	GraphGoalNode = NumGraphNodes++;
+	GraphNodes[GraphGoalNode].ChunkIndex = GRAPH_GOAL_NODE;
+	GraphNodes[GraphGoalNode].Portal = 0;
+	GraphNodes[GraphGoalNode].Gone = 0x7FFFFFFF;
+	GraphNodes[GraphGoalNode].Value = 0x7FFFFFFF;
+	GraphNodes[GraphGoalNode].Parent = -1;
+	GraphNodes[GraphGoalNode].HeapIndex = NODE_CLOSED;
+
+	int StartIndex = StartChunkX + StartChunkY * ChunkWidth;
+	int GoalIndex = GoalChunkX + GoalChunkY * ChunkWidth;
+	int n;
+	int Node;
+	int Cost;
+	PORTAL_T *pPortal;
+	PORTAL_CHUNK_T *pPortals;
+	int ChunkX;
+	int ChunkY;
+
+	pStart->SearchGeneration = SearchGeneration;
+	memset(pStart->SearchNode, 0xFF, sizeof(pStart->SearchNode));
+
+	for(n = 0; n < pStart->NumPortals; n++)
+	{
+		pPortal = &pStart->Portals[n];
+		Cost = StartCosts[pPortal->x + pPortal->y * CHUNK_TILE_WIDTH];
+		if(Cost == PORTAL_NO_ROUTE)
+		{
+			continue;
+		}
+		Node = NumGraphNodes++;
+		GraphNodes[Node].ChunkIndex = StartIndex;
+		GraphNodes[Node].Portal = n;
+		GraphNodes[Node].Gone = Cost;
+		GraphNodes[Node].Value = Cost + GraphDistance(StartChunkX * CHUNK_TILE_WIDTH + pPortal->x, StartChunkY * CHUNK_TILE_HEIGHT + pPortal->y, x2, y2);
+		GraphNodes[Node].Parent = -1;
+		GraphNodes[Node].HeapIndex = NODE_CLOSED;
+		pStart->SearchNode[n] = Node;
+		GraphAddToOpen(Node);
+	}
+
+	int Current;
+	int ToChunk;
+	int ToPortal;
+	int ToX;
+	int ToY;
+	int Gone;
+	PORTAL_CHUNK_T *pTo;
+
+	while(GraphOpenCount)
+	{
+		Current = GraphPopOpen();
+
+		if(Current == GraphGoalNode)
+		{
+			break;
+		}
+
+		pPortals = Chunks[GraphNodes[Current].ChunkIndex];
+		pPortal = &pPortals->Portals[GraphNodes[Current].Portal];
+		ChunkX = GraphNodes[Current].ChunkIndex % ChunkWidth;
+		ChunkY = GraphNodes[Current].ChunkIndex / ChunkWidth;
+
+		//finish at the goal tile
+		if(GraphNodes[Current].ChunkIndex == GoalIndex)
+		{
+			Cost = GoalCosts[pPortal->x + pPortal->y * CHUNK_TILE_WIDTH];
+			if(Cost != PORTAL_NO_ROUTE && GraphNodes[Current].Gone + Cost < GraphNodes[GraphGoalNode].Gone)
+			{
+				GraphNodes[GraphGoalNode].Gone = GraphNodes[Current].Gone + Cost;
+				GraphNodes[GraphGoalNode].Value = GraphNodes[GraphGoalNode].Gone;
+				GraphNodes[GraphGoalNode].Parent = Current;
+				GraphAddToOpen(GraphGoalNode);
+			}
+		}
+
+		//step across the border into the neighbouring chunk
+		ToChunk = -1;
+		ToX = pPortal->x;
+		ToY = pPortal->y;
+		switch(pPortal->Side)
+		{
+		case PORTAL_NORTH:
+			pTo = GetPortals(ChunkX, ChunkY - 1);
+			ToChunk = GraphNodes[Current].ChunkIndex - ChunkWidth;
+			ToY = CHUNK_TILE_HEIGHT - 1;
+			break;
+		case PORTAL_SOUTH:
+			pTo = GetPortals(ChunkX, ChunkY + 1);
+			ToChunk = GraphNodes[Current].ChunkIndex + ChunkWidth;
+			ToY = 0;
+			break;
+		case PORTAL_WEST:
+			pTo = GetPortals(ChunkX - 1, ChunkY);
+			ToChunk = GraphNodes[Current].ChunkIndex - 1;
+			ToX = CHUNK_TILE_WIDTH - 1;
+			break;
+		default:
+			pTo = GetPortals(ChunkX + 1, ChunkY);
+			ToChunk = GraphNodes[Current].ChunkIndex + 1;
+			ToX = 0;
+			break;
+		}
+
+		for(n = -1; n < pPortal->NumEdges; n++)
+		{
+			if(n < 0)
+			{
+				if(!pTo)
+				{
+					continue;
+				}
+				ToPortal = FindPortal(pTo, ToX, ToY);
+				if(ToPortal < 0)
+				{
+					continue;
+				}
+				Gone = GraphNodes[Current].Gone + 10;
+			}
+			else
+			{
+				pTo = pPortals;
+				ToChunk = GraphNodes[Current].ChunkIndex;
+				ToPortal = pPortals->Edges[pPortal->FirstEdge + n].To;
+				Gone = GraphNodes[Current].Gone + pPortals->Edges[pPortal->FirstEdge + n].Cost;
+			}
+
+			if(pTo->SearchGeneration == SearchGeneration && pTo->SearchNode[ToPortal] >= 0)
+			{
+				Node = pTo->SearchNode[ToPortal];
+				if(GraphNodes[Node].Gone <= Gone)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				if(NumGraphNodes >= MAX_GRAPH_SEARCH_NODES)
+				{
+					continue;
+				}
+				if(pTo->SearchGeneration != SearchGeneration)
+				{
+					pTo->SearchGeneration = SearchGeneration;
+					memset(pTo->SearchNode, 0xFF, sizeof(pTo->SearchNode));
+				}
+				Node = NumGraphNodes++;
+				GraphNodes[Node].ChunkIndex = ToChunk;
+				GraphNodes[Node].Portal = ToPortal;
+				GraphNodes[Node].HeapIndex = NODE_CLOSED;
+				pTo->SearchNode[ToPortal] = Node;
+			}
+
+			GraphNodes[Node].Gone = Gone;
+			GraphNodes[Node].Value = Gone + GraphDistance((ToChunk % ChunkWidth) * CHUNK_TILE_WIDTH + pTo->Portals[ToPortal].x,
+															(ToChunk / ChunkWidth) * CHUNK_TILE_HEIGHT + pTo->Portals[ToPortal].y,
+															x2, y2);
+			GraphNodes[Node].Parent = Current;
+			GraphAddToOpen(Node);
+		}
+	}
+
+	//a chunk the search wanted to cross wasn't there, the route found
+	//without it may not be the one to take.  everything it asked for is
+	//on its way for the next try
+	if(Missing)
+	{
+		return ROUTE_NOT_RESIDENT;
+	}
+
+	if(GraphNodes[GraphGoalNode].Parent < 0)
+	{
+		return ROUTE_NONE;
+	}
+
+	//walk back to the start, remembering the last portal before the route first
+	//leaves the refine window
+	int Way = -1;
+	Node = GraphNodes[GraphGoalNode].Parent;
+	while(Node >= 0)
+	{
+		ChunkX = GraphNodes[Node].ChunkIndex % ChunkWidth;
+		ChunkY = GraphNodes[Node].ChunkIndex / ChunkWidth;
+		if(abs(ChunkX - StartChunkX) > MaxChunks || abs(ChunkY - StartChunkY) > MaxChunks)
+		{
+			Way = -1;
+		}
+		else
+		if(Way < 0)
+		{
+			Way = Node;
+		}
+		Node = GraphNodes[Node].Parent;
+	}
+
+	if(Way < 0)
+	{
+		return ROUTE_NONE;
+	}
+
+	pPortals = Chunks[GraphNodes[Way].ChunkIndex];
+	*pWayX = (GraphNodes[Way].ChunkIndex % ChunkWidth) * CHUNK_TILE_WIDTH + pPortals->Portals[GraphNodes[Way].Portal].x;
+	*pWayY = (GraphNodes[Way].ChunkIndex / ChunkWidth) * CHUNK_TILE_HEIGHT + pPortals->Portals[GraphNodes[Way].Portal].y;
+
+	return ROUTE_FOUND;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************ Mutators ************************************************
+
+//dijkstra over the tiles of one chunk, PORTAL_NO_ROUTE where unreachable
+void PathGraph::LocalCosts(Chunk *pChunk, int StartX, int StartY, unsigned short *pCosts)
+{
+	//every tile can be pushed once per neighbour
+	int Heap[CHUNK_TILES * 8];
+	int HeapCost[CHUNK_TILES * 8];
+	int HeapCount = 0;
+	int n;
+	int Index;
+	int Child;
+	int Tile;
+	int TileCost;
+	int x, y, ToX, ToY;
+	int Step;
+	int TempTile;
+	int TempCost;
+
+	static const int StepX[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	static const int StepY[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+	for(n = 0; n < CHUNK_TILES; n++)
+	{
+		pCosts[n] = PORTAL_NO_ROUTE;
+	}
+
+	if(pChunk->GetBlocking(StartX, StartY))
+	{
+		return;
+	}
+
+	pCosts[StartX + StartY * CHUNK_TILE_WIDTH] = 0;
+	Heap[0] = StartX + StartY * CHUNK_TILE_WIDTH;
+	HeapCost[0] = 0;
+	HeapCount = 1;
+
+	while(HeapCount)
+	{
+		Tile = Heap[0];
+		TileCost = HeapCost[0];
+
+		//pop
+		HeapCount--;
+		Heap[0] = Heap[HeapCount];
+		HeapCost[0] = HeapCost[HeapCount];
+		Index = 0;
+		while((Child = Index * 2 + 1) < HeapCount)
+		{
+			if(Child + 1 < HeapCount && HeapCost[Child + 1] < HeapCost[Child])
+			{
+				Child++;
+			}
+			if(HeapCost[Index] <= HeapCost[Child])
+			{
+				break;
+			}
+			TempTile = Heap[Index]; Heap[Index] = Heap[Child]; Heap[Child] = TempTile;
+			TempCost = HeapCost[Index]; HeapCost[Index] = HeapCost[Child]; HeapCost[Child] = TempCost;
+			Index = Child;
+		}
+
+		//stale entry, a cheaper one was already expanded
+		if(TileCost > pCosts[Tile])
+		{
+			continue;
+		}
+
+		x = Tile % CHUNK_TILE_WIDTH;
+		y = Tile / CHUNK_TILE_WIDTH;
+
+		for(n = 0; n < 8; n++)
+		{
+			ToX = x + StepX[n];
+			ToY = y + StepY[n];
+			if(ToX < 0 || ToY < 0 || ToX >= CHUNK_TILE_WIDTH || ToY >= CHUNK_TILE_HEIGHT)
+			{
+				continue;
+			}
+			if(pChunk->GetBlocking(ToX, ToY))
+			{
+				continue;
+			}
+			if(fabs(pChunk->GetHeight(ToX, ToY) - pChunk->GetHeight(x, y)) > MAX_HEIGHT_DIFFERENCE)
+			{
+				continue;
+			}
+			if(StepX[n] && StepY[n])
+			{
+				//same corner rule as CanTravel
+				if(pChunk->GetBlocking(x, ToY) && pChunk->GetBlocking(ToX, y))
+				{
+					continue;
+				}
+				Step = 14;
+			}
+			else
+			{
+				Step = 10;
+			}
+
+			if(TileCost + Step >= pCosts[ToX + ToY * CHUNK_TILE_WIDTH])
+			{
+				continue;
+			}
+			pCosts[ToX + ToY * CHUNK_TILE_WIDTH] = (unsigned short)(TileCost + Step);
+
+			//push
+			Index = HeapCount++;
+			Heap[Index] = ToX + ToY * CHUNK_TILE_WIDTH;
+			HeapCost[Index] = TileCost + Step;
+			while(Index > 0 && HeapCost[(Index - 1) / 2] > HeapCost[Index])
+			{
+				Child = (Index - 1) / 2;
+				TempTile = Heap[Index]; Heap[Index] = Heap[Child]; Heap[Child] = TempTile;
+				TempCost = HeapCost[Index]; HeapCost[Index] = HeapCost[Child]; HeapCost[Child] = TempCost;
+				Index = Child;
+			}
+		}
+	}
+}
+
+//FALSE if the chunk or a neighbour has to be waited for, the entry is
+//left as it was
+BOOL PathGraph::BuildChunk(int ChunkX, int ChunkY)
+{
+	Chunk *pChunk;
+	Chunk *Neighbours[4];
+	BOOL ChunkMissing;
+	BOOL NeighbourMissing;
+	BOOL AnyMissing;
+	int Side;
+	int NeighbourX;
+	int NeighbourY;
+
+	pChunk = AcquireChunk(ChunkX, ChunkY, &ChunkMissing);
+	AnyMissing = ChunkMissing;
+
+	//every side is needed before anything is built
+	for(Side = PORTAL_NORTH; Side <= PORTAL_WEST; Side++)
+	{
+		NeighbourX = ChunkX;
+		NeighbourY = ChunkY;
+		switch(Side)
+		{
+		case PORTAL_NORTH:
+			NeighbourY--;
+			break;
+		case PORTAL_EAST:
+			NeighbourX++;
+			break;
+		case PORTAL_SOUTH:
+			NeighbourY++;
+			break;
+		case PORTAL_WEST:
+			NeighbourX--;
+			break;
+		}
+		Neighbours[Side] = AcquireChunk(NeighbourX, NeighbourY, &NeighbourMissing);
+		if(NeighbourMissing)
+		{
+			AnyMissing = TRUE;
+		}
+	}
+
+	if(AnyMissing)
+	{
+		return FALSE;
+	}
+
+	PORTAL_CHUNK_T *pPortals;
+	pPortals = Chunks[ChunkX + ChunkY * ChunkWidth];
+
+	if(!pPortals)
+	{
+		pPortals = new PORTAL_CHUNK_T;
+		memset(pPortals, 0, sizeof(PORTAL_CHUNK_T));
+		Chunks[ChunkX + ChunkY * ChunkWidth] = pPortals;
+		NumBuilt++;
+	}
+
+	if(pPortals->Edges)
+	{
+		delete[] pPortals->Edges;
+		pPortals->Edges = NULL;
+	}
+	pPortals->NumEdges = 0;
+	pPortals->NumPortals = 0;
+	pPortals->Dirty = FALSE;
+
+	//an empty chunk has no portals
+	if(!pChunk)
+	{
+		return TRUE;
+	}
+
+	int n;
+	int RunStart;
+	BOOL Open;
+	Chunk *pNeighbour;
+	int ax, ay, bx, by;
+
+	for(Side = PORTAL_NORTH; Side <= PORTAL_WEST; Side++)
+	{
+		pNeighbour = Neighbours[Side];
+		if(!pNeighbour)
+		{
+			continue;
+		}
+
+		//each unbroken run of open border tiles becomes one portal at its middle
+		RunStart = -1;
+		for(n = 0; n <= CHUNK_TILE_WIDTH; n++)
+		{
+			Open = FALSE;
+			if(n < CHUNK_TILE_WIDTH)
+			{
+				switch(Side)
+				{
+				case PORTAL_NORTH:
+					ax = n; ay = 0; bx = n; by = CHUNK_TILE_HEIGHT - 1;
+					break;
+				case PORTAL_EAST:
+					ax = CHUNK_TILE_WIDTH - 1; ay = n; bx = 0; by = n;
+					break;
+				case PORTAL_SOUTH:
+					ax = n; ay = CHUNK_TILE_HEIGHT - 1; bx = n; by = 0;
+					break;
+				default:
+					ax = 0; ay = n; bx = CHUNK_TILE_WIDTH - 1; by = n;
+					break;
+				}
+				Open = !pChunk->GetBlocking(ax, ay) &&
+						 !pNeighbour->GetBlocking(bx, by) &&
+						 fabs(pChunk->GetHeight(ax, ay) - pNeighbour->GetHeight(bx, by)) <= MAX_HEIGHT_DIFFERENCE;
+			}
+
+			if(Open && RunStart < 0)
+			{
+				RunStart = n;
+			}
+			else
+			if(!Open && RunStart >= 0 && pPortals->NumPortals >= MAX_CHUNK_PORTALS)
+			{
+				LogPrintf(LOG_WARNING, LOG_WORLD, "chunk %i, %i has more than %i portals", ChunkX, ChunkY, MAX_CHUNK_PORTALS);
+				RunStart = -1;
+			}
+			else
+			if(!Open && RunStart >= 0)
+			{
+				PORTAL_T *pPortal;
+				pPortal = &pPortals->Portals[pPortals->NumPortals++];
+				switch(Side)
+				{
+				case PORTAL_NORTH:
+					pPortal->x = (BYTE)((RunStart + n - 1) / 2);
+					pPortal->y = 0;
+					break;
+				case PORTAL_EAST:
+					pPortal->x = CHUNK_TILE_WIDTH - 1;
+					pPortal->y = (BYTE)((RunStart + n - 1) / 2);
+					break;
+				case PORTAL_SOUTH:
+					pPortal->x = (BYTE)((RunStart + n - 1) / 2);
+					pPortal->y = CHUNK_TILE_HEIGHT - 1;
+					break;
+				default:
+					pPortal->x = 0;
+					pPortal->y = (BYTE)((RunStart + n - 1) / 2);
+					break;
+				}
+				pPortal->Side = (BYTE)Side;
+				pPortal->NumEdges = 0;
+				pPortal->FirstEdge = 0;
+				RunStart = -1;
+			}
+		}
+	}
+
+	//connect the portals through the inside of the chunk
+	PORTAL_EDGE_T Edges[MAX_CHUNK_PORTALS * MAX_CHUNK_PORTALS];
+	unsigned short Costs[CHUNK_TILES];
+	int To;
+	unsigned short Cost;
+
+	for(n = 0; n < pPortals->NumPortals; n++)
+	{
+		LocalCosts(pChunk, pPortals->Portals[n].x, pPortals->Portals[n].y, Costs);
+		pPortals->Portals[n].FirstEdge = (short)pPortals->NumEdges;
+		for(To = 0; To < pPortals->NumPortals; To++)
+		{
+			Cost = Costs[pPortals->Portals[To].x + pPortals->Portals[To].y * CHUNK_TILE_WIDTH];
+			if(To != n && Cost != PORTAL_NO_ROUTE)
+			{
+				Edges[pPortals->NumEdges].To = (BYTE)To;
+				Edges[pPortals->NumEdges].Cost = Cost;
+				pPortals->NumEdges++;
+				pPortals->Portals[n].NumEdges++;
+			}
+		}
+	}
+
+	if(pPortals->NumEdges)
+	{
+		pPortals->Edges = new PORTAL_EDGE_T[pPortals->NumEdges];
+		memcpy(pPortals->Edges, Edges, sizeof(PORTAL_EDGE_T) * pPortals->NumEdges);
+	}
+
+	return TRUE;
+}
+
+//a change anywhere in a chunk can alter its border runs, which the
+//neighbours share
+void PathGraph::InvalidateChunk(int ChunkX, int ChunkY)
+{
+	int xn;
+	int yn;
+	for(yn = ChunkY - 1; yn <= ChunkY + 1; yn++)
+	for(xn = ChunkX - 1; xn <= ChunkX + 1; xn++)
+	{
+		if(xn >= 0 && yn >= 0 && xn < ChunkWidth && yn < ChunkHeight &&
+			(xn == ChunkX || yn == ChunkY) &&
+			Chunks[xn + yn * ChunkWidth])
+		{
+			Chunks[xn + yn * ChunkWidth]->Dirty = TRUE;
+		}
+	}
+}
+
+void PathGraph::InvalidateTile(int x, int y)
+{
+	int ChunkX = x / CHUNK_TILE_WIDTH;
+	int ChunkY = y / CHUNK_TILE_HEIGHT;
+	int TileX = x % CHUNK_TILE_WIDTH;
+	int TileY = y % CHUNK_TILE_HEIGHT;
+
+	if(ChunkX < 0 || ChunkY < 0 || ChunkX >= ChunkWidth || ChunkY >= ChunkHeight)
+	{
+		return;
+	}
+
+	if(Chunks[ChunkX + ChunkY * ChunkWidth])
+	{
+		Chunks[ChunkX + ChunkY * ChunkWidth]->Dirty = TRUE;
+	}
+
+	//border tiles also belong to the neighbour's portals
+	if(TileX == 0 && ChunkX > 0 && Chunks[ChunkX - 1 + ChunkY * ChunkWidth])
+	{
+		Chunks[ChunkX - 1 + ChunkY * ChunkWidth]->Dirty = TRUE;
+	}
+	if(TileX == CHUNK_TILE_WIDTH - 1 && ChunkX < ChunkWidth - 1 && Chunks[ChunkX + 1 + ChunkY * ChunkWidth])
+	{
+		Chunks[ChunkX + 1 + ChunkY * ChunkWidth]->Dirty = TRUE;
+	}
+	if(TileY == 0 && ChunkY > 0 && Chunks[ChunkX + (ChunkY - 1) * ChunkWidth])
+	{
+		Chunks[ChunkX + (ChunkY - 1) * ChunkWidth]->Dirty = TRUE;
+	}
+	if(TileY == CHUNK_TILE_HEIGHT - 1 && ChunkY < ChunkHeight - 1 && Chunks[ChunkX + (ChunkY + 1) * ChunkWidth])
+	{
+		Chunks[ChunkX + (ChunkY + 1) * ChunkWidth]->Dirty = TRUE;
+	}
+}
+
+void PathGraph::BuildAll()
+{
+	int xn;
+	int yn;
+	for(yn = 0; yn < ChunkHeight; yn++)
+	for(xn = 0; xn < ChunkWidth; xn++)
+	{
+		GetPortals(xn, yn);
+	}
+}
+
+//end: Mutators ********************************************************
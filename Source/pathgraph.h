@@ -0,0 +1,140 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				pathgraph.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  chunk level portal graph used to plan long routes
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		diagonal crossings at chunk corners are not portals
+//*********************************************************************
+//*********************************************************************
+#ifndef PATHGRAPH_H
+#define PATHGRAPH_H
+
+#include "defs.h"
+#include "chunks.h"
+
+//preprocessor defs ***********************************************
+
+//separate openings need a closed tile between them
+#define PORTALS_PER_SIDE		((CHUNK_TILE_WIDTH + 1) / 2)
+#define MAX_CHUNK_PORTALS		(PORTALS_PER_SIDE * 4)
+#define MAX_GRAPH_SEARCH_NODES	8192
+
+//routes shorter than this are left to the tile search
+#define LONG_PATH_MIN_DISTANCE	(CHUNK_TILE_WIDTH * 4)
+//how many chunks ahead of the traveller get a tile level path
+#define LONG_PATH_REFINE_CHUNKS	3
+
+typedef enum
+{
+	PORTAL_NORTH = 0,
+	PORTAL_EAST,
+	PORTAL_SOUTH,
+	PORTAL_WEST,
+} PORTAL_SIDE_T;
+
+typedef enum
+{
+	ROUTE_NONE = 0,
+	ROUTE_FOUND,
+	ROUTE_NOT_RESIDENT,	//a chunk on the way isn't in memory yet, it has been asked for
+} ROUTE_T;
+
+typedef struct
+{
+	BYTE To;	//portal index within the same chunk
+	unsigned short Cost;
+} PORTAL_EDGE_T;
+
+typedef struct
+{
+	BYTE x;	//tile within the chunk
+	BYTE y;
+	BYTE Side;
+	BYTE NumEdges;
+	short FirstEdge;
+} PORTAL_T;
+
+typedef struct
+{
+	BOOL Dirty;
+	int NumPortals;
+	PORTAL_T Portals[MAX_CHUNK_PORTALS];
+	int NumEdges;
+	PORTAL_EDGE_T *Edges;
+
+	//search bookkeeping, only valid when the generation matches
+	unsigned int SearchGeneration;
+	short SearchNode[MAX_CHUNK_PORTALS];
+} PORTAL_CHUNK_T;
+
+class Area;
+class Chunk;
+
+//*******************************CLASS********************************
+//**************          PathGraph              *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Keep the portals along every chunk border and the cost of
+//*			 walking between them inside the chunk, so long routes can
+//*			 be planned a chunk at a time.
+//********************************************************************
+//*Invariants: a chunk entry is either NULL (never built), dirty, or
+//*				 matches the blocking and heights of the chunk and its
+//*				 four neighbours.  Only resident chunks are built, the rest
+//*				 are asked of the area's streamer.  An entry is not rebuilt
+//*				 while a search is using it.
+//********************************************************************
+class PathGraph
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	Area *pArea;
+	int ChunkWidth;
+	int ChunkHeight;
+	PORTAL_CHUNK_T **Chunks;
+	unsigned int SearchGeneration;
+	int NumBuilt;
+	//set by GetPortals when a chunk couldn't be built for want of memory
+	BOOL Missing;
+
+	PORTAL_CHUNK_T *GetPortals(int ChunkX, int ChunkY);
+	BOOL BuildChunk(int ChunkX, int ChunkY);
+	Chunk *AcquireChunk(int ChunkX, int ChunkY, BOOL *pMissing);
+	int FindPortal(PORTAL_CHUNK_T *pPortals, int x, int y);
+	void LocalCosts(Chunk *pChunk, int StartX, int StartY, unsigned short *pCosts);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetNumBuilt() { return NumBuilt; }
+
+	//plan from one tile to another, returning the furthest point along the
+	//route that lies within MaxChunks chunks of the start
+	ROUTE_T FindRoute(int x1, int y1, int x2, int y2, int MaxChunks, int *pWayX, int *pWayY);
+
+// Mutators -----------------------------------------
+	void InvalidateChunk(int ChunkX, int ChunkY);
+	void InvalidateTile(int x, int y);
+	//builds what is resident, the rest is asked for
+	void BuildAll();
+	void Clear();
+
+// Constructors ---------------------------------------
+	PathGraph(Area *pNewArea, int NewChunkWidth, int NewChunkHeight);
+
+// Destructor -----------------------------------------
+	~PathGraph();
+
+};
+
+#endif
@@ -0,0 +1,466 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				profiler.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  timed zones around the main parts of a frame, shown as a
+//*			 text overlay or captured to a trace file that chrome://tracing
+//*			 reads
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		a capture that fills a thread's buffer loses the rest of that
+//*		thread's zones, the count lost goes in the file
+//*********************************************************************
+//*********************************************************************
+#include "profiler.h"
+#include "zsutilities.h"
+#include <stdlib.h>
+#include <string.h>
+
+volatile BOOL ProfileOn = FALSE;
+
+static PROFILE_BUFFER_T Buffers[PROFILE_MAX_THREADS];
+//one past the highest buffer ever taken
+static volatile LONG NumBuffers = 0;
+static __declspec(thread) PROFILE_BUFFER_T *pThreadBuffer = NULL;
+
+static BOOL Overlay = FALSE;
+static BOOL Totals = FALSE;
+static volatile LONG Capturing = FALSE;
+static LONGLONG CaptureStart = 0;
+
+//what each buffer's totals were at the last refresh
+static LONGLONG LastTime[PROFILE_MAX_THREADS][PROFILE_NUM_ZONES];
+static LONG LastCalls[PROFILE_MAX_THREADS][PROFILE_NUM_ZONES];
+static int OverlayFrames = 0;
+static char OverlayText[PROFILE_OVERLAY_LENGTH];
+
+static const char *ZoneNames[PROFILE_NUM_ZONES] =
+{
+	"World::Update",
+	"area update",
+	"Area::Draw",
+	"Combat::Update",
+	"Path::Find",
+	"ScriptBlock::Process",
+	"Chunk::Load",
+	"Creature::Update",
+	"asset lookup",
+	"OffScreenSim::Update"
+};
+
+//************** Zones  ***********************************************
+
+static PROFILE_BUFFER_T *GetBuffer()
+{
+	PROFILE_BUFFER_T *pBuffer;
+	LONG Num;
+	int n;
+	int zn;
+
+	if(!pThreadBuffer)
+	{
+		for(n = 0; n < PROFILE_MAX_THREADS; n++)
+		{
+			if(!Buffers[n].InUse && InterlockedCompareExchange(&Buffers[n].InUse, 1, 0) == 0)
+			{
+				break;
+			}
+		}
+		if(n >= PROFILE_MAX_THREADS)
+		{
+			return NULL;
+		}
+
+		//the last owner may have been stopped inside a zone
+		pBuffer = &Buffers[n];
+		pBuffer->ThreadID = GetCurrentThreadId();
+		pBuffer->Depth = 0;
+		for(zn = 0; zn < PROFILE_NUM_ZONES; zn++)
+		{
+			pBuffer->ZoneDepth[zn] = 0;
+		}
+
+		Num = NumBuffers;
+		while(Num <= n && InterlockedCompareExchange(&NumBuffers, n + 1, Num) != Num)
+		{
+			Num = NumBuffers;
+		}
+		pThreadBuffer = pBuffer;
+	}
+	return pThreadBuffer;
+}
+
+void ProfileThreadDone()
+{
+	if(pThreadBuffer)
+	{
+		pThreadBuffer = NULL;
+		ProfileReleaseThread(GetCurrentThreadId());
+	}
+}
+
+void ProfileReleaseThread(DWORD ThreadID)
+{
+	int n;
+
+	for(n = 0; n < PROFILE_MAX_THREADS; n++)
+	{
+		if(Buffers[n].InUse && Buffers[n].ThreadID == ThreadID)
+		{
+			Buffers[n].ThreadID = 0;
+			InterlockedExchange(&Buffers[n].Busy, FALSE);
+			InterlockedExchange(&Buffers[n].InUse, 0);
+			return;
+		}
+	}
+}
+
+PROFILE_BUFFER_T *ProfileEnter(int Zone)
+{
+	PROFILE_BUFFER_T *pBuffer;
+
+	pBuffer = GetBuffer();
+	if(!pBuffer)
+	{
+		return NULL;
+	}
+
+	//a thread that turns up mid capture gets its events here
+	if(Capturing && !pBuffer->Events)
+	{
+		InterlockedExchange(&pBuffer->Busy, TRUE);
+		if(Capturing && !pBuffer->Events)
+		{
+			pBuffer->Events = new PROFILE_EVENT_T[PROFILE_BUFFER_SIZE];
+		}
+		InterlockedExchange(&pBuffer->Busy, FALSE);
+	}
+
+	pBuffer->Depth++;
+	pBuffer->ZoneDepth[Zone]++;
+	return pBuffer;
+}
+
+void ProfileLeave(PROFILE_BUFFER_T *pBuffer, int Zone, LONGLONG Start)
+{
+	LARGE_INTEGER End;
+	PROFILE_EVENT_T *pEvent;
+	LONG Num;
+
+	QueryPerformanceCounter(&End);
+
+	pBuffer->Depth--;
+	pBuffer->ZoneDepth[Zone]--;
+	if(!pBuffer->ZoneDepth[Zone])
+	{
+		pBuffer->ZoneTime[Zone] += End.QuadPart - Start;
+		pBuffer->ZoneCalls[Zone]++;
+	}
+
+	//Capturing is looked at again once Busy is held, after that the
+	//capture can't be stopped under us
+	if(Capturing)
+	{
+		InterlockedExchange(&pBuffer->Busy, TRUE);
+		if(Capturing && pBuffer->Events)
+		{
+			Num = pBuffer->NumEvents;
+			if(Num < PROFILE_BUFFER_SIZE)
+			{
+				pEvent = &pBuffer->Events[Num];
+				pEvent->Start = Start;
+				pEvent->End = End.QuadPart;
+				pEvent->Zone = (WORD)Zone;
+				pEvent->Depth = (WORD)pBuffer->Depth;
+				pEvent->ThreadID = pBuffer->ThreadID;
+				InterlockedExchange((LONG *)&pBuffer->NumEvents, Num + 1);
+			}
+			else
+			{
+				pBuffer->NumLost++;
+			}
+		}
+		InterlockedExchange(&pBuffer->Busy, FALSE);
+	}
+}
+
+//************** Totals  **********************************************
+
+void ProfileKeepTotals(BOOL On)
+{
+	Totals = On;
+	ProfileOn = Overlay || Capturing || Totals;
+}
+
+LONGLONG ProfileThreadTime(int Zone)
+{
+	PROFILE_BUFFER_T *pBuffer;
+
+	pBuffer = GetBuffer();
+	if(!pBuffer)
+	{
+		return 0;
+	}
+	return pBuffer->ZoneTime[Zone];
+}
+
+//************** Overlay  *********************************************
+
+void ProfileShowOverlay(BOOL On)
+{
+	int Num;
+	int n;
+	int zn;
+
+	Overlay = On;
+	ProfileOn = Overlay || Capturing || Totals;
+
+	//start averaging from now
+	Num = NumBuffers;
+	if(Num > PROFILE_MAX_THREADS)
+	{
+		Num = PROFILE_MAX_THREADS;
+	}
+	for(n = 0; n < Num; n++)
+	{
+		for(zn = 0; zn < PROFILE_NUM_ZONES; zn++)
+		{
+			LastTime[n][zn] = Buffers[n].ZoneTime[zn];
+			LastCalls[n][zn] = Buffers[n].ZoneCalls[zn];
+		}
+	}
+	OverlayFrames = 0;
+	strcpy(OverlayText, "profiling");
+}
+
+BOOL ProfileOverlayOn()
+{
+	return Overlay;
+}
+
+BOOL ProfileEndFrame()
+{
+	LARGE_INTEGER Frequency;
+	LONGLONG Time[PROFILE_NUM_ZONES];
+	LONG Calls[PROFILE_NUM_ZONES];
+	int Order[PROFILE_NUM_ZONES];
+	LONGLONG Now;
+	LONG NowCalls;
+	double ToMS;
+	int Length;
+	int Num;
+	int Temp;
+	int n;
+	int zn;
+
+	if(!Overlay)
+	{
+		return FALSE;
+	}
+
+	OverlayFrames++;
+	if(OverlayFrames < PROFILE_OVERLAY_FRAMES)
+	{
+		return FALSE;
+	}
+
+	//other threads' totals only ever grow, so the difference since the
+	//last refresh is theirs for these frames
+	Num = NumBuffers;
+	if(Num > PROFILE_MAX_THREADS)
+	{
+		Num = PROFILE_MAX_THREADS;
+	}
+	for(zn = 0; zn < PROFILE_NUM_ZONES; zn++)
+	{
+		Time[zn] = 0;
+		Calls[zn] = 0;
+		Order[zn] = zn;
+		for(n = 0; n < Num; n++)
+		{
+			Now = Buffers[n].ZoneTime[zn];
+			NowCalls = Buffers[n].ZoneCalls[zn];
+			Time[zn] += Now - LastTime[n][zn];
+			Calls[zn] += NowCalls - LastCalls[n][zn];
+			LastTime[n][zn] = Now;
+			LastCalls[n][zn] = NowCalls;
+		}
+	}
+
+	//few enough zones to sort them by hand
+	for(n = 1; n < PROFILE_NUM_ZONES; n++)
+	{
+		for(zn = n; zn > 0 && Time[Order[zn]] > Time[Order[zn - 1]]; zn--)
+		{
+			Temp = Order[zn];
+			Order[zn] = Order[zn - 1];
+			Order[zn - 1] = Temp;
+		}
+	}
+
+	QueryPerformanceFrequency(&Frequency);
+	ToMS = 1000.0 / (double)Frequency.QuadPart / (double)OverlayFrames;
+
+	//the font engine breaks lines at a \n written out as two characters
+	Length = sprintf(OverlayText, "ms/frame  calls/frame\\n");
+	for(n = 0; n < PROFILE_OVERLAY_ZONES && n < PROFILE_NUM_ZONES; n++)
+	{
+		zn = Order[n];
+		if(!Calls[zn])
+		{
+			break;
+		}
+		Length += sprintf(&OverlayText[Length], "%6.2f  %5.1f  %s\\n",
+			(double)Time[zn] * ToMS,
+			(double)Calls[zn] / (double)OverlayFrames,
+			ZoneNames[zn]);
+	}
+
+	OverlayFrames = 0;
+	return TRUE;
+}
+
+const char *ProfileGetOverlay()
+{
+	return OverlayText;
+}
+
+//************** Capture  *********************************************
+
+//only once no thread can be writing to them
+static void FreeEvents(int Num)
+{
+	int n;
+
+	for(n = 0; n < Num; n++)
+	{
+		if(Buffers[n].Events)
+		{
+			delete[] Buffers[n].Events;
+			Buffers[n].Events = NULL;
+		}
+		Buffers[n].NumEvents = 0;
+	}
+}
+
+void ProfileStartCapture()
+{
+	LARGE_INTEGER Now;
+	int Num;
+	int n;
+
+	if(Capturing)
+	{
+		return;
+	}
+
+	Num = NumBuffers;
+	if(Num > PROFILE_MAX_THREADS)
+	{
+		Num = PROFILE_MAX_THREADS;
+	}
+	for(n = 0; n < Num; n++)
+	{
+		Buffers[n].NumEvents = 0;
+		Buffers[n].NumLost = 0;
+	}
+
+	QueryPerformanceCounter(&Now);
+	CaptureStart = Now.QuadPart;
+	InterlockedExchange(&Capturing, TRUE);
+	ProfileOn = TRUE;
+}
+
+BOOL ProfileCapturing()
+{
+	return Capturing;
+}
+
+BOOL ProfileStopCapture(const char *FileName)
+{
+	LARGE_INTEGER Frequency;
+	PROFILE_EVENT_T *pEvent;
+	FILE *fp;
+	double ToUS;
+	LONG Lost;
+	LONG NumEvents;
+	BOOL First;
+	int Num;
+	int n;
+	int en;
+
+	if(!Capturing)
+	{
+		return FALSE;
+	}
+
+	InterlockedExchange(&Capturing, FALSE);
+	ProfileOn = Overlay || Totals;
+
+	Num = NumBuffers;
+	if(Num > PROFILE_MAX_THREADS)
+	{
+		Num = PROFILE_MAX_THREADS;
+	}
+
+	//wait out any thread still writing an event it started before the stop
+	for(n = 0; n < Num; n++)
+	{
+		while(Buffers[n].Busy)
+		{
+			Sleep(0);
+		}
+	}
+
+	fp = fopen(FileName, "wt");
+	if(!fp)
+	{
+		DEBUG_INFO("Could not open profile file\n");
+		FreeEvents(Num);
+		return FALSE;
+	}
+
+	QueryPerformanceFrequency(&Frequency);
+	ToUS = 1000000.0 / (double)Frequency.QuadPart;
+
+	//complete events, one per zone, in the trace event format
+	fprintf(fp, "{\"traceEvents\":[\n");
+	First = TRUE;
+	Lost = 0;
+	for(n = 0; n < Num; n++)
+	{
+		if(!Buffers[n].Events)
+		{
+			continue;
+		}
+		NumEvents = Buffers[n].NumEvents;
+		Lost += Buffers[n].NumLost;
+		for(en = 0; en < NumEvents; en++)
+		{
+			pEvent = &Buffers[n].Events[en];
+			//a zone that was already open when the capture started
+			if(pEvent->Start < CaptureStart)
+			{
+				continue;
+			}
+			fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"prelude\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%lu}",
+				First ? "" : ",\n",
+				ZoneNames[pEvent->Zone],
+				(double)(pEvent->Start - CaptureStart) * ToUS,
+				(double)(pEvent->End - pEvent->Start) * ToUS,
+				(unsigned long)pEvent->ThreadID);
+			First = FALSE;
+		}
+	}
+	fprintf(fp, "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"lost\":%ld}}\n", (long)Lost);
+	fclose(fp);
+	FreeEvents(Num);
+
+	LogPrintf(LOG_INFO, LOG_ENGINE, "Profile written to %s, %ld zones lost", FileName, (long)Lost);
+	return TRUE;
+}
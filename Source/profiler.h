@@ -0,0 +1,144 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				profiler.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  timed zones around the main parts of a frame, shown as a
+//*			 text overlay or captured to a trace file that chrome://tracing
+//*			 reads
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		a capture that fills a thread's buffer loses the rest of that
+//*		thread's zones, the count lost goes in the file
+//*********************************************************************
+//*********************************************************************
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <windows.h>
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define PROFILE_MAX_THREADS		16
+//zones each thread keeps during a capture
+#define PROFILE_BUFFER_SIZE		262144
+//zones listed in the overlay
+#define PROFILE_OVERLAY_ZONES	6
+//frames averaged for each refresh of the overlay
+#define PROFILE_OVERLAY_FRAMES	30
+#define PROFILE_OVERLAY_LENGTH	512
+#define PROFILE_FILE_NAME		"profile.json"
+
+typedef enum
+{
+	ZONE_WORLD_UPDATE = 0,
+	ZONE_AREA_UPDATE,
+	ZONE_AREA_DRAW,
+	ZONE_COMBAT_UPDATE,
+	ZONE_PATH,
+	ZONE_SCRIPT,
+	ZONE_CHUNK_LOAD,
+	ZONE_CREATURE_UPDATE,
+	ZONE_ASSET_LOOKUP,
+	ZONE_OFFSCREEN,
+	PROFILE_NUM_ZONES
+} PROFILE_ZONE_T;
+
+typedef struct
+{
+	LONGLONG Start;
+	LONGLONG End;
+	WORD Zone;
+	WORD Depth;
+	//a buffer can change hands mid capture
+	DWORD ThreadID;
+} PROFILE_EVENT_T;
+
+//only the owning thread writes a buffer.  NumEvents is published with an
+//interlocked exchange once the event is filled in.  the owner holds Busy
+//while it touches Events so a capture can be stopped and Events freed.
+//a buffer given back keeps its totals, the overlay only looks at how
+//they grow
+typedef struct
+{
+	volatile LONG InUse;
+	volatile LONG Busy;
+	DWORD ThreadID;
+	int Depth;
+	int ZoneDepth[PROFILE_NUM_ZONES];
+	//outermost calls only, so a zone that calls itself counts once
+	LONGLONG ZoneTime[PROFILE_NUM_ZONES];
+	LONG ZoneCalls[PROFILE_NUM_ZONES];
+	PROFILE_EVENT_T *Events;
+	volatile LONG NumEvents;
+	volatile LONG NumLost;
+} PROFILE_BUFFER_T;
+
+//zones cost a flag test when nothing is looking at them
+extern volatile BOOL ProfileOn;
+
+PROFILE_BUFFER_T *ProfileEnter(int Zone);
+void ProfileLeave(PROFILE_BUFFER_T *pBuffer, int Zone, LONGLONG Start);
+
+//gives the calling thread's buffer back for another thread to take, call
+//it last thing in a thread procedure that has zones.  ProfileReleaseThread
+//does the same for a thread stopped with TerminateThread
+void ProfileThreadDone();
+void ProfileReleaseThread(DWORD ThreadID);
+
+//times the rest of the scope it's declared in as a zone
+class ProfileZone
+{
+private:
+	int Zone;
+	PROFILE_BUFFER_T *pBuffer;
+	LARGE_INTEGER Start;
+
+public:
+	ProfileZone(int NewZone)
+	{
+		pBuffer = NULL;
+		if(ProfileOn)
+		{
+			Zone = NewZone;
+			pBuffer = ProfileEnter(Zone);
+			QueryPerformanceCounter(&Start);
+		}
+	}
+
+	~ProfileZone()
+	{
+		if(pBuffer)
+		{
+			ProfileLeave(pBuffer, Zone, Start.QuadPart);
+		}
+	}
+};
+
+//keeps each thread's zone totals running without the overlay or a
+//capture, for whatever reads them with ProfileThreadTime
+void ProfileKeepTotals(BOOL On);
+//the calling thread's time in the zone so far, outermost calls only, in
+//QueryPerformanceCounter ticks
+LONGLONG ProfileThreadTime(int Zone);
+
+//the overlay averages each zone over the frames between refreshes,
+//summed over every thread
+void ProfileShowOverlay(BOOL On);
+BOOL ProfileOverlayOn();
+//call once a frame, TRUE when the overlay text has changed
+BOOL ProfileEndFrame();
+const char *ProfileGetOverlay();
+
+//a capture keeps every zone until it is stopped and written out, the
+//zones are freed once they are
+void ProfileStartCapture();
+BOOL ProfileCapturing();
+BOOL ProfileStopCapture(const char *FileName);
+
+#endif
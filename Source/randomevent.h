@@ -1,6 +1,8 @@
 #ifndef RANDOMEVENT_H
 #define RANDOMEVENT_H
 
+#include <windows.h>
+
 class RandomEventManager
 {
 private:
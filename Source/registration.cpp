@@ -12,7 +12,12 @@ void GetHardwareID()
 	unsigned char TempID[256];
 	
 	DWORD dwID;
+#ifdef HEADLESS
+	//no volume serial to go on
+	dwID = 0;
+#else
 	GetVolumeInformation("C:\\",NULL,0,&dwID,NULL,NULL,NULL, 0);
+#endif
 
 	char blarg[256];
 	int first = 0;
@@ -61,10 +66,6 @@ inline void GenerateKey(unsigned char *Destination, unsigned char *From)
 
 void GetRegisteredKey()
 {
-	HKEY WindowsIDKey;
-	DWORD Length;
-	HRESULT hResult;
-
 	FILE *fp;
 	
 	
@@ -74,6 +75,19 @@ void GetRegisteredKey()
 	}
 	RegistrationKey[16] = '\0';
 
+#ifdef HEADLESS
+	//no registry, key.bin is all there is
+	fp = fopen ("key.bin","rb");
+	if(fp)
+	{
+		fread(RegistrationKey,sizeof(char),16,fp);
+		fclose(fp);
+	}
+#else
+	HKEY WindowsIDKey;
+	DWORD Length;
+	HRESULT hResult;
+
 	hResult = 
 		RegOpenKeyEx( HKEY_LOCAL_MACHINE,
 			"Software\\ZeroSum\\Prelude",
@@ -114,11 +128,13 @@ void GetRegisteredKey()
 			fclose(fp);
 		}
 	}
+#endif
 
 }
 
 void RegisterKey(unsigned char *toregister)
 {
+#ifndef HEADLESS
 	HKEY WindowsIDKey;
 	DWORD Length;
 	HRESULT hResult;
@@ -157,6 +173,7 @@ void RegisterKey(unsigned char *toregister)
 	RegFlushKey(WindowsIDKey);
 	
 	RegCloseKey(WindowsIDKey);
+#endif
 
 	FILE *fp;
 	fp = fopen("key.bin","wb");
@@ -168,7 +185,7 @@ void RegisterKey(unsigned char *toregister)
 
 }
 
-inline BOOL ValidateKey(unsigned char *keytovalidate)
+BOOL ValidateKey(unsigned char *keytovalidate)
 {
    unsigned char TempKey[64];
    unsigned char *vkey;
@@ -211,6 +228,7 @@ void MaskStrings(unsigned char *string, unsigned char *mask, unsigned char *resu
 	result[Length] = '\0';
 }
 
+#ifndef HEADLESS
 //---------------------------------------------------------------------
 LRESULT CALLBACK DlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
@@ -274,6 +292,7 @@ LRESULT CALLBACK DlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 
     return FALSE;
 }
+#endif
 
 
 
@@ -286,7 +305,12 @@ HRESULT Register()
 	GetRegisteredKey();
 	if (!ValidateKey(RegistrationKey))
 	{
+#ifdef HEADLESS
+		//nobody to ask, carry on as the trial version
+		hres = IDOK;
+#else
 		hres = DialogBox(NULL, (LPSTR)MAKEINTRESOURCE(IDD_DIALOG1), NULL, (DLGPROC)DlgProc);
+#endif
 	}
 
 	if(hres == IDCANCEL)
@@ -15,7 +15,7 @@ BOOL ValidateHardwareID(unsigned char *tovalidate);
 inline void GenerateKey(unsigned char *Destination, unsigned char *From);
 void GetRegisteredKey();
 void RegisterKey(unsigned char *toregister);
-inline BOOL ValidateKey(unsigned char *keytovalidate);
+BOOL ValidateKey(unsigned char *keytovalidate);
 void MaskStrings(unsigned char *string, unsigned char *mask, unsigned char *result);
 
 HRESULT Register();
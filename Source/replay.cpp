@@ -0,0 +1,569 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				replay.cpp						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the game's random numbers and clock, and recording and
+//*			 replaying the commands the player gives in the world view
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		a session file is only good with the data it was recorded on
+//*********************************************************************
+//*********************************************************************
+#include "replay.h"
+#include "world.h"
+#include "area.h"
+#include "creatures.h"
+#include "party.h"
+#include "path.h"
+#include "zsutilities.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <stddef.h>
+
+Replay PreludeReplay;
+
+static const char *SectionNames[NUM_SECTIONS] = { "tick", "area", "offscreen", "combat", "scripts", "pathing" };
+static const int SectionZones[NUM_SECTIONS] = { ZONE_WORLD_UPDATE, ZONE_AREA_UPDATE, ZONE_OFFSCREEN, ZONE_COMBAT_UPDATE, ZONE_SCRIPT, ZONE_PATH };
+
+//************** Random numbers and the clock ***************************
+
+//the same linear congruential generator as the Visual C library, kept
+//here so every build and platform gets the same sequence
+static DWORD GameRandState = 1;
+
+static BOOL Fixed = FALSE;
+static DWORD FixedStart = 0;
+static DWORD FixedLength = 0;
+static DWORD FixedTick = 0;
+
+void SeedGameRand(DWORD Seed)
+{
+	GameRandState = Seed;
+}
+
+DWORD GetGameRandState()
+{
+	return GameRandState;
+}
+
+int GameRand()
+{
+	GameRandState = (GameRandState * 214013 + 2531011) & 0xffffffff;
+	return (int)((GameRandState >> 16) & GAME_RAND_MAX);
+}
+
+DWORD GameTime()
+{
+	if(Fixed)
+	{
+		return FixedStart + FixedTick * FixedLength;
+	}
+	return timeGetTime();
+}
+
+BOOL FixedTicks()
+{
+	return Fixed;
+}
+
+void StartFixedTicks(DWORD Start, DWORD Length)
+{
+	Fixed = TRUE;
+	FixedStart = Start;
+	FixedLength = Length;
+	FixedTick = 0;
+}
+
+void StopFixedTicks()
+{
+	Fixed = FALSE;
+}
+
+//************** Recording and playback *********************************
+
+void Replay::Perform(REPLAY_ENTRY_T *pEntry, Object *pTarget)
+{
+	Creature *pActive;
+	Path *pPath;
+	BOOL Found;
+
+	pActive = (Creature *)PreludeWorld->GetActive();
+	if(!pActive)
+	{
+		return;
+	}
+
+	switch(pEntry->Command)
+	{
+		case REPLAY_ATTACK:
+			//the attack type rides in the action's pointer argument
+			pActive->InsertAction(ACTION_ATTACK,(void *)pTarget,(void *)(intptr_t)pEntry->Data);
+			break;
+		case REPLAY_DEFEND:
+			pActive->InsertAction(ACTION_DEFEND,NULL,NULL);
+			break;
+		case REPLAY_OPEN:
+			pActive->InsertAction(ACTION_OPEN,(void *)pTarget,NULL);
+			break;
+		case REPLAY_CLOSE:
+			pActive->InsertAction(ACTION_CLOSE,(void *)pTarget,NULL);
+			break;
+		case REPLAY_PICKUP:
+			pActive->InsertAction(ACTION_PICKUP,(void *)pTarget,NULL);
+			break;
+		case REPLAY_WAIT:
+			pActive->InsertAction(ACTION_WAITACTION,NULL,NULL);
+			break;
+		case REPLAY_MOVE:
+			PreludeParty.MoveParty(pEntry->X,pEntry->Y);
+			break;
+		case REPLAY_PATH:
+			//found again from the same place, the path that was shown
+			//is only cut short at the end the player picked
+			pPath = new Path;
+			pPath->SetTraveller(pActive);
+			pPath->SetTarget(NULL);
+			pPath->SetTargetSize(0);
+			if(pActive->IsLarge())
+			{
+				pPath->SetTravellerSize(2);
+				Found = pPath->FindLargeCombatPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, pEntry->ToX, pEntry->ToY, 0.0f, pActive);
+			}
+			else
+			{
+				pPath->SetTravellerSize(1);
+				Found = pPath->FindCombatFloodPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, pEntry->ToX, pEntry->ToY, pActive)
+					|| pPath->FindCombatPath((int)pActive->GetPosition()->x,(int)pActive->GetPosition()->y, pEntry->ToX, pEntry->ToY, 0.0f, pActive);
+			}
+			if(!Found)
+			{
+				delete pPath;
+				break;
+			}
+			pPath->SetEnd(pEntry->X,pEntry->Y);
+			pActive->InsertAction(ACTION_FOLLOWPATH,(void *)pPath,NULL);
+			break;
+		default:
+			break;
+	}
+}
+
+BOOL Replay::StartRecording(const char *FileName, const char *NewSaveName, DWORD NewTickLength)
+{
+	char GameID[32];
+
+	if(Mode != REPLAY_OFF)
+	{
+		return FALSE;
+	}
+
+	fpRecord = fopen(FileName, "wt");
+	if(!fpRecord)
+	{
+		DEBUG_INFO("Could not open session file\n");
+		return FALSE;
+	}
+
+	strncpy(SaveName, NewSaveName, sizeof(SaveName) - 1);
+	SaveName[sizeof(SaveName) - 1] = '\0';
+	//kept positive, GetInt reads them back
+	Seed = timeGetTime() & 0x7fffffff;
+	Start = Seed;
+	TickLength = NewTickLength;
+
+	//the clock is fixed first so the load sees the time playback will
+	StartFixedTicks(Start, TickLength);
+	strcpy(GameID, "Recorded session");
+	PreludeWorld->SaveGame(SaveName, GameID);
+	PreludeWorld->LoadGame(SaveName);
+
+	SeedGameRand(Seed);
+	NumTicks = 0;
+	Mode = REPLAY_RECORD;
+
+	fprintf(fpRecord, "Replay:\t\t%i\n", REPLAY_VERSION);
+	fprintf(fpRecord, "Save:\t\t%s\n", SaveName);
+	fprintf(fpRecord, "Seed:\t\t%lu\n", (unsigned long)Seed);
+	fprintf(fpRecord, "Start:\t\t%lu\n", (unsigned long)Start);
+	fprintf(fpRecord, "TickLength:\t%lu\n", (unsigned long)TickLength);
+	fprintf(fpRecord, "\n");
+
+	LogPrintf(LOG_INFO, LOG_WORLD, "Recording session to %s", FileName);
+	return TRUE;
+}
+
+void Replay::StopRecording()
+{
+	if(Mode != REPLAY_RECORD)
+	{
+		return;
+	}
+
+	Check = WorldCheck();
+	fprintf(fpRecord, "\n");
+	fprintf(fpRecord, "Ticks:\t\t%i\n", NumTicks);
+	fprintf(fpRecord, "Check:\t\t%lu\n", (unsigned long)Check);
+	fclose(fpRecord);
+	fpRecord = NULL;
+
+	StopFixedTicks();
+	Mode = REPLAY_OFF;
+	LogPrintf(LOG_INFO, LOG_WORLD, "Recorded %i ticks", NumTicks);
+}
+
+BOOL Replay::Load(const char *FileName)
+{
+	FILE *fp;
+	char *pName;
+	int n;
+
+	fp = fopen(FileName, "rt");
+	if(!fp)
+	{
+		return FALSE;
+	}
+
+	if(!SeekTo(fp, "Replay:") || GetInt(fp) != REPLAY_VERSION)
+	{
+		DEBUG_INFO("Not a session file, or the wrong version\n");
+		fclose(fp);
+		return FALSE;
+	}
+
+	fseek(fp, 0, SEEK_SET);
+	if(!SeekTo(fp, "Save:"))
+	{
+		fclose(fp);
+		return FALSE;
+	}
+	pName = GetStringNoWhite(fp);
+	strncpy(SaveName, pName, sizeof(SaveName) - 1);
+	SaveName[sizeof(SaveName) - 1] = '\0';
+	delete[] pName;
+
+	fseek(fp, 0, SEEK_SET);
+	SeekTo(fp, "Seed:");
+	Seed = (DWORD)GetInt(fp);
+	fseek(fp, 0, SEEK_SET);
+	SeekTo(fp, "Start:");
+	Start = (DWORD)GetInt(fp);
+	fseek(fp, 0, SEEK_SET);
+	SeekTo(fp, "TickLength:");
+	TickLength = (DWORD)GetInt(fp);
+
+	//count the commands, then read them
+	fseek(fp, 0, SEEK_SET);
+	NumEntries = 0;
+	while(SeekTo(fp, "Command:"))
+	{
+		NumEntries++;
+	}
+
+	if(Entries)
+	{
+		delete[] Entries;
+		Entries = NULL;
+	}
+	if(NumEntries)
+	{
+		Entries = new REPLAY_ENTRY_T[NumEntries];
+	}
+
+	fseek(fp, 0, SEEK_SET);
+	for(n = 0; n < NumEntries; n++)
+	{
+		SeekTo(fp, "Command:");
+		Entries[n].Tick = GetInt(fp);
+		Entries[n].Command = (REPLAY_COMMAND_T)GetInt(fp);
+		Entries[n].TargetType = GetInt(fp);
+		Entries[n].X = GetInt(fp);
+		Entries[n].Y = GetInt(fp);
+		Entries[n].Data = GetInt(fp);
+		Entries[n].ToX = GetInt(fp);
+		Entries[n].ToY = GetInt(fp);
+	}
+
+	//a session that never stopped properly runs to its last command
+	fseek(fp, 0, SEEK_SET);
+	if(SeekTo(fp, "Ticks:"))
+	{
+		Length = GetInt(fp);
+		SeekTo(fp, "Check:");
+		Check = (DWORD)GetInt(fp);
+	}
+	else
+	{
+		Length = NumEntries ? Entries[NumEntries - 1].Tick + 1 : 0;
+		Check = 0;
+	}
+
+	fclose(fp);
+	return TRUE;
+}
+
+void Replay::StartPlayback()
+{
+	SeedGameRand(Seed);
+	NumTicks = 0;
+	NextEntry = 0;
+	Mode = REPLAY_PLAY;
+}
+
+void Replay::StopPlayback()
+{
+	if(Mode != REPLAY_PLAY)
+	{
+		return;
+	}
+
+	StopFixedTicks();
+	Mode = REPLAY_OFF;
+	LogPrintf(LOG_INFO, LOG_WORLD, "Played back %i ticks", NumTicks);
+}
+
+void Replay::Command(REPLAY_COMMAND_T NewCommand, Object *pTarget, int X, int Y, int Data, int ToX, int ToY)
+{
+	REPLAY_ENTRY_T Entry;
+
+	Entry.Tick = NumTicks;
+	Entry.Command = NewCommand;
+	if(pTarget)
+	{
+		Entry.TargetType = pTarget->GetObjectType();
+		Entry.X = (int)pTarget->GetPosition()->x;
+		Entry.Y = (int)pTarget->GetPosition()->y;
+	}
+	else
+	{
+		Entry.TargetType = REPLAY_NO_TARGET;
+		Entry.X = X;
+		Entry.Y = Y;
+	}
+	Entry.Data = Data;
+	Entry.ToX = ToX;
+	Entry.ToY = ToY;
+
+	if(Mode == REPLAY_RECORD)
+	{
+		fprintf(fpRecord, "Command:\t%i %i %i %i %i %i %i %i\n",
+			Entry.Tick, Entry.Command, Entry.TargetType, Entry.X, Entry.Y,
+			Entry.Data, Entry.ToX, Entry.ToY);
+	}
+
+	Perform(&Entry, pTarget);
+}
+
+void Replay::BeginTick()
+{
+	REPLAY_ENTRY_T *pEntry;
+	Object *pTarget;
+
+	if(Mode == REPLAY_PLAY)
+	{
+		while(NextEntry < NumEntries && Entries[NextEntry].Tick <= NumTicks)
+		{
+			pEntry = &Entries[NextEntry];
+			NextEntry++;
+
+			pTarget = NULL;
+			if(pEntry->TargetType != REPLAY_NO_TARGET)
+			{
+				pTarget = Valley->FindObject(pEntry->X, pEntry->Y, (OBJECT_T)pEntry->TargetType);
+				if(!pTarget)
+				{
+					LogPrintf(LOG_WARNING, LOG_WORLD, "Replay tick %i: no target at %i, %i", NumTicks, pEntry->X, pEntry->Y);
+					continue;
+				}
+			}
+			Perform(pEntry, pTarget);
+		}
+	}
+
+	NumTicks++;
+	if(Fixed)
+	{
+		FixedTick++;
+	}
+}
+
+DWORD Replay::WorldCheck()
+{
+	DWORD Sum;
+	Creature *pMember;
+	int n;
+
+	Sum = GetGameRandState();
+	Sum = Sum * 31 + (DWORD)PreludeWorld->GetTotalTime();
+	for(n = 0; n < PreludeParty.GetNumMembers(); n++)
+	{
+		pMember = PreludeParty.GetMember(n);
+		Sum = Sum * 31 + (DWORD)pMember->GetPosition()->x;
+		Sum = Sum * 31 + (DWORD)pMember->GetPosition()->y;
+		Sum = Sum * 31 + (DWORD)pMember->GetData(INDEX_HITPOINTS).Value;
+	}
+	return Sum & 0x7fffffff;
+}
+
+//************** Section timing *****************************************
+
+void Replay::StartTiming(int NewMaxSamples)
+{
+	int n;
+
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		if(Samples[n])
+		{
+			delete[] Samples[n];
+		}
+		Samples[n] = new LONGLONG[NewMaxSamples];
+	}
+	MaxSamples = NewMaxSamples;
+	NumSamples = 0;
+
+	ProfileKeepTotals(TRUE);
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		LastTime[n] = ProfileThreadTime(SectionZones[n]);
+	}
+	Timing = TRUE;
+}
+
+void Replay::EndTick()
+{
+	LONGLONG Now;
+	int n;
+
+	if(!Timing)
+	{
+		return;
+	}
+
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		Now = ProfileThreadTime(SectionZones[n]);
+		if(NumSamples < MaxSamples)
+		{
+			Samples[n][NumSamples] = Now - LastTime[n];
+		}
+		LastTime[n] = Now;
+	}
+	if(NumSamples < MaxSamples)
+	{
+		NumSamples++;
+	}
+}
+
+static int CompareSamples(const void *pA, const void *pB)
+{
+	LONGLONG A = *(const LONGLONG *)pA;
+	LONGLONG B = *(const LONGLONG *)pB;
+
+	if(A < B)
+	{
+		return -1;
+	}
+	if(A > B)
+	{
+		return 1;
+	}
+	return 0;
+}
+
+void Replay::OutputTimes(FILE *fp)
+{
+	LARGE_INTEGER Frequency;
+	LONGLONG *Sorted;
+	LONGLONG Total;
+	double ToMS;
+	int n;
+	int sn;
+
+	if(!NumSamples)
+	{
+		fprintf(fp, "no ticks timed\n");
+		return;
+	}
+
+	QueryPerformanceFrequency(&Frequency);
+	ToMS = 1000.0 / (double)Frequency.QuadPart;
+
+	fprintf(fp, "%-10s %10s %10s %10s %10s %10s %12s\n",
+		"ms", "mean", "median", "95th", "99th", "max", "total");
+
+	Sorted = new LONGLONG[NumSamples];
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		Total = 0;
+		for(sn = 0; sn < NumSamples; sn++)
+		{
+			Sorted[sn] = Samples[n][sn];
+			Total += Sorted[sn];
+		}
+		qsort(Sorted, NumSamples, sizeof(LONGLONG), CompareSamples);
+
+		fprintf(fp, "%-10s %10.4f %10.4f %10.4f %10.4f %10.4f %12.3f\n",
+			SectionNames[n],
+			(double)Total * ToMS / (double)NumSamples,
+			(double)Sorted[NumSamples / 2] * ToMS,
+			(double)Sorted[(NumSamples * 95) / 100] * ToMS,
+			(double)Sorted[(NumSamples * 99) / 100] * ToMS,
+			(double)Sorted[NumSamples - 1] * ToMS,
+			(double)Total * ToMS);
+	}
+	delete[] Sorted;
+}
+
+//************** Constructors *******************************************
+
+Replay::Replay()
+{
+	int n;
+
+	Mode = REPLAY_OFF;
+	NumTicks = 0;
+	fpRecord = NULL;
+	Entries = NULL;
+	NumEntries = 0;
+	NextEntry = 0;
+	Length = 0;
+	SaveName[0] = '\0';
+	Seed = 0;
+	Start = 0;
+	TickLength = 0;
+	Check = 0;
+	Timing = FALSE;
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		Samples[n] = NULL;
+		LastTime[n] = 0;
+	}
+	MaxSamples = 0;
+	NumSamples = 0;
+}
+
+Replay::~Replay()
+{
+	int n;
+
+	if(fpRecord)
+	{
+		fclose(fpRecord);
+	}
+	if(Entries)
+	{
+		delete[] Entries;
+	}
+	for(n = 0; n < NUM_SECTIONS; n++)
+	{
+		if(Samples[n])
+		{
+			delete[] Samples[n];
+		}
+	}
+}
@@ -0,0 +1,201 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				replay.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the game's random numbers and clock, and recording and
+//*			 replaying the commands the player gives in the world view
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		only orders given by clicking in the world or the combat keys
+//*		are recorded, a session that goes through talk, spell or
+//*		inventory windows will not replay the same way
+//*********************************************************************
+//*********************************************************************
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define REPLAY_VERSION			1
+#define REPLAY_FILE_NAME		"session.rec"
+#define REPLAY_SAVE_NAME		"session.gam"
+#define REPLAY_NO_TARGET		-1
+
+//GameRand returns 0 to GAME_RAND_MAX, the same on every build
+#define GAME_RAND_MAX			0x7fff
+
+class Thing;
+class Object;
+
+typedef enum
+{
+	REPLAY_OFF,
+	REPLAY_RECORD,
+	REPLAY_PLAY
+} REPLAY_MODE_T;
+
+//the numbers are written to the session file, add new ones at the end
+typedef enum
+{
+	REPLAY_ATTACK = 0,
+	REPLAY_DEFEND,
+	REPLAY_OPEN,
+	REPLAY_CLOSE,
+	REPLAY_PICKUP,
+	REPLAY_WAIT,
+	REPLAY_MOVE,
+	REPLAY_PATH,
+	REPLAY_NUM_COMMANDS
+} REPLAY_COMMAND_T;
+
+//each section is the profiler zone of the same name on the thread that
+//runs the ticks.  a section's time includes what it calls, so pathing
+//and scripts are also inside area and combat
+typedef enum
+{
+	SECTION_TICK = 0,
+	SECTION_AREA,
+	SECTION_OFFSCREEN,
+	SECTION_COMBAT,
+	SECTION_SCRIPTS,
+	SECTION_PATHING,
+	NUM_SECTIONS
+} REPLAY_SECTION_T;
+
+typedef struct
+{
+	int Tick;					//World::Update calls before it was given
+	REPLAY_COMMAND_T Command;
+	int TargetType;				//OBJECT_T, REPLAY_NO_TARGET for none
+	int X;						//target or destination tile
+	int Y;
+	int Data;					//attack type for REPLAY_ATTACK
+	int ToX;					//REPLAY_PATH, where the path was asked for
+	int ToY;
+} REPLAY_ENTRY_T;
+
+//************** Random numbers and the clock ***************************
+
+void SeedGameRand(DWORD Seed);
+DWORD GetGameRandState();
+int GameRand();
+
+//timeGetTime until StartFixedTicks, then the time of the current tick
+//until StopFixedTicks
+DWORD GameTime();
+BOOL FixedTicks();
+void StartFixedTicks(DWORD Start, DWORD Length);
+void StopFixedTicks();
+
+//*******************************CLASS********************************
+//**************          Replay                 *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Record a session as a saved game, a seed and the commands
+//*			 given each tick, and play one back.  Both run the clock in
+//*			 fixed ticks so a tick does the same work however long the
+//*			 frame around it took.
+//********************************************************************
+//*Invariants: NumTicks counts World::Update calls since the session
+//*				 started, entries are in tick order
+//********************************************************************
+class Replay
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	REPLAY_MODE_T Mode;
+	int NumTicks;
+
+	//recording
+	FILE *fpRecord;
+
+	//playback
+	REPLAY_ENTRY_T *Entries;
+	int NumEntries;
+	int NextEntry;
+	int Length;
+	char SaveName[64];
+	DWORD Seed;
+	DWORD Start;
+	DWORD TickLength;
+	DWORD Check;
+
+	//per tick section times, in QueryPerformanceCounter ticks
+	BOOL Timing;
+	LONGLONG *Samples[NUM_SECTIONS];
+	//the zone totals at the end of the last tick
+	LONGLONG LastTime[NUM_SECTIONS];
+	int MaxSamples;
+	int NumSamples;
+
+	void Perform(REPLAY_ENTRY_T *pEntry, Object *pTarget);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	REPLAY_MODE_T GetMode() { return Mode; }
+	BOOL IsRecording() { return Mode == REPLAY_RECORD; }
+	int GetNumTicks() { return NumTicks; }
+	//length of the session being played
+	int GetLength() { return Length; }
+	const char *GetSaveName() { return SaveName; }
+	DWORD GetSeed() { return Seed; }
+	DWORD GetStart() { return Start; }
+	DWORD GetTickLength() { return TickLength; }
+	//what the world came to at the end of the recording, 0 if unknown
+	DWORD GetCheck() { return Check; }
+
+	//sums up the party, the game time and the random state
+	static DWORD WorldCheck();
+
+// Mutators -----------------------------------------
+	//saves and reloads the game so the recording starts from exactly
+	//what the save holds
+	BOOL StartRecording(const char *FileName, const char *NewSaveName, DWORD NewTickLength);
+	void StopRecording();
+
+	//reads the session.  the caller fixes the clock at GetStart, loads
+	//GetSaveName and then calls StartPlayback
+	BOOL Load(const char *FileName);
+	void StartPlayback();
+	//hands the clock back to timeGetTime, as StopRecording does
+	void StopPlayback();
+
+	//a command from the world view, recorded if need be and carried out
+	//by the active creature
+	void Command(REPLAY_COMMAND_T NewCommand, Object *pTarget, int X, int Y, int Data, int ToX = 0, int ToY = 0);
+
+	//called by World::Update before anything else
+	void BeginTick();
+
+	//start keeping per tick section times for up to NewMaxSamples ticks
+	void StartTiming(int NewMaxSamples);
+	//store the times of the tick just run
+	void EndTick();
+
+// Output ---------------------------------------------
+	//mean and percentiles for each section, in milliseconds
+	void OutputTimes(FILE *fp);
+
+// Constructors ---------------------------------------
+	Replay();
+
+// Destructor -----------------------------------------
+	~Replay();
+
+};
+
+extern Replay PreludeReplay;
+
+#endif
@@ -7,9 +7,15 @@
 #include "items.h"
 #include <assert.h>
 #include "party.h"
+#include "scriptvm.h"
+#include "profiler.h"
+#include <new.h>
 
 #define IDC_TALK_WIN		666
 
+//a pooled block is followed directly by its arguments
+#define SCRIPT_BLOCK_BYTES	((sizeof(ScriptBlock) + SCRIPT_ALIGN - 1) & ~(SCRIPT_ALIGN - 1))
+
 int G_NumBlocks = 0;
 int G_NumArgs = 0;
 
@@ -123,16 +129,16 @@ void ScriptArg::Save(FILE *fp)
 		fwrite(&ID,sizeof(ID),1,fp);
 		break;
 	case ARG_FLAG:
-		Length = strlen(((Flag *)Value)->Name) + 1;
+		Length = strlen(PreludeFlags.GetName((int)Value)) + 1;
 		fwrite(&Length,sizeof(Length),1,fp);
-		fwrite(((Flag *)Value)->Name,Length-1,1,fp);
+		fwrite(PreludeFlags.GetName((int)Value),Length-1,1,fp);
 		break;
 	default:
 		break;
 	}
 }
 
-void ScriptArg::Load(FILE *fp)
+void ScriptArg::Load(FILE *fp, ScriptManager *pManager)
 {
 //write out the typeof arg
 	fread(&Type,sizeof(Type),1,fp);
@@ -154,14 +160,28 @@ void ScriptArg::Load(FILE *fp)
 	case ARG_CHARACTER_LABEL:
 	case ARG_STRING:
 		fread(&Length,sizeof(Length),1,fp);
-		Value = new char[Length];
+		if(pManager)
+		{
+			Value = pManager->GetString(Length);
+		}
+		else
+		{
+			Value = new char[Length];
+		}
 		assert(Value);
 		fgets((char *)Value,Length,fp);
 		break;
 	case ARG_BLOCK:
-		Value = new ScriptBlock;
-		assert(Value);
-		((ScriptBlock *)Value)->Load(fp);
+		if(pManager)
+		{
+			Value = ScriptBlock::LoadBlock(fp, pManager);
+		}
+		else
+		{
+			Value = new ScriptBlock;
+			assert(Value);
+			((ScriptBlock *)Value)->Load(fp);
+		}
 		break;
 	case ARG_ITEM:
 		fread(&ID,sizeof(ID),1,fp);
@@ -185,7 +205,7 @@ void ScriptArg::Load(FILE *fp)
 		fread(&Length,sizeof(Length),1,fp);
 		fgets(TempString,Length,fp);
 		assert(Length < 128);
-		Value = (void *)PreludeFlags.Get(TempString);
+		Value = (void *)PreludeFlags.GetID(TempString);
 		break;
 	default:
 		break;
@@ -274,20 +294,39 @@ void ScriptBlock::Save(FILE *fp)
 }
 
 
-void ScriptBlock::Load(FILE *fp)
+void ScriptBlock::Load(FILE *fp, ScriptManager *pNewManager)
 {
+	Release();
+	SetManager(pNewManager);
+
 	fread(&NumArgs,sizeof(NumArgs),1,fp);
 
-	ArgList = new ScriptArg[NumArgs];
-	assert(ArgList);
-	
+	ArgList = pManager->GetArgs(NumArgs);
+
 	int n;
 
 	for(n = 0; n < NumArgs; n++)
 	{
-		ArgList[n].Load(fp);
+		ArgList[n].Load(fp, pManager);
 	}
+}
 
+ScriptBlock *ScriptBlock::LoadBlock(FILE *fp, ScriptManager *pManager)
+{
+	ScriptBlock *pBlock;
+	int Num;
+	int n;
+
+	fread(&Num,sizeof(Num),1,fp);
+
+	pBlock = pManager->GetBlock(Num);
+
+	for(n = 0; n < Num; n++)
+	{
+		pBlock->ArgList[n].Load(fp, pManager);
+	}
+
+	return pBlock;
 }
 void ScriptBlock::Import(const char *FileName)
 {
@@ -302,11 +341,54 @@ void ScriptBlock::Import(const char *FileName)
 	fclose(fp);
 }
 
-void ScriptBlock::Import(FILE *fp)
+//moves the parsed arguments into place and terminates the list
+static void MoveArgs(ScriptArg *ArgList, ScriptArg *TempArgs, int Num)
+{
+	int n;
+
+	for(n = 0; n < Num; n++)
+	{
+		memcpy(&ArgList[n],&TempArgs[n],sizeof(ScriptArg));
+		TempArgs[n].SetValue(NULL);
+		TempArgs[n].SetType(ARG_NONE);
+	}
+	ArgList[Num].SetValue(NULL);
+	ArgList[Num].SetType(ARG_TERMINATOR);
+}
+
+void ScriptBlock::Import(FILE *fp, ScriptManager *pNewManager)
 {
 	ScriptArg TempArgs[MAX_ARGS];
-	
-	NumArgs = 0;
+
+	Release();
+	SetManager(pNewManager);
+
+	NumArgs = ImportArgs(fp, TempArgs, pManager);
+
+	ArgList = pManager->GetArgs(NumArgs + 1);
+	MoveArgs(ArgList, TempArgs, NumArgs);
+	NumArgs++;
+}
+
+ScriptBlock *ScriptBlock::ImportBlock(FILE *fp, ScriptManager *pManager)
+{
+	ScriptArg TempArgs[MAX_ARGS];
+	ScriptBlock *pBlock;
+	int Num;
+
+	Num = ImportArgs(fp, TempArgs, pManager);
+
+	pBlock = pManager->GetBlock(Num + 1);
+	MoveArgs(pBlock->ArgList, TempArgs, Num);
+
+	return pBlock;
+}
+
+//reads arguments up to the closing paren, strings and nested blocks go
+//in pManager
+int ScriptBlock::ImportArgs(FILE *fp, ScriptArg *TempArgs, ScriptManager *pManager)
+{
+	int NumArgs = 0;
 
 	//look at our next char
 	char c = '\0';
@@ -322,15 +404,7 @@ void ScriptBlock::Import(FILE *fp)
 		if(c == '(')
 		{
 			TempArgs[NumArgs].SetType(ARG_BLOCK);
-			TempArgs[NumArgs].SetValue(new ScriptBlock);
-			if(!TempArgs[NumArgs].GetValue())
-			{
-				SafeExit("COULD not allocate block!!!!!");
-			}
-			else
-			{
-				((ScriptBlock *)TempArgs[NumArgs].GetValue())->Import(fp);
-			}
+			TempArgs[NumArgs].SetValue(ImportBlock(fp, pManager));
 		}	
 		else
 		if(isalpha(c))
@@ -346,19 +420,25 @@ void ScriptBlock::Import(FILE *fp)
 		if(c == '[')
 		{
 			TempArgs[NumArgs].SetType(ARG_STRING);
-			TempArgs[NumArgs].SetValue(GetString(fp, ']'));
+			TempString = GetString(fp, ']');
+			TempArgs[NumArgs].SetValue(pManager->AddString(TempString));
+			delete[] TempString;
 		}
 		else
 		if(c == '!')
 		{
 			TempArgs[NumArgs].SetType(ARG_LABEL);
-			TempArgs[NumArgs].SetValue(GetString(fp, '!'));
+			TempString = GetString(fp, '!');
+			TempArgs[NumArgs].SetValue(pManager->AddString(TempString));
+			delete[] TempString;
 		}
 		else
 		if(c == '#')
 		{
 			TempArgs[NumArgs].SetType(ARG_CHARACTER_LABEL);
-			TempArgs[NumArgs].SetValue(GetString(fp, '#'));
+			TempString = GetString(fp, '#');
+			TempArgs[NumArgs].SetValue(pManager->AddString(TempString));
+			delete[] TempString;
 		}
 		else
 		if(c == '^')
@@ -391,7 +471,9 @@ void ScriptBlock::Import(FILE *fp)
 					//didn't find in things or creatures
 					ConvertToCapitals(TempString);
 					
-					n = Creature::GetFirst()->GetIndex(TempString);
+					//field names are resolved to their index here, once,
+					//so running the script never looks a name up
+					n = Creature::GetFirst()->FindField(TempString);
 					if(n != - 1)
 					{
 						TempArgs[NumArgs].SetValue((void *)n);
@@ -399,14 +481,14 @@ void ScriptBlock::Import(FILE *fp)
 					}
 					else
 					{
-						n = Item::GetFirst()->GetIndex(TempString);
+						n = Item::GetFirst()->FindField(TempString);
 						if(n != -1)
 						{
 							TempArgs[NumArgs].SetValue((void *)n);
 						}
 						else
 						{
-							TempArgs[NumArgs].SetValue((void *)PreludeFlags.Get(TempString));
+							TempArgs[NumArgs].SetValue((void *)PreludeFlags.GetID(TempString));
 							TempArgs[NumArgs].SetType(ARG_FLAG);
 						}
 					}
@@ -440,19 +522,7 @@ void ScriptBlock::Import(FILE *fp)
 		}
 	}
 
-	ArgList = new ScriptArg[NumArgs + 1];
-	assert(ArgList);
-
-	for(n = 0; n < NumArgs; n++)
-	{
-		memcpy(&ArgList[n],&TempArgs[n],sizeof(ScriptArg));
-		TempArgs[n].SetValue(NULL);
-		TempArgs[n].SetType(ARG_NONE);
-	}
-	ArgList[NumArgs].SetValue(NULL);
-	ArgList[NumArgs].SetType(ARG_TERMINATOR);
-	NumArgs++;
-	return;
+	return NumArgs;
 }
 
 
@@ -460,19 +530,76 @@ ScriptBlock::ScriptBlock()
 {
 	NumArgs = 0;
 	ArgList = NULL;
+	pProgram = NULL;
+	pManager = NULL;
+	OwnsManager = FALSE;
+	LabelsIndexed = FALSE;
 	G_NumBlocks++;
 }
 
 ScriptBlock::~ScriptBlock()
 {
+	Release();
+
+	if(OwnsManager)
+	{
+		delete pManager;
+	}
+	pManager = NULL;
+	G_NumBlocks--;
+}
+
+void ScriptBlock::Release()
+{
+	if(pProgram)
+	{
+		delete pProgram;
+		pProgram = NULL;
+	}
+
+	Labels.Clear();
+	LabelsIndexed = FALSE;
+
 	if(ArgList)
 	{
 		Value.ClearValue();
 
-		delete[] ArgList;
+		if(pManager)
+		{
+			pManager->FreeArgs(ArgList, NumArgs);
+		}
+		else
+		{
+			delete[] ArgList;
+		}
 		ArgList = NULL;
 	}
-	G_NumBlocks--;
+	NumArgs = 0;
+}
+
+void ScriptBlock::SetManager(ScriptManager *pNewManager)
+{
+	if(pNewManager && pNewManager != pManager)
+	{
+		if(OwnsManager)
+		{
+			delete pManager;
+		}
+		pManager = pNewManager;
+		OwnsManager = FALSE;
+	}
+	else
+	if(OwnsManager)
+	{
+		//nothing of the last script is left, give it all back at once
+		pManager->Clear();
+	}
+	else
+	if(!pManager)
+	{
+		pManager = new ScriptManager;
+		OwnsManager = TRUE;
+	}
 }
 
 void ScriptBlock::Export(FILE *fp)
@@ -486,7 +613,49 @@ void ScriptBlock::Export(FILE *fp)
 	fprintf(fp,") \n");
 }
 
+void ScriptBlock::Talk()
+{
+	ZSWindow *pWin;
+
+	if(pScriptRecord)
+	{
+		RecordScriptTalk(ArgList[0].GetType() == ARG_CHARACTER_LABEL ? (char *)ArgList[0].GetValue() : NULL);
+		return;
+	}
+
+	pWin = new ZSTalkWin(IDC_TALK_WIN,125, 125, 550,350, this);
+
+	pWin->Show();
+
+	ZSWindow::GetMain()->AddTopChild(pWin);
+
+	pWin->SetFocus(pWin);
+
+	pWin->GoModal();
+
+	pWin->ReleaseFocus();
+	pWin->Hide();
+	
+	ZSWindow::GetMain()->RemoveChild(pWin);
+}
+
 ScriptArg *ScriptBlock::Process()
+{
+	ProfileZone ScriptZone(ZONE_SCRIPT);
+
+	if(ScriptUseVM)
+	{
+		if(!pProgram)
+		{
+			pProgram = ScriptProgram::Compile(this);
+		}
+		return pProgram->Run();
+	}
+
+	return Interpret();
+}
+
+ScriptArg *ScriptBlock::Interpret()
 {
 	int n;
 
@@ -502,21 +671,7 @@ ScriptArg *ScriptBlock::Process()
 	}
 	if(pArgZero->GetType() == ARG_CHARACTER_LABEL)
 	{
-		ZSWindow *pWin;
-		pWin = new ZSTalkWin(IDC_TALK_WIN,125, 125, 550,350, this);
-
-		pWin->Show();
-	
-		ZSWindow::GetMain()->AddTopChild(pWin);
-	
-		pWin->SetFocus(pWin);
-
-		pWin->GoModal();
-
-		pWin->ReleaseFocus();
-		pWin->Hide();
-		
-		ZSWindow::GetMain()->RemoveChild(pWin);
+		Talk();
 	}
 	else
 	{
@@ -563,25 +718,106 @@ ScriptArg *ScriptArg::Evaluate()
 
 
 
-ScriptBlock *ScriptBlock::FindLabel(char *Label)
+void ScriptBlock::IndexLabels()
 {
+	const char *Label;
+	int NumLabels = 0;
+	int Slot;
 	int n;
+
+	LabelsIndexed = TRUE;
+
 	for(n = 0; n < NumArgs; n++)
 	{
-		if(ArgList[n].GetType() == ARG_BLOCK)
+		if(ArgList[n].GetType() == ARG_BLOCK && ((ScriptBlock *)ArgList[n].GetValue())->GetLabel())
 		{
-			if(((ScriptBlock *)ArgList[n].GetValue())->GetArg(0)->GetType() == ARG_LABEL)
-			{
-				if(!strcmp((char *)((ScriptBlock *)ArgList[n].GetValue())->GetArg(0)->GetValue(),Label))
-				{
-					return (ScriptBlock *)ArgList[n].GetValue();
-				}
-			}
+			NumLabels++;
+		}
+	}
+	if(!NumLabels)
+	{
+		return;
+	}
+
+	Labels.Reset(NumLabels);
+
+	for(n = 0; n < NumArgs; n++)
+	{
+		if(ArgList[n].GetType() != ARG_BLOCK)
+		{
+			continue;
+		}
+		Label = GetArgLabel(n);
+		if(!Label)
+		{
+			continue;
+		}
+
+		//the first block with a label keeps it, as with the old scan
+		Slot = Labels.First(HashString(Label));
+		while(Labels.Get(Slot) != HASH_EMPTY && strcmp(GetArgLabel(Labels.Get(Slot)), Label))
+		{
+			Slot = Labels.Next(Slot);
+		}
+		if(Labels.Get(Slot) == HASH_EMPTY)
+		{
+			Labels.Set(Slot, n);
+		}
+	}
+}
+
+ScriptBlock *ScriptBlock::FindLabel(const char *Label)
+{
+	int Slot;
+	int n;
+
+	if(!LabelsIndexed)
+	{
+		IndexLabels();
+	}
+
+	for(Slot = Labels.First(HashString(Label)); (n = Labels.Get(Slot)) != HASH_EMPTY; Slot = Labels.Next(Slot))
+	{
+		if(!strcmp(GetArgLabel(n), Label))
+		{
+			return (ScriptBlock *)ArgList[n].GetValue();
 		}
 	}
 	return NULL;
 }
 
+int ScriptBlock::CheckConversation()
+{
+	return CheckLabels(this);
+}
+
+int ScriptBlock::CheckLabels(ScriptBlock *pRoot)
+{
+	SCRIPT_FUNC_T pFunc;
+	int NumMissing = 0;
+	int n;
+
+	if(NumArgs > 1 && ArgList[0].GetType() == ARG_FUNC_ID && ArgList[1].GetType() == ARG_STRING
+		&& (int)ArgList[0].GetValue() >= 0 && (int)ArgList[0].GetValue() < MAX_FUNCS)
+	{
+		pFunc = GetFunc((int)ArgList[0].GetValue());
+		if((pFunc == addword || pFunc == goword) && !pRoot->FindLabel((char *)ArgList[1].GetValue()))
+		{
+			LogPrintf(LOG_WARNING, LOG_SCRIPT, "missing label: %s", (char *)ArgList[1].GetValue());
+			NumMissing++;
+		}
+	}
+
+	for(n = 0; n < NumArgs; n++)
+	{
+		if(ArgList[n].GetType() == ARG_BLOCK)
+		{
+			NumMissing += ((ScriptBlock *)ArgList[n].GetValue())->CheckLabels(pRoot);
+		}
+	}
+	return NumMissing;
+}
+
 void ScriptArg::Print(FILE *fp)
 {
 
@@ -608,7 +844,7 @@ void ScriptArg::Print(FILE *fp)
 			((ScriptBlock *)Value)->Export(fp);
 			break;
 		case ARG_FLAG:
-			fprintf(fp," ^%s^", ((Flag *)Value)->Name);
+			fprintf(fp," ^%s^", PreludeFlags.GetName((int)Value));
 			break;
 		case ARG_ITEM:
 		case ARG_CREATURE:
@@ -640,7 +876,6 @@ void ScriptArg::Print(FILE *fp)
 void ScriptArg::UnsetCreature()
 {
 		int ID;
-		char *flagname;
 	switch(this->Type)
 	{
 		case ARG_CREATURE:
@@ -650,11 +885,6 @@ void ScriptArg::UnsetCreature()
 		case ARG_BLOCK:
 			((ScriptBlock *)Value)->UnsetCreatures();
 			break;
-		case ARG_FLAG:
-			flagname = new char[32];
-			memcpy(flagname, ((Flag *)Value)->Name, sizeof(char) * 32);
-			Value = (void *)flagname;
-			break;
 		default:
 			break;
 	}
@@ -664,8 +894,6 @@ void ScriptArg::UnsetCreature()
 void ScriptArg::SetCreature()
 {
 	int ID;
-	Flag *pFlag;
-	char *flagname;
 	switch(this->Type)
 	{
 		case ARG_CREATURE:
@@ -675,12 +903,6 @@ void ScriptArg::SetCreature()
 		case ARG_BLOCK:
 			((ScriptBlock *)Value)->SetCreatures();
 			break;
-		case ARG_FLAG:
-			flagname = (char *)Value;
-			pFlag = PreludeFlags.Get(flagname);
-			delete[] flagname;
-			Value = (void *)pFlag;
-			break;
 		default:
 			break;
 	}
@@ -702,30 +924,256 @@ void ScriptBlock::SetCreatures()
 	}
 }
 
+//************************************************************************************
+//ScriptManager
+
+int ScriptManager::GetSizeClass(int Size)
+{
+	int n = 0;
+
+	while((1 << n) < Size)
+	{
+		n++;
+	}
+	if(n >= SCRIPT_SIZE_CLASSES)
+	{
+		return SCRIPT_SIZE_LARGE;
+	}
+	return n;
+}
+
+void *ScriptManager::Alloc(int Size)
+{
+	char *pChunk;
+	int NewSize;
+
+	Size = (Size + SCRIPT_ALIGN - 1) & ~(SCRIPT_ALIGN - 1);
+
+	if(!pChunks || ChunkUsed + Size > ChunkSize)
+	{
+		NewSize = SCRIPT_CHUNK_SIZE;
+		if(Size + SCRIPT_ALIGN > NewSize)
+		{
+			NewSize = Size + SCRIPT_ALIGN;
+		}
+		pChunk = new char[NewSize];
+		if(!pChunk)
+		{
+			SafeExit("could not allocate script memory\n");
+		}
+		*(char **)pChunk = pChunks;
+		pChunks = pChunk;
+		ChunkUsed = SCRIPT_ALIGN;
+		ChunkSize = NewSize;
+		NumChunks++;
+		HeapBytes += NewSize;
+	}
+
+	pChunk = pChunks + ChunkUsed;
+	ChunkUsed += Size;
+	UsedBytes += Size;
+	return pChunk;
+}
+
 ScriptBlock *ScriptManager::GetBlock(int Size)
 {
+	ScriptBlock *pBlock;
+	char *pSlot;
+	int Class;
+	int n;
 
-	return NULL;
+	Class = GetSizeClass(Size);
+
+	if(Class == SCRIPT_SIZE_LARGE)
+	{
+		pSlot = new char[SCRIPT_BLOCK_BYTES + Size * sizeof(ScriptArg)];
+		if(!pSlot)
+		{
+			SafeExit("could not allocate script memory\n");
+		}
+		NumLargeBlocks++;
+	}
+	else
+	{
+		if(!BlockAvailable[Class])
+		{
+			AddBlock(Size);
+		}
+		pSlot = (char *)BlockAvailable[Class];
+		BlockAvailable[Class] = *(ScriptBlock **)pSlot;
+		BlockUsed[Class]++;
+	}
+
+	pBlock = new(pSlot) ScriptBlock;
+	pBlock->ArgList = (ScriptArg *)(pSlot + SCRIPT_BLOCK_BYTES);
+	for(n = 0; n < Size; n++)
+	{
+		new(&pBlock->ArgList[n]) ScriptArg;
+	}
+	pBlock->NumArgs = Size;
+	pBlock->pManager = this;
+
+	NumBlocks++;
+	return pBlock;
 };
 
 void ScriptManager::AddBlock(int Size)
 {
+	char *pSlot;
+	int Class;
+
+	Class = GetSizeClass(Size);
+	if(Class == SCRIPT_SIZE_LARGE)
+	{
+		return;
+	}
 
+	pSlot = (char *)Alloc(SCRIPT_BLOCK_BYTES + (1 << Class) * sizeof(ScriptArg));
+	*(ScriptBlock **)pSlot = BlockAvailable[Class];
+	BlockAvailable[Class] = (ScriptBlock *)pSlot;
 };
 
-void ScriptManager::FreeBlock(ScriptBlock *)
+void ScriptManager::FreeBlock(ScriptBlock *pBlock)
 {
+	int Class;
+
+	Class = GetSizeClass(pBlock->NumArgs);
 
+	pBlock->~ScriptBlock();
+
+	if(Class == SCRIPT_SIZE_LARGE)
+	{
+		delete[] (char *)pBlock;
+		NumLargeBlocks--;
+		return;
+	}
+
+	*(ScriptBlock **)pBlock = BlockAvailable[Class];
+	BlockAvailable[Class] = pBlock;
+	BlockUsed[Class]--;
 }
 
-	
-ScriptManager::ScriptManager()
+ScriptArg *ScriptManager::GetArgs(int Num)
 {
+	ScriptArg *ArgList;
+	int n;
 
+	ArgList = (ScriptArg *)Alloc(Num * sizeof(ScriptArg));
+	for(n = 0; n < Num; n++)
+	{
+		new(&ArgList[n]) ScriptArg;
+	}
+
+	NumArgLists++;
+	return ArgList;
 }
 
-ScriptManager::~ScriptManager()
+void ScriptManager::FreeArgs(ScriptArg *ArgList, int Num)
+{
+	int n;
+
+	for(n = 0; n < Num; n++)
+	{
+		if(ArgList[n].GetType() == ARG_BLOCK && ArgList[n].GetValue())
+		{
+			FreeBlock((ScriptBlock *)ArgList[n].GetValue());
+		}
+		//strings stay where they are until the manager is cleared
+		ArgList[n].SetValue(NULL);
+		ArgList[n].~ScriptArg();
+	}
+}
+
+char *ScriptManager::GetString(int Length)
+{
+	NumStrings++;
+	return (char *)Alloc(Length);
+}
+
+char *ScriptManager::AddString(const char *String)
 {
+	char *NewString;
 
+	NewString = GetString(strlen(String) + 1);
+	strcpy(NewString, String);
+	return NewString;
 }
 
+void ScriptManager::Clear()
+{
+	char *pChunk;
+	int n;
+
+	for(n = 0; n < SCRIPT_SIZE_CLASSES; n++)
+	{
+		if(BlockUsed[n])
+		{
+			LogPrintf(LOG_WARNING, LOG_SCRIPT, "%i script blocks of %i args still in use when their manager was cleared", BlockUsed[n], 1 << n);
+		}
+		BlockAvailable[n] = NULL;
+		BlockUsed[n] = 0;
+	}
+	if(NumLargeBlocks)
+	{
+		LogPrintf(LOG_WARNING, LOG_SCRIPT, "%i script blocks of more than %i args still in use when their manager was cleared", NumLargeBlocks, 1 << (SCRIPT_SIZE_CLASSES - 1));
+		NumLargeBlocks = 0;
+	}
+
+	while(pChunks)
+	{
+		pChunk = pChunks;
+		pChunks = *(char **)pChunk;
+		delete[] pChunk;
+	}
+
+	ChunkUsed = 0;
+	ChunkSize = 0;
+	NumChunks = 0;
+	HeapBytes = 0;
+	UsedBytes = 0;
+	NumBlocks = 0;
+	NumArgLists = 0;
+	NumStrings = 0;
+}
+
+void ScriptManager::OutPutDebugInfo(FILE *fp)
+{
+	int n;
+
+	fprintf(fp,"Script Manager\n");
+	fprintf(fp,"Chunks: %i  Heap bytes: %i  Used bytes: %i\n",NumChunks,HeapBytes,UsedBytes);
+	fprintf(fp,"Blocks: %i  Arg lists: %i  Strings: %i\n",NumBlocks,NumArgLists,NumStrings);
+	fprintf(fp,"Allocations: %i, %i a piece at a time\n",NumChunks,GetNumPieces());
+	for(n = 0; n < SCRIPT_SIZE_CLASSES; n++)
+	{
+		fprintf(fp,"  %3i args: %i in use\n",1 << n,BlockUsed[n]);
+	}
+	fprintf(fp,"  larger: %i in use\n",NumLargeBlocks);
+}
+
+ScriptManager::ScriptManager()
+{
+	int n;
+
+	for(n = 0; n < SCRIPT_SIZE_CLASSES; n++)
+	{
+		BlockAvailable[n] = NULL;
+		BlockUsed[n] = 0;
+	}
+
+	pChunks = NULL;
+	ChunkUsed = 0;
+	ChunkSize = 0;
+	NumChunks = 0;
+	HeapBytes = 0;
+	UsedBytes = 0;
+	NumBlocks = 0;
+	NumArgLists = 0;
+	NumStrings = 0;
+	NumLargeBlocks = 0;
+}
+
+ScriptManager::~ScriptManager()
+{
+	Clear();
+}
@@ -4,10 +4,20 @@
 #include "zswindow.h"
 #include "flags.h"
 #include "creatures.h"
+#include "hashindex.h"
 #include <stdio.h>
 
 #define MAX_ARGS 128
 
+//ScriptManager
+#define SCRIPT_SIZE_CLASSES	8		//1, 2, 4, 8, 16, 32, 64, 128 arguments
+#define SCRIPT_SIZE_LARGE		SCRIPT_SIZE_CLASSES	//bigger blocks, each its own heap allocation
+#define SCRIPT_CHUNK_SIZE	65536	//bytes asked of the heap at a time
+#define SCRIPT_ALIGN			8
+
+class ScriptProgram;
+class ScriptManager;
+
 typedef enum
 {
 	ARG_NONE,
@@ -69,7 +79,8 @@ public:
 	ScriptArg(ScriptArg *pFrom);
 	~ScriptArg();
 
-	void Load(FILE *fp);
+	//strings and blocks go in pManager's arena when there is one
+	void Load(FILE *fp, ScriptManager *pManager = NULL);
 	void Save(FILE *fp);
 
 	Creature *GetCreature();
@@ -84,12 +95,42 @@ public:
 
 class ScriptBlock
 {
+	friend class ScriptProgram;
+	friend class ScriptManager;
+
 protected:
 	int NumArgs;
 	ScriptArg *ArgList;
 	ScriptArg Value;
 	ScriptBlock *pNext;
 	ScriptBlock *pPrev;
+	//compiled the first time the block is processed
+	ScriptProgram *pProgram;
+	//holds the argument list, the strings and the blocks below this one
+	ScriptManager *pManager;
+	BOOL OwnsManager;
+	//the arguments holding labelled blocks, hashed on the label,
+	//built by the first FindLabel
+	HashIndex Labels;
+	BOOL LabelsIndexed;
+
+	void Talk();
+
+	//frees the program and the arguments
+	void Release();
+	//pNewManager replaces the block's own, without one the block makes
+	//or clears its own
+	void SetManager(ScriptManager *pNewManager);
+
+	static int ImportArgs(FILE *fp, ScriptArg *TempArgs, ScriptManager *pManager);
+	static ScriptBlock *ImportBlock(FILE *fp, ScriptManager *pManager);
+
+	const char *GetLabel() { return (ArgList && ArgList[0].GetType() == ARG_LABEL) ? (char *)ArgList[0].GetValue() : NULL; }
+	void IndexLabels();
+	const char *GetArgLabel(int Num) { return ((ScriptBlock *)ArgList[Num].GetValue())->GetLabel(); }
+	//logs the words added or gone to below this block that pRoot has no
+	//label for, returns how many
+	int CheckLabels(ScriptBlock *pRoot);
 
 public:
 	ScriptArg *GetValue() { return &Value; }
@@ -98,16 +139,25 @@ public:
 
 	void Save(FILE *fp);
 
-	void Load(FILE *fp);
+	//without a manager the block gets one of its own, freed with it
+	void Load(FILE *fp, ScriptManager *pNewManager = NULL);
+	static ScriptBlock *LoadBlock(FILE *fp, ScriptManager *pManager);
 
-	void Import(FILE *fp);
+	void Import(FILE *fp, ScriptManager *pNewManager = NULL);
 	void Import(const char *FileName);
 	
 	void Export(FILE *fp);
 
+	//runs the compiled program unless ScriptUseVM is off
 	ScriptArg *Process();
+	//walks the tree directly
+	ScriptArg *Interpret();
 
-	ScriptBlock *FindLabel(char *Label);
+	ScriptBlock *FindLabel(const char *Label);
+	//a conversation is the context its words are looked up in while it
+	//runs, so every word it adds or goes to should be one of its labels.
+	//logs those that aren't, returns how many
+	int CheckConversation();
 
 	void UnsetCreatures();
 	void SetCreatures();
@@ -116,21 +166,73 @@ public:
 	~ScriptBlock();
 };
 
+//*******************************CLASS********************************
+//**************          ScriptManager          *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Holds everything loaded from one script file.  Memory is
+//*			 taken from the heap in large chunks and handed out in
+//*			 order; blocks come with their argument list attached and are
+//*			 kept in free lists by size class so a freed block is reused
+//*			 by the next one of its size.  Blocks past the biggest class
+//*			 come straight from the heap and go back to it when freed.
+//*			 Strings and top level argument lists are only given back
+//*			 when the whole manager is cleared.
+//********************************************************************
+//*Invariants: every block handed out is freed before the manager is
+//*				 cleared, values a block produces while running are still
+//*				 on the heap
+//********************************************************************
 class ScriptManager
 {
 protected:
-	ScriptBlock *BlockAvailable[8]; //1, 2, 4, 8, 16, 32, 64, 128
-	ScriptBlock *BlockUsed[8];//1, 2, 4, 8, 16, 32, 64, 128
+	ScriptBlock *BlockAvailable[SCRIPT_SIZE_CLASSES]; //1, 2, 4, 8, 16, 32, 64, 128
+	int BlockUsed[SCRIPT_SIZE_CLASSES];//1, 2, 4, 8, 16, 32, 64, 128
+
+	//each chunk starts with a pointer to the one before it
+	char *pChunks;
+	int ChunkUsed;
+	int ChunkSize;
+
+	//stats
+	int NumChunks;
+	int HeapBytes;
+	int UsedBytes;
+	int NumBlocks;
+	int NumArgLists;
+	int NumStrings;
+	int NumLargeBlocks;
+
+	void *Alloc(int Size);
+	//SCRIPT_SIZE_LARGE past the biggest class
+	static int GetSizeClass(int Size);
 
 public:
 	ScriptBlock *GetBlock(int Size);
 	void AddBlock(int Size);
 	void FreeBlock(ScriptBlock *);
 
+	//top level argument lists, constructed
+	ScriptArg *GetArgs(int Num);
+	//frees whatever the arguments point to and destroys them
+	void FreeArgs(ScriptArg *ArgList, int Num);
+
+	char *GetString(int Length);
+	char *AddString(const char *String);
+
+	//gives every chunk back to the heap at once
+	void Clear();
+
+	int GetHeapBytes() { return HeapBytes; }
+	int GetNumChunks() { return NumChunks; }
+	//heap allocations loading the same scripts a piece at a time took
+	int GetNumPieces() { return NumBlocks * 2 + NumArgLists + NumStrings; }
+
+	void OutPutDebugInfo(FILE *fp);
+
 	ScriptManager();
 	~ScriptManager();
 
-
 };
 
 extern ScriptBlock *ScriptContextBlock;
@@ -29,6 +29,8 @@
 #include "spells.h"
 #include "entrance.h"
 #include "zsHelpWin.h"
+#include "replay.h"
+#include <stddef.h>
 
 #define IDC_ASK			989898
 #define IDC_SAY_CHAR		6543
@@ -44,7 +46,7 @@ static int NextTalkWin = IDC_TALK_START;
 
 ScriptArg *ScriptStack[128];
 int StackTop = 0;
-ScriptArg *(*ScriptFunctions[256])(ScriptArg *ArgList, ScriptArg *pDestination);
+ScriptArg *(*ScriptFunctions[MAX_FUNCS])(ScriptArg *ArgList, ScriptArg *pDestination);
 
 ScriptArg *talk(ScriptArg *ArgList, ScriptArg *pDestination) 
 {
@@ -863,7 +865,7 @@ ScriptArg *sflag(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 	else
 	{
-		pFlag = (Flag *)SA->GetValue();
+		pFlag = PreludeFlags.GetFlag((int)SA->GetValue());
 		pFlag->Value = ArgList[1].Evaluate()->GetValue();
 	}
 	
@@ -896,7 +898,7 @@ ScriptArg *flagm(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 	else
 	{
-		pFlag = (Flag *)SA->GetValue();
+		pFlag = PreludeFlags.GetFlag((int)SA->GetValue());
 		pFlag->Value = (void *)((int)pFlag->Value - (int)ArgList[1].Evaluate()->GetValue());
 	}
 
@@ -910,7 +912,6 @@ ScriptArg *flagm(ScriptArg *ArgList, ScriptArg *pDestination)
 /* true if flag existed, false if not */
 ScriptArg *killflag(ScriptArg *ArgList, ScriptArg *pDestination)
 {
-	Flag *pFlag;
 	ScriptArg *SA;
 	int BResult;
 
@@ -925,8 +926,7 @@ ScriptArg *killflag(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 	else
 	{
-		pFlag = (Flag *)SA->GetValue();
-		BResult = PreludeFlags.Kill(pFlag->Name);
+		BResult = PreludeFlags.Kill((int)SA->GetValue());
 	}
 	
 	pDestination->SetType(ARG_NUMBER);
@@ -954,7 +954,7 @@ ScriptArg *flagp(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 	else
 	{
-		pFlag = (Flag *)SA->GetValue();
+		pFlag = PreludeFlags.GetFlag((int)SA->GetValue());
 		pFlag->Value = (void *) ((int)pFlag->Value + (int)ArgList[1].Evaluate()->GetValue());
 	}
 	
@@ -982,7 +982,7 @@ ScriptArg *flag(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 	else
 	{
-		pFlag = (Flag *)SA->GetValue();
+		pFlag = PreludeFlags.GetFlag((int)SA->GetValue());
 	}
 	
 	pDestination->SetType(ARG_NUMBER);
@@ -1201,7 +1201,7 @@ ScriptArg *randnum(ScriptArg *ArgList, ScriptArg *pDestination)
 	}
 
 
-	pDestination->SetValue((void *)(rand() % (int)SA->GetValue()));
+	pDestination->SetValue((void *)(GameRand() % (int)SA->GetValue()));
 	pDestination->SetType(ARG_NUMBER);
 
 	return pDestination;
@@ -1234,7 +1234,7 @@ ScriptArg *prand(ScriptArg *ArgList, ScriptArg *pDestination)
 	Modifier = (int)pSB->GetValue();
 
 	int Base;
-	Base = rand();
+	Base = GameRand();
 
 	pDestination->SetValue((void *)(Base % (int)pSA->GetValue()));
 	pDestination->SetType(ARG_NUMBER);
@@ -3148,7 +3148,7 @@ ScriptArg *placeclearlarge(ScriptArg *ArgList, ScriptArg *pDestination)
 		pCreature->SetAreaIn(AreaNum);
 		pCreature->SetRegionIn(PreludeWorld->GetArea(AreaNum)->GetRegion(&vNewPos));
 		pCreature->AddToWorld();
-		pCreature->SetAngle(((float)rand() / (float)RAND_MAX) * PI_MUL_2);
+		pCreature->SetAngle(((float)GameRand() / (float)GAME_RAND_MAX) * PI_MUL_2);
 		pDestination->SetType(ARG_CREATURE);
 		pDestination->SetValue((void *)pCreature);
 		pCreature->SetLastPlacedTime(PreludeWorld->GetTotalTime());
@@ -5162,6 +5162,66 @@ ScriptArg *illegal(ScriptArg *ArgList, ScriptArg *pDestination)
 
 
 
+SCRIPT_RECORD_T *pScriptRecord = NULL;
+
+static void Record(const char *Text)
+{
+	int Length;
+
+	Length = strlen(Text);
+	if(pScriptRecord->Length + Length >= SCRIPT_RECORD_LENGTH)
+	{
+		Length = SCRIPT_RECORD_LENGTH - 1 - pScriptRecord->Length;
+	}
+	memcpy(&pScriptRecord->Text[pScriptRecord->Length], Text, Length);
+	pScriptRecord->Length += Length;
+	pScriptRecord->Text[pScriptRecord->Length] = '\0';
+}
+
+static void RecordArg(ScriptArg *pArg)
+{
+	char Text[80];
+
+	switch(pArg->GetType())
+	{
+		case ARG_LABEL:
+		case ARG_CHARACTER_LABEL:
+		case ARG_STRING:
+			sprintf(Text," [%.64s]",(char *)pArg->GetValue());
+			break;
+		default:
+			sprintf(Text," %i:%ld",(int)pArg->GetType(),(long)(intptr_t)pArg->GetValue());
+			break;
+	}
+	Record(Text);
+}
+
+void RecordScriptCall(int FuncNum, ScriptArg *ArgList)
+{
+	char FuncName[FUNC_NAME_LENGTH];
+	int n;
+
+	pScriptRecord->NumCalls++;
+
+	GetFuncName(FuncNum, FuncName);
+	Record(FuncName);
+	Record("(");
+	for(n = 0; ArgList[n].GetType() != ARG_TERMINATOR; n++)
+	{
+		RecordArg(ArgList[n].Evaluate());
+	}
+	Record(")\n");
+}
+
+void RecordScriptTalk(const char *Character)
+{
+	pScriptRecord->NumCalls++;
+
+	Record("talk #");
+	Record(Character ? Character : "");
+	Record("#\n");
+}
+
 ScriptArg *CallFunc(int FuncNum, ScriptArg *ArgList, ScriptArg *pDestination)
 {
 	if(!ScriptFunctions[FuncNum])
@@ -5169,6 +5229,14 @@ ScriptArg *CallFunc(int FuncNum, ScriptArg *ArgList, ScriptArg *pDestination)
 		SafeExit("Attempted to call non-existent function\n");
 	}
 
+	if(pScriptRecord && !IsQuietFunc(FuncNum))
+	{
+		RecordScriptCall(FuncNum, ArgList);
+		pDestination->ClearValue();
+		pDestination->SetType(ARG_NUMBER);
+		return pDestination;
+	}
+
 	ScriptArg *SA;
 
 #ifdef SHOW_SCRIPT_DEBUG
@@ -5203,6 +5271,51 @@ ScriptArg *CallFunc(int FuncNum, ScriptArg *ArgList, ScriptArg *pDestination)
 	return pDestination;
 }
 
+SCRIPT_FUNC_T GetFunc(int FuncNum)
+{
+	return ScriptFunctions[FuncNum];
+}
+
+BOOL IsQuietFunc(int FuncNum)
+{
+	SCRIPT_FUNC_T pFunc;
+
+	pFunc = ScriptFunctions[FuncNum];
+
+	return pFunc == flag || pFunc == sflag || pFunc == flagp || pFunc == flagm ||
+			 pFunc == killflag || pFunc == iff || pFunc == cond || pFunc == add ||
+			 pFunc == sub || pFunc == mul || pFunc == div || pFunc == comp ||
+			 pFunc == Mod || pFunc == Equals || pFunc == And || pFunc == Or ||
+			 pFunc == Not || pFunc == GetHour || pFunc == GetTotalTime;
+}
+
+int GetFuncArgs(int FuncNum, ScriptArg *ArgList)
+{
+	SCRIPT_FUNC_T pFunc;
+
+	pFunc = ScriptFunctions[FuncNum];
+
+	//add describes a bad argument before evaluating the next, and the flag
+	//setters look at the flag first, so those stay lazy
+	if(pFunc == flag || pFunc == killflag || pFunc == Not)
+	{
+		return 1;
+	}
+	if(pFunc == comp || pFunc == Equals || pFunc == Mod)
+	{
+		return 2;
+	}
+	//these give up on a bad first argument without evaluating the second
+	if((pFunc == sub || pFunc == mul || pFunc == div) && ArgList[0].GetType() == ARG_NUMBER)
+	{
+		return 2;
+	}
+	return FUNC_ARGS_LAZY;
+}
+
+//functions LoadFuncs put in the table, checked against funcs.txt
+static int NumRegistered = 0;
+
 void LoadFuncs()
 {
 	int n = 1;
@@ -5359,11 +5472,142 @@ void LoadFuncs()
 	ScriptFunctions[n++] = toggleinventory;
 	ScriptFunctions[n++] = removecreatures;
 
+	//n counts slot 0, which is never filled but has a name in funcs.txt
+	NumRegistered = n;
+
 	DEBUG_INFO("\nFunction Pointers assigned\n\n");
 
 }
 
-int GetFuncID(char *FuncName)
+//funcs.txt names the functions in the order LoadFuncs registers them, it
+//is read once into these
+static char FuncNames[MAX_FUNCS][FUNC_NAME_LENGTH];
+static int NumFuncNames = 0;
+static HashIndex FuncHash;
+static BOOL FuncNamesLoaded = FALSE;
+//the benchmark uses this to time the old way
+static BOOL ScanFuncsFile = FALSE;
+
+static int FindFuncName(const char *FuncName)
+{
+	int Slot;
+	int n;
+
+	for(Slot = FuncHash.First(HashString(FuncName)); (n = FuncHash.Get(Slot)) != HASH_EMPTY; Slot = FuncHash.Next(Slot))
+	{
+		if(!strcmp(FuncNames[n], FuncName))
+		{
+			return n;
+		}
+	}
+	return -1;
+}
+
+//every slot LoadFuncs fills needs a name and every name a filled slot,
+//otherwise the IDs scripts compile to call the wrong functions
+static void CheckFuncNames()
+{
+	int NumUnnamed = 0;
+	int NumUnfilled = 0;
+	int FirstUnnamed = -1;
+	int FirstUnfilled = -1;
+	int n;
+
+	for(n = 1; n < NumRegistered || n < NumFuncNames; n++)
+	{
+		if(n < NumRegistered && ScriptFunctions[n] && n >= NumFuncNames)
+		{
+			if(FirstUnnamed == -1)
+			{
+				FirstUnnamed = n;
+			}
+			NumUnnamed++;
+		}
+		if(n < NumFuncNames && (n >= NumRegistered || !ScriptFunctions[n]))
+		{
+			if(FirstUnfilled == -1)
+			{
+				FirstUnfilled = n;
+			}
+			NumUnfilled++;
+		}
+	}
+
+	if(NumUnnamed)
+	{
+		LogPrintf(LOG_WARNING, LOG_SCRIPT, "%i registered functions have no name in funcs.txt, the first is %i of %i",
+			NumUnnamed, FirstUnnamed, NumRegistered);
+	}
+	if(NumUnfilled)
+	{
+		LogPrintf(LOG_WARNING, LOG_SCRIPT, "%i names in funcs.txt have no registered function, the first is %s (%i of %i)",
+			NumUnfilled, FuncNames[FirstUnfilled], FirstUnfilled, NumFuncNames);
+	}
+}
+
+static void LoadFuncNames()
+{
+	FILE *gfp;
+	char funcname[FUNC_NAME_LENGTH];
+	char c;
+	int offset;
+	int Slot;
+
+	FuncHash.Reset(MAX_FUNCS);
+	NumFuncNames = 0;
+
+	gfp = SafeFileOpen("funcs.txt","rt");
+
+	c = '7';
+	while (!feof(gfp) && c != EOF)
+	{
+		c = fgetc(gfp);
+		if(c == '"')
+		{
+			offset = 0;
+			c = fgetc(gfp);
+			while(c != '"' && c != EOF && !feof(gfp))
+			{
+				if(offset < FUNC_NAME_LENGTH - 1)
+				{
+					funcname[offset] = c;
+					offset++;
+				}
+				c = fgetc(gfp);
+			}
+			funcname[offset] = '\0';
+
+			if(NumFuncNames >= MAX_FUNCS)
+			{
+				SafeExit("too many functions in funcs.txt");
+			}
+
+			//IDs still count a repeated name, but the first one is found
+			strcpy(FuncNames[NumFuncNames], funcname);
+			if(FindFuncName(funcname) == -1)
+			{
+				Slot = FuncHash.First(HashString(funcname));
+				while(FuncHash.Get(Slot) != HASH_EMPTY)
+				{
+					Slot = FuncHash.Next(Slot);
+				}
+				FuncHash.Set(Slot, NumFuncNames);
+			}
+			NumFuncNames++;
+		}
+	}
+	fclose(gfp);
+
+	if(NumRegistered)
+	{
+		CheckFuncNames();
+	}
+
+	FuncNamesLoaded = TRUE;
+}
+
+//the old lookup, -1 if not found
+static int ScanFuncID(char *FuncName)
 {
 	char funcname[32];
 
@@ -5399,59 +5643,136 @@ int GetFuncID(char *FuncName)
 	}
 	fclose(gfp);
 
-	char blarg[64];
-	sprintf(blarg,"unknown func: %s",FuncName);
-	SafeExit(blarg);
-	return FALSE;
+	return -1;
+}
+
+int GetFuncID(char *FuncName)
+{
+	int ID;
+
+	if(ScanFuncsFile)
+	{
+		ID = ScanFuncID(FuncName);
+	}
+	else
+	{
+		if(!FuncNamesLoaded)
+		{
+			LoadFuncNames();
+		}
+		ID = FindFuncName(FuncName);
+	}
 
+	if(ID == -1)
+	{
+		char blarg[64];
+		sprintf(blarg,"unknown func: %s",FuncName);
+		SafeExit(blarg);
+		return FALSE;
+	}
+
+	return ID;
 }
 
 void GetFuncName(int ID, char *Dest)
 {
-	FILE *gfp;
-	
-	gfp = SafeFileOpen("funcs.txt","rt");
-	
-	char c = '7';
-	int n = 0;
-	int offset = 0;
-	while ((n < ID) && !feof(gfp) && c != EOF)
+	if(!FuncNamesLoaded)
 	{
-		c = fgetc(gfp);
-		if(c == '"')
+		LoadFuncNames();
+	}
+
+	if(ID < 0 || ID >= NumFuncNames)
+	{
+		char blarg[64];
+		sprintf(blarg,"unknown number: %i", ID);
+		SafeExit(blarg);
+		return;
+	}
+
+	strcpy(Dest, FuncNames[ID]);
+}
+
+static int ImportScriptFile(const char *FileName, const char *BlockStart, BOOL Events)
+{
+	FILE *fp;
+	int NumBlocks = 0;
+
+	fp = fopen(FileName,"rt");
+	if(!fp)
+	{
+		return 0;
+	}
+
+	//events are #n# (...), characters are (#name# ...)
+	while(SeekTo(fp, BlockStart))
+	{
+		if(Events)
 		{
-			c = fgetc(gfp);
-			while(c != '"' && c != EOF && !feof(gfp))
+			SeekTo(fp, BlockStart);
+		}
+		ScriptBlock SB;
+		SB.Import(fp);
+		NumBlocks++;
+	}
+
+	fclose(fp);
+
+	return NumBlocks;
+}
+
+int BenchmarkScriptImport(FILE *fpResults)
+{
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double Time[2];
+	int NumBlocks = 0;
+	int NumMismatches = 0;
+	int Pass;
+	int n;
+
+	QueryPerformanceFrequency(&Frequency);
+
+	if(!FuncNamesLoaded)
+	{
+		LoadFuncNames();
+	}
+
+	for(n = 0; n < NumFuncNames; n++)
+	{
+		if(ScanFuncID(FuncNames[n]) != FindFuncName(FuncNames[n]))
+		{
+			NumMismatches++;
+			if(fpResults)
 			{
-				c = fgetc(gfp);
+				fprintf(fpResults,"func %s: file and table disagree\n", FuncNames[n]);
 			}
-			n++;
 		}
-		
 	}
 
-	c = fgetc(gfp);
-	while(c != '"') 
-		c = fgetc(gfp);
+	//the file scan first, then the table
+	for(Pass = 0; Pass < 2; Pass++)
+	{
+		ScanFuncsFile = !Pass;
+
+		QueryPerformanceCounter(&Start);
+		NumBlocks = ImportScriptFile("events.txt", "#", TRUE);
+		NumBlocks += ImportScriptFile("people.txt", "(", FALSE);
+		QueryPerformanceCounter(&End);
+
+		Time[Pass] = (double)(End.QuadPart - Start.QuadPart) * 1000.0 / (double)Frequency.QuadPart;
+	}
+	ScanFuncsFile = FALSE;
 
-	offset = 0;
-	c = fgetc(gfp);
-	while(c != '"' && c != EOF && !feof(gfp))
+	if(fpResults)
 	{
-		Dest[offset] = c;
-		offset++;
-		c = fgetc(gfp);
+		fprintf(fpResults,"script import of %i blocks, %i function names\n", NumBlocks, NumFuncNames);
+		fprintf(fpResults,"reading funcs.txt per name: %f ms\n", Time[0]);
+		fprintf(fpResults,"name table: %f ms\n", Time[1]);
+		fprintf(fpResults,"%i mismatches\n", NumMismatches);
 	}
-	Dest[offset] = '\0';
-	
-	fclose(gfp);
-	
-	return;
-	
-	char blarg[64];
-	sprintf(blarg,"unknown number: %i", ID);
-	SafeExit(blarg);
-	return;
+
+	return NumMismatches;
 }
 
 void ClearStack()
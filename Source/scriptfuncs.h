@@ -5,14 +5,63 @@
 #include "creatures.h"
 #include "items.h"
 
+#define MAX_FUNCS				256
+#define FUNC_NAME_LENGTH		32
+
+typedef ScriptArg *(*SCRIPT_FUNC_T)(ScriptArg *ArgList, ScriptArg *pDestination);
+
+//a function that evaluates its arguments only as it needs them, the rest
+//evaluate a fixed number, each once, first to last, doing nothing else
+//until the last is evaluated
+#define FUNC_ARGS_LAZY		-1
+
 void LoadFuncs();
 
 ScriptArg *CallFunc(int FuncNum, ScriptArg* ArgList, ScriptArg *Destination);
 
+//NULL if nothing was loaded into the slot
+SCRIPT_FUNC_T GetFunc(int FuncNum);
+
+//only touches PreludeFlags and its own arguments, so can safely be run twice
+BOOL IsQuietFunc(int FuncNum);
+
+//FUNC_ARGS_LAZY or a count, ArgList is what the function would be given
+int GetFuncArgs(int FuncNum, ScriptArg *ArgList);
+
+#define SCRIPT_RECORD_LENGTH	8192
+
+//a line per call, a call's arguments and what they call in turn inside
+//its brackets.  a record that runs out of room stops growing
+typedef struct
+{
+	int NumCalls;
+	int Length;
+	char Text[SCRIPT_RECORD_LENGTH];
+} SCRIPT_RECORD_T;
+
+//while this is set, functions that aren't quiet and conversations are
+//written to it instead of being run.  every argument is evaluated once,
+//first to last, and the result is the number 0
+extern SCRIPT_RECORD_T *pScriptRecord;
+
+void RecordScriptCall(int FuncNum, ScriptArg *ArgList);
+void RecordScriptTalk(const char *Character);
+
+//the script compiler builds its own branches for iff
+ScriptArg *iff(ScriptArg *ArgList, ScriptArg *pDestination);
+
+//their words are checked against the labels when a script is loaded
+ScriptArg *addword(ScriptArg *ArgList, ScriptArg *pDestination);
+ScriptArg *goword(ScriptArg *ArgList, ScriptArg *pDestination);
+
 int GetFuncID(char *FuncName);
 
 void GetFuncName(int ID, char *Dest);
 
+//times importing events.txt and people.txt with funcs.txt read for each
+//function name against the table, returns names the two disagree on
+int BenchmarkScriptImport(FILE *fpResults);
+
 void ClearStack();
 
 void GetSub(ScriptArg *ToFill, char *SubString);
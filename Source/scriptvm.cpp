@@ -0,0 +1,741 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				scriptvm.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  compile script blocks to a flat list of instructions and
+//*			 run them without walking the tree
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		only functions that evaluate every argument once, in order, get
+//*		their arguments compiled inline, the rest evaluate the block's
+//*		own argument list and go back through Process for each block
+//*********************************************************************
+//*********************************************************************
+#include "scriptvm.h"
+#include "zsutilities.h"
+#include "events.h"
+#include <assert.h>
+#include <stddef.h>
+
+BOOL ScriptUseVM = TRUE;
+BOOL ScriptCheck = FALSE;
+
+//arguments already evaluated, copied in for one call at a time.  the
+//functions given these never run a script themselves so one set will do
+static ScriptArg CallArgs[MAX_ARGS + 1];
+
+//the test iff makes of its condition
+static BOOL IsTrue(ScriptArg *pCondition)
+{
+	switch(pCondition->GetType())
+	{
+		case ARG_PARTYONE:
+		case ARG_PARTYTWO:
+		case ARG_PARTYTHREE:
+		case ARG_PARTYFOUR:
+		case ARG_PARTYFIVE:
+		case ARG_PARTYSIX:
+			return pCondition->GetCreature() != NULL;
+		default:
+			return pCondition->GetValue() != NULL;
+	}
+}
+
+void InitScriptVM()
+{
+	FILE *fp;
+
+	fp = fopen("gui.ini","rt");
+	if(fp)
+	{
+		if(SeekTo(fp,"SCRIPTVM"))
+		{
+			ScriptUseVM = GetInt(fp);
+		}
+		fseek(fp,0,SEEK_SET);
+		if(SeekTo(fp,"SCRIPTCHECK"))
+		{
+			ScriptCheck = GetInt(fp);
+		}
+		fclose(fp);
+	}
+}
+
+//************** Constructors  ****************************************
+
+ScriptProgram::ScriptProgram()
+{
+	Code = NULL;
+	CodeSize = 0;
+	MaxCode = 0;
+
+	Blocks = NULL;
+	NumBlocks = 0;
+	MaxBlocks = 0;
+
+	Operands = NULL;
+	NumOperands = 0;
+	MaxOperands = 0;
+
+	Funcs = NULL;
+	FuncNums = NULL;
+	NumFuncs = 0;
+	MaxFuncs = 0;
+}
+
+ScriptProgram *ScriptProgram::Compile(ScriptBlock *pBlock)
+{
+	ScriptProgram *pProgram;
+
+	pProgram = new ScriptProgram;
+	pProgram->CompileBlock(pBlock);
+	pProgram->Emit(SOP_END);
+
+	return pProgram;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+ScriptProgram::~ScriptProgram()
+{
+	if(Code)
+	{
+		delete[] Code;
+	}
+	if(Blocks)
+	{
+		delete[] Blocks;
+	}
+	if(Operands)
+	{
+		delete[] Operands;
+	}
+	if(Funcs)
+	{
+		delete[] Funcs;
+		delete[] FuncNums;
+	}
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Compiling  *********************************************
+
+void ScriptProgram::Emit(int Value)
+{
+	int *NewCode;
+
+	if(CodeSize == MaxCode)
+	{
+		MaxCode += SCRIPT_CODE_GROW;
+		NewCode = new int[MaxCode];
+		if(Code)
+		{
+			memcpy(NewCode, Code, CodeSize * sizeof(int));
+			delete[] Code;
+		}
+		Code = NewCode;
+	}
+
+	Code[CodeSize++] = Value;
+}
+
+int ScriptProgram::AddBlock(ScriptBlock *pBlock)
+{
+	ScriptBlock **NewBlocks;
+
+	if(NumBlocks == MaxBlocks)
+	{
+		MaxBlocks += SCRIPT_CODE_GROW;
+		NewBlocks = new ScriptBlock *[MaxBlocks];
+		if(Blocks)
+		{
+			memcpy(NewBlocks, Blocks, NumBlocks * sizeof(ScriptBlock *));
+			delete[] Blocks;
+		}
+		Blocks = NewBlocks;
+	}
+
+	Blocks[NumBlocks] = pBlock;
+	return NumBlocks++;
+}
+
+int ScriptProgram::AddOperand(ScriptArg *pArg)
+{
+	ScriptArg **NewOperands;
+
+	if(NumOperands == MaxOperands)
+	{
+		MaxOperands += SCRIPT_CODE_GROW;
+		NewOperands = new ScriptArg *[MaxOperands];
+		if(Operands)
+		{
+			memcpy(NewOperands, Operands, NumOperands * sizeof(ScriptArg *));
+			delete[] Operands;
+		}
+		Operands = NewOperands;
+	}
+
+	Operands[NumOperands] = pArg;
+	return NumOperands++;
+}
+
+int ScriptProgram::AddFunc(int FuncNum)
+{
+	SCRIPT_FUNC_T *NewFuncs;
+	int *NewFuncNums;
+	int n;
+
+	for(n = 0; n < NumFuncs; n++)
+	{
+		if(FuncNums[n] == FuncNum)
+		{
+			return n;
+		}
+	}
+
+	if(NumFuncs == MaxFuncs)
+	{
+		MaxFuncs += SCRIPT_CODE_GROW;
+		NewFuncs = new SCRIPT_FUNC_T[MaxFuncs];
+		NewFuncNums = new int[MaxFuncs];
+		if(Funcs)
+		{
+			memcpy(NewFuncs, Funcs, NumFuncs * sizeof(SCRIPT_FUNC_T));
+			memcpy(NewFuncNums, FuncNums, NumFuncs * sizeof(int));
+			delete[] Funcs;
+			delete[] FuncNums;
+		}
+		Funcs = NewFuncs;
+		FuncNums = NewFuncNums;
+	}
+
+	Funcs[NumFuncs] = GetFunc(FuncNum);
+	FuncNums[NumFuncs] = FuncNum;
+	return NumFuncs++;
+}
+
+//an argument block is compiled inline ahead of its use and the operand is
+//its value, anything else is used where it lies
+int ScriptProgram::CompileOperand(ScriptBlock *pBlock, int Num)
+{
+	ScriptBlock *pArgBlock;
+
+	if(pBlock->ArgList[Num].GetType() == ARG_BLOCK)
+	{
+		pArgBlock = (ScriptBlock *)pBlock->ArgList[Num].GetValue();
+		CompileBlock(pArgBlock);
+		return AddOperand(&pArgBlock->Value);
+	}
+
+	return AddOperand(&pBlock->ArgList[Num]);
+}
+
+void ScriptProgram::CompileBlock(ScriptBlock *pBlock)
+{
+	int BlockNum;
+	int Operand;
+	int ElseJump;
+	int EndJump;
+	int *EndJumps;
+	int NumEndJumps;
+	int FuncNum;
+	int Args;
+	int CallOperands[MAX_ARGS];
+	BOOL HasBlock;
+	int n;
+
+	BlockNum = AddBlock(pBlock);
+
+	Emit(SOP_CLEAR);
+	Emit(BlockNum);
+
+	switch(pBlock->ArgList[0].GetType())
+	{
+		case ARG_FUNC_ID:
+			//iff's branches are only run one way, so they can be laid out
+			//here rather than left to the function
+			if(GetFunc((int)(intptr_t)pBlock->ArgList[0].GetValue()) == iff && pBlock->NumArgs >= 4)
+			{
+				Operand = CompileOperand(pBlock, 1);
+				Emit(SOP_IF);
+				Emit(Operand);
+				ElseJump = CodeSize;
+				Emit(0);
+
+				Operand = CompileOperand(pBlock, 2);
+				Emit(SOP_RESULT);
+				Emit(BlockNum);
+				Emit(Operand);
+				Emit(SOP_JUMP);
+				EndJump = CodeSize;
+				Emit(0);
+
+				Code[ElseJump] = CodeSize;
+				Operand = CompileOperand(pBlock, 3);
+				Emit(SOP_RESULT);
+				Emit(BlockNum);
+				Emit(Operand);
+
+				Code[EndJump] = CodeSize;
+				return;
+			}
+
+			FuncNum = (int)(intptr_t)pBlock->ArgList[0].GetValue();
+			Args = GetFuncArgs(FuncNum, &pBlock->ArgList[1]);
+
+			//a strict function's argument blocks can be run here, unless
+			//it would read past the end of the block
+			HasBlock = FALSE;
+			if(Args != FUNC_ARGS_LAZY)
+			{
+				for(n = 1; n < pBlock->NumArgs && pBlock->ArgList[n].GetType() != ARG_TERMINATOR; n++)
+				{
+					if(n <= Args && pBlock->ArgList[n].GetType() == ARG_BLOCK)
+					{
+						HasBlock = TRUE;
+					}
+				}
+				if(n - 1 < Args)
+				{
+					HasBlock = FALSE;
+				}
+			}
+
+			//with only literals the function may as well read the block
+			if(!HasBlock)
+			{
+				Emit(SOP_CALL);
+				Emit(BlockNum);
+				Emit(AddFunc(FuncNum));
+				return;
+			}
+
+			for(n = 0; n < Args; n++)
+			{
+				CallOperands[n] = CompileOperand(pBlock, n + 1);
+			}
+
+			Emit(SOP_CALLARGS);
+			Emit(BlockNum);
+			Emit(AddFunc(FuncNum));
+			Emit(Args);
+			for(n = 0; n < Args; n++)
+			{
+				Emit(CallOperands[n]);
+			}
+			return;
+
+		case ARG_CHARACTER_LABEL:
+			Emit(SOP_TALK);
+			Emit(BlockNum);
+			return;
+
+		default:
+			break;
+	}
+
+	//a list, the value is the first argument's and the rest are run until
+	//one comes back a terminator
+	EndJumps = new int[pBlock->NumArgs];
+	NumEndJumps = 0;
+
+	Operand = CompileOperand(pBlock, 0);
+	Emit(SOP_FIRST);
+	Emit(BlockNum);
+	Emit(Operand);
+	EndJumps[NumEndJumps++] = CodeSize;
+	Emit(0);
+
+	//literals other than the last never stop the list, so only blocks
+	//need a test
+	for(n = 1; n < pBlock->NumArgs && pBlock->ArgList[n].GetType() != ARG_TERMINATOR; n++)
+	{
+		if(pBlock->ArgList[n].GetType() == ARG_BLOCK)
+		{
+			Operand = CompileOperand(pBlock, n);
+			Emit(SOP_STOP);
+			Emit(BlockNum);
+			Emit(Operand);
+			EndJumps[NumEndJumps++] = CodeSize;
+			Emit(0);
+		}
+	}
+
+	for(n = 0; n < NumEndJumps; n++)
+	{
+		Code[EndJumps[n]] = CodeSize;
+	}
+
+	delete[] EndJumps;
+}
+
+//end: Compiling *******************************************************
+
+
+
+//************  Running  ***********************************************
+
+ScriptArg *ScriptProgram::Run()
+{
+	ScriptBlock *pBlock;
+	ScriptArg *pArg;
+	int NumArgs;
+	int PC;
+	int n;
+
+	PC = 0;
+
+	while(TRUE)
+	{
+		switch(Code[PC])
+		{
+			case SOP_CLEAR:
+				Blocks[Code[PC + 1]]->Value.ClearValue();
+				PC += 2;
+				break;
+
+			case SOP_CALL:
+				pBlock = Blocks[Code[PC + 1]];
+#ifdef SHOW_SCRIPT_DEBUG
+				CallFunc(FuncNums[Code[PC + 2]], &pBlock->ArgList[1], &pBlock->Value);
+#else
+				if(Funcs[Code[PC + 2]] && !pScriptRecord)
+				{
+					Funcs[Code[PC + 2]](&pBlock->ArgList[1], &pBlock->Value);
+				}
+				else
+				{
+					//records the call, or exits with the usual complaint
+					CallFunc(FuncNums[Code[PC + 2]], &pBlock->ArgList[1], &pBlock->Value);
+				}
+#endif
+				PC += 3;
+				break;
+
+			case SOP_CALLARGS:
+				pBlock = Blocks[Code[PC + 1]];
+				NumArgs = Code[PC + 3];
+				for(n = 0; n < NumArgs; n++)
+				{
+					pArg = Operands[Code[PC + 4 + n]];
+					CallArgs[n].SetValue(pArg->GetValue());
+					CallArgs[n].SetType(pArg->GetType());
+				}
+				CallArgs[NumArgs].SetValue(NULL);
+				CallArgs[NumArgs].SetType(ARG_TERMINATOR);
+#ifdef SHOW_SCRIPT_DEBUG
+				CallFunc(FuncNums[Code[PC + 2]], CallArgs, &pBlock->Value);
+#else
+				Funcs[Code[PC + 2]](CallArgs, &pBlock->Value);
+#endif
+				//the copies don't own what they point to
+				for(n = 0; n < NumArgs; n++)
+				{
+					CallArgs[n].SetValue(NULL);
+					CallArgs[n].SetType(ARG_NONE);
+				}
+				PC += 4 + NumArgs;
+				break;
+
+			case SOP_TALK:
+				Blocks[Code[PC + 1]]->Talk();
+				PC += 2;
+				break;
+
+			case SOP_FIRST:
+				pBlock = Blocks[Code[PC + 1]];
+				pArg = Operands[Code[PC + 2]];
+				if(pArg->GetType() == ARG_FUNC_ID)
+				{
+					//Interpret takes the id from the argument itself, not its value
+					CallFunc((int)(intptr_t)pBlock->ArgList[0].GetValue(), &pBlock->ArgList[1], &pBlock->Value);
+					PC = Code[PC + 3];
+				}
+				else
+				if(pArg->GetType() == ARG_CHARACTER_LABEL)
+				{
+					pBlock->Talk();
+					PC = Code[PC + 3];
+				}
+				else
+				{
+					pBlock->Value = *pArg;
+					if(pBlock->Value.GetType() == ARG_TERMINATOR)
+					{
+						if(pBlock->ArgList[0].GetType() == ARG_TERMINATOR)
+						{
+							pBlock->Value.SetType(ARG_NONE);
+						}
+						PC = Code[PC + 3];
+					}
+					else
+					{
+						PC += 4;
+					}
+				}
+				break;
+
+			case SOP_STOP:
+				if(Operands[Code[PC + 2]]->GetType() == ARG_TERMINATOR)
+				{
+					Blocks[Code[PC + 1]]->Value.SetType(ARG_TERMINATOR);
+					PC = Code[PC + 3];
+				}
+				else
+				{
+					PC += 4;
+				}
+				break;
+
+			case SOP_IF:
+				if(IsTrue(Operands[Code[PC + 1]]))
+				{
+					PC += 3;
+				}
+				else
+				{
+					PC = Code[PC + 2];
+				}
+				break;
+
+			case SOP_RESULT:
+				Blocks[Code[PC + 1]]->Value = *Operands[Code[PC + 2]];
+				PC += 3;
+				break;
+
+			case SOP_JUMP:
+				PC = Code[PC + 1];
+				break;
+
+			case SOP_END:
+				return &Blocks[0]->Value;
+
+			default:
+				SafeExit("bad script instruction\n");
+				break;
+		}
+	}
+}
+
+//end: Running *********************************************************
+
+
+
+//************ Debug ***************************************************
+
+void ScriptProgram::OutPutDebugInfo(FILE *fp)
+{
+	fprintf(fp,"script program: %i words of code, %i blocks, %i operands, %i functions\n", CodeSize, NumBlocks, NumOperands, NumFuncs);
+}
+
+static BOOL SameResult(ScriptArg *pA, ScriptArg *pB)
+{
+	if(pA->GetType() != pB->GetType())
+	{
+		return FALSE;
+	}
+
+	switch(pA->GetType())
+	{
+		case ARG_LABEL:
+		case ARG_CHARACTER_LABEL:
+		case ARG_STRING:
+			return !strcmp((char *)pA->GetValue(), (char *)pB->GetValue());
+		default:
+			return pA->GetValue() == pB->GetValue();
+	}
+}
+
+//the line each record first differs on
+static void OutputCallDifference(SCRIPT_RECORD_T *pExpected, SCRIPT_RECORD_T *pGot, FILE *fp)
+{
+	int Start;
+	int n;
+
+	Start = 0;
+	for(n = 0; n < pExpected->Length && n < pGot->Length && pExpected->Text[n] == pGot->Text[n]; n++)
+	{
+		if(pExpected->Text[n] == '\n')
+		{
+			Start = n + 1;
+		}
+	}
+
+	fprintf(fp,"calls differ, interpreted made %i, compiled %i\ninterpreted: ", pExpected->NumCalls, pGot->NumCalls);
+	for(n = Start; n < pExpected->Length && pExpected->Text[n] != '\n'; n++)
+	{
+		fputc(pExpected->Text[n], fp);
+	}
+	fprintf(fp,"\ncompiled: ");
+	for(n = Start; n < pGot->Length && pGot->Text[n] != '\n'; n++)
+	{
+		fputc(pGot->Text[n], fp);
+	}
+	fprintf(fp,"\nfor: ");
+}
+
+int ScriptProgram::CheckBlock(ScriptBlock *pBlock, FILE *fp, SCRIPT_CHECK_T *pCheck)
+{
+	ScriptProgram *pProgram;
+	SCRIPT_RECORD_T *pOldRecord;
+	ScriptArg Expected;
+	ScriptArg *pResult;
+	BOOL OldUseVM;
+	int Differences;
+	int n;
+
+	pCheck->NumChecked++;
+
+	pProgram = Compile(pBlock);
+	OldUseVM = ScriptUseVM;
+	pOldRecord = pScriptRecord;
+
+	PreludeFlags.GetState(pCheck->Before, pCheck->LiveBefore);
+
+	pCheck->pExpectedCalls->NumCalls = 0;
+	pCheck->pExpectedCalls->Length = 0;
+	pCheck->pExpectedCalls->Text[0] = '\0';
+	pScriptRecord = pCheck->pExpectedCalls;
+	ScriptUseVM = FALSE;
+	Expected = *pBlock->Interpret();
+	PreludeFlags.GetState(pCheck->Expected, pCheck->LiveExpected);
+
+	PreludeFlags.SetState(pCheck->Before, pCheck->LiveBefore);
+
+	pCheck->pGotCalls->NumCalls = 0;
+	pCheck->pGotCalls->Length = 0;
+	pCheck->pGotCalls->Text[0] = '\0';
+	pScriptRecord = pCheck->pGotCalls;
+	ScriptUseVM = TRUE;
+	pResult = pProgram->Run();
+	PreludeFlags.GetState(pCheck->Got, pCheck->LiveGot);
+
+	PreludeFlags.SetState(pCheck->Before, pCheck->LiveBefore);
+	ScriptUseVM = OldUseVM;
+	pScriptRecord = pOldRecord;
+
+	Differences = 0;
+
+	if(!SameResult(&Expected, pResult))
+	{
+		fprintf(fp,"result differs for: ");
+		pBlock->Export(fp);
+		fprintf(fp,"interpreted:");
+		Expected.Print(fp);
+		fprintf(fp,"\ncompiled:");
+		pResult->Print(fp);
+		fprintf(fp,"\n");
+		Differences++;
+	}
+
+	for(n = 0; n < pCheck->NumFlags; n++)
+	{
+		if(pCheck->Expected[n] != pCheck->Got[n] || pCheck->LiveExpected[n] != pCheck->LiveGot[n])
+		{
+			fprintf(fp,"flag %s differs, interpreted: %i compiled: %i for: ", PreludeFlags.GetName(n), (int)(intptr_t)pCheck->Expected[n], (int)(intptr_t)pCheck->Got[n]);
+			pBlock->Export(fp);
+			Differences++;
+		}
+	}
+
+	if(pCheck->pExpectedCalls->NumCalls != pCheck->pGotCalls->NumCalls ||
+		strcmp(pCheck->pExpectedCalls->Text, pCheck->pGotCalls->Text))
+	{
+		OutputCallDifference(pCheck->pExpectedCalls, pCheck->pGotCalls, fp);
+		pBlock->Export(fp);
+		Differences++;
+	}
+
+	delete pProgram;
+
+	return Differences;
+}
+
+int ScriptProgram::Check(ScriptBlock *pBlock, FILE *fp, int *pNumChecked)
+{
+	SCRIPT_CHECK_T Check;
+	int Differences;
+	int NumFlags;
+
+	//Interpret never interns a flag, so the count holds for the whole check
+	Check.NumFlags = PreludeFlags.GetNumFlags();
+	NumFlags = Check.NumFlags ? Check.NumFlags : 1;
+
+	Check.NumChecked = 0;
+	Check.Before = new void *[NumFlags];
+	Check.Expected = new void *[NumFlags];
+	Check.Got = new void *[NumFlags];
+	Check.LiveBefore = new BOOL[NumFlags];
+	Check.LiveExpected = new BOOL[NumFlags];
+	Check.LiveGot = new BOOL[NumFlags];
+	Check.pExpectedCalls = new SCRIPT_RECORD_T;
+	Check.pGotCalls = new SCRIPT_RECORD_T;
+
+	Differences = CheckBlock(pBlock, fp, &Check);
+
+	delete[] Check.Before;
+	delete[] Check.Expected;
+	delete[] Check.Got;
+	delete[] Check.LiveBefore;
+	delete[] Check.LiveExpected;
+	delete[] Check.LiveGot;
+	delete Check.pExpectedCalls;
+	delete Check.pGotCalls;
+
+	if(pNumChecked)
+	{
+		*pNumChecked += Check.NumChecked;
+	}
+
+	return Differences;
+}
+
+int ScriptProgram::CheckAll(const char *LogName)
+{
+	FILE *fp;
+	FILE *fpPeople;
+	int Differences;
+	int NumChecked;
+	int n;
+
+	fp = SafeFileOpen(LogName,"wt");
+
+	Differences = 0;
+	NumChecked = 0;
+
+	for(n = 0; n < PreludeEvents.GetNumEvents(); n++)
+	{
+		Differences += Check(PreludeEvents.GetEvent(n), fp, &NumChecked);
+	}
+
+	fpPeople = fopen("people.txt","rt");
+	if(fpPeople)
+	{
+		while(SeekTo(fpPeople,"("))
+		{
+			ScriptBlock SB;
+			SB.Import(fpPeople);
+			Differences += Check(&SB, fp, &NumChecked);
+		}
+		fclose(fpPeople);
+	}
+
+	fprintf(fp,"%i blocks checked, %i differences\n", NumChecked, Differences);
+	fclose(fp);
+
+	return Differences;
+}
+
+//end: Debug ***********************************************************
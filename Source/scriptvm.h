@@ -0,0 +1,146 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				scriptvm.h						  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  compile script blocks to a flat list of instructions and
+//*			 run them without walking the tree
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		only functions that evaluate every argument once, in order, get
+//*		their arguments compiled inline, the rest evaluate the block's
+//*		own argument list and go back through Process for each block
+//*********************************************************************
+//*********************************************************************
+#ifndef SCRIPTVM_H
+#define SCRIPTVM_H
+
+#include "script.h"
+#include "scriptfuncs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+typedef enum
+{
+	SOP_CLEAR,		//block							clear the block's value
+	SOP_CALL,		//block, function				call with the block's arguments
+	SOP_CALLARGS,	//block, function, count, operands...	call with the operands
+	SOP_TALK,		//block							open a talk window on the block
+	SOP_FIRST,		//block, operand, jump		first argument of a list
+	SOP_STOP,		//block, operand, jump		later arguments of a list
+	SOP_IF,			//operand, jump				jump if the operand is false
+	SOP_RESULT,		//block, operand				copy the operand to the block's value
+	SOP_JUMP,		//jump
+	SOP_END,
+} SCRIPT_OP_T;
+
+#define SCRIPT_CODE_GROW		64
+
+//falls back to ScriptBlock::Interpret when FALSE
+extern BOOL ScriptUseVM;
+//run ScriptProgram::CheckAll once the events are loaded
+extern BOOL ScriptCheck;
+
+//flag states and calls made around the two runs of a block
+typedef struct
+{
+	int NumFlags;
+	int NumChecked;
+	void **Before;
+	void **Expected;
+	void **Got;
+	BOOL *LiveBefore;
+	BOOL *LiveExpected;
+	BOOL *LiveGot;
+	SCRIPT_RECORD_T *pExpectedCalls;
+	SCRIPT_RECORD_T *pGotCalls;
+} SCRIPT_CHECK_T;
+
+//*******************************CLASS********************************
+//**************          ScriptProgram          *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  The instructions for one block.  Lists of blocks, the
+//*			 branches of iff and the arguments of functions that take
+//*			 them strictly are compiled inline, so a whole event runs as
+//*			 one loop with the functions called through pointers resolved
+//*			 at compile time.  Operands point straight at the literal
+//*			 argument or at the value of the block that produces it.
+//********************************************************************
+//*Invariants: leaves every block's value just as Interpret would,
+//*				 the program is never changed once compiled so it can be
+//*				 run again from inside itself
+//********************************************************************
+class ScriptProgram
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	int *Code;
+	int CodeSize;
+	int MaxCode;
+
+	ScriptBlock **Blocks;
+	int NumBlocks;
+	int MaxBlocks;
+
+	ScriptArg **Operands;
+	int NumOperands;
+	int MaxOperands;
+
+	SCRIPT_FUNC_T *Funcs;
+	int *FuncNums;
+	int NumFuncs;
+	int MaxFuncs;
+
+	void Emit(int Value);
+	int AddBlock(ScriptBlock *pBlock);
+	int AddOperand(ScriptArg *pArg);
+	int AddFunc(int FuncNum);
+
+	void CompileBlock(ScriptBlock *pBlock);
+	int CompileOperand(ScriptBlock *pBlock, int Num);
+
+	static int CheckBlock(ScriptBlock *pBlock, FILE *fp, SCRIPT_CHECK_T *pCheck);
+
+	ScriptProgram();
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	int GetCodeSize() { return CodeSize; }
+	int GetNumBlocks() { return NumBlocks; }
+
+// Mutators -----------------------------------------
+	ScriptArg *Run();
+
+// Constructors ---------------------------------------
+	static ScriptProgram *Compile(ScriptBlock *pBlock);
+
+// Destructor -----------------------------------------
+	~ScriptProgram();
+
+// Debug ----------------------------------------------
+	void OutPutDebugInfo(FILE *fp);
+
+	//run pBlock through both Interpret and Run with the calls that aren't
+	//quiet going to pScriptRecord, and log any difference in result, in
+	//PreludeFlags or in the calls made.  flags are left as they were.
+	//returns the differences and adds to pNumChecked
+	static int Check(ScriptBlock *pBlock, FILE *fp, int *pNumChecked);
+	//every event and every character in people.txt
+	static int CheckAll(const char *LogName);
+
+};
+
+//reads SCRIPTVM and SCRIPTCHECK from gui.ini
+void InitScriptVM();
+
+#endif
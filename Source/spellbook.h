@@ -16,7 +16,7 @@ public:
 	friend void SaveSpellbooks(FILE *fp);
 
 	static Thing *GetFirst() { return pFirst; }
-	void SetFirst(Thing *NewFirst) { pFirst = (Spellbook *)NewFirst; }
+	void SetFirst(Thing *NewFirst) { pFirst = (Spellbook *)NewFirst; InvalidateFind(); }
 
 	Spellbook();
 	~Spellbook();
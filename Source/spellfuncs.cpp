@@ -19,6 +19,7 @@
 #include "combatmanager.h"
 #include "aura.h"
 #include "mainwindow.h"
+#include "replay.h"
 
 //TBD:  add check for half-bloods
 //TBD:  add check for knowledge of blood magic
@@ -230,7 +231,7 @@ int FlameFinger(Object *pCaster, Object *pTarget, int Level, int CallType, int D
 			pOb = Valley->FindObject(vLast.x, vLast.y, OBJECT_CREATURE);
 			if(pOb)
 			{	
-				Damage = MinDamage + (rand() % (MaxDamage - MinDamage));
+				Damage = MinDamage + (GameRand() % (MaxDamage - MinDamage));
 				if(Level != 1 || !PreludeParty.IsMember((Creature *)pOb))
 				{
 					pCreature = (Creature *)pOb;
@@ -851,7 +852,7 @@ int Spear(Object *pCaster, Object *pTarget, int Level, int CallType, int Data)
 	}
 
 	int Damage;
-	Damage = (rand() % (MaxDamage - MinDamage)) + MinDamage;
+	Damage = (GameRand() % (MaxDamage - MinDamage)) + MinDamage;
 
 	//now we have to trace the line of the "burst"
 	D3DVECTOR vRay, vCur, vLast;
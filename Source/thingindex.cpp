@@ -0,0 +1,420 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				thingindex.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed ID and name lookups over the creature, item and
+//*			 spellbook lists
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*
+//*********************************************************************
+//*********************************************************************
+#include "thingindex.h"
+#include "things.h"
+#include "creatures.h"
+#include <assert.h>
+
+//************** Constructors  ****************************************
+
+ThingIndex::ThingIndex()
+{
+	pHead = NULL;
+	Built = FALSE;
+	NumEntries = 0;
+	MaxEntries = 0;
+	Entries = NULL;
+	NumBuilds = 0;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+ThingIndex::~ThingIndex()
+{
+	Clear();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Accessors  *********************************************
+
+inline void ThingIndex::Validate(Thing *pListHead)
+{
+	if(!Built || pHead != pListHead)
+	{
+		Build(pListHead);
+	}
+}
+
+Thing *ThingIndex::Find(Thing *pListHead, int ID, int UID)
+{
+	int Slot;
+	int n;
+
+	Validate(pListHead);
+
+	for(Slot = IDTable.First(HashInt(ID)); (n = IDTable.Get(Slot)) != HASH_EMPTY; Slot = IDTable.Next(Slot))
+	{
+		if(Entries[n].ID == ID)
+		{
+			while(n != THING_INDEX_EMPTY)
+			{
+				if(Entries[n].pThing && (!UID || Entries[n].UID == UID))
+				{
+					return Entries[n].pThing;
+				}
+				n = Entries[n].NextSameID;
+			}
+			return NULL;
+		}
+	}
+
+	return NULL;
+}
+
+Thing *ThingIndex::Find(Thing *pListHead, const char *ThingName)
+{
+	unsigned int Hash;
+	int Slot;
+	int n;
+
+	Validate(pListHead);
+
+	Hash = HashString(ThingName);
+	for(Slot = NameTable.First(Hash); (n = NameTable.Get(Slot)) != HASH_EMPTY; Slot = NameTable.Next(Slot))
+	{
+		//a chain whose things are all gone holds no name any more
+		n = FirstAlive(n, TRUE);
+		if(n != THING_INDEX_EMPTY && Entries[n].NameHash == Hash &&
+			!strcmp(Entries[n].pThing->GetData(INDEX_NAME).String, ThingName))
+		{
+			return Entries[n].pThing;
+		}
+	}
+
+	return NULL;
+}
+
+int ThingIndex::FirstAlive(int n, BOOL ByName)
+{
+	while(n != THING_INDEX_EMPTY && !Entries[n].pThing)
+	{
+		n = ByName ? Entries[n].NextSameName : Entries[n].NextSameID;
+	}
+	return n;
+}
+
+int ThingIndex::Locate(Thing *pThing)
+{
+	int ID;
+	int Slot;
+	int n;
+
+	if(!Built || !pThing->DataFields)
+	{
+		return THING_INDEX_EMPTY;
+	}
+
+	//straight from the fields, this is called from ~Thing
+	ID = pThing->DataFields[INDEX_ID].Value;
+	for(Slot = IDTable.First(HashInt(ID)); (n = IDTable.Get(Slot)) != HASH_EMPTY; Slot = IDTable.Next(Slot))
+	{
+		if(Entries[n].ID == ID)
+		{
+			while(n != THING_INDEX_EMPTY && Entries[n].pThing != pThing)
+			{
+				n = Entries[n].NextSameID;
+			}
+			return n;
+		}
+	}
+
+	return THING_INDEX_EMPTY;
+}
+
+//end: Accessors *******************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void ThingIndex::Clear()
+{
+	if(Entries)
+	{
+		delete[] Entries;
+		Entries = NULL;
+	}
+	IDTable.Clear();
+	NameTable.Clear();
+	pHead = NULL;
+	Built = FALSE;
+	NumEntries = 0;
+	MaxEntries = 0;
+}
+
+void ThingIndex::Insert(int n)
+{
+	THING_INDEX_ENTRY_T *pEntry;
+	char *Name;
+	int Slot;
+	int Other;
+
+	pEntry = &Entries[n];
+
+	Slot = IDTable.First(HashInt(pEntry->ID));
+	while(IDTable.Get(Slot) != HASH_EMPTY && Entries[IDTable.Get(Slot)].ID != pEntry->ID)
+	{
+		Slot = IDTable.Next(Slot);
+	}
+	pEntry->NextSameID = IDTable.Get(Slot);
+	IDTable.Set(Slot, n);
+
+	pEntry->NextSameName = THING_INDEX_EMPTY;
+	Name = pEntry->pThing->GetData(INDEX_NAME).String;
+	if(Name)
+	{
+		for(Slot = NameTable.First(pEntry->NameHash); NameTable.Get(Slot) != HASH_EMPTY; Slot = NameTable.Next(Slot))
+		{
+			Other = FirstAlive(NameTable.Get(Slot), TRUE);
+			if(Other != THING_INDEX_EMPTY && Entries[Other].NameHash == pEntry->NameHash &&
+				!strcmp(Entries[Other].pThing->GetData(INDEX_NAME).String, Name))
+			{
+				pEntry->NextSameName = NameTable.Get(Slot);
+				break;
+			}
+		}
+		NameTable.Set(Slot, n);
+	}
+}
+
+void ThingIndex::AddHead(Thing *pThing)
+{
+	THING_INDEX_ENTRY_T *pEntry;
+	char *Name;
+
+	if(!Built)
+	{
+		return;
+	}
+	if((Thing *)pThing->GetNext() != pHead)
+	{
+		Built = FALSE;
+		return;
+	}
+
+	pHead = pThing;
+	if(!pThing->DataFields)
+	{
+		return;
+	}
+	//the tables were sized for MaxEntries
+	if(NumEntries >= MaxEntries)
+	{
+		Built = FALSE;
+		return;
+	}
+
+	pEntry = &Entries[NumEntries];
+	pEntry->pThing = pThing;
+	pEntry->ID = pThing->GetData(INDEX_ID).Value;
+	pEntry->UID = pThing->GetData(INDEX_UID).Value;
+	Name = pThing->GetData(INDEX_NAME).String;
+	pEntry->NameHash = Name ? HashString(Name) : 0;
+	Insert(NumEntries++);
+}
+
+void ThingIndex::Remove(Thing *pThing)
+{
+	int n;
+
+	if(!Built)
+	{
+		return;
+	}
+	if(pHead == pThing)
+	{
+		pHead = (Thing *)pThing->GetNext();
+	}
+
+	n = Locate(pThing);
+	if(n != THING_INDEX_EMPTY)
+	{
+		Entries[n].pThing = NULL;
+	}
+}
+
+void ThingIndex::Changing(Thing *pThing)
+{
+	if(Locate(pThing) != THING_INDEX_EMPTY)
+	{
+		Built = FALSE;
+	}
+}
+
+void ThingIndex::Build(Thing *pNewHead)
+{
+	Thing *pThing;
+	THING_INDEX_ENTRY_T *pEntry;
+	char *Name;
+	int NumThings;
+	int n;
+
+	NumThings = 0;
+	pThing = pNewHead;
+	while(pThing)
+	{
+		NumThings++;
+		pThing = (Thing *)pThing->GetNext();
+	}
+
+	if(NumThings > MaxEntries)
+	{
+		if(Entries)
+		{
+			delete[] Entries;
+		}
+		MaxEntries = NumThings + NumThings / 4;
+		Entries = new THING_INDEX_ENTRY_T[MaxEntries];
+	}
+
+	//room for the things AddHead links on before the next build
+	IDTable.Reset(MaxEntries);
+	NameTable.Reset(MaxEntries);
+
+	NumEntries = 0;
+	pThing = pNewHead;
+	while(pThing)
+	{
+		//lists are briefly headed by a thing whose data has not been read yet
+		if(pThing->DataFields)
+		{
+			pEntry = &Entries[NumEntries];
+			pEntry->pThing = pThing;
+			pEntry->ID = pThing->GetData(INDEX_ID).Value;
+			pEntry->UID = pThing->GetData(INDEX_UID).Value;
+			Name = pThing->GetData(INDEX_NAME).String;
+			pEntry->NameHash = Name ? HashString(Name) : 0;
+			NumEntries++;
+		}
+		pThing = (Thing *)pThing->GetNext();
+	}
+
+	//insert from the back of the list so the first of each key in list order
+	//ends up in the table and the rest follow it
+	for(n = NumEntries - 1; n >= 0; n--)
+	{
+		Insert(n);
+	}
+
+	pHead = pNewHead;
+	Built = TRUE;
+	NumBuilds++;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Debug ***************************************************
+
+int BenchmarkThingFind(FILE *fpResults)
+{
+	Thing *pFirst;
+	Thing *pThing;
+	Thing *pWalked;
+	Thing *pIndexed;
+	int NumLookups = 0;
+	int NumMismatches = 0;
+	LARGE_INTEGER Frequency;
+	LARGE_INTEGER Start;
+	LARGE_INTEGER End;
+	double WalkTime = 0.0;
+	double IndexTime = 0.0;
+	int ID;
+	int UID;
+	char *Name;
+
+	pFirst = Creature::GetFirst();
+	if(!pFirst)
+	{
+		return 0;
+	}
+
+	QueryPerformanceFrequency(&Frequency);
+
+	//force the build outside the timings
+	Thing::Find(pFirst, 0, 0);
+
+	pThing = pFirst;
+	while(pThing)
+	{
+		ID = pThing->GetData(INDEX_ID).Value;
+		UID = pThing->GetData(INDEX_UID).Value;
+		Name = pThing->GetData(INDEX_NAME).String;
+
+		QueryPerformanceCounter(&Start);
+		pWalked = Thing::WalkFind(pFirst, Name);
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		pIndexed = Thing::Find(pFirst, Name);
+		QueryPerformanceCounter(&End);
+		IndexTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(pWalked != pIndexed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"name %s: walk and index disagree\n",Name);
+			}
+		}
+
+		QueryPerformanceCounter(&Start);
+		pWalked = Thing::WalkFind(pFirst, ID, UID);
+		QueryPerformanceCounter(&End);
+		WalkTime += (double)(End.QuadPart - Start.QuadPart);
+
+		QueryPerformanceCounter(&Start);
+		pIndexed = Thing::Find(pFirst, ID, UID);
+		QueryPerformanceCounter(&End);
+		IndexTime += (double)(End.QuadPart - Start.QuadPart);
+
+		if(pWalked != pIndexed)
+		{
+			NumMismatches++;
+			if(fpResults)
+			{
+				fprintf(fpResults,"id %i uid %i: walk and index disagree\n",ID,UID);
+			}
+		}
+
+		NumLookups += 2;
+		pThing = (Thing *)pThing->GetNext();
+	}
+
+	if(fpResults)
+	{
+		WalkTime = WalkTime * 1000000.0 / (double)Frequency.QuadPart;
+		IndexTime = IndexTime * 1000000.0 / (double)Frequency.QuadPart;
+		fprintf(fpResults,"%i creature lookups, %i mismatches\n",NumLookups,NumMismatches);
+		fprintf(fpResults,"walk: total %.1f us, average %.3f us\n",WalkTime,WalkTime / (double)NumLookups);
+		fprintf(fpResults,"index: total %.1f us, average %.3f us\n",IndexTime,IndexTime / (double)NumLookups);
+	}
+
+	return NumMismatches;
+}
+
+//end: Debug ***********************************************************
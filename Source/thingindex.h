@@ -0,0 +1,114 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				thingindex.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  hashed ID and name lookups over the creature, item and
+//*			 spellbook lists
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		searches that start part way down a list still walk it
+//*********************************************************************
+//*********************************************************************
+#ifndef THINGINDEX_H
+#define THINGINDEX_H
+
+#include "defs.h"
+#include <stdio.h>
+#include "hashindex.h"
+
+//preprocessor defs ***********************************************
+
+#define THING_INDEX_EMPTY		HASH_EMPTY
+
+class Thing;
+
+typedef struct
+{
+	Thing *pThing;
+	int ID;
+	int UID;
+	unsigned int NameHash;
+	//the next thing down the list sharing this ID or name
+	int NextSameID;
+	int NextSameName;
+} THING_INDEX_ENTRY_T;
+
+//*******************************CLASS********************************
+//**************          ThingIndex             *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  Answer Thing::Find from a hash of a whole list instead of
+//*			 walking it.  Matches come back in list order so the first
+//*			 thing found is the one the walk would have found.
+//*			 A thing linked at the head or destroyed is added or
+//*			 dropped in place, anything else that changes the list or
+//*			 a key invalidates it and the next Find rebuilds.
+//********************************************************************
+//*Invariants: the index is only trusted while Built and its head is
+//*				 the head passed to Find.  Destroyed things stay as dead
+//*				 entries, with no thing, until the next build.
+//********************************************************************
+class ThingIndex
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	Thing *pHead;
+	BOOL Built;
+
+	int NumEntries;
+	int MaxEntries;
+	THING_INDEX_ENTRY_T *Entries;
+
+	HashIndex IDTable;
+	HashIndex NameTable;
+
+	int NumBuilds;
+
+	void Build(Thing *pNewHead);
+	inline void Validate(Thing *pListHead);
+	//chains entry n in front of the entries already holding its keys
+	void Insert(int n);
+	//the entry for pThing, or THING_INDEX_EMPTY
+	int Locate(Thing *pThing);
+	//the first entry still holding a thing from n on down its chain
+	int FirstAlive(int n, BOOL ByName);
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	Thing *Find(Thing *pListHead, int ID, int UID);
+	Thing *Find(Thing *pListHead, const char *ThingName);
+
+	int GetNumEntries() { return NumEntries; }
+	int GetNumBuilds() { return NumBuilds; }
+
+// Mutators -----------------------------------------
+	void Clear();
+	void Invalidate() { Built = FALSE; }
+	//pThing has just been linked in front of the head
+	void AddHead(Thing *pThing);
+	//pThing is being destroyed
+	void Remove(Thing *pThing);
+	//pThing's name, ID or UID is about to change
+	void Changing(Thing *pThing);
+
+// Constructors ---------------------------------------
+	ThingIndex();
+
+// Destructor -----------------------------------------
+	~ThingIndex();
+
+};
+
+//time every creature lookup by name and ID against a plain walk of the list
+int BenchmarkThingFind(FILE *fpResults);
+
+#endif
@@ -21,6 +21,11 @@
 #include "zsutilities.h"
 #include "world.h"
 #include "gameitem.h"
+#include "creatures.h"
+#include "items.h"
+#include "spellbook.h"
+#include "thingindex.h"
+#include "fieldschema.h"
 #include <assert.h>
 
 float ArrowAngle = 0.0f;
@@ -32,6 +37,10 @@ float ArrowAlpha = 0.1f;
 int Thing::NextUniqueID = 0;
 int Thing::NumThings = 0;
 
+static ThingIndex CreatureIndex;
+static ThingIndex ItemIndex;
+static ThingIndex SpellbookIndex;
+
 
 //************** Constructors  ****************************************
 
@@ -103,6 +112,10 @@ Thing::Thing(Thing *pFrom)
 
 Thing::~Thing()
 {
+	CreatureIndex.Remove(this);
+	ItemIndex.Remove(this);
+	SpellbookIndex.Remove(this);
+
 	//delete all data fields
 	delete[] DataFields;
 	//because things may cross reference data field names, do not delete them
@@ -161,18 +174,14 @@ DATA_FIELD_T Thing::GetData(int fieldnum)
 
 DATA_FIELD_T Thing::GetData(char *fieldname)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found return the value at that fieldname
 	//if no match is found display an error message
-	int fn = 0;
 	int n;
-	for(n = 0; n < NumFields; n++)
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
-		{
-			return DataFields[n];
-		}
-		fn += 32;
+		return DataFields[n];
 	}
 
 	//display error
@@ -202,6 +211,91 @@ int Thing::GetNumFields()
 }
 
 Thing *Thing::Find(Thing *SearchStart, int ID, int UID)
+{
+	if(!SearchStart)
+	{
+		return NULL;
+	}
+	if(SearchStart == (Thing *)Creature::GetFirst())
+	{
+		return CreatureIndex.Find(SearchStart, ID, UID);
+	}
+	if(SearchStart == (Thing *)Item::GetFirst())
+	{
+		return ItemIndex.Find(SearchStart, ID, UID);
+	}
+	if(SearchStart == Spellbook::GetFirst())
+	{
+		return SpellbookIndex.Find(SearchStart, ID, UID);
+	}
+
+	return WalkFind(SearchStart, ID, UID);
+}
+
+Thing *Thing::Find(Thing *SearchStart, const char *ThingName)
+{
+	if(!SearchStart)
+	{
+		return NULL;
+	}
+	if(SearchStart == (Thing *)Creature::GetFirst())
+	{
+		return CreatureIndex.Find(SearchStart, ThingName);
+	}
+	if(SearchStart == (Thing *)Item::GetFirst())
+	{
+		return ItemIndex.Find(SearchStart, ThingName);
+	}
+	if(SearchStart == Spellbook::GetFirst())
+	{
+		return SpellbookIndex.Find(SearchStart, ThingName);
+	}
+
+	return WalkFind(SearchStart, ThingName);
+}
+
+void Thing::InvalidateFind(OBJECT_T ListType)
+{
+	switch(ListType)
+	{
+	case OBJECT_CREATURE:
+		CreatureIndex.Invalidate();
+		break;
+	case OBJECT_ITEM:
+		ItemIndex.Invalidate();
+		break;
+	default:
+		CreatureIndex.Invalidate();
+		ItemIndex.Invalidate();
+		SpellbookIndex.Invalidate();
+		break;
+	}
+}
+
+void Thing::ChangingFindKey()
+{
+	CreatureIndex.Changing(this);
+	ItemIndex.Changing(this);
+	SpellbookIndex.Changing(this);
+}
+
+void Thing::LinkedAtHead()
+{
+	switch(GetObjectType())
+	{
+	case OBJECT_CREATURE:
+		CreatureIndex.AddHead(this);
+		break;
+	case OBJECT_ITEM:
+		ItemIndex.AddHead(this);
+		break;
+	default:
+		InvalidateFind(GetObjectType());
+		break;
+	}
+}
+
+Thing *Thing::WalkFind(Thing *SearchStart, int ID, int UID)
 {
 	Thing *pThing = SearchStart;
 
@@ -227,7 +321,7 @@ Thing *Thing::Find(Thing *SearchStart, int ID, int UID)
 	return pThing;
 }
 
-Thing *Thing::Find(Thing *SearchStart, const char *ThingName)
+Thing *Thing::WalkFind(Thing *SearchStart, const char *ThingName)
 {
 	Thing *pThing = SearchStart;
 
@@ -246,13 +340,30 @@ Thing *Thing::Find(Thing *SearchStart, const char *ThingName)
 	return pThing;
 }
 
-int Thing::GetIndex(char *FieldName)
+int Thing::FindField(const char *FieldName)
 {
-	//compare each data field name to the field name passed
-	//when a match is found return the value at that fieldname
-	//if no match is found display an error message
+	FieldSchema *pSchema;
+	int n;
+
+	if(!DataFieldNames)
+	{
+		return -1;
+	}
+
+	pSchema = FieldSchema::Get(DataFieldNames, NumFields);
+	if(pSchema)
+	{
+		n = pSchema->Find(FieldName);
+		if(n < NumFields)
+		{
+			return n;
+		}
+		return -1;
+	}
+
+	//every schema slot is taken, fall back to comparing names
 	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	for(n = 0; n < NumFields; n++)
 	{
 		if(!strcmp(FieldName,&DataFieldNames[fn]))
 		{
@@ -260,6 +371,20 @@ int Thing::GetIndex(char *FieldName)
 		}
 		fn += 32;
 	}
+	return -1;
+}
+
+int Thing::GetIndex(char *FieldName)
+{
+	//look the field name up in the schema for this class of thing
+	//when a match is found return the value at that fieldname
+	//if no match is found display an error message
+	int n;
+	n = FindField(FieldName);
+	if(n != -1)
+	{
+		return n;
+	}
 
 	//display error
 	
@@ -567,6 +692,10 @@ int Thing::SetNumFields(int NewNumFields)
 int Thing::SetData(int fieldnum, int NewValue)
 {
 	//set the value at the index provide to be equal to the value passed
+	if((fieldnum == INDEX_ID || fieldnum == INDEX_UID) && DataFields[fieldnum].Value != NewValue)
+	{
+		ChangingFindKey();
+	}
 	DataFields[fieldnum].Value = NewValue;
 	//done
 	return TRUE;
@@ -574,18 +703,19 @@ int Thing::SetData(int fieldnum, int NewValue)
 
 int Thing::SetData(char *fieldname, int NewValue)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		if((n == INDEX_ID || n == INDEX_UID) && DataFields[n].Value != NewValue)
 		{
-			DataFields[n].Value = NewValue;
-			return TRUE;
+			ChangingFindKey();
 		}
-		fn += 32;
+		DataFields[n].Value = NewValue;
+		return TRUE;
 	}
 
 	//display error
@@ -608,18 +738,15 @@ int Thing::SetData(int fieldnum, float NewfValue)
 
 int Thing::SetData(char *fieldname, float NewfValue)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
-		{
-			DataFields[n].fValue = NewfValue;
-			return TRUE;
-		}
-		fn += 32;
+		DataFields[n].fValue = NewfValue;
+		return TRUE;
 	}
 	
 	DEBUG_INFO("SetData: Failed to find field: ");
@@ -633,6 +760,10 @@ int Thing::SetData(char *fieldname, float NewfValue)
 int Thing::SetData(int fieldnum, char *NewString)
 {
 	//set the value at the index provide to be equal to the value passed
+	if(fieldnum == INDEX_NAME)
+	{
+		ChangingFindKey();
+	}
 	if(DataFields[fieldnum].String)
 		delete[] DataFields[fieldnum].String;
 	DataFields[fieldnum].String = NewString;
@@ -642,20 +773,21 @@ int Thing::SetData(int fieldnum, char *NewString)
 
 int Thing::SetData(char *fieldname, char *NewString)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
+		if(n == INDEX_NAME)
 		{
-			if(DataFields[n].String)
-				delete[] DataFields[n].String;
-			DataFields[n].String = NewString;
-			return TRUE;
+			ChangingFindKey();
 		}
-		fn += 32;
+		if(DataFields[n].String)
+			delete[] DataFields[n].String;
+		DataFields[n].String = NewString;
+		return TRUE;
 	}
 
 
@@ -676,18 +808,15 @@ int Thing::SetData(int fieldnum, D3DVECTOR *NewpVector)
 
 int Thing::SetData(char *fieldname, D3DVECTOR *NewpVector)
 {
-	//compare each data field name to the field name passed
+	//look the field name up in the schema for this class of thing
 	//when a match is found set that field to equal to value passed
 	//if no match is found display an error message
-	int fn = 0;
-	for(int n = 0; n < NumFields; n++)
+	int n;
+	n = FindField(fieldname);
+	if(n != -1)
 	{
-		if(!strcmp(fieldname,&DataFieldNames[fn]))
-		{
-			DataFields[n].pVector = NewpVector;
-			return TRUE;
-		}
-		fn += 32;
+		DataFields[n].pVector = NewpVector;
+		return TRUE;
 	}
 
 	//display error
@@ -758,6 +887,7 @@ int Thing::LoadFieldNames(FILE *fp, char *destination)
 	//printf("number of fields: %i\n",numfields);
 
 	DataFieldNames = destination;
+	FieldSchema::Rebuild(DataFieldNames, NumFields);
 
 	DEBUG_INFO("Loaded FieldNames\n");
 
@@ -793,6 +923,8 @@ int Thing::LoadBin(FILE *fp)
 	}
 
 	DataFields = new DATA_FIELD_T[NumFields];
+	//a thing linked before its data was read has no entry yet
+	InvalidateFind(GetObjectType());
 
 	int Length, n;
 	for(n = 0; n < NumFields; n++)
@@ -847,6 +979,8 @@ int Thing::LoadData(FILE *fp)
 	//read in the data fields one at a time from the file passed 
 	//allocate space for the data
 	DataFields = new DATA_FIELD_T[NumFields];
+	//a thing linked before its data was read has no entry yet
+	InvalidateFind(GetObjectType());
 	if(!DataTypes)
 	{
 		DataTypes = new DATA_T[NumFields];
@@ -1035,6 +1169,7 @@ bool Thing::operator == (Thing &ThingOne)
 
 Thing& Thing::operator = (Thing &OtherThing)
 {
+	ChangingFindKey();
 	for(int n = 0; n < NumFields; n++)
 	{
 		switch(DataTypes[n])
@@ -188,6 +188,8 @@ protected:
 //	Thing *pNext;
 	
 	DATA_T *DataTypes;
+
+	friend class ThingIndex;
 	
 //************************************************************************************** 
 
@@ -209,6 +211,9 @@ public:
 
 	static Thing *Find(Thing *SearchStart, int ID, int UID = 0);
 	static Thing *Find(Thing *SearchStart, const char *ThingName);
+	//the plain list walks Find falls back to away from the head of a list
+	static Thing *WalkFind(Thing *SearchStart, int ID, int UID = 0);
+	static Thing *WalkFind(Thing *SearchStart, const char *ThingName);
 
    virtual DATA_FIELD_T GetData(int fieldnum);			
    virtual DATA_FIELD_T GetData(char *fieldname);	
@@ -217,6 +222,8 @@ public:
 	char *GetFieldNames();
 	int GetNumFields();
 	int GetIndex(char *FieldName);
+	//GetIndex without the complaint, -1 if this thing has no such field
+	int FindField(const char *FieldName);
 	char *GetName(int FieldNum);
 	DATA_T GetType(int FieldNum);
 	DATA_T *GetDataTypes() { return DataTypes; }
@@ -247,6 +254,14 @@ public:
 
 
 //	int SetNext(Thing *NewNext);
+	//anything that relinks the creature, item or spellbook lists, other than
+	//linking a new thing at the head, must call this.  spellbooks are plain
+	//things, so OBJECT_THING drops every index.
+	static void InvalidateFind(OBJECT_T ListType = OBJECT_THING);
+	//call before changing a name, ID or UID without going through SetData
+	void ChangingFindKey();
+	//call after linking this thing in front of the head of its list
+	void LinkedAtHead();
 	int SetFieldNames(char *NewNames);
 	int SetNumFields(int NewNumFields);
 
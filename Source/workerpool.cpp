@@ -0,0 +1,236 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				workerpool.cpp					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the one set of worker threads the offscreen scheduler and
+//*			 the bakes share
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		one Run at a time, a second one from another thread or from
+//*		inside a job runs its jobs on its own caller
+//*********************************************************************
+//*********************************************************************
+#include "workerpool.h"
+#include "debuglog.h"
+#include "profiler.h"
+
+WorkerPool PreludeWorkers;
+
+//************** Constructors  ****************************************
+
+WorkerPool::WorkerPool()
+{
+	SYSTEM_INFO SysInfo;
+
+	//the caller of Run takes a share itself
+	GetSystemInfo(&SysInfo);
+	NumThreads = (int)SysInfo.dwNumberOfProcessors - 1;
+	if(NumThreads > WORKER_MAX_THREADS)
+	{
+		NumThreads = WORKER_MAX_THREADS;
+	}
+	if(NumThreads < 0)
+	{
+		NumThreads = 0;
+	}
+
+	Started = FALSE;
+	Quit = FALSE;
+	Busy = 0;
+	Job = NULL;
+	pData = NULL;
+	NumJobs = 0;
+	NextJob = 0;
+	NumWoken = 0;
+	NumRuns = 0;
+	NumInline = 0;
+}
+
+//end:  Constructors ***************************************************
+
+
+
+//*************** Destructor *******************************************
+
+WorkerPool::~WorkerPool()
+{
+	Stop();
+}
+
+//end:  Destructor *****************************************************
+
+
+
+//************  Worker Threads  ****************************************
+
+DWORD WINAPI WorkerPool::WorkerThread(LPVOID pParam)
+{
+	WORKER_T *pWorker;
+	pWorker = (WORKER_T *)pParam;
+	pWorker->pPool->WorkerLoop(pWorker->Num);
+	ProfileThreadDone();
+	LogThreadDone();
+	return 0;
+}
+
+void WorkerPool::WorkerLoop(int Worker)
+{
+	while(TRUE)
+	{
+		WaitForSingleObject(hStart[Worker], INFINITE);
+		if(Quit)
+		{
+			break;
+		}
+		Work();
+		SetEvent(hDone[Worker]);
+	}
+}
+
+void WorkerPool::Work()
+{
+	LONG Next;
+
+	while((Next = InterlockedIncrement(&NextJob) - 1) < NumJobs)
+	{
+		Job((int)Next, pData);
+	}
+}
+
+//end: Worker Threads **************************************************
+
+
+
+//************  Mutators  **********************************************
+
+void WorkerPool::Start()
+{
+	DWORD ThreadID;
+	int n;
+
+	Quit = FALSE;
+
+	for(n = 0; n < NumThreads; n++)
+	{
+		Workers[n].pPool = this;
+		Workers[n].Num = n;
+		hStart[n] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		hDone[n] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		hThreads[n] = CreateThread(NULL,
+			0,
+			(LPTHREAD_START_ROUTINE)WorkerThread,
+			(LPVOID)&Workers[n],
+			0,
+			&ThreadID);
+
+		if(!hThreads[n])
+		{
+			DEBUG_INFO("Worker pool could not start all its threads\n");
+			CloseHandle(hStart[n]);
+			CloseHandle(hDone[n]);
+			NumThreads = n;
+			break;
+		}
+	}
+
+	Started = TRUE;
+}
+
+void WorkerPool::Run(WORKER_JOB_T NewJob, void *pNewData, int Count)
+{
+	int n;
+
+	if(Count < 1)
+	{
+		return;
+	}
+
+	//nothing to share, or the threads are already on another run
+	if(Count == 1 || !NumThreads || InterlockedCompareExchange(&Busy, 1, 0) != 0)
+	{
+		for(n = 0; n < Count; n++)
+		{
+			NewJob(n, pNewData);
+		}
+		InterlockedIncrement(&NumInline);
+		return;
+	}
+
+	if(!Started)
+	{
+		Start();
+	}
+
+	Job = NewJob;
+	pData = pNewData;
+	NumJobs = Count;
+	InterlockedExchange(&NextJob, 0);
+
+	NumWoken = Count - 1;
+	if(NumWoken > NumThreads)
+	{
+		NumWoken = NumThreads;
+	}
+	for(n = 0; n < NumWoken; n++)
+	{
+		SetEvent(hStart[n]);
+	}
+
+	Work();
+
+	if(NumWoken)
+	{
+		WaitForMultipleObjects(NumWoken, hDone, TRUE, INFINITE);
+	}
+
+	Job = NULL;
+	pData = NULL;
+	NumRuns++;
+	InterlockedExchange(&Busy, 0);
+}
+
+void WorkerPool::Stop()
+{
+	int n;
+
+	if(!Started)
+	{
+		return;
+	}
+
+	Quit = TRUE;
+	for(n = 0; n < NumThreads; n++)
+	{
+		SetEvent(hStart[n]);
+	}
+	if(NumThreads)
+	{
+		WaitForMultipleObjects(NumThreads, hThreads, TRUE, INFINITE);
+	}
+	for(n = 0; n < NumThreads; n++)
+	{
+		CloseHandle(hThreads[n]);
+		CloseHandle(hStart[n]);
+		CloseHandle(hDone[n]);
+	}
+	Started = FALSE;
+}
+
+//end: Mutators ********************************************************
+
+
+
+//************ Debug ***************************************************
+
+void WorkerPool::OutPutDebugInfo(FILE *fp)
+{
+	fprintf(fp,"Worker pool: %i threads and the caller, %s\n", NumThreads, Started ? "running" : "not started");
+	fprintf(fp,"%i runs shared, %li run by their caller alone\n", NumRuns, (long)NumInline);
+}
+
+//end: Debug ***********************************************************
@@ -0,0 +1,113 @@
+//*********************************************************************
+//*                                                                                                                                    **
+//**************				workerpool.h					  *********************
+//**                                                                                                                                  **
+//**                                                                                                                                  **
+//*********************************************************************
+//*                                                                                                                                      *
+//*Revision:                                                                                            *
+//*Revisor:
+//*Purpose:  the one set of worker threads the offscreen scheduler and
+//*			 the bakes share
+//*********************************************************************
+//*Outstanding issues:                                                                                                       *
+//*		one Run at a time, a second one from another thread or from
+//*		inside a job runs its jobs on its own caller
+//*********************************************************************
+//*********************************************************************
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "defs.h"
+#include <stdio.h>
+
+//preprocessor defs ***********************************************
+
+#define WORKER_MAX_THREADS		16
+
+//Job is which of Run's jobs this is, from 0 to Count - 1.  No two calls
+//with the same Job overlap, so it can pick a copy of anything the job
+//needs to itself
+typedef void (*WORKER_JOB_T)(int Job, void *pData);
+
+class WorkerPool;
+
+typedef struct
+{
+	WorkerPool *pPool;
+	int Num;
+} WORKER_T;
+
+//*******************************CLASS********************************
+//**************          WorkerPool             *********************
+//**					                                  **
+//********************************************************************
+//*Purpose:  A thread for every processor but the one that calls Run,
+//*			 started the first time there is work for them and asleep
+//*			 between runs.  Run hands out its jobs to the threads and
+//*			 the caller alike and returns when every one has finished.
+//********************************************************************
+//*Invariants: Job, pData, NumJobs and NumWoken only change while
+//*				 Busy is held and the threads are asleep
+//********************************************************************
+class WorkerPool
+{
+private:
+//**************************************************************************************
+//                             MEMBER VARIABLES
+	int NumThreads;
+	BOOL Started;
+	WORKER_T Workers[WORKER_MAX_THREADS];
+	HANDLE hThreads[WORKER_MAX_THREADS];
+	HANDLE hStart[WORKER_MAX_THREADS];
+	HANDLE hDone[WORKER_MAX_THREADS];
+	volatile BOOL Quit;
+
+	//the run going on
+	volatile LONG Busy;
+	WORKER_JOB_T Job;
+	void *pData;
+	LONG NumJobs;
+	volatile LONG NextJob;
+	int NumWoken;
+
+	//stats
+	int NumRuns;
+	volatile LONG NumInline;
+
+	static DWORD WINAPI WorkerThread(LPVOID pParam);
+	void WorkerLoop(int Worker);
+	void Start();
+	//takes jobs until there are none left
+	void Work();
+
+//**************************************************************************************
+
+public:
+
+// Accessors ----------------------------------------
+	//threads a Run can spread over, the caller's included
+	int GetNumThreads() { return NumThreads + 1; }
+	int GetNumRuns() { return NumRuns; }
+
+// Mutators -----------------------------------------
+	//calls Job for 0 to Count - 1 across the threads and waits for them
+	void Run(WORKER_JOB_T NewJob, void *pNewData, int Count);
+
+	//ends the threads, the next Run starts them again
+	void Stop();
+
+// Constructors ---------------------------------------
+	WorkerPool();
+
+// Destructor -----------------------------------------
+	~WorkerPool();
+
+// Debug ----------------------------------------------
+	void OutPutDebugInfo(FILE *fp);
+
+};
+
+extern WorkerPool PreludeWorkers;
+
+#endif